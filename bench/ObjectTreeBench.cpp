@@ -0,0 +1,73 @@
+#include "../src/Graphics/BVH.hpp"
+
+#include <chrono>
+#include <glm/gtc/matrix_transform.hpp>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#define BENCH_WORLD_SIZE 1000.0f // Width of the cube the objects are scattered in
+#define BENCH_REPEATS	 100	 // Times each query is run
+
+// Average milliseconds p_query takes over BENCH_REPEATS runs
+template <typename T>
+static double Time( const T& p_query )
+{
+	auto start = std::chrono::high_resolution_clock::now();
+	for ( uint32_t i = 0; i < BENCH_REPEATS; i++ )
+		p_query();
+	return std::chrono::duration<double, std::milli>( std::chrono::high_resolution_clock::now() - start ).count() / BENCH_REPEATS;
+}
+
+static void Compare( const char* p_name, const double& p_linear, const double& p_tree, const size_t& p_linearFound, const size_t& p_treeFound )
+{
+	std::cout << "\t" << p_name << ": linear " << p_linear << "ms, tree " << p_tree << "ms (" << p_linear / p_tree << "x, " << p_linearFound << " found, " << p_treeFound << " by the fattened bounds)" << std::endl;
+}
+
+static void Bench( const uint32_t& p_objectCount )
+{
+	// Scatter the objects' bounds through the world
+	std::mt19937						  random( p_objectCount );
+	std::uniform_real_distribution<float> position( -0.5f * BENCH_WORLD_SIZE, 0.5f * BENCH_WORLD_SIZE );
+	std::uniform_real_distribution<float> size( 0.5f, 4.0f );
+
+	std::vector<AABB> bounds( p_objectCount );
+	DynamicBVH		  tree;
+	for ( uint32_t i = 0; i < p_objectCount; i++ )
+	{
+		glm::vec3 centre( position( random ), position( random ), position( random ) );
+		bounds[i] = AABB( centre - glm::vec3( size( random ) ), centre + glm::vec3( size( random ) ) );
+		tree.CreateProxy( bounds[i], i );
+	}
+
+	std::cout << p_objectCount << " objects (Tree height " << tree.GetHeight() << "):" << std::endl;
+
+	// A camera at the centre of the world looking down negative z, as the engine's does
+	glm::mat4	  view	  = glm::lookAt( glm::vec3( 0.0f ), glm::vec3( 0.0f, 0.0f, -1.0f ), glm::vec3( 0.0f, 1.0f, 0.0f ) );
+	glm::mat4	  proj	  = glm::perspective( glm::radians( 45.0f ), 16.0f / 9.0f, 0.1f, 0.5f * BENCH_WORLD_SIZE );
+	const Frustum frustum = Frustum::FromMatrix( proj * view );
+
+	// Find the objects in the camera's frustum
+	size_t linearFound = 0, treeFound = 0;
+	double linear = Time( [&]() {
+		linearFound = 0;
+		for ( const AABB& box : bounds )
+			if ( frustum.Classify( box ) != FrustumTest::OUTSIDE ) linearFound++;
+	} );
+	double treeTime = Time( [&]() {
+		treeFound = 0;
+		tree.QueryFrustum( frustum, [&]( const uint32_t& p_objectID ) {
+			treeFound++;
+			return true; // Continue the query
+		} );
+	} );
+	Compare( "frustum", linear, treeTime, linearFound, treeFound );
+}
+
+int main()
+{
+	// Compare a linear scan of every object against the bounding volume hierarchy's frustum query
+	Bench( 10000 );
+	Bench( 100000 );
+	return 0;
+}
\ No newline at end of file
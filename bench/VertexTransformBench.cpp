@@ -0,0 +1,118 @@
+#include "../src/Graphics/Models.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <glm/gtc/matrix_transform.hpp>
+#include <iostream>
+#include <vector>
+
+#define BENCH_VERTEX_COUNT 1000000 // Vertices in the benchmarked mesh
+#define BENCH_REPEATS	   20	   // Times each path transforms the mesh
+
+// Average milliseconds p_transform takes over BENCH_REPEATS runs
+template <typename T>
+static double Time( const T& p_transform )
+{
+	auto start = std::chrono::high_resolution_clock::now();
+	for ( uint32_t i = 0; i < BENCH_REPEATS; i++ )
+		p_transform();
+	return std::chrono::duration<double, std::milli>( std::chrono::high_resolution_clock::now() - start ).count() / BENCH_REPEATS;
+}
+
+// Model::GetVerticesAfterMatrix as it was before the kernels, a copy of the vertices transformed one at a time
+static std::vector<Vertex> GetVerticesAfterMatrixLegacy( const std::vector<Vertex>& p_vertices, const glm::mat4& p_modelMatrix, const glm::mat3& p_normalMatrix )
+{
+	std::vector<Vertex> modifiedVertices = p_vertices;
+
+	// Iterate through the modifiedVertices and apply the matrix
+	for ( uint32_t i = 0; i < p_vertices.size(); i++ )
+	{
+		modifiedVertices[i].position = glm::vec3( p_modelMatrix * glm::vec4( p_vertices[i].position, 1.0f ) );
+		modifiedVertices[i].normal	 = glm::vec3( p_normalMatrix * p_vertices[i].normal );
+	}
+
+	return modifiedVertices;
+}
+
+// Largest difference from the expected positions and normals
+static float GetError( const Vertex* p_expected, const Vertex* p_actual, const size_t& p_count )
+{
+	float error = 0.0f;
+	for ( size_t i = 0; i < p_count; i++ )
+		for ( int axis = 0; axis < 3; axis++ )
+			error = std::max( { error, std::abs( p_expected[i].position[axis] - p_actual[i].position[axis] ), std::abs( p_expected[i].normal[axis] - p_actual[i].normal[axis] ) } );
+	return error;
+}
+
+static void Report( const char* p_name, const double& p_milliseconds, const double& p_baseline, const float& p_error )
+{
+	std::cout << "\t" << p_name << ": " << p_milliseconds << "ms (" << p_baseline / p_milliseconds << "x, error " << p_error << ")" << std::endl;
+}
+
+int main()
+{
+	// Build a mesh with an odd count, so every kernel leaves a tail
+	std::vector<Vertex> vertices( BENCH_VERTEX_COUNT + 3 );
+	for ( size_t i = 0; i < vertices.size(); i++ )
+	{
+		float t				 = static_cast<float>( i );
+		vertices[i].position = glm::vec3( std::sin( t ), std::cos( t ), t * 0.001f );
+		vertices[i].normal	 = glm::vec3( std::cos( t ), 0.0f, std::sin( t ) );
+	}
+
+	Model model;
+	model.SetVerticesAndIndices( vertices, {} );
+
+	VertexStreams streams;
+	streams.Build( vertices );
+
+	glm::mat4 modelMatrix  = glm::rotate( glm::translate( glm::mat4( 1.0f ), glm::vec3( 1.0f, 2.0f, 3.0f ) ), glm::radians( 30.0f ), glm::vec3( 0.0f, 1.0f, 0.0f ) );
+	glm::mat3 normalMatrix = glm::transpose( glm::inverse( glm::mat3( modelMatrix ) ) );
+
+	// Stands in for the mapped staging buffer the engine writes the frame's vertices into
+	size_t				count = vertices.size();
+	std::vector<Vertex> frameVertices, staging( count );
+
+	std::cout << "Transforming " << count << " vertices (Picked kernel " << VERTEX_TRANSFORM_KERNEL_NAMES[static_cast<uint32_t>( GetVertexTransformKernel() )] << ")" << std::endl;
+
+	// The path before the kernels is the baseline: transform a copy, gather it into the frame's vertices, then copy those into the staging buffer
+	double legacy = Time(
+		[&]()
+		{
+			std::vector<Vertex> modelVertices = GetVerticesAfterMatrixLegacy( model.GetVertices(), modelMatrix, normalMatrix );
+			frameVertices.clear();
+			frameVertices.insert( frameVertices.end(), modelVertices.begin(), modelVertices.end() );
+			std::memcpy( staging.data(), frameVertices.data(), frameVertices.size() * sizeof( Vertex ) );
+		} );
+	std::cout << "\tlegacy: " << legacy << "ms" << std::endl;
+
+	std::vector<Vertex> expected = staging;
+
+	// Each kernel on its own, straight into the staging buffer
+	for ( VertexTransformKernel kernel : { VertexTransformKernel::SCALAR, VertexTransformKernel::SSE, VertexTransformKernel::AVX2 } )
+	{
+		const char* name = VERTEX_TRANSFORM_KERNEL_NAMES[static_cast<uint32_t>( kernel )];
+		if ( !IsVertexTransformKernelSupported( kernel ) )
+		{
+			std::cout << "\t" << name << ": not supported" << std::endl;
+			continue;
+		}
+
+		double milliseconds = Time( [&]() { TransformVertexRange( streams, vertices.data(), modelMatrix, normalMatrix, staging.data(), 0, count, kernel ); } );
+		Report( name, milliseconds, legacy, GetError( expected.data(), staging.data(), count ) );
+	}
+
+	// The engine's path, the model writing its vertices with the picked kernel, then split across the job system
+	double single = Time( [&]() { model.WriteVerticesAfterMatrix( modelMatrix, normalMatrix, staging.data() ); } );
+	Report( "model", single, legacy, GetError( expected.data(), staging.data(), count ) );
+
+	JobSystem jobs;
+	jobs.Init();
+
+	double threaded = Time( [&]() { model.WriteVerticesAfterMatrix( modelMatrix, normalMatrix, staging.data(), &jobs ); } );
+	std::cout << "\tmodel threaded (" << jobs.GetWorkerCount() << " workers): " << threaded << "ms (" << legacy / threaded << "x, error " << GetError( expected.data(), staging.data(), count ) << ")" << std::endl;
+
+	jobs.Cleanup();
+	return 0;
+}
\ No newline at end of file
@@ -1,23 +1,43 @@
 #pragma once
 #include "Buffers/Buffers.hpp"
+#include "Buffers/FramePacket.hpp"
 #include "Buffers/UniformBuffers.hpp"
 #include "Buffers/Vertex.hpp"
 #include "Descriptors/DescriptorCollection.hpp"
 #include "Descriptors/DescriptorPool.hpp"
 #include "Descriptors/DescriptorSetLayout.hpp"
+#include "Graphics/BVH.hpp"
 #include "Graphics/Camera.hpp"
+#include "Graphics/ClusteredLighting.hpp"
+#include "Graphics/DrawList.hpp"
+#include "Graphics/DynamicResolution.hpp"
+#include "Graphics/GBuffer.hpp"
 #include "Graphics/Images.hpp"
 #include "Graphics/Light.hpp"
+#include "Graphics/Materials.hpp"
 #include "Graphics/Multisampling.hpp"
+#include "Graphics/OverdrawCounters.hpp"
+#include "Graphics/Pipelines.hpp"
+#include "Graphics/QualityPresets.hpp"
+#include "Graphics/RenderGraph.hpp"
 #include "Graphics/Shaders.hpp"
+#include "Graphics/ShadowMaps.hpp"
+#include "Graphics/TextureStreaming.hpp"
 #include "Graphics/Textures.hpp"
 #include "Graphics/WorldObject.hpp"
 #include "Input/Callbacks.hpp"
+#include "Jobs/JobSystem.hpp"
+#include "VulkanUtil/Config.hpp"
 #include "VulkanUtil/DebugMessenger.hpp"
+#include "VulkanUtil/DeletionQueue.hpp"
 #include "VulkanUtil/DeviceAndExtensions.hpp"
+#include "VulkanUtil/FrameLimiter.hpp"
 #include "VulkanUtil/ImageView.hpp"
+#include "VulkanUtil/MemoryTracker.hpp"
+#include "VulkanUtil/ObjectCache.hpp"
 #include "VulkanUtil/QueueFamilies.hpp"
 #include "VulkanUtil/Swapchain.hpp"
+#include "VulkanUtil/TimelineSemaphore.hpp"
 #include "VulkanUtil/Timing.hpp"
 #include "VulkanUtil/Window.hpp"
 
@@ -26,6 +46,8 @@
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
+#include <array>
+#include <chrono>
 #include <glm/glm.hpp>
 #include <iostream>
 #include <stdexcept>
@@ -34,7 +56,20 @@
 const std::string MODEL_PATH   = "resources/models/viking_room.obj";
 const std::string TEXTURE_PATH = "resources/textures/viking_room.png";
 
-#define MAX_FRAMES_IN_FLIGHT 2 // Maximum number of frames to process concurrently
+#define MAX_FRAMES_IN_FLIGHT 2							  // Maximum number of frames to process concurrently
+#define FRAME_PACKET_COUNT	 ( MAX_FRAMES_IN_FLIGHT + 1 ) // One more than the frames in flight, so the next frame can be simulated while this one is recorded
+
+#define TEXTURE_SAMPLER_COUNT 3 // Number of texture samplers in the descriptor set layout
+#define TEXTURE_BINDING		  7 // Binding of the first texture sampler, after the buffers and the shadow map
+
+#define PIPELINE_CACHE_PATH "lib/pipeline.cache" // Driver pipeline cache data saved between runs
+#define PIPELINE_LIST_PATH	"lib/pipelines.txt"	 // Pipeline variants used by previous runs, compiled in the background at startup
+
+#define JOB_WORKER_COUNT 0		// Number of job system workers (Zero uses one per extra core)
+#define JOB_PIN_WORKERS	 false	// Pin each job system worker to its own core
+
+#define LATENCY_REPORT_INTERVAL 5.0f  // Seconds between input to submit latency reports
+#define MEMORY_REPORT_INTERVAL	10.0f // Seconds between device memory reports
 
 class Application
 {
@@ -47,6 +82,8 @@ private:
 	VkDevice					 m_logicalDevice;
 	VkQueue						 m_graphicsQueue;
 	VkQueue						 m_presentQueue;
+	VkQueue						 m_transferQueue; // The graphics queue when there is no dedicated transfer family
+	QueueFamilyIndices			 m_queueFamilies;
 	VkSurfaceKHR				 m_surface;
 	VkSwapchainKHR				 m_swapchain;
 	std::vector<VkImage>		 m_swapchainImages;
@@ -55,37 +92,107 @@ private:
 	std::vector<VkImageView>	 m_swapchainImageViews;
 	VkRenderPass				 m_renderPass;
 	DescriptorCollection		 m_descriptorCollection;
+	ObjectCache					 m_objectCache; // Samplers, layouts and render passes, shared by everything that creates an identical one
 	VkPipelineLayout			 m_pipelineLayout;
-	VkPipeline					 m_graphicsPipeline;
-	std::vector<char>			 m_vertShaderCode;
-	std::vector<char>			 m_fragShaderCode;
-	std::vector<VkFramebuffer>	 m_swapchainFramebuffers;
+	VkPipeline					 m_fallbackPipeline; // Drawn with until a scene variant is ready
+	PipelineCache				 m_pipelineCache;
+	uint32_t					 m_fallbackFrames;	 // Frames drawn with the fallback pipeline
+	VkPipeline					 m_shadowPipeline;	 // Owned by the pipeline cache
+	VkPipeline					 m_prepassPipeline;	 // Forward path with the depth pre-pass only, owned by the pipeline cache
+	VkPipeline					 m_gBufferPipeline;	 // Deferred path only, owned by the pipeline cache
+	VkPipeline					 m_upscalePipeline;	 // Owned by the pipeline cache
+	VkFramebuffer				 m_sceneFramebuffer; // Renders into the dynamic resolution's scene target
 	VkCommandPool				 m_commandPool;
+	VkCommandPool				 m_transferCommandPool;
 	std::vector<VkCommandBuffer> m_commandBuffers;
 	std::vector<VkSemaphore>	 m_imageAvailableSemaphores;
 	std::vector<VkSemaphore>	 m_renderFinishedSemaphores;
-	std::vector<VkFence>		 m_inFlightFences;
-	std::vector<VkFence>		 m_inFlightImages;
+	TimelineSemaphore			 m_frameTimeline; // Signalled with the frame number + 1 when each frame finishes on the GPU
+	uint64_t					 m_frameNumber;	  // Number of frames submitted
+	DeletionQueue				 m_deletionQueue;
 	size_t						 m_currentFrame;
 	std::vector<WorldObject>	 m_objects;
+	MaterialLibrary				 m_materials; // Shared by the objects, along with their textures
+	TextureStreamer				 m_textureStreaming;
+	DynamicBVH					 m_objectTree;
+	TransformStore				 m_transforms;
+	JobSystem					 m_jobs;
 	VkBuffer					 m_vertexBuffer;
 	VkDeviceMemory				 m_vertexBufferMemory;
 	VkBuffer					 m_indexBuffer;
 	VkDeviceMemory				 m_indexBufferMemory;
-	uint32_t					 m_indicesCount;
+	std::vector<uint32_t>		 m_objectFirstIndices; // Where each object's indices start in the index buffer
 	std::vector<VkBuffer>		 m_vertexUniformBufferObjects;
 	std::vector<VkDeviceMemory>	 m_vertexUniformBufferObjectMemory;
+	FramePacket					 m_framePackets[FRAME_PACKET_COUNT]; // Filled by the simulation job, indexed by the frame number
 	// std::vector<VkBuffer>		 m_fragmentUniformBufferObjects;
 	// std::vector<VkDeviceMemory>	 m_fragmentUniformBufferObjectMemory;
-	Image					m_depthImage;
-	Image					m_colourImage;
+	RenderGraph				m_renderGraph;	  // Rebuilt with the swapchain, owns the scene's transient attachments
+	RenderGraphResource		m_colourResource; // Forward path only, multisampled
+	RenderGraphResource		m_depthResource;
+	RenderGraphResource		m_sceneTargetResource;
+	RenderGraphResource		m_swapchainResource; // Swapped for the acquired image every frame
+	RenderGraphResource		m_vertexResource;
+	uint32_t				m_recordImageIndex; // What the graph's passes record with, set before it is executed
+	VkExtent2D				m_recordExtent;
+	FramePacket*			m_recordPacket;
+	GBuffer					m_gBuffer; // Deferred path only
+	DynamicResolution		m_resolution;
+	RenderPath				m_renderPath;
 	VkSampleCountFlagBits	m_msaaSampleCount;
+	bool					m_sampleShadingSupported;
+	bool					m_pipelineStatisticsSupported;
+	bool					m_depthPrepass;		// Forward path only, draws the scene's depth before shading it
+	bool					m_requestedPrepass; // Set from the input, applied after the frame is presented
+	OverdrawCounters		m_overdraw;
 	Camera					m_camera;
 	std::vector<PointLight> m_pointLights;
-	std::vector<DirLight>	m_dirLights;
+	ClusteredLighting		m_clusteredLighting;
+	std::vector<DirLight>	m_dirLights; // The first casts the cascaded shadows
+	ShadowCascades			m_shadows;
+	bool					m_shadowsEnabled;
+
+	// The scene's variant for each material pipeline, owned by the pipeline cache (Null until it has compiled)
+	std::array<VkPipeline, MATERIAL_PIPELINE_COUNT>	 m_scenePipelines;
+	std::array<PipelineKey, MATERIAL_PIPELINE_COUNT> m_scenePipelineKeys;
 
 	bool m_framebufferResized;
 
+	std::string m_deviceOverride; // Name or UUID of the GPU to use, from the command line
+
+	// Quality settings, switched between frames
+	QualityPreset								  m_qualityPreset;
+	QualityPreset								  m_requestedPreset; // Set from the input, applied after the frame is presented
+	QualitySettings								  m_quality;
+	std::array<QualityCost, QUALITY_PRESET_COUNT> m_qualityCosts;
+
+	// Frame pacing settings
+	PresentPolicy m_presentPolicy;
+	FrameLimiter  m_frameLimiter;
+	bool		  m_justInTime; // Sample input and update the camera uniforms right before submitting
+
+	// Input to submit latency measurement
+	std::chrono::steady_clock::time_point m_inputSampleTime;
+	double								  m_latencyTotal;
+	uint32_t							  m_latencySamples;
+	float								  m_latencyReportTime;
+
+	float m_memoryReportTime;
+
+	void LoadFrameSettings()
+	{
+		// Read the frame pacing settings
+		m_presentPolicy = ParsePresentPolicy( GetConfigString( "ENGINE_PRESENT_MODE", "mailbox" ) );
+		m_frameLimiter.Init( GetConfigFloat( "ENGINE_FPS_LIMIT", 0.0f ) );
+		m_justInTime = GetConfigBool( "ENGINE_JUST_IN_TIME", false );
+
+		// Reset the latency measurement
+		m_latencyTotal		= 0.0;
+		m_latencySamples	= 0;
+		m_latencyReportTime = 0.0f;
+		m_memoryReportTime	= 0.0f;
+	}
+
 	void InitVulkan()
 	{
 		// Create a Vulkan instance
@@ -101,11 +208,20 @@ private:
 		m_physicalDevice = VK_NULL_HANDLE; // Set a default value for m_physicalDevice
 		PickPhysicalDevice();			   // Pick a suitable device
 
-		// Initialise multisampling sample count
-		m_msaaSampleCount = GetMaxUsableSampleCount( m_physicalDeviceProperties );
+		// Pick the render path and the quality preset
+		m_renderPath	  = ParseRenderPath( GetConfigString( "ENGINE_RENDER_PATH", "forward" ) );
+		m_qualityPreset	  = ParseQualityPreset( GetConfigString( "ENGINE_QUALITY", "medium" ) );
+		m_requestedPreset = m_qualityPreset;
+		m_quality		  = GetQualitySettings( m_qualityPreset );
+		m_msaaSampleCount = GetSceneSampleCount();
+
+		// Draw the scene's depth first if the scene asks for it (The deferred path already shades each pixel once)
+		m_depthPrepass	   = m_renderPath == RenderPath::FORWARD && GetConfigBool( "ENGINE_DEPTH_PREPASS", false );
+		m_requestedPrepass = m_depthPrepass;
 
-		// Initialise the logical device
+		// Initialise the logical device, and the cache every sampler, layout and render pass is created through
 		CreateLogicalDevice();
+		m_objectCache.Init( m_logicalDevice );
 
 		// Initialise the swapchain
 		CreateSwapchain();
@@ -113,39 +229,59 @@ private:
 		// Create image views for the swapchain images
 		CreateImageViews();
 
-		// Create a render pass
+		// Create the dynamic resolution's timestamps and upscale layout (The scene is scaled to keep the GPU time within the budget, up to the preset's scale)
+		m_resolution.Init( m_logicalDevice, m_physicalDeviceProperties, &m_objectCache, MAX_FRAMES_IN_FLIGHT, GetConfigFloat( "ENGINE_GPU_BUDGET_MS", 16.0f ),
+						   GetConfigFloat( "ENGINE_RESOLUTION_MIN_SCALE", RESOLUTION_MIN_SCALE ), GetConfigFloat( "ENGINE_SHARPNESS", RESOLUTION_SHARPNESS ) );
+		m_resolution.SetMaxScale( m_quality.resolutionScale );
+
+		// Create the counters that show how often each pixel is shaded
+		m_overdraw.Init( m_logicalDevice, m_pipelineStatisticsSupported, MAX_FRAMES_IN_FLIGHT );
+
+		// Create the scene's render pass, and the pass that upscales it into the swapchain image
 		CreateRenderPass();
+		m_resolution.CreateRenderPass( m_swapchainImageFormat );
 
 		// Create the descriptor set layout
 		CreateDescriptorSetLayout();
 
-		// Read from the shader files
-		ReadShaderFiles();
-
-		// Create the graphics pipeline
-		CreateGraphicsPipeline();
+		// Create the scene's lights (The light count is built into the pipeline)
+		CreateLights();
 
 		// Create the command pool
 		CreateCommandPool();
 
-		// Create a secondary render target for multisampling
-		CreateColourResources();
+		// Create the sun's shadow cascades (The shadow pipeline is made with their render pass)
+		m_shadowsEnabled = GetConfigBool( "ENGINE_SHADOWS", true );
+		m_shadows.Init( m_logicalDevice, m_physicalDevice, m_commandPool, m_graphicsQueue, &m_objectCache, MAX_FRAMES_IN_FLIGHT );
+
+		// Create the pipeline cache and the graphics pipeline
+		m_pipelineCache.Init( m_logicalDevice, &m_jobs, PIPELINE_CACHE_PATH, PIPELINE_LIST_PATH );
+		m_fallbackFrames = 0;
+		CreateGraphicsPipeline();
 
-		// Create the depth buffer resources
-		CreateDepthResources();
+		// Create the frame's render graph, and the attachments it owns
+		m_renderGraph.Init( m_logicalDevice, m_physicalDevice );
+		CreateRenderGraph();
 
 		// Create the framebuffers
 		CreateFramebuffers();
 
-		// Create the scene's lights
-		CreateLights();
-
-		// Load the environment model
+		// Load the environment model and its materials, and filter their textures as the preset asks
+		m_materials.Init( m_logicalDevice, m_physicalDevice, m_commandPool, m_graphicsQueue, m_physicalDeviceProperties, &m_objectCache, MAX_FRAMES_IN_FLIGHT );
 		CreateEnvironmentModel();
+		ApplyTextureQuality();
+
+		// Stream the textures' top levels in within the memory budget, as the draws ask for them
+		m_textureStreaming.Init( m_logicalDevice, m_physicalDevice, GetUploadQueues(), static_cast<VkDeviceSize>( GetConfigFloat( "ENGINE_TEXTURE_BUDGET_MB", TEXTURE_STREAM_BUDGET_MB ) * 1024.0f * 1024.0f ),
+								 static_cast<VkDeviceSize>( GetConfigFloat( "ENGINE_TEXTURE_UPLOAD_MB", TEXTURE_STREAM_UPLOAD_MB ) * 1024.0f * 1024.0f ), MAX_FRAMES_IN_FLIGHT );
 
 		// Create an index and vertex buffer
 		CreateIndexAndVertexBuffer();
 
+		// Create the per frame simulation packets and their light clusters
+		CreateFramePackets();
+		m_clusteredLighting.Init( m_logicalDevice, m_physicalDevice, MAX_FRAMES_IN_FLIGHT );
+
 		// Create the uniform buffers
 		CreateUniformBuffers();
 
@@ -282,6 +418,24 @@ private:
 		std::cout << std::endl; // Padding
 	}
 
+	std::string GetDeviceUUID( const VkPhysicalDevice& p_device ) const
+	{
+		// The UUID needs the physical device properties 2 and external memory capabilities instance extensions
+		auto vkGetPhysicalDeviceProperties2 = (PFN_vkGetPhysicalDeviceProperties2KHR)vkGetInstanceProcAddr( m_instance, "vkGetPhysicalDeviceProperties2KHR" );
+		if ( vkGetPhysicalDeviceProperties2 == nullptr || !IsInstanceExtensionSupported( VK_KHR_EXTERNAL_MEMORY_CAPABILITIES_EXTENSION_NAME ) ) return "";
+
+		// Query the ID properties
+		VkPhysicalDeviceIDPropertiesKHR idProperties {};
+		idProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES_KHR;
+
+		VkPhysicalDeviceProperties2KHR properties {};
+		properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2_KHR;
+		properties.pNext = &idProperties;
+		vkGetPhysicalDeviceProperties2( p_device, &properties );
+
+		return FormatUUID( idProperties.deviceUUID );
+	}
+
 	void PickPhysicalDevice()
 	{
 		// Get the amount of GPUs available
@@ -296,35 +450,64 @@ private:
 		VkPhysicalDevice devices[deviceCount];
 		vkEnumeratePhysicalDevices( m_instance, &deviceCount, devices );
 
-		// Check if any physical devices are suitable
+		// Get the device the user asked for, from the command line or the environment
+		std::string deviceOverride = m_deviceOverride.empty() ? GetConfigString( "ENGINE_DEVICE", "" ) : m_deviceOverride;
+
+		// Score every suitable device, and keep the best (Or the first that matches the override)
+		uint64_t bestScore	 = 0;
+		bool	 overrideHit = false;
+
+		std::cout << "Physical devices (" << deviceCount << "):" << std::endl;
 		for ( const auto& device : devices )
 		{
-			// Set the class physical device to the first suitable device
-			if ( IsDeviceSuitable( device, m_surface ) )
-			{
-				// Set the physical device
-				m_physicalDevice = device;
+			// Get the device's details
+			VkPhysicalDeviceProperties properties;
+			vkGetPhysicalDeviceProperties( device, &properties );
+			std::string uuid	 = GetDeviceUUID( device );
+			bool		suitable = IsDeviceSuitable( device, m_surface );
+			uint64_t	score	 = suitable ? ScorePhysicalDevice( device ) : 0;
+
+			// Output the device and its score
+			std::cout << '\t' << properties.deviceName << " (" << GetDeviceTypeName( properties.deviceType ) << ", " << GetDeviceLocalMemorySize( device ) / ( 1024 * 1024 ) << "MiB"
+					  << ( uuid.empty() ? "" : ", " + uuid ) << "): " << ( suitable ? "score " + std::to_string( score ) : "unsuitable" ) << std::endl;
 
-				// Query the device properties
-				vkGetPhysicalDeviceProperties( m_physicalDevice, &m_physicalDeviceProperties );
+			if ( !suitable || overrideHit ) continue;
 
-				break;
+			// Always take a device that matches the override
+			if ( !deviceOverride.empty() && DeviceMatchesOverride( deviceOverride, properties.deviceName, uuid ) )
+			{
+				m_physicalDevice = device;
+				overrideHit		 = true;
+			}
+			else if ( score > bestScore )
+			{
+				m_physicalDevice = device;
+				bestScore		 = score;
 			}
 		}
 
 		// Check if a device was found
+		if ( !deviceOverride.empty() && !overrideHit )
+			throw std::runtime_error( "Failed to find a suitable GPU matching \"" + deviceOverride + "\"" );
 		if ( m_physicalDevice == VK_NULL_HANDLE )
 			throw std::runtime_error( "Failed to find a suitable GPU" ); // Device wasn't found
+
+		// Query the device properties
+		vkGetPhysicalDeviceProperties( m_physicalDevice, &m_physicalDeviceProperties );
+
+		std::cout << "Using " << m_physicalDeviceProperties.deviceName << ( overrideHit ? " (Override)" : "" ) << std::endl
+				  << std::endl;
 	}
 
 	void CreateLogicalDevice()
 	{
 		// Get the queue family indices
-		QueueFamilyIndices indices = FindQueueFamilies( m_physicalDevice, m_surface );
+		m_queueFamilies			   = FindQueueFamilies( m_physicalDevice, m_surface );
+		QueueFamilyIndices indices = m_queueFamilies;
 
 		// Create a set of unique queue families
 		std::set<uint32_t> uniqueQueueFamilies = {
-			indices.graphicsFamily.value(), indices.presentFamily.value()
+			indices.graphicsFamily.value(), indices.presentFamily.value(), indices.GetTransferFamily()
 		};
 
 		// Set the queue priority
@@ -349,19 +532,37 @@ private:
 			}
 		}
 
-		// Specify the device features to use
+		// Check which optional features the device has
+		VkPhysicalDeviceFeatures supportedFeatures;
+		vkGetPhysicalDeviceFeatures( m_physicalDevice, &supportedFeatures );
+		m_sampleShadingSupported	  = supportedFeatures.sampleRateShading;
+		m_pipelineStatisticsSupported = supportedFeatures.pipelineStatisticsQuery;
+
+		// Specify the device features to use (Sample shading is only turned on in the pipelines the quality settings ask for it in)
 		VkPhysicalDeviceFeatures deviceFeatures {};
-		deviceFeatures.samplerAnisotropy = VK_TRUE;
-		deviceFeatures.sampleRateShading = VK_TRUE; // Sample shading for textures
+		deviceFeatures.samplerAnisotropy	   = VK_TRUE;
+		deviceFeatures.sampleRateShading	   = supportedFeatures.sampleRateShading;
+		deviceFeatures.pipelineStatisticsQuery = supportedFeatures.pipelineStatisticsQuery; // Overdraw counters
+
+		// Enable timeline semaphores
+		VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineFeatures {};
+		timelineFeatures.sType			   = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+		timelineFeatures.timelineSemaphore = VK_TRUE;
+
+		// Add the memory budget extension to the required ones when the device has it (Only used to report memory use)
+		std::vector<const char*> extensions( deviceExtensions, deviceExtensions + deviceExtensionCount );
+		bool					 memoryBudgetSupported = IsDeviceExtensionSupported( m_physicalDevice, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME );
+		if ( memoryBudgetSupported ) extensions.push_back( VK_EXT_MEMORY_BUDGET_EXTENSION_NAME );
 
 		// Create the logical device
 		VkDeviceCreateInfo createInfo {};
 		createInfo.sType				   = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+		createInfo.pNext				   = &timelineFeatures;
 		createInfo.pQueueCreateInfos	   = queueCreateInfos;
 		createInfo.queueCreateInfoCount	   = uniqueQueueFamilies.size();
 		createInfo.pEnabledFeatures		   = &deviceFeatures;
-		createInfo.enabledExtensionCount   = static_cast<uint32_t>( deviceExtensionCount );
-		createInfo.ppEnabledExtensionNames = deviceExtensions;
+		createInfo.enabledExtensionCount   = static_cast<uint32_t>( extensions.size() );
+		createInfo.ppEnabledExtensionNames = extensions.data();
 
 		// Set the validation layers (For compatability with older versions)
 		if ( ENABLE_VALIDATION_LAYERS )
@@ -376,11 +577,22 @@ private:
 		if ( vkCreateDevice( m_physicalDevice, &createInfo, nullptr, &m_logicalDevice ) != VK_SUCCESS )
 			throw std::runtime_error( "Failed to create logical device" ); // Throw an error if it failed
 
+		// Count every allocation made on the device from here on by its heap and what it is for
+		GetMemoryTracker().Init( m_instance, m_physicalDevice, memoryBudgetSupported );
+
 		// Get the queue handle for the graphics queue
 		vkGetDeviceQueue( m_logicalDevice, indices.graphicsFamily.value(), 0, &m_graphicsQueue );
 
 		// Get the queue handle for the presentation queue
 		vkGetDeviceQueue( m_logicalDevice, indices.presentFamily.value(), 0, &m_presentQueue );
+
+		// Get the queue handle for the transfer queue
+		vkGetDeviceQueue( m_logicalDevice, indices.GetTransferFamily(), 0, &m_transferQueue );
+
+		// Output which queue families were found
+		std::cout << "Queue families: graphics " << indices.graphicsFamily.value() << ", present " << indices.presentFamily.value()
+				  << ", transfer " << ( indices.transferFamily.has_value() ? std::to_string( indices.transferFamily.value() ) : "(Shared with graphics)" ) << std::endl
+				  << std::endl;
 	}
 
 	void CreateSurface()
@@ -397,7 +609,7 @@ private:
 
 		// Pick the best properties for the swapchain from the available settings
 		VkSurfaceFormatKHR surfaceFormat = ChooseSwapSurfaceFormat( swapchainSupport.formats );
-		VkPresentModeKHR   presentMode	 = ChooseSwapPresentMode( swapchainSupport.presentModes );
+		VkPresentModeKHR   presentMode	 = ChooseSwapPresentMode( swapchainSupport.presentModes, m_presentPolicy );
 		VkExtent2D		   extent		 = ChooseSwapExtent( swapchainSupport.capabilities, m_window );
 
 		// Specify the minimum number of images for the swapchain to function
@@ -472,6 +684,13 @@ private:
 
 	void CreateRenderPass()
 	{
+		// The deferred path has its own render pass
+		if ( m_renderPath == RenderPath::DEFERRED )
+		{
+			CreateDeferredRenderPass();
+			return;
+		}
+
 		// Set colour attachment settings
 		VkAttachmentDescription colourAttatchment {};
 		colourAttatchment.format		 = m_swapchainImageFormat;
@@ -480,7 +699,7 @@ private:
 		colourAttatchment.storeOp		 = VK_ATTACHMENT_STORE_OP_STORE; // Store the contents into memory
 		colourAttatchment.stencilLoadOp	 = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 		colourAttatchment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-		colourAttatchment.initialLayout	 = VK_IMAGE_LAYOUT_UNDEFINED;
+		colourAttatchment.initialLayout	 = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL; // The render graph transitions every attachment before and after the pass
 		colourAttatchment.finalLayout	 = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
 		// Set colour attachment settings
@@ -491,7 +710,7 @@ private:
 		depthAttachment.storeOp		   = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 		depthAttachment.stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 		depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-		depthAttachment.initialLayout  = VK_IMAGE_LAYOUT_UNDEFINED;
+		depthAttachment.initialLayout  = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 		depthAttachment.finalLayout	   = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
 		// Add a resolve attachment for multisampling
@@ -502,24 +721,32 @@ private:
 		colourResolveAttachment.storeOp		   = VK_ATTACHMENT_STORE_OP_STORE;
 		colourResolveAttachment.stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 		colourResolveAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-		colourResolveAttachment.initialLayout  = VK_IMAGE_LAYOUT_UNDEFINED;
-		colourResolveAttachment.finalLayout	   = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+		colourResolveAttachment.initialLayout  = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL; // Resolved into the scene target, the graph makes it ready to sample for the upscale pass
+		colourResolveAttachment.finalLayout	   = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
 		// Setup the colour attachment reference
 		VkAttachmentReference colourAttatchmentRef {};
 		colourAttatchmentRef.attachment = 0;										// Which attachment to reference (by index in attachment descriptions array)
 		colourAttatchmentRef.layout		= VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL; // Layout for the subpass
 
-		// Setup the colour attachment reference
+		// Setup the depth attachment reference (Read only after a pre-pass, it has already written every depth)
 		VkAttachmentReference depthAttachmentRef {};
 		depthAttachmentRef.attachment = 1;
-		depthAttachmentRef.layout	  = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+		depthAttachmentRef.layout	  = m_depthPrepass ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
 		// Setup the colour resolve attachment reference
 		VkAttachmentReference colourResolveAttachmentRef {};
 		colourResolveAttachmentRef.attachment = 2;
 		colourResolveAttachmentRef.layout	  = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
+		// The depth pre-pass writes depth only
+		VkAttachmentReference prepassDepthAttachmentRef { 1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+
+		VkSubpassDescription prepassSubpass {};
+		prepassSubpass.pipelineBindPoint	   = VK_PIPELINE_BIND_POINT_GRAPHICS;
+		prepassSubpass.colorAttachmentCount	   = 0;
+		prepassSubpass.pDepthStencilAttachment = &prepassDepthAttachmentRef;
+
 		// Create a subpass description
 		VkSubpassDescription subpass {};
 		subpass.pipelineBindPoint		= VK_PIPELINE_BIND_POINT_GRAPHICS;
@@ -528,14 +755,25 @@ private:
 		subpass.pDepthStencilAttachment = &depthAttachmentRef;
 		subpass.pResolveAttachments		= &colourResolveAttachmentRef;
 
-		// Set a dependency for the image to be acquired before the subpass starts
-		VkSubpassDependency dependency {};
-		dependency.srcSubpass	 = VK_SUBPASS_EXTERNAL;
-		dependency.dstSubpass	 = 0;
-		dependency.srcStageMask	 = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT; // Wait on this operation
-		dependency.srcAccessMask = 0;
-		dependency.dstStageMask	 = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT; // The operations that should wait
-		dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;		   // The operations that should wait
+		std::vector<VkSubpassDescription> subpasses;
+		if ( m_depthPrepass ) subpasses.push_back( prepassSubpass );
+		subpasses.push_back( subpass );
+
+		// Only the subpasses depend on each other, the render graph synchronises the pass with the rest of the frame
+		std::vector<VkSubpassDependency> dependencies;
+		if ( m_depthPrepass )
+		{
+			// Finish writing the depth before it is tested against (Per pixel, so tilers stay on chip)
+			VkSubpassDependency depthDependency {};
+			depthDependency.srcSubpass		= 0;
+			depthDependency.dstSubpass		= 1;
+			depthDependency.srcStageMask	= VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+			depthDependency.srcAccessMask	= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+			depthDependency.dstStageMask	= VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+			depthDependency.dstAccessMask	= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+			depthDependency.dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+			dependencies.push_back( depthDependency );
+		}
 
 		// Create an array of attachment descriptions
 		std::array<VkAttachmentDescription, 3> attachments = { colourAttatchment, depthAttachment, colourResolveAttachment };
@@ -545,259 +783,330 @@ private:
 		renderPassCreateInfo.sType			 = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
 		renderPassCreateInfo.attachmentCount = static_cast<uint32_t>( attachments.size() );
 		renderPassCreateInfo.pAttachments	 = attachments.data();
-		renderPassCreateInfo.subpassCount	 = 1;
-		renderPassCreateInfo.pSubpasses		 = &subpass;
-		renderPassCreateInfo.dependencyCount = 1;
-		renderPassCreateInfo.pDependencies	 = &dependency;
+		renderPassCreateInfo.subpassCount	 = static_cast<uint32_t>( subpasses.size() );
+		renderPassCreateInfo.pSubpasses		 = subpasses.data();
+		renderPassCreateInfo.dependencyCount = static_cast<uint32_t>( dependencies.size() );
+		renderPassCreateInfo.pDependencies	 = dependencies.data();
 
-		// Create the render pass
-		if ( vkCreateRenderPass( m_logicalDevice, &renderPassCreateInfo, nullptr, &m_renderPass ) != VK_SUCCESS )
-			throw std::runtime_error( "Failed to create render pass" );
+		// Get the render pass from the cache
+		m_renderPass = m_objectCache.GetRenderPass( renderPassCreateInfo );
 	}
 
-	void ReadShaderFiles()
+	void CreateDeferredRenderPass()
 	{
-		// Read the shader files
-		m_vertShaderCode = ReadFile( "lib/shaders/SimpleShader.vert.spv" );
-		m_fragShaderCode = ReadFile( "lib/shaders/SimpleShader.frag.spv" );
+		// The lighting subpass writes to the scene target (Every pixel that is rendered is written, so nothing is loaded)
+		VkAttachmentDescription colourAttatchment {};
+		colourAttatchment.format		 = m_swapchainImageFormat;
+		colourAttatchment.samples		 = VK_SAMPLE_COUNT_1_BIT;
+		colourAttatchment.loadOp		 = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		colourAttatchment.storeOp		 = VK_ATTACHMENT_STORE_OP_STORE;
+		colourAttatchment.stencilLoadOp	 = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		colourAttatchment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		colourAttatchment.initialLayout	 = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL; // The render graph transitions every attachment before and after the pass
+		colourAttatchment.finalLayout	 = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
-		// If shader files have data
-		if ( !m_vertShaderCode.empty() && !m_fragShaderCode.empty() )
+		// Set depth attachment settings
+		VkAttachmentDescription depthAttachment {};
+		depthAttachment.format		   = FindDepthFormat( m_physicalDevice );
+		depthAttachment.samples		   = VK_SAMPLE_COUNT_1_BIT;
+		depthAttachment.loadOp		   = VK_ATTACHMENT_LOAD_OP_CLEAR;
+		depthAttachment.storeOp		   = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		depthAttachment.stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		depthAttachment.initialLayout  = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+		depthAttachment.finalLayout	   = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+		// The G-buffer is cleared, then thrown away at the end of the pass (Never written out to memory)
+		std::vector<VkAttachmentDescription> attachments = { colourAttatchment, depthAttachment };
+		std::vector<VkAttachmentReference>	 gBufferOutputRefs, gBufferInputRefs;
+		for ( uint32_t i = 0; i < GBUFFER_ATTACHMENT_COUNT; i++ )
 		{
-			std::cout << "Vertex shader read from file (" << m_vertShaderCode.size() << " bytes)" << std::endl
-					  << "Fragment shader read from file (" << m_fragShaderCode.size() << " bytes)" << std::endl;
+			VkAttachmentDescription gBufferAttachment {};
+			gBufferAttachment.format		 = m_gBuffer.GetFormat( i );
+			gBufferAttachment.samples		 = VK_SAMPLE_COUNT_1_BIT;
+			gBufferAttachment.loadOp		 = VK_ATTACHMENT_LOAD_OP_CLEAR;
+			gBufferAttachment.storeOp		 = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+			gBufferAttachment.stencilLoadOp	 = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+			gBufferAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+			gBufferAttachment.initialLayout	 = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+			gBufferAttachment.finalLayout	 = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+			// Written as colour attachments by the first subpass, read as input attachments by the second
+			uint32_t index = static_cast<uint32_t>( attachments.size() );
+			gBufferOutputRefs.push_back( { index, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL } );
+			gBufferInputRefs.push_back( { index, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL } );
+			attachments.push_back( gBufferAttachment );
 		}
-		else
-			std::cout << "Could not read shader files" << std::endl;
+
+		// Setup the attachment references for the scene target and the depth buffer
+		VkAttachmentReference colourAttatchmentRef { 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+		VkAttachmentReference depthAttachmentRef { 1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+
+		// The first subpass fills the G-buffer, the second shades each pixel from it
+		std::array<VkSubpassDescription, 2> subpasses {};
+		subpasses[0].pipelineBindPoint		 = VK_PIPELINE_BIND_POINT_GRAPHICS;
+		subpasses[0].colorAttachmentCount	 = static_cast<uint32_t>( gBufferOutputRefs.size() );
+		subpasses[0].pColorAttachments		 = gBufferOutputRefs.data();
+		subpasses[0].pDepthStencilAttachment = &depthAttachmentRef;
+		subpasses[1].pipelineBindPoint		 = VK_PIPELINE_BIND_POINT_GRAPHICS;
+		subpasses[1].inputAttachmentCount	 = static_cast<uint32_t>( gBufferInputRefs.size() );
+		subpasses[1].pInputAttachments		 = gBufferInputRefs.data();
+		subpasses[1].colorAttachmentCount	 = 1;
+		subpasses[1].pColorAttachments		 = &colourAttatchmentRef;
+
+		// Wait for the G-buffer to be written before it is read (Per pixel, so tilers stay on chip, the render graph synchronises the rest of the frame)
+		VkSubpassDependency gBufferDependency {};
+		gBufferDependency.srcSubpass	  = 0;
+		gBufferDependency.dstSubpass	  = 1;
+		gBufferDependency.srcStageMask	  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		gBufferDependency.srcAccessMask	  = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		gBufferDependency.dstStageMask	  = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+		gBufferDependency.dstAccessMask	  = VK_ACCESS_INPUT_ATTACHMENT_READ_BIT;
+		gBufferDependency.dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+
+		// Set the render pass create info
+		VkRenderPassCreateInfo renderPassCreateInfo {};
+		renderPassCreateInfo.sType			 = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+		renderPassCreateInfo.attachmentCount = static_cast<uint32_t>( attachments.size() );
+		renderPassCreateInfo.pAttachments	 = attachments.data();
+		renderPassCreateInfo.subpassCount	 = static_cast<uint32_t>( subpasses.size() );
+		renderPassCreateInfo.pSubpasses		 = subpasses.data();
+		renderPassCreateInfo.dependencyCount = 1;
+		renderPassCreateInfo.pDependencies	 = &gBufferDependency;
+
+		// Get the render pass from the cache
+		m_renderPass = m_objectCache.GetRenderPass( renderPassCreateInfo );
+	}
+
+	// The scene's variant a material's pipeline is drawn with
+	PipelineKey GetScenePipelineKey( const uint32_t& p_materialPipeline ) const
+	{
+		// The deferred path's scene variant is its lighting subpass (Its G-buffer pass draws every material the same way)
+		if ( m_renderPath == RenderPath::DEFERRED ) return GetDeferredLightingPipelineKey();
+
+		// The scene's shaders and state
+		PipelineKey key;
+		key.vertexShader   = "lib/shaders/SimpleShader.vert.spv";
+		key.fragmentShader = "lib/shaders/SimpleShader.frag.spv";
+		key.sampleCount	   = m_msaaSampleCount;
+		key.sampleShading  = m_sampleShadingSupported ? static_cast<uint32_t>( std::clamp( m_quality.sampleShading, 0.0f, 1.0f ) * 100.0f ) : 0;
+		key.layout		   = m_pipelineLayout;
+		key.renderPass	   = m_renderPass;
+
+		// After a pre-pass only the fragments at the depth it wrote are shaded
+		if ( m_depthPrepass )
+		{
+			key.pass			 = PIPELINE_PASS_SCENE_PREPASS;
+			key.depthWriteEnable = VK_FALSE;
+			key.depthCompareOp	 = VK_COMPARE_OP_EQUAL;
+			key.subpass			 = 1;
+		}
+
+		// Specialise the shaders for the scene
+		key.specialization[SPEC_SAMPLER_COUNT]	 = TEXTURE_SAMPLER_COUNT;
+		key.specialization[SPEC_LIGHT_COUNT]	 = CLUSTER_MAX_LIGHTS_PER_CLUSTER;
+		key.specialization[SPEC_ENABLE_SPECULAR] = p_materialPipeline == MATERIAL_PIPELINE_SPECULAR;
+		key.specialization[SPEC_ENABLE_SHADOWS]	 = m_shadowsEnabled;
+
+		return key;
+	}
+
+	PipelineKey GetDepthPrepassPipelineKey() const
+	{
+		// Depth only, reading just the positions (Its depths must match the scene's vertex shader exactly)
+		PipelineKey key;
+		key.pass				  = PIPELINE_PASS_SCENE_PREPASS;
+		key.vertexShader		  = "lib/shaders/DepthPrepass.vert.spv";
+		key.vertexLayout		  = VertexLayout::POSITION;
+		key.blendEnable			  = VK_FALSE;
+		key.sampleCount			  = m_msaaSampleCount;
+		key.colourAttachmentCount = 0;
+		key.layout				  = m_pipelineLayout;
+		key.renderPass			  = m_renderPass;
+		key.subpass				  = 0;
+
+		return key;
+	}
+
+	PipelineKey GetFallbackPipelineKey() const
+	{
+		// The cheapest variant of the scene's shaders (Unlit, no specular or shadows)
+		PipelineKey key							 = GetScenePipelineKey( MATERIAL_PIPELINE_DIFFUSE );
+		key.specialization[SPEC_LIGHT_COUNT]	 = 0;
+		key.specialization[SPEC_ENABLE_SPECULAR] = VK_FALSE;
+		key.specialization[SPEC_ENABLE_SHADOWS]	 = VK_FALSE;
+
+		return key;
+	}
+
+	PipelineKey GetShadowPipelineKey() const
+	{
+		// Depth only, biased to stop surfaces shadowing themselves
+		PipelineKey key;
+		key.pass				  = SHADOW_PIPELINE_PASS;
+		key.vertexShader		  = "lib/shaders/Shadow.vert.spv";
+		key.vertexLayout		  = VertexLayout::POSITION;
+		key.blendEnable			  = VK_FALSE;
+		key.depthBiasEnable		  = VK_TRUE;
+		key.colourAttachmentCount = 0;
+		key.layout				  = m_shadows.GetPipelineLayout();
+		key.renderPass			  = m_shadows.GetRenderPass();
+
+		return key;
+	}
+
+	PipelineKey GetGBufferPipelineKey() const
+	{
+		// The scene's vertex shader, writing the surface to every G-buffer attachment
+		PipelineKey key;
+		key.pass				  = PIPELINE_PASS_DEFERRED;
+		key.vertexShader		  = "lib/shaders/SimpleShader.vert.spv";
+		key.fragmentShader		  = "lib/shaders/GBuffer.frag.spv";
+		key.blendEnable			  = VK_FALSE;
+		key.colourAttachmentCount = GBUFFER_ATTACHMENT_COUNT;
+		key.layout				  = m_pipelineLayout;
+		key.renderPass			  = m_renderPass;
+		key.subpass				  = 0;
+
+		key.specialization[SPEC_SAMPLER_COUNT] = TEXTURE_SAMPLER_COUNT;
+
+		return key;
+	}
+
+	PipelineKey GetDeferredLightingPipelineKey() const
+	{
+		// A triangle covering the screen, shading each pixel once from the G-buffer
+		PipelineKey key;
+		key.pass			 = PIPELINE_PASS_DEFERRED;
+		key.vertexShader	 = "lib/shaders/Fullscreen.vert.spv";
+		key.fragmentShader	 = "lib/shaders/DeferredLighting.frag.spv";
+		key.vertexLayout	 = VertexLayout::NONE;
+		key.blendEnable		 = VK_FALSE;
+		key.depthTestEnable	 = VK_FALSE;
+		key.depthWriteEnable = VK_FALSE;
+		key.layout			 = m_pipelineLayout;
+		key.renderPass		 = m_renderPass;
+		key.subpass			 = 1;
+
+		// Specialise the shaders for the scene
+		key.specialization[SPEC_SAMPLER_COUNT]	 = TEXTURE_SAMPLER_COUNT;
+		key.specialization[SPEC_LIGHT_COUNT]	 = CLUSTER_MAX_LIGHTS_PER_CLUSTER;
+		key.specialization[SPEC_ENABLE_SPECULAR] = VK_TRUE; // Each pixel's strength comes from its material, zero for diffuse ones
+		key.specialization[SPEC_ENABLE_SHADOWS]	 = m_shadowsEnabled;
+
+		return key;
+	}
+
+	PipelineKey GetUpscalePipelineKey() const
+	{
+		// A triangle covering the swapchain image, sampling the scene target
+		PipelineKey key;
+		key.pass			 = RESOLUTION_PIPELINE_PASS;
+		key.vertexShader	 = "lib/shaders/Fullscreen.vert.spv";
+		key.fragmentShader	 = "lib/shaders/Upscale.frag.spv";
+		key.vertexLayout	 = VertexLayout::NONE;
+		key.blendEnable		 = VK_FALSE;
+		key.depthTestEnable	 = VK_FALSE;
+		key.depthWriteEnable = VK_FALSE;
+		key.layout			 = m_resolution.GetPipelineLayout();
+		key.renderPass		 = m_resolution.GetRenderPass();
+
+		return key;
 	}
 
 	void CreateGraphicsPipeline()
 	{
-		// If shader files have data
-		if ( !m_vertShaderCode.empty() && !m_fragShaderCode.empty() )
+		// Set the pipeline layout
+		VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo {};
+		pipelineLayoutCreateInfo.sType					= VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutCreateInfo.setLayoutCount			= 1;
+		pipelineLayoutCreateInfo.pSetLayouts			= &m_descriptorCollection.GetLayout();
+		pipelineLayoutCreateInfo.pushConstantRangeCount = 0;
+		pipelineLayoutCreateInfo.pPushConstantRanges	= nullptr;
+
+		// Get the pipeline layout from the cache
+		m_pipelineLayout = m_objectCache.GetPipelineLayout( pipelineLayoutCreateInfo );
+
+		// Create the fallback now, every draw needs a pipeline
+		m_fallbackPipeline = m_pipelineCache.GetPipeline( GetFallbackPipelineKey() );
+
+		// Compile the variants used by previous runs of this render pass in the background
+		m_pipelineCache.Precompile( GetScenePipelineKey( MATERIAL_PIPELINE_DIFFUSE ).pass, m_msaaSampleCount, m_pipelineLayout, m_renderPass );
+
+		// Request the scene's variant for each material pipeline (Null until it has compiled)
+		for ( uint32_t i = 0; i < MATERIAL_PIPELINE_COUNT; i++ )
 		{
-			// Create the shader modules
-			VkShaderModule vertShaderModule = CreateShaderModule( m_vertShaderCode, m_logicalDevice );
-			VkShaderModule fragShaderModule = CreateShaderModule( m_fragShaderCode, m_logicalDevice );
-
-			// Set the create info for the vertex shader stage
-			VkPipelineShaderStageCreateInfo vertShaderStageInfo {};
-			vertShaderStageInfo.sType				= VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-			vertShaderStageInfo.stage				= VK_SHADER_STAGE_VERTEX_BIT;
-			vertShaderStageInfo.module				= vertShaderModule;
-			vertShaderStageInfo.pName				= "main";  // Entry point
-			vertShaderStageInfo.pSpecializationInfo = nullptr; // Set shader constants
-
-			// Set the create info for the fragment shader stage
-			VkPipelineShaderStageCreateInfo fragShaderStageInfo {};
-			fragShaderStageInfo.sType				= VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-			fragShaderStageInfo.stage				= VK_SHADER_STAGE_FRAGMENT_BIT;
-			fragShaderStageInfo.module				= fragShaderModule;
-			fragShaderStageInfo.pName				= "main";  // Entry point
-			fragShaderStageInfo.pSpecializationInfo = nullptr; // Set shader constants
-
-			// Create an array with the shader stage information
-			VkPipelineShaderStageCreateInfo shaderStages[] = { vertShaderStageInfo, fragShaderStageInfo };
-
-			// Get the vertex binding and attribute descriptions
-			auto bindingDescription	   = Vertex::GetBindingDescription();
-			auto attributeDescriptions = Vertex::GetAttributeDescriptions();
-
-			// Setup structure of the vertex data using create information
-			VkPipelineVertexInputStateCreateInfo vertexInputInfo {};
-			vertexInputInfo.sType							= VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-			vertexInputInfo.vertexBindingDescriptionCount	= 1;
-			vertexInputInfo.pVertexBindingDescriptions		= &bindingDescription;
-			vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>( attributeDescriptions.size() );
-			vertexInputInfo.pVertexAttributeDescriptions	= attributeDescriptions.data();
-
-			// Describe the primitive which will be drawn and if primitive restart should be enabled
-			VkPipelineInputAssemblyStateCreateInfo inputAssemblyCreateInfo {};
-			inputAssemblyCreateInfo.sType				   = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-			inputAssemblyCreateInfo.topology			   = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-			inputAssemblyCreateInfo.primitiveRestartEnable = VK_FALSE;
-
-			// Setup the viewport
-			VkViewport viewport {};
-			viewport.x		  = 0.0f;
-			viewport.y		  = 0.0f;
-			viewport.width	  = (float)m_swapchainExtent.width;
-			viewport.height	  = (float)m_swapchainExtent.height;
-			viewport.minDepth = 0.0f; // Minimum depth value to use
-			viewport.maxDepth = 1.0f; // Maxmimum depth value to use
-
-			// Define the clipping rectangle (scissor rectangle)
-			VkRect2D scissor {};
-			scissor.offset = { 0, 0 };
-			scissor.extent = m_swapchainExtent;
-
-			// Combine viewport and clipping rectangle
-			VkPipelineViewportStateCreateInfo viewportStateCreateInfo {};
-			viewportStateCreateInfo.sType		  = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-			viewportStateCreateInfo.viewportCount = 1;
-			viewportStateCreateInfo.pViewports	  = &viewport;
-			viewportStateCreateInfo.scissorCount  = 1;
-			viewportStateCreateInfo.pScissors	  = &scissor;
-
-			// Setup the rasteriser
-			VkPipelineRasterizationStateCreateInfo rasteriserCreateInfo {};
-			rasteriserCreateInfo.sType					 = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-			rasteriserCreateInfo.depthClampEnable		 = VK_FALSE;
-			rasteriserCreateInfo.rasterizerDiscardEnable = VK_FALSE; // Disable output to geometry shader (disable output to framebuffer)
-			rasteriserCreateInfo.polygonMode			 = VK_POLYGON_MODE_FILL;
-			rasteriserCreateInfo.lineWidth				 = 1.0f;
-			rasteriserCreateInfo.cullMode				 = 0;								// Cull back faces
-			rasteriserCreateInfo.frontFace				 = VK_FRONT_FACE_COUNTER_CLOCKWISE; // Anti-clockwise because of the flipped y axis
-			rasteriserCreateInfo.depthBiasEnable		 = VK_FALSE;						// Enable alteration of depth values
-			rasteriserCreateInfo.depthBiasConstantFactor = 0.0f;
-			rasteriserCreateInfo.depthBiasClamp			 = 0.0f;
-			rasteriserCreateInfo.depthBiasSlopeFactor	 = 0.0f;
-
-			// Configure multisampling
-			VkPipelineMultisampleStateCreateInfo multisamplingCreateInfo {};
-			multisamplingCreateInfo.sType				  = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-			multisamplingCreateInfo.sampleShadingEnable	  = VK_TRUE;
-			multisamplingCreateInfo.rasterizationSamples  = m_msaaSampleCount;
-			multisamplingCreateInfo.minSampleShading	  = 0.2f; // Closer to 1 is smoother
-			multisamplingCreateInfo.pSampleMask			  = nullptr;
-			multisamplingCreateInfo.alphaToCoverageEnable = VK_FALSE;
-			multisamplingCreateInfo.alphaToOneEnable	  = VK_FALSE;
-
-			VkPipelineDepthStencilStateCreateInfo depthStencilCreateInfo {};
-			depthStencilCreateInfo.sType				 = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-			depthStencilCreateInfo.depthTestEnable		 = VK_TRUE;
-			depthStencilCreateInfo.depthWriteEnable		 = VK_TRUE;
-			depthStencilCreateInfo.depthCompareOp		 = VK_COMPARE_OP_LESS;
-			depthStencilCreateInfo.depthBoundsTestEnable = VK_FALSE;
-			depthStencilCreateInfo.minDepthBounds		 = 0.0f;
-			depthStencilCreateInfo.maxDepthBounds		 = 1.0f;
-			depthStencilCreateInfo.stencilTestEnable	 = VK_FALSE;
-			depthStencilCreateInfo.front				 = {};
-			depthStencilCreateInfo.back					 = {};
-
-			// Setup the colour blending stage (Per Framebuffer)
-			VkPipelineColorBlendAttachmentState colourBlendAttatchment {};
-			colourBlendAttatchment.colorWriteMask	   = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-			colourBlendAttatchment.blendEnable		   = VK_TRUE;
-			colourBlendAttatchment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
-			colourBlendAttatchment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
-			colourBlendAttatchment.colorBlendOp		   = VK_BLEND_OP_ADD;
-			colourBlendAttatchment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-			colourBlendAttatchment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
-			colourBlendAttatchment.alphaBlendOp		   = VK_BLEND_OP_ADD;
-
-			// Setup the create information
-			VkPipelineColorBlendStateCreateInfo colourBlendCreateInfo {};
-			colourBlendCreateInfo.sType				= VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-			colourBlendCreateInfo.logicOpEnable		= VK_FALSE; // Enable bitwise blending
-			colourBlendCreateInfo.logicOp			= VK_LOGIC_OP_COPY;
-			colourBlendCreateInfo.attachmentCount	= 1;
-			colourBlendCreateInfo.pAttachments		= &colourBlendAttatchment;
-			colourBlendCreateInfo.blendConstants[0] = 0.0f;
-			colourBlendCreateInfo.blendConstants[1] = 0.0f;
-			colourBlendCreateInfo.blendConstants[2] = 0.0f;
-			colourBlendCreateInfo.blendConstants[3] = 0.0f;
-
-			// Set the dynamic states for the graphics pipeline
-			VkDynamicState dynamicStates[] = {
-				VK_DYNAMIC_STATE_VIEWPORT,
-				VK_DYNAMIC_STATE_LINE_WIDTH
-			};
-
-			// Create the dynamic state pipeline create information
-			VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo {};
-			dynamicStateCreateInfo.sType			 = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-			dynamicStateCreateInfo.dynamicStateCount = 2;
-			dynamicStateCreateInfo.pDynamicStates	 = dynamicStates;
-
-			// Set the pipeline layout
-			VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo {};
-			pipelineLayoutCreateInfo.sType					= VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-			pipelineLayoutCreateInfo.setLayoutCount			= 1;
-			pipelineLayoutCreateInfo.pSetLayouts			= &m_descriptorCollection.GetLayout();
-			pipelineLayoutCreateInfo.pushConstantRangeCount = 0;
-			pipelineLayoutCreateInfo.pPushConstantRanges	= nullptr;
-
-			// Create the pipeline layout
-			if ( vkCreatePipelineLayout( m_logicalDevice, &pipelineLayoutCreateInfo, nullptr, &m_pipelineLayout ) != VK_SUCCESS )
-				throw std::runtime_error( "Failed to create pipeline lauout" );
-
-			// Setup the graphics pipeline create information
-			VkGraphicsPipelineCreateInfo graphicsPipelineCreateInfo {};
-			graphicsPipelineCreateInfo.sType			   = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-			graphicsPipelineCreateInfo.stageCount		   = 2;
-			graphicsPipelineCreateInfo.pStages			   = shaderStages;
-			graphicsPipelineCreateInfo.pVertexInputState   = &vertexInputInfo;
-			graphicsPipelineCreateInfo.pInputAssemblyState = &inputAssemblyCreateInfo;
-			graphicsPipelineCreateInfo.pViewportState	   = &viewportStateCreateInfo;
-			graphicsPipelineCreateInfo.pRasterizationState = &rasteriserCreateInfo;
-			graphicsPipelineCreateInfo.pMultisampleState   = &multisamplingCreateInfo;
-			graphicsPipelineCreateInfo.pDepthStencilState  = &depthStencilCreateInfo;
-			graphicsPipelineCreateInfo.pColorBlendState	   = &colourBlendCreateInfo;
-			graphicsPipelineCreateInfo.pDynamicState	   = nullptr;
-			graphicsPipelineCreateInfo.layout			   = m_pipelineLayout;
-			graphicsPipelineCreateInfo.renderPass		   = m_renderPass;
-			graphicsPipelineCreateInfo.subpass			   = 0;
-			graphicsPipelineCreateInfo.basePipelineHandle  = VK_NULL_HANDLE;
-			graphicsPipelineCreateInfo.basePipelineIndex   = -1;
-
-			// Create the graphics pipeline
-			if ( vkCreateGraphicsPipelines( m_logicalDevice, VK_NULL_HANDLE, 1, &graphicsPipelineCreateInfo, nullptr, &m_graphicsPipeline ) != VK_SUCCESS )
-				throw std::runtime_error( "Failed to create graphics pipeline" );
-
-			// Destroy the shader modules (Once the graphics pipeline is created they aren't needed)
-			vkDestroyShaderModule( m_logicalDevice, vertShaderModule, nullptr );
-			vkDestroyShaderModule( m_logicalDevice, fragShaderModule, nullptr );
+			m_scenePipelineKeys[i] = GetScenePipelineKey( i );
+			m_scenePipelines[i]	   = m_pipelineCache.RequestPipeline( m_scenePipelineKeys[i] );
 		}
+
+		// Create the shadow and depth pre-pass pipelines now, they are cheap and drawn every frame
+		m_shadowPipeline  = m_shadowsEnabled ? m_pipelineCache.GetPipeline( GetShadowPipelineKey() ) : VK_NULL_HANDLE;
+		m_prepassPipeline = m_depthPrepass ? m_pipelineCache.GetPipeline( GetDepthPrepassPipelineKey() ) : VK_NULL_HANDLE;
+
+		// The deferred path fills its G-buffer with one variant, so it is created now as well
+		m_gBufferPipeline = m_renderPath == RenderPath::DEFERRED ? m_pipelineCache.GetPipeline( GetGBufferPipelineKey() ) : VK_NULL_HANDLE;
+
+		// Every frame is upscaled into the swapchain image
+		m_upscalePipeline = m_pipelineCache.GetPipeline( GetUpscalePipelineKey() );
 	}
 
 	void CreateFramebuffers()
 	{
-		// Resize the framebuffer vector to hold all the framebuffers
-		m_swapchainFramebuffers.resize( m_swapchainImageViews.size() );
-
-		// Create framebuffers from the image views
-		for ( size_t i = 0; i < m_swapchainImageViews.size(); i++ )
+		// Create an image view array (In the order of the render pass's attachments, the scene target replaces the swapchain image)
+		std::vector<VkImageView> attachments;
+		if ( m_renderPath == RenderPath::DEFERRED )
 		{
-			// Create an image view array
-			std::array<VkImageView, 3> attachments = { m_colourImage.GetImageView(), m_depthImage.GetImageView(), m_swapchainImageViews[i] };
-
-			// Setup the framebuffer create information
-			VkFramebufferCreateInfo framebufferCreateInfo {};
-			framebufferCreateInfo.sType			  = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-			framebufferCreateInfo.renderPass	  = m_renderPass;
-			framebufferCreateInfo.attachmentCount = static_cast<uint32_t>( attachments.size() );
-			framebufferCreateInfo.pAttachments	  = attachments.data();
-			framebufferCreateInfo.width			  = m_swapchainExtent.width;
-			framebufferCreateInfo.height		  = m_swapchainExtent.height;
-			framebufferCreateInfo.layers		  = 1;
-
-			// Create the framebuffer
-			if ( vkCreateFramebuffer( m_logicalDevice, &framebufferCreateInfo, nullptr, &m_swapchainFramebuffers[i] ) != VK_SUCCESS )
-				throw std::runtime_error( "Failed to create framebuffer" );
+			attachments = { m_resolution.GetSceneImageView(), m_renderGraph.GetImageView( m_depthResource ) };
+			for ( uint32_t i = 0; i < GBUFFER_ATTACHMENT_COUNT; i++ )
+				attachments.push_back( m_gBuffer.GetImageView( i ) );
 		}
+		else
+			attachments = { m_renderGraph.GetImageView( m_colourResource ), m_renderGraph.GetImageView( m_depthResource ), m_resolution.GetSceneImageView() };
+
+		// Setup the framebuffer create information (Full size, the dynamic resolution only renders into part of it)
+		VkFramebufferCreateInfo framebufferCreateInfo {};
+		framebufferCreateInfo.sType			  = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+		framebufferCreateInfo.renderPass	  = m_renderPass;
+		framebufferCreateInfo.attachmentCount = static_cast<uint32_t>( attachments.size() );
+		framebufferCreateInfo.pAttachments	  = attachments.data();
+		framebufferCreateInfo.width			  = m_swapchainExtent.width;
+		framebufferCreateInfo.height		  = m_swapchainExtent.height;
+		framebufferCreateInfo.layers		  = 1;
+
+		// Create the framebuffer (Only one, the swapchain images are only written by the upscale pass)
+		if ( vkCreateFramebuffer( m_logicalDevice, &framebufferCreateInfo, nullptr, &m_sceneFramebuffer ) != VK_SUCCESS )
+			throw std::runtime_error( "Failed to create framebuffer" );
 	}
 
 	void CreateCommandPool()
 	{
-		// Get the family indices
-		QueueFamilyIndices queueFamilyIndices = FindQueueFamilies( m_physicalDevice, m_surface );
-
 		// Setup the create information for the command pool
 		VkCommandPoolCreateInfo poolCreateInfo {};
 		poolCreateInfo.sType			= VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-		poolCreateInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily.value();
-		poolCreateInfo.flags			= 0;
+		poolCreateInfo.queueFamilyIndex = m_queueFamilies.graphicsFamily.value();
+		poolCreateInfo.flags			= VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT; // The frame command buffers are re-recorded every frame
 
 		// Create the command pool
 		if ( vkCreateCommandPool( m_logicalDevice, &poolCreateInfo, nullptr, &m_commandPool ) != VK_SUCCESS )
 			throw std::runtime_error( "Failed to create command pool" );
+
+		// Create the transfer command pool (Only used for short lived command buffers)
+		poolCreateInfo.queueFamilyIndex = m_queueFamilies.GetTransferFamily();
+		poolCreateInfo.flags			= VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+		if ( vkCreateCommandPool( m_logicalDevice, &poolCreateInfo, nullptr, &m_transferCommandPool ) != VK_SUCCESS )
+			throw std::runtime_error( "Failed to create transfer command pool" );
+	}
+
+	inline UploadQueues GetUploadQueues() const
+	{
+		return UploadQueues { m_transferCommandPool, m_transferQueue, m_queueFamilies.GetTransferFamily(), m_commandPool, m_graphicsQueue, m_queueFamilies.graphicsFamily.value() };
 	}
 
 	void CreateCommandBuffers()
 	{
-		// Resize the command buffers vector
-		m_commandBuffers.resize( m_swapchainFramebuffers.size() );
+		// Resize the command buffers vector (One per frame in flight, recorded each frame)
+		m_commandBuffers.resize( MAX_FRAMES_IN_FLIGHT );
 
 		// Setup the allocation information for the command buffer
 		VkCommandBufferAllocateInfo commandBufferAllocInfo {};
@@ -809,190 +1118,406 @@ private:
 		// Create the command buffers
 		if ( vkAllocateCommandBuffers( m_logicalDevice, &commandBufferAllocInfo, m_commandBuffers.data() ) != VK_SUCCESS )
 			throw std::runtime_error( "Failed to allocate command buffers" );
+	}
+
+	void RecordCommandBuffer( const VkCommandBuffer& p_commandBuffer, const uint32_t& p_imageIndex, FramePacket& p_packet )
+	{
+		// Reset the command buffer (The timeline wait guarantees the GPU is finished with it)
+		vkResetCommandBuffer( p_commandBuffer, 0 );
+
+		// Setup the begin information for the command buffer
+		VkCommandBufferBeginInfo commandBufferBeginInfo {};
+		commandBufferBeginInfo.sType			= VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		commandBufferBeginInfo.flags			= VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		commandBufferBeginInfo.pInheritanceInfo = nullptr;
+
+		// Create the command buffer
+		if ( vkBeginCommandBuffer( p_commandBuffer, &commandBufferBeginInfo ) != VK_SUCCESS )
+			throw std::runtime_error( "Failed to begin recording to command buffer" );
+
+		// Read back the frame's GPU time (The scale is updated from the last time this frame was drawn, which is also what the preset cost)
+		if ( m_resolution.BeginFrame( p_commandBuffer, static_cast<uint32_t>( m_currentFrame ) ) )
+		{
+			m_qualityCosts[static_cast<uint32_t>( m_qualityPreset )].frames++;
+			m_qualityCosts[static_cast<uint32_t>( m_qualityPreset )].totalMilliseconds += m_resolution.GetLastGpuMilliseconds();
+			m_overdraw.AddGpuTime( static_cast<uint32_t>( m_currentFrame ), m_resolution.GetLastGpuMilliseconds() );
+		}
+
+		// Render at the size the frame was simulated with (It can't be larger than the target if the swapchain has shrunk since)
+		VkExtent2D renderExtent = { std::min( p_packet.extent.width, m_swapchainExtent.width ), std::min( p_packet.extent.height, m_swapchainExtent.height ) };
+
+		// Read the last overdraw counts of this frame, and reset its query
+		m_overdraw.BeginFrame( p_commandBuffer, static_cast<uint32_t>( m_currentFrame ), m_depthPrepass, static_cast<uint64_t>( renderExtent.width ) * renderExtent.height );
+
+		// Write the materials edited since this frame was last drawn
+		m_materials.Upload( static_cast<uint32_t>( m_currentFrame ) );
+
+		// Stream texture levels in and out on the transfer queue, then point this frame's descriptor set at any texture's new image (Before the set is bound)
+		m_textureStreaming.Update( p_commandBuffer, static_cast<uint32_t>( m_currentFrame ), m_frameNumber, p_packet.textureRequests, &m_materials, &m_deletionQueue );
+		if ( m_textureStreaming.TakeSwapped( static_cast<uint32_t>( m_currentFrame ) ) )
+		{
+			for ( uint32_t i = 0; i < TEXTURE_SAMPLER_COUNT; i++ )
+			{
+				const Texture& texture = m_materials.GetTexture( i < m_materials.GetTextureCount() ? i : 0 );
+				m_descriptorCollection.SetImage( static_cast<uint32_t>( m_currentFrame ), TEXTURE_BINDING + i, 0, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, texture.GetImageView(), texture.GetSampler() );
+			}
+			m_descriptorCollection.UpdateSets();
+		}
+
+		// Point the graph at this frame's swapchain image and packet
+		m_recordImageIndex = p_imageIndex;
+		m_recordExtent	   = renderExtent;
+		m_recordPacket	   = &p_packet;
+		m_renderGraph.SetImportedImage( m_swapchainResource, m_swapchainImages[p_imageIndex], m_swapchainImageViews[p_imageIndex] );
+		m_renderGraph.SetImportedBuffer( m_vertexResource, m_vertexBuffer );
 
-		// Create an array of clear values
-		std::array<VkClearValue, 2> clearValues {};
+		// Bind the vertex buffers (Shared by the shadow and scene passes)
+		VkBuffer	 vertexBuffers[] = { m_vertexBuffer };
+		VkDeviceSize offsets[]		 = { 0 };
+		vkCmdBindVertexBuffers( p_commandBuffer, 0, 1, vertexBuffers, offsets );
+
+		// Bind the index buffers
+		vkCmdBindIndexBuffer( p_commandBuffer, m_indexBuffer, 0, INDEX_BUFFER_TYPE );
+
+		// Record the frame's passes with the barriers between them, then stop timing the frame
+		m_renderGraph.Execute( p_commandBuffer );
+		m_resolution.EndFrame( p_commandBuffer, static_cast<uint32_t>( m_currentFrame ) );
+
+		// Finish the recording and check for errors
+		if ( vkEndCommandBuffer( p_commandBuffer ) != VK_SUCCESS )
+			throw std::runtime_error( "Failed to record command buffer" );
+	}
+
+	void RecordVertexUpload( const VkCommandBuffer& p_commandBuffer ) const
+	{
+		// Copy the frame's vertices from the packet's staging buffer
+		VkBufferCopy copyRegion {};
+		copyRegion.srcOffset = 0;
+		copyRegion.dstOffset = 0;
+		copyRegion.size		 = m_recordPacket->GetVertexSize();
+		vkCmdCopyBuffer( p_commandBuffer, m_recordPacket->GetVertexStagingBuffer(), m_vertexBuffer, 1, &copyRegion );
+	}
+
+	void RecordShadows( const VkCommandBuffer& p_commandBuffer )
+	{
+		// Render the sun's shadow cascades (Only the cascades that moved redraw their static casters, and only those with dynamic casters in them copy and redraw the rest)
+		m_shadows.Record(
+			p_commandBuffer, m_shadowPipeline, [this]( const VkCommandBuffer& p_cmd ) { DrawObjects( p_cmd, true ); }, [this]( const VkCommandBuffer& p_cmd ) { DrawObjects( p_cmd, false ); },
+			[this]( const Frustum& p_frustum ) { return HasDynamicObjects( p_frustum ); } );
+	}
+
+	void RecordScene( const VkCommandBuffer& p_commandBuffer )
+	{
+		// Create an array of clear values (The G-buffer clears to zero, so its position's w marks the pixels nothing was drawn to)
+		std::vector<VkClearValue> clearValues( m_renderPath == RenderPath::DEFERRED ? 2 + GBUFFER_ATTACHMENT_COUNT : 2 );
 		clearValues[0].color		= { { 0.0f, 0.0f, 0.0f, 1.0f } };
 		clearValues[1].depthStencil = { 1.0f, 0 };
 
-		// Begin recording to the command buffers
-		for ( size_t i = 0; i < m_commandBuffers.size(); i++ )
+		// Setup the begin informatio for the render pass
+		VkRenderPassBeginInfo renderPassBeginInfo {};
+		renderPassBeginInfo.sType			  = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+		renderPassBeginInfo.renderPass		  = m_renderPass;
+		renderPassBeginInfo.framebuffer		  = m_sceneFramebuffer;
+		renderPassBeginInfo.renderArea.offset = { 0, 0 };
+		renderPassBeginInfo.renderArea.extent = m_recordExtent;
+		renderPassBeginInfo.clearValueCount	  = static_cast<uint32_t>( clearValues.size() );
+		renderPassBeginInfo.pClearValues	  = clearValues.data();
+
+		// Start timing the frame on the GPU, then record the beginning of a render pass
+		m_resolution.StartTiming( p_commandBuffer, static_cast<uint32_t>( m_currentFrame ) );
+		vkCmdBeginRenderPass( p_commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE );
+
+		// Check whether the scene's variants have finished compiling, drawing with the fallback until they have
+		std::array<VkPipeline, MATERIAL_PIPELINE_COUNT> pipelines;
+		bool											fallback = false;
+		for ( uint32_t i = 0; i < MATERIAL_PIPELINE_COUNT; i++ )
 		{
-			// Setup the begin information for the command buffer
-			VkCommandBufferBeginInfo commandBufferBeginInfo {};
-			commandBufferBeginInfo.sType			= VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-			commandBufferBeginInfo.flags			= 0;
-			commandBufferBeginInfo.pInheritanceInfo = nullptr;
-
-			// Create the command buffer
-			if ( vkBeginCommandBuffer( m_commandBuffers[i], &commandBufferBeginInfo ) != VK_SUCCESS )
-				throw std::runtime_error( "Failed to begin recording to command buffer[" + std::to_string( i ) + "]" );
-
-			// Setup the begin informatio for the render pass
-			VkRenderPassBeginInfo renderPassBeginInfo {};
-			renderPassBeginInfo.sType			  = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-			renderPassBeginInfo.renderPass		  = m_renderPass;
-			renderPassBeginInfo.framebuffer		  = m_swapchainFramebuffers[i];
-			renderPassBeginInfo.renderArea.offset = { 0, 0 };
-			renderPassBeginInfo.renderArea.extent = m_swapchainExtent;
-			renderPassBeginInfo.clearValueCount	  = static_cast<uint32_t>( clearValues.size() );
-			renderPassBeginInfo.pClearValues	  = clearValues.data();
-
-			// Record the beginning of a render pass
-			vkCmdBeginRenderPass( m_commandBuffers[i], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE );
-
-			// Record the binding of the graphics pipeline
-			vkCmdBindPipeline( m_commandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipeline );
-
-			// Bind the vertex buffers
-			VkBuffer	 vertexBuffers[] = { m_vertexBuffer };
-			VkDeviceSize offsets[]		 = { 0 };
-			vkCmdBindVertexBuffers( m_commandBuffers[i], 0, 1, vertexBuffers, offsets );
-
-			// Bind the index buffers
-			vkCmdBindIndexBuffer( m_commandBuffers[i], m_indexBuffer, 0, INDEX_BUFFER_TYPE );
-
-			// Bind the descriptor sets
-			vkCmdBindDescriptorSets( m_commandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 0, 1, m_descriptorCollection.GetSetRef( i ), 0, nullptr );
-
-			// Record the drawing of the triangle
-			vkCmdDrawIndexed( m_commandBuffers[i], m_indicesCount, 1, 0, 0, 0 );
-
-			// Record the end of the render pass
-			vkCmdEndRenderPass( m_commandBuffers[i] );
-
-			// Finish the recording and check for errors
-			if ( vkEndCommandBuffer( m_commandBuffers[i] ) != VK_SUCCESS )
-				throw std::runtime_error( "Failed to record command buffer" );
+			if ( m_scenePipelines[i] == VK_NULL_HANDLE )
+				m_scenePipelines[i] = m_pipelineCache.RequestPipeline( m_scenePipelineKeys[i] );
+
+			pipelines[i] = m_scenePipelines[i] != VK_NULL_HANDLE ? m_scenePipelines[i] : m_fallbackPipeline;
+			fallback |= m_scenePipelines[i] == VK_NULL_HANDLE;
+		}
+		if ( fallback ) m_fallbackFrames++;
+
+		// Set the viewport and scissor to the scaled region (Dynamic so pipelines don't depend on the resolution)
+		VkViewport viewport { 0.0f, 0.0f, (float)m_recordExtent.width, (float)m_recordExtent.height, 0.0f, 1.0f };
+		VkRect2D   scissor { { 0, 0 }, m_recordExtent };
+		vkCmdSetViewport( p_commandBuffer, 0, 1, &viewport );
+		vkCmdSetScissor( p_commandBuffer, 0, 1, &scissor );
+
+		// Bind the descriptor sets (One per frame in flight, shared by every subpass)
+		vkCmdBindDescriptorSets( p_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 0, 1, m_descriptorCollection.GetSetRef( m_currentFrame ), 0, nullptr );
+
+		// Write the depth of the nearest surfaces first, so the colour subpass only shades those (Every material writes its depth the same way)
+		if ( m_depthPrepass )
+		{
+			std::array<VkPipeline, MATERIAL_PIPELINE_COUNT> prepassPipelines;
+			prepassPipelines.fill( m_prepassPipeline );
+			m_recordPacket->drawList.Record( p_commandBuffer, prepassPipelines.data(), MATERIAL_PIPELINE_COUNT );
+			vkCmdNextSubpass( p_commandBuffer, VK_SUBPASS_CONTENTS_INLINE );
 		}
+
+		// Draw the objects in their sorted order with their material's variant, counting the fragments they shade (The deferred path fills its G-buffer first, the same way for every material)
+		std::array<VkPipeline, MATERIAL_PIPELINE_COUNT> drawPipelines = pipelines;
+		if ( m_renderPath == RenderPath::DEFERRED ) drawPipelines.fill( m_gBufferPipeline );
+		m_overdraw.BeginQuery( p_commandBuffer, static_cast<uint32_t>( m_currentFrame ) );
+		m_recordPacket->drawList.Record( p_commandBuffer, drawPipelines.data(), MATERIAL_PIPELINE_COUNT );
+		m_overdraw.EndQuery( p_commandBuffer, static_cast<uint32_t>( m_currentFrame ) );
+
+		// Shade every pixel once from the G-buffer (No vertex buffer, the triangle covers the screen)
+		if ( m_renderPath == RenderPath::DEFERRED )
+		{
+			vkCmdNextSubpass( p_commandBuffer, VK_SUBPASS_CONTENTS_INLINE );
+			vkCmdBindPipeline( p_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelines[MATERIAL_PIPELINE_DIFFUSE] );
+			vkCmdDraw( p_commandBuffer, 3, 1, 0, 0 );
+		}
+
+		// Record the end of the render pass
+		vkCmdEndRenderPass( p_commandBuffer );
+	}
+
+	void DrawObjects( const VkCommandBuffer& p_commandBuffer, const bool& p_static ) const
+	{
+		// Draw either the static or the dynamic objects, one draw each
+		for ( size_t i = 0; i < m_objects.size(); i++ )
+		{
+			if ( m_objects[i].IsStatic() != p_static ) continue;
+
+			uint32_t indexCount = static_cast<uint32_t>( m_objects[i].GetModel().GetIndices().size() );
+			vkCmdDrawIndexed( p_commandBuffer, indexCount, 1, m_objectFirstIndices[i], 0, 0 );
+		}
+	}
+
+	bool HasDynamicObjects( const Frustum& p_frustum ) const
+	{
+		// Check whether any dynamic object is inside the region (Where the frame's simulation left them)
+		for ( const AABB& bounds : m_recordPacket->dynamicBounds )
+			if ( p_frustum.Classify( bounds ) != FrustumTest::OUTSIDE ) return true;
+		return false;
 	}
 
 	void CreateSyncObjects()
 	{
-		// Resize the semaphore and fence vectors
+		// Resize the semaphore vectors
 		m_imageAvailableSemaphores.resize( MAX_FRAMES_IN_FLIGHT );
 		m_renderFinishedSemaphores.resize( MAX_FRAMES_IN_FLIGHT );
-		m_inFlightFences.resize( MAX_FRAMES_IN_FLIGHT );
-		m_inFlightImages.resize( m_swapchainImages.size(), VK_NULL_HANDLE ); // Initialise to no fence
 
 		// Setup the semaphore create information
 		VkSemaphoreCreateInfo semaphoreCreateInfo {};
 		semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-		// Setup the fence create information
-		VkFenceCreateInfo fenceCreateInfo {};
-		fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-		fenceCreateInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT; // Start in the signaled state
-
-		for ( size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ ) // Create the semaphores for each frame
+		for ( size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ ) // Create the semaphores for each frame (The swapchain still needs binary semaphores)
 		{
-			// Create the semaphores and the fence
+			// Create the semaphores
 			if ( vkCreateSemaphore( m_logicalDevice, &semaphoreCreateInfo, nullptr, &m_imageAvailableSemaphores[i] ) != VK_SUCCESS ||
-				 vkCreateSemaphore( m_logicalDevice, &semaphoreCreateInfo, nullptr, &m_renderFinishedSemaphores[i] ) != VK_SUCCESS ||
-				 vkCreateFence( m_logicalDevice, &fenceCreateInfo, nullptr, &m_inFlightFences[i] ) != VK_SUCCESS )
+				 vkCreateSemaphore( m_logicalDevice, &semaphoreCreateInfo, nullptr, &m_renderFinishedSemaphores[i] ) != VK_SUCCESS )
 				throw std::runtime_error( "Failed to create syncronisation objects for a frame" );
 		}
+
+		// Create the frame timeline, no frames have been submitted yet
+		m_frameTimeline.Init( m_logicalDevice, 0 );
+		m_frameNumber = 0;
 	}
 
-	void CreateIndexAndVertexBuffer()
-	{
-		// Define a vertices vector
-		std::vector<Vertex> vertices {};
+	// The timeline value that means the GPU has finished with the resources frame p_frameNumber shares with earlier frames
+	static inline uint64_t GetReuseValue( const uint64_t& p_frameNumber ) { return p_frameNumber >= MAX_FRAMES_IN_FLIGHT ? p_frameNumber + 1 - MAX_FRAMES_IN_FLIGHT : 0; }
 
-		// Define a indices vector
-		std::vector<IndexBufferType> indices {};
+	// The timeline value that means the GPU has finished with the packet frame p_frameNumber shares with earlier frames
+	static inline uint64_t GetPacketReuseValue( const uint64_t& p_frameNumber ) { return p_frameNumber >= FRAME_PACKET_COUNT ? p_frameNumber + 1 - FRAME_PACKET_COUNT : 0; }
 
-		// Create an offset for the indices;
-		IndexBufferType offset = 0;
+	inline FramePacket& GetFramePacket( const uint64_t& p_frameNumber ) { return m_framePackets[p_frameNumber % FRAME_PACKET_COUNT]; }
 
-		// Add the indices from all the object models
+	void GetObjectBufferSizes( size_t* p_vertexCount, size_t* p_indexCount ) const
+	{
+		// Total up the vertices and indices of every object model
+		*p_vertexCount = 0;
+		*p_indexCount  = 0;
 		for ( const auto& object : m_objects )
 		{
-			// Create a vector of the model's indices
-			std::vector<IndexBufferType> modelIndices = object.GetModel().GetAdjustedIndices( offset );
+			*p_vertexCount += object.GetModel().GetVertices().size();
+			*p_indexCount += object.GetModel().GetIndices().size();
+		}
+	}
 
-			// Create a vector of the model's vertices after a matrix transformation
-			std::vector<Vertex> modelVertices = object.GetVerticesAfterModelMatrix( m_camera.GetMVP().view );
+	void WriteObjectVertices( Vertex* p_destination )
+	{
+		// Find where each object's vertices start in the destination
+		std::vector<size_t> offsets( m_objects.size() );
+		size_t				offset = 0;
+		for ( size_t i = 0; i < m_objects.size(); i++ )
+		{
+			offsets[i] = offset;
+			offset += m_objects[i].GetModel().GetVertices().size();
+		}
 
-			// Increment the offset
-			offset += modelVertices.size();
+		// Transform each object's vertices straight into the destination as a separate job (Large meshes are split further)
+		m_jobs.ParallelFor( m_objects.size(), 1, [&]( const size_t& p_first, const size_t& p_last ) {
+			for ( size_t i = p_first; i < p_last; i++ )
+				m_objects[i].WriteVerticesAfterModelMatrix( p_destination + offsets[i], &m_jobs );
+		} );
+	}
 
-			// Add it to the end of the vertices vector
-			vertices.insert( vertices.end(), modelVertices.begin(), modelVertices.end() );
+	void WriteObjectIndices( IndexBufferType* p_destination ) const
+	{
+		// Create an offset for the indices
+		IndexBufferType offset = 0;
 
-			// Add it to the end of the indices vector
-			indices.insert( indices.end(), modelIndices.begin(), modelIndices.end() );
+		// Write each object's indices, offset by the vertices before it
+		for ( const auto& object : m_objects )
+		{
+			object.GetModel().WriteAdjustedIndices( offset, p_destination );
+			p_destination += object.GetModel().GetIndices().size();
+			offset += object.GetModel().GetVertices().size();
 		}
+	}
+
+	void CreateIndexAndVertexBuffer()
+	{
+		// Get the size of the combined buffers
+		size_t vertexCount, indexCount;
+		GetObjectBufferSizes( &vertexCount, &indexCount );
 
-		// Set the number of indices (needed to know how many to draw)
-		m_indicesCount = indices.size();
+		// Find where each object's indices start (Each object is its own draw)
+		m_objectFirstIndices.clear();
+		uint32_t firstIndex = 0;
+		for ( const auto& object : m_objects )
+		{
+			m_objectFirstIndices.push_back( firstIndex );
+			firstIndex += static_cast<uint32_t>( object.GetModel().GetIndices().size() );
+		}
 
-		// Create a vertex buffer using a staging buffer
-		CreateBufferViaStagingBuffer( m_logicalDevice, m_physicalDevice, m_commandPool, m_graphicsQueue, vertices.size() * sizeof( Vertex ), vertices.data(),
-									  VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &m_vertexBuffer, &m_vertexBufferMemory );
+		// Create the vertex and index buffers
+		CreateBuffer( m_logicalDevice, m_physicalDevice, vertexCount * sizeof( Vertex ), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &m_vertexBuffer, &m_vertexBufferMemory );
+		CreateBuffer( m_logicalDevice, m_physicalDevice, indexCount * sizeof( IndexBufferType ), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &m_indexBuffer, &m_indexBufferMemory );
 
-		// Create an index buffer using a staging buffer
-		CreateBufferViaStagingBuffer( m_logicalDevice, m_physicalDevice, m_commandPool, m_graphicsQueue, indices.size() * sizeof( IndexBufferType ), indices.data(),
-									  VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &m_indexBuffer, &m_indexBufferMemory );
+		// Fill them through staging buffers
+		UpdateIndexAndVertexBuffer();
 	}
 
 	void UpdateIndexAndVertexBuffer()
 	{
-		// Define a vertices vector
-		std::vector<Vertex> vertices {};
+		// Get the size of the combined buffers
+		size_t vertexCount, indexCount;
+		GetObjectBufferSizes( &vertexCount, &indexCount );
+
+		// Transform the vertices directly into the mapped staging memory and upload them on the transfer queue
+		UploadBufferViaTransferQueue(
+			m_logicalDevice, m_physicalDevice, GetUploadQueues(), vertexCount * sizeof( Vertex ), [&]( void* p_mapped ) { WriteObjectVertices( static_cast<Vertex*>( p_mapped ) ); }, &m_vertexBuffer,
+			VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT );
+
+		// Write the indices directly into the mapped staging memory and upload them on the transfer queue
+		UploadBufferViaTransferQueue(
+			m_logicalDevice, m_physicalDevice, GetUploadQueues(), indexCount * sizeof( IndexBufferType ), [&]( void* p_mapped ) { WriteObjectIndices( static_cast<IndexBufferType*>( p_mapped ) ); }, &m_indexBuffer,
+			VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_INDEX_READ_BIT );
+	}
 
-		// Define a indices vector
-		std::vector<IndexBufferType> indices {};
+	void CreateFramePackets()
+	{
+		// Get the size of the combined buffers
+		size_t vertexCount, indexCount;
+		GetObjectBufferSizes( &vertexCount, &indexCount );
 
-		// Create an offset for the indices;
-		IndexBufferType offset = 0;
+		// Create the packets the frames are simulated into
+		for ( auto& packet : m_framePackets )
+			packet.Init( m_logicalDevice, m_physicalDevice, vertexCount );
+	}
 
-		// Add the indices from all the object models
-		for ( const auto& object : m_objects )
-		{
-			// Create a vector of the model's indices
-			std::vector<IndexBufferType> modelIndices = object.GetModel().GetAdjustedIndices( offset );
+	void StartSimulation( const uint64_t& p_frameNumber )
+	{
+		FramePacket* packet = &GetFramePacket( p_frameNumber );
 
-			// Create a vector of the model's vertices after a matrix transformation
-			std::vector<Vertex> modelVertices = object.GetVerticesAfterModelMatrix( m_camera.GetMVP().view );
+		// Wait for the GPU to finish with the packet in an earlier frame before the job writes to it (Already done by the frame wait, unless the packet is simulated again)
+		packet->reuseValue = GetPacketReuseValue( p_frameNumber );
+		m_frameTimeline.Wait( packet->reuseValue );
 
-			// Increment the offset
-			offset += modelVertices.size();
+		// Snapshot the camera and time on this thread, so input can keep being processed while the job runs
+		packet->ubo			= m_camera.GetMVP();
+		packet->view		= packet->ubo.view;
+		packet->extent		= m_resolution.GetRenderExtent();
+		packet->deltaT		= deltaT;
+		packet->timeElapsed = timeElapsed;
 
-			// Add it to the end of the vertices vector
-			vertices.insert( vertices.end(), modelVertices.begin(), modelVertices.end() );
+		// Simulate the frame on the job system
+		m_jobs.Run( [this, packet]() { SimulateFrame( packet ); }, &packet->ready );
+	}
 
-			// Add it to the end of the indices vector
-			indices.insert( indices.end(), modelIndices.begin(), modelIndices.end() );
-		}
-		// auto pos = normalize( vertices[0].position - m_pointLights[0].GetPos() );
-		// std::cout << pos.x << " " << pos.y << " " << pos.z << std::endl;
+	void SimulateFrame( FramePacket* p_packet )
+	{
+		// Update the models (Keeping a static object's move until the packet is drawn, in case it is simulated again)
+		UpdateObjects( p_packet->timeElapsed, &p_packet->staticMoved );
+
+		// Copy what the render thread reads from the scene into the packet
+		p_packet->pointLights = m_pointLights;
+		p_packet->dynamicBounds.clear();
+		for ( const auto& object : m_objects )
+			if ( !object.IsStatic() ) p_packet->dynamicBounds.push_back( object.GetBounds() );
 
-		// Update the vertex buffer
-		UpdateBufferViaStagingBuffer( m_logicalDevice, m_physicalDevice, m_commandPool, m_graphicsQueue, vertices.size() * sizeof( Vertex ), vertices.data(), &m_vertexBuffer );
+		// Sort the scene's draws for the packet's frame, and ask for the texture levels they are seen at
+		BuildDrawList( p_packet, p_packet->view, p_packet->ubo.proj, p_packet->extent );
 
-		// Update the index buffer
-		UpdateBufferViaStagingBuffer( m_logicalDevice, m_physicalDevice, m_commandPool, m_graphicsQueue, indices.size() * sizeof( IndexBufferType ), indices.data(), &m_indexBuffer );
+		// Transform the vertices straight into the packet's staging buffer (World space, so they don't depend on the camera)
+		WriteObjectVertices( p_packet->GetMappedVertices() );
+	}
+
+	void BuildDrawList( FramePacket* p_packet, const glm::mat4& p_view, const glm::mat4& p_proj, const VkExtent2D& p_extent )
+	{
+		// Key each object in the camera's frustum by its material's pipeline, its material and its distance from the camera (Culled through the bounding volume hierarchy)
+		p_packet->drawList.Begin();
+		p_packet->textureRequests.assign( m_materials.GetTextureCount(), TEXTURE_STREAM_NOT_SEEN );
+		m_objectTree.QueryFrustum( Frustum::FromMatrix( p_proj * p_view ), [&]( const uint32_t& p_objectID ) {
+			AABB	 bounds		= m_objects[p_objectID].GetBounds();
+			uint32_t material	= m_objects[p_objectID].GetMaterial();
+			float	 depth		= -( p_view * glm::vec4( bounds.GetCentre(), 1.0f ) ).z; // The camera looks down negative z
+			uint64_t key		= MakeDrawKey( DrawPass::SOLID, m_materials.GetMaterial( material ).pipeline, material, p_objectID, ( depth - CAMERA_NEAR ) / ( CAMERA_FAR - CAMERA_NEAR ) );
+			uint32_t indexCount = static_cast<uint32_t>( m_objects[p_objectID].GetModel().GetIndices().size() );
+			p_packet->drawList.Add( { key, m_objectFirstIndices[p_objectID], indexCount, material } );
+
+			// Ask for the level of the object's texture that matches the pixels it covers, unless it is behind the camera (Assuming the texture is stretched once across it)
+			float radius = 0.5f * glm::length( bounds.max - bounds.min );
+			if ( depth + radius < CAMERA_NEAR ) return true;
+			uint32_t	   textureIndex = m_materials.GetMaterial( material ).texture;
+			const Texture& texture		= m_materials.GetTexture( textureIndex );
+			float		   pixels		= radius * p_proj[1][1] / std::max( depth, CAMERA_NEAR ) * p_extent.height;
+			uint32_t&	   request		= p_packet->textureRequests[textureIndex];
+			request						= std::min( request, GetStreamLevel( std::max( texture.GetWidth(), texture.GetHeight() ), pixels ) ); // The finest level asked for wins
+
+			return true; // Continue the query
+		} );
+
+		// Radix sort the keys on the job system
+		p_packet->drawList.Sort( &m_jobs );
 	}
 
 	void CreateDescriptorSetLayout()
 	{
 		// Setup the descriptor collection
-		m_descriptorCollection.Init( m_logicalDevice, static_cast<uint32_t>( m_swapchainImages.size() ) );
+		m_descriptorCollection.Init( m_logicalDevice, MAX_FRAMES_IN_FLIGHT, m_objectCache.GetDescriptorLayouts() );
 
 		// Setup the descriptor set layout binding for the model view projection matrix
 		m_descriptorCollection.AddLayoutBinding( VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr );
 
-		// // Setup the descriptor set layout binding for the model view projection matrix
-		// m_descriptorCollection.AddLayoutBinding( VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr );
+		// Setup the descriptor set layout bindings for the lights, the clusters, and the cluster light indices
+		for ( uint32_t i = 0; i < 3; i++ )
+			m_descriptorCollection.AddLayoutBinding( VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr );
 
-		// Add an image layout binding for all objects
-		for ( uint32_t i = 0; i < 3; i++ ) // Hardcoded value for now
+		// Setup the descriptor set layout bindings for the sun's cascades, the materials and the sun's shadow map (Buffers come before images)
+		m_descriptorCollection.AddLayoutBinding( VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr );
+		m_descriptorCollection.AddLayoutBinding( VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr );
+		m_descriptorCollection.AddLayoutBinding( VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr );
+
+		// Add an image layout binding for each texture
+		for ( uint32_t i = 0; i < TEXTURE_SAMPLER_COUNT; i++ )
 		{
 			// Setup the descriptor set layout binding for an image
 			m_descriptorCollection.AddLayoutBinding( VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr );
 		}
 
+		// Setup the descriptor set layout bindings for the G-buffer, read by the deferred lighting subpass
+		if ( m_renderPath == RenderPath::DEFERRED )
+			for ( uint32_t i = 0; i < GBUFFER_ATTACHMENT_COUNT; i++ )
+				m_descriptorCollection.AddLayoutBinding( VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr );
+
 		// Create the descriptor set layout
 		m_descriptorCollection.CreateLayout();
 	}
@@ -1003,11 +1528,11 @@ private:
 
 		// Resize the buffer and memory vectors
 		VkDeviceSize bufferSize = sizeof( VertexUniformBufferObject );
-		m_vertexUniformBufferObjects.resize( m_swapchainImages.size() );
-		m_vertexUniformBufferObjectMemory.resize( m_swapchainImages.size() );
+		m_vertexUniformBufferObjects.resize( MAX_FRAMES_IN_FLIGHT );
+		m_vertexUniformBufferObjectMemory.resize( MAX_FRAMES_IN_FLIGHT );
 
-		// Create a buffer for each swapchain image
-		for ( size_t i = 0; i < m_swapchainImages.size(); i++ )
+		// Create a buffer for each frame in flight
+		for ( size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
 			CreateBuffer( m_logicalDevice, m_physicalDevice, bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &m_vertexUniformBufferObjects[i], &m_vertexUniformBufferObjectMemory[i] );
 
 		// // Point Light UBO
@@ -1033,77 +1558,154 @@ private:
 		// Add a uniform buffer descriptor
 		m_descriptorCollection.AddBufferSets( m_vertexUniformBufferObjects, 0, sizeof( VertexUniformBufferObject ), VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER );
 
-		// // Add a uniform buffer descriptor
-		// m_descriptorCollection.AddBufferSets( m_fragmentUniformBufferObjects, 0, sizeof( *m_pointLights.data() ), VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER );
+		// Add the clustered lighting storage buffers (Each frame in flight has its own)
+		std::vector<VkBuffer> lightBuffers, clusterBuffers, indexBuffers;
+		for ( uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
+		{
+			lightBuffers.push_back( m_clusteredLighting.GetLightBuffer( i ) );
+			clusterBuffers.push_back( m_clusteredLighting.GetClusterBuffer( i ) );
+			indexBuffers.push_back( m_clusteredLighting.GetIndexBuffer( i ) );
+		}
+		m_descriptorCollection.AddBufferSets( lightBuffers, 0, static_cast<uint32_t>( ClusteredLighting::GetLightBufferSize() ), VK_DESCRIPTOR_TYPE_STORAGE_BUFFER );
+		m_descriptorCollection.AddBufferSets( clusterBuffers, 0, static_cast<uint32_t>( ClusteredLighting::GetClusterBufferSize() ), VK_DESCRIPTOR_TYPE_STORAGE_BUFFER );
+		m_descriptorCollection.AddBufferSets( indexBuffers, 0, static_cast<uint32_t>( ClusteredLighting::GetIndexBufferSize() ), VK_DESCRIPTOR_TYPE_STORAGE_BUFFER );
 
-		// Add an image descriptor for all objects
-		for ( uint32_t i = 0; i < m_objects.size(); i++ )
+		// Add the sun's cascades, the materials and the sun's shadow map (Each frame in flight has its own material table)
+		std::vector<VkBuffer> shadowBuffers, materialBuffers;
+		for ( uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
+		{
+			shadowBuffers.push_back( m_shadows.GetUniformBuffer( i ) );
+			materialBuffers.push_back( m_materials.GetBuffer( i ) );
+		}
+		m_descriptorCollection.AddBufferSets( shadowBuffers, 0, sizeof( ShadowUniformBufferObject ), VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER );
+		m_descriptorCollection.AddBufferSets( materialBuffers, 0, static_cast<uint32_t>( MaterialLibrary::GetBufferSize() ), VK_DESCRIPTOR_TYPE_STORAGE_BUFFER );
+		m_descriptorCollection.AddImageSets( VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, m_shadows.GetImageView(), m_shadows.GetSampler(), VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER );
+
+		// Add an image descriptor for each texture (Bindings past the last texture repeat the first)
+		if ( m_materials.GetTextureCount() > TEXTURE_SAMPLER_COUNT )
+			throw std::runtime_error( "Failed to add texture descriptors, the materials use more textures than there are samplers" );
+		for ( uint32_t i = 0; i < TEXTURE_SAMPLER_COUNT; i++ )
 		{
 			// Add an image descriptor
-			m_descriptorCollection.AddImageSets( VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, m_objects[i].GetModel().GetTexture().GetImageView(), m_objects[i].GetModel().GetTexture().GetSampler(), VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER );
+			const Texture& texture = m_materials.GetTexture( i < m_materials.GetTextureCount() ? i : 0 );
+			m_descriptorCollection.AddImageSets( VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, texture.GetImageView(), texture.GetSampler(), VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER );
 		}
 
+		// Add the G-buffer's input attachments (Recreated with the swapchain, like the sets)
+		if ( m_renderPath == RenderPath::DEFERRED )
+			for ( uint32_t i = 0; i < GBUFFER_ATTACHMENT_COUNT; i++ )
+				m_descriptorCollection.AddImageSets( VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, m_gBuffer.GetImageView( i ), VK_NULL_HANDLE, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT );
+
 		// Update the sets
 		m_descriptorCollection.UpdateSets();
 	}
 
 	void CreateEnvironmentModel()
 	{
+		// Create the materials (The cubes share one, and with it their texture)
+		uint32_t grass		= m_materials.CreateMaterial( "grass", { m_materials.LoadTexture( "resources/textures/Grass_Block_TEX.png" ) } );
+		uint32_t vikingRoom = m_materials.CreateMaterial( "viking room", { m_materials.LoadTexture( TEXTURE_PATH ), glm::vec4( 1.0f ), 0.5f, MATERIAL_PIPELINE_SPECULAR } );
+
 		// Create a world object
 		WorldObject object;
 
-		// Initialise the object and its texture
-		object.Init( "resources/models/Cube.obj", "resources/textures/Grass_Block_TEX.png", { 0.0f, 0.0f, 2.0f }, { 0.0f, 0.0f, 0.0f }, { 1.0f, 1.0f, 1.0f }, VK_SAMPLE_COUNT_1_BIT, m_logicalDevice, m_physicalDevice, m_commandPool, m_graphicsQueue, m_physicalDeviceProperties,
-					 VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-					 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_IMAGE_ASPECT_COLOR_BIT, static_cast<uint32_t>( m_objects.size() ) );
+		// Initialise the object
+		object.Init( "resources/models/Cube.obj", grass, { 0.0f, 0.0f, 2.0f }, { 0.0f, 0.0f, 0.0f }, { 1.0f, 1.0f, 1.0f }, &m_transforms );
 
 		// Add to the objects vector
 		m_objects.push_back( object );
 
-		// Initialise the object and its texture
-		object.Init( MODEL_PATH.c_str(), TEXTURE_PATH.c_str(), { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f }, { 1.0f, 1.0f, 1.0f }, VK_SAMPLE_COUNT_1_BIT, m_logicalDevice, m_physicalDevice, m_commandPool, m_graphicsQueue, m_physicalDeviceProperties,
-					 VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-					 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_IMAGE_ASPECT_COLOR_BIT, static_cast<uint32_t>( m_objects.size() ) );
+		// Initialise the object
+		object.Init( MODEL_PATH.c_str(), vikingRoom, { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f }, { 1.0f, 1.0f, 1.0f }, &m_transforms );
 
 		// Add to the objects vector
 		m_objects.push_back( object );
 
-		// Initialise the object and its texture
-		object.Init( "resources/models/Cube.obj", "resources/textures/Grass_Block_TEX.png", m_pointLights[0].GetPos(), { 0.0f, 0.0f, 0.0f }, { 0.2f, 0.2f, 0.2f }, VK_SAMPLE_COUNT_1_BIT, m_logicalDevice, m_physicalDevice, m_commandPool, m_graphicsQueue, m_physicalDeviceProperties,
-					 VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-					 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_IMAGE_ASPECT_COLOR_BIT, static_cast<uint32_t>( m_objects.size() ) );
+		// Initialise the object
+		object.Init( "resources/models/Cube.obj", grass, m_pointLights[0].GetPos(), { 0.0f, 0.0f, 0.0f }, { 0.2f, 0.2f, 0.2f }, &m_transforms );
 
-		// Add to the objects vector
+		// Add to the objects vector, it follows the light so its shadow is redrawn every frame
 		m_objects.push_back( object );
+		m_objects.back().SetStatic( false );
+
+		// Compute the initial world matrices
+		m_transforms.Update();
+
+		// Add the objects to the bounding volume hierarchy (The user data is the index into m_objects)
+		for ( uint32_t i = 0; i < m_objects.size(); i++ )
+			m_objects[i].AttachToTree( &m_objectTree, i );
 	}
 
-	void UpdateObjects()
+	void UpdateObjects( const float& p_timeElapsed, bool* p_staticMoved )
 	{
-		m_pointLights[0].SetPos( { 0.0f, 4.5f * sin( timeElapsed ), 0.0f } );
+		m_pointLights[0].SetPos( { 0.0f, 4.5f * sin( p_timeElapsed ), 0.0f } );
 		m_objects[2].SetPos( m_pointLights[0].GetPos() );
-	}
 
-	void CreateColourResources()
-	{
-		// Find a suitable format
-		VkFormat colourFormat = m_swapchainImageFormat;
+		// Recompute the world matrices of the transforms which changed
+		m_transforms.Update();
 
-		// Initialise an Image object using the correct parameters
-		m_colourImage.Init( m_logicalDevice, m_physicalDevice, m_swapchainExtent.width, m_swapchainExtent.height, 1, m_msaaSampleCount, colourFormat, VK_IMAGE_TILING_OPTIMAL,
-							VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_IMAGE_ASPECT_COLOR_BIT );
+		// Refit the objects which moved in the bounding volume hierarchy
+		for ( auto& object : m_objects )
+		{
+			object.RefitIfMoved();
+
+			// The cached shadows of static objects are out of date once one moves
+			if ( object.IsStatic() && object.HasMoved() ) *p_staticMoved = true;
+		}
 	}
 
-	void CreateDepthResources()
+	void CreateRenderGraph()
 	{
-		// Find a suitable depth format
-		VkFormat depthFormat = FindDepthFormat( m_physicalDevice );
+		// Create the scene target at the swapchain's size, and the upscale pass's framebuffers
+		m_resolution.CreateTargets( m_physicalDevice, m_swapchainImageFormat, m_swapchainExtent, m_swapchainImageViews );
+
+		// The sun's shadow cascades, left ready for the scene to sample
+		RenderGraphResource shadowMap = m_renderGraph.ImportImage( "shadow map", m_shadows.GetImage(), m_shadows.GetImageView(), m_shadows.GetSubresourceRange(), ResourceUsage::DEPTH_SAMPLED, ResourceUsage::DEPTH_SAMPLED );
+
+		// The other resources that live between frames (The acquired swapchain image and the vertex buffer are set each frame)
+		VkImageSubresourceRange colourRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
 
-		// Initialise an Image object using the correct parameters
-		m_depthImage.Init( m_logicalDevice, m_physicalDevice, m_swapchainExtent.width, m_swapchainExtent.height, 1, m_msaaSampleCount, depthFormat, VK_IMAGE_TILING_OPTIMAL,
-						   VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-						   VK_IMAGE_ASPECT_DEPTH_BIT );
+		m_sceneTargetResource = m_renderGraph.ImportImage( "scene target", m_resolution.GetSceneImage(), m_resolution.GetSceneImageView(), colourRange, ResourceUsage::SAMPLED, ResourceUsage::SAMPLED );
+		m_swapchainResource	  = m_renderGraph.ImportImage( "swapchain image", VK_NULL_HANDLE, VK_NULL_HANDLE, colourRange, ResourceUsage::COLOUR_ATTACHMENT, ResourceUsage::PRESENT );
+		m_vertexResource	  = m_renderGraph.ImportBuffer( "vertex buffer", VK_NULL_HANDLE, ResourceUsage::VERTEX_INPUT, ResourceUsage::VERTEX_INPUT );
+		m_renderGraph.MarkOutput( m_swapchainResource );
 
-		m_depthImage.TransitionLayout( m_commandPool, m_graphicsQueue, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL );
+		// The attachments only live within the scene pass (The deferred path renders into its G-buffer instead of a multisampled target)
+		m_depthResource = m_renderGraph.CreateImage( "depth", { FindDepthFormat( m_physicalDevice ), m_swapchainExtent, m_msaaSampleCount, VK_IMAGE_ASPECT_DEPTH_BIT } );
+		if ( m_renderPath == RenderPath::DEFERRED )
+			m_gBuffer.Declare( &m_renderGraph, m_swapchainExtent );
+		else
+			m_colourResource = m_renderGraph.CreateImage( "multisampled colour", { m_swapchainImageFormat, m_swapchainExtent, m_msaaSampleCount, VK_IMAGE_ASPECT_COLOR_BIT } );
+
+		// Copy the frame's vertices
+		uint32_t vertexPass = m_renderGraph.AddPass( "vertices", [this]( const VkCommandBuffer& p_commandBuffer ) { RecordVertexUpload( p_commandBuffer ); } );
+		m_renderGraph.Write( vertexPass, m_vertexResource, ResourceUsage::TRANSFER_DST );
+
+		// Render the sun's shadow cascades (Culled when the scene doesn't sample them)
+		uint32_t shadowPass = m_renderGraph.AddPass( "shadows", [this]( const VkCommandBuffer& p_commandBuffer ) { RecordShadows( p_commandBuffer ); } );
+		m_renderGraph.Read( shadowPass, m_vertexResource, ResourceUsage::VERTEX_INPUT );
+		m_renderGraph.Write( shadowPass, shadowMap, ResourceUsage::TRANSFER_DST, ResourceUsage::DEPTH_ATTACHMENT, false ); // Cascades without dynamic casters keep last frame's layer
+
+		// Render the scene into the scene target (Everything it draws into is cleared or overwritten)
+		uint32_t scenePass = m_renderGraph.AddPass( "scene", [this]( const VkCommandBuffer& p_commandBuffer ) { RecordScene( p_commandBuffer ); } );
+		m_renderGraph.Read( scenePass, m_vertexResource, ResourceUsage::VERTEX_INPUT );
+		if ( m_shadowsEnabled ) m_renderGraph.Read( scenePass, shadowMap, ResourceUsage::DEPTH_SAMPLED );
+		m_renderGraph.Write( scenePass, m_depthResource, ResourceUsage::DEPTH_ATTACHMENT, true );
+		m_renderGraph.Write( scenePass, m_sceneTargetResource, ResourceUsage::COLOUR_ATTACHMENT, true );
+		if ( m_renderPath == RenderPath::DEFERRED )
+			for ( uint32_t i = 0; i < GBUFFER_ATTACHMENT_COUNT; i++ )
+				m_renderGraph.Write( scenePass, m_gBuffer.GetResource( i ), ResourceUsage::COLOUR_ATTACHMENT, true );
+		else
+			m_renderGraph.Write( scenePass, m_colourResource, ResourceUsage::COLOUR_ATTACHMENT, true );
+
+		// Upscale and sharpen the rendered region into the swapchain image
+		uint32_t upscalePass = m_renderGraph.AddPass( "upscale", [this]( const VkCommandBuffer& p_commandBuffer ) { m_resolution.RecordUpscale( p_commandBuffer, m_upscalePipeline, m_recordImageIndex, m_recordExtent ); } );
+		m_renderGraph.Read( upscalePass, m_sceneTargetResource, ResourceUsage::SAMPLED );
+		m_renderGraph.Write( upscalePass, m_swapchainResource, ResourceUsage::COLOUR_ATTACHMENT, true );
+
+		// Cull, place the barriers and create the transient attachments
+		m_renderGraph.Compile();
+		ReportRenderGraphStats();
 	}
 
 	void RecreateSwapchain()
@@ -1128,11 +1730,12 @@ private:
 
 		// Call the creation functions to recreate the swapchain and all dependencies of it
 		CreateSwapchain();
+		m_camera.SetAspectRatio( m_swapchainExtent.width / (float)m_swapchainExtent.height );
 		CreateImageViews();
 		CreateRenderPass();
-		CreateGraphicsPipeline(); // This can be avoided by using dynamic states for the scissor and viewport
-		CreateColourResources();
-		CreateDepthResources();
+		m_resolution.CreateRenderPass( m_swapchainImageFormat );
+		CreateGraphicsPipeline(); // Hands back the cached variants, only a changed render pass compiles new ones
+		CreateRenderGraph();
 		CreateFramebuffers();
 		CreateUniformBuffers();
 		CreateDescriptorPoolAndSets();
@@ -1142,13 +1745,32 @@ private:
 	void CreateLights()
 	{
 		m_pointLights.resize( 1 );
-		m_pointLights[0] = PointLight( { 1.0f, 1.0f, 1.0f }, { 1.0f, 4.0f, 2.0f } );
+		m_pointLights[0] = PointLight( { 1.0f, 1.0f, 1.0f }, { 1.0f, 4.0f, 2.0f }, 20.0f );
+
+		// Scatter extra small lights over a grid around the scene (For testing the clustering)
+		uint32_t extraLights = static_cast<uint32_t>( GetConfigFloat( "ENGINE_POINT_LIGHTS", 0.0f ) );
+		uint32_t side		 = static_cast<uint32_t>( std::ceil( std::sqrt( (float)extraLights ) ) );
+		for ( uint32_t i = 0; i < extraLights; i++ )
+		{
+			glm::vec3 position = { ( i % side ) / (float)side * 40.0f - 20.0f, 0.5f, ( i / side ) / (float)side * 40.0f - 20.0f };
+			glm::vec3 colour   = { ( i * 37 % 100 ) / 100.0f, ( i * 59 % 100 ) / 100.0f, ( i * 83 % 100 ) / 100.0f };
+			m_pointLights.push_back( PointLight( colour, position, 2.0f ) );
+		}
+
+		// The sun
+		m_dirLights = { DirLight( { 0.6f, 0.6f, 0.55f }, { -0.4f, -1.0f, -0.3f } ) };
 	}
 
 	void DrawFrame()
 	{
-		// Wait for the frame to be finished before accessing it again
-		vkWaitForFences( m_logicalDevice, 1, &m_inFlightFences[m_currentFrame], VK_TRUE, (uint64_t)-1 );
+		// Wait for the GPU to finish the last frame that used this frame's command buffer, semaphores and uniform buffer
+		m_frameTimeline.Wait( GetReuseValue( m_frameNumber ) );
+
+		// Destroy anything the GPU has finished with
+		m_deletionQueue.Flush( m_frameTimeline.GetCompletedValue() );
+
+		// Hold the frame back if it is ahead of the frame rate limit
+		m_frameLimiter.Wait();
 
 		// Acquire the image from the swapchain (gets the index from the the swapchainImages array)
 		// And recreate the swapchain if it is out of date
@@ -1156,51 +1778,91 @@ private:
 		VkResult result = vkAcquireNextImageKHR( m_logicalDevice, m_swapchain, (uint64_t)-1, m_imageAvailableSemaphores[m_currentFrame], VK_NULL_HANDLE, &imageIndex );
 		if ( result == VK_ERROR_OUT_OF_DATE_KHR )
 		{
+			// The frame was simulated with the old extent and projection, so simulate it again once the swapchain is recreated
+			m_jobs.Wait( GetFramePacket( m_frameNumber ).ready );
 			RecreateSwapchain();
+			StartSimulation( m_frameNumber );
 			return;
 		}
 		else if ( !( result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR ) )
 			throw std::runtime_error( "Failed to acquire swapchain image" );
 
-		// Update the models
-		UpdateObjects();
+		// Wait for the simulation of this frame to finish
+		FramePacket& packet = GetFramePacket( m_frameNumber );
+		m_jobs.Wait( packet.ready );
 
-		// Update the vertex and index buffers
-		UpdateIndexAndVertexBuffer();
+		if ( m_justInTime )
+		{
+			// Sample the input as late as possible
+			glfwPollEvents();
+			ProcessInput();
 
-		// Update the uniform buffer
-		UpdateUniformBuffer( imageIndex );
+			// Use the latest camera for this frame (The vertices are in world space, the shaders take them into its view)
+			const VertexUniformBufferObject& mvp = m_camera.GetMVP();
+			packet.ubo.view						 = mvp.view;
+			packet.ubo.proj						 = mvp.proj;
 
-		// Wait on any frame that is using the assigned image
-		if ( m_inFlightImages[imageIndex] != VK_NULL_HANDLE ) // Is in use
-			vkWaitForFences( m_logicalDevice, 1, &m_inFlightImages[imageIndex], VK_TRUE, (uint64_t)-1 );
+			// Cull and sort the draws again, so objects the latest camera turned towards are drawn (Before the next frame's simulation starts moving them)
+			BuildDrawList( &packet, packet.ubo.view, packet.ubo.proj, packet.extent );
+		}
+
+		// Simulate the next frame while this one is recorded, submitted and rendered (From here on this frame only reads its packet)
+		StartSimulation( m_frameNumber + 1 );
+
+		// Render the cached shadows again if a static object moved
+		if ( packet.staticMoved )
+		{
+			m_shadows.InvalidateStatic();
+			packet.staticMoved = false;
+		}
+
+		// Sort the packet's lights into this frame's clusters, the fragments are shaded in its camera's view space
+		m_clusteredLighting.Build( static_cast<uint32_t>( m_currentFrame ), packet.pointLights, packet.ubo.view, packet.ubo.proj, packet.extent, CAMERA_NEAR, CAMERA_FAR, &m_jobs );
 
-		// Mark the image as being used by this frame
-		m_inFlightImages[imageIndex] = m_inFlightFences[m_currentFrame];
+		// Fit the shadow cascades to the frame's camera
+		m_shadows.Update( m_currentFrame, packet.ubo.view, packet.ubo.proj, CAMERA_NEAR, m_dirLights[0] );
 
-		// Which semaphores and stages to wait on before execution
-		VkSemaphore			 waitSemaphores[] = { m_imageAvailableSemaphores[m_currentFrame] };
-		VkPipelineStageFlags waitStages[]	  = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+		// Record the frame's vertex copy and draw, and update its uniform buffer
+		RecordCommandBuffer( m_commandBuffers[m_currentFrame], imageIndex, packet );
+		UpdateUniformBuffer( m_currentFrame, packet.ubo );
 
-		// Specify the signal semaphores
-		VkSemaphore signalSemaphores[] = { m_renderFinishedSemaphores[m_currentFrame] }; // Semaphores to signal when the execution ends
+		// Which semaphores and stages to wait on before execution (The frame's texture uploads only hold back the fragment shaders that sample them, a value of 0 when there were none)
+		VkSemaphore			 waitSemaphores[] = { m_imageAvailableSemaphores[m_currentFrame], m_textureStreaming.GetUploadSemaphore() };
+		VkPipelineStageFlags waitStages[]	  = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT };
+		uint64_t			 waitValues[]	  = { 0, m_textureStreaming.GetUploadValue( static_cast<uint32_t>( m_currentFrame ) ) }; // The first is ignored, it is a binary semaphore
+
+		// Specify the signal semaphores, the timeline is signalled with this frame's value
+		VkSemaphore signalSemaphores[] = { m_renderFinishedSemaphores[m_currentFrame], m_frameTimeline.GetSemaphore() }; // Semaphores to signal when the execution ends
+		uint64_t	signalValues[]	   = { 0, m_frameNumber + 1 };
+
+		// Setup the timeline values
+		VkTimelineSemaphoreSubmitInfoKHR timelineSubmitInfo {};
+		timelineSubmitInfo.sType					 = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+		timelineSubmitInfo.waitSemaphoreValueCount	 = 2;
+		timelineSubmitInfo.pWaitSemaphoreValues		 = waitValues;
+		timelineSubmitInfo.signalSemaphoreValueCount = 2;
+		timelineSubmitInfo.pSignalSemaphoreValues	 = signalValues;
 
 		// Submit the command buffer
 		VkSubmitInfo submitInfo {};
 		submitInfo.sType				= VK_STRUCTURE_TYPE_SUBMIT_INFO;
-		submitInfo.waitSemaphoreCount	= 1;
+		submitInfo.pNext				= &timelineSubmitInfo;
+		submitInfo.waitSemaphoreCount	= 2;
 		submitInfo.pWaitSemaphores		= waitSemaphores;
 		submitInfo.pWaitDstStageMask	= waitStages;
 		submitInfo.commandBufferCount	= 1;
-		submitInfo.pCommandBuffers		= &m_commandBuffers[imageIndex];
-		submitInfo.signalSemaphoreCount = 1;
+		submitInfo.pCommandBuffers		= &m_commandBuffers[m_currentFrame];
+		submitInfo.signalSemaphoreCount = 2;
 		submitInfo.pSignalSemaphores	= signalSemaphores;
 
-		// Reset fence to an unsignaled state
-		vkResetFences( m_logicalDevice, 1, &m_inFlightFences[m_currentFrame] );
+		// Measure how long ago the input used by this frame was sampled
+		RecordLatency( std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - m_inputSampleTime ).count() );
+
+		// Log the device memory use every interval, and warn about heaps nearing their budget
+		ReportMemoryUsage();
 
 		// Submit the command buffer to the queue
-		if ( vkQueueSubmit( m_graphicsQueue, 1, &submitInfo, m_inFlightFences[m_currentFrame] ) != VK_SUCCESS )
+		if ( vkQueueSubmit( m_graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE ) != VK_SUCCESS )
 			throw std::runtime_error( "Failed to submit draw command buffer" );
 
 		// Specify the swapchain
@@ -1210,28 +1872,49 @@ private:
 		VkPresentInfoKHR presentInfo {};
 		presentInfo.sType			   = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
 		presentInfo.waitSemaphoreCount = 1;
-		presentInfo.pWaitSemaphores	   = signalSemaphores;
+		presentInfo.pWaitSemaphores	   = &m_renderFinishedSemaphores[m_currentFrame];
 		presentInfo.swapchainCount	   = 1;
 		presentInfo.pSwapchains		   = swapchains;
 		presentInfo.pImageIndices	   = &imageIndex;
 		presentInfo.pResults		   = nullptr;
 
-		// Give the present image to the swapchain and recreate swapchain if it is out of date
+		// Give the present image to the swapchain
 		result = vkQueuePresentKHR( m_presentQueue, &presentInfo );
-		if ( result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || m_framebufferResized )
+
+		// Increment the frames (Which of the in flight frames are being rendered), the next frame's packet is already being simulated
+		m_frameNumber++;
+		m_currentFrame = ( m_currentFrame + 1 ) % MAX_FRAMES_IN_FLIGHT;
+
+		// Recreate swapchain if it is out of date, or the quality preset or depth pre-pass was changed (Everything they change is recreated with it)
+		bool qualityChanged = m_requestedPreset != m_qualityPreset;
+		bool prepassChanged = m_requestedPrepass != m_depthPrepass;
+		if ( result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || m_framebufferResized || qualityChanged || prepassChanged )
 		{
+			// Let the next frame's simulation finish first, it reads the resolution and textures that are about to change
+			m_jobs.Wait( GetFramePacket( m_frameNumber ).ready );
+
+			// Switch to the requested quality preset
+			if ( qualityChanged )
+				SetQualityPreset( m_requestedPreset );
+
+			// Turn the depth pre-pass on or off (It changes the render pass)
+			if ( prepassChanged )
+			{
+				m_depthPrepass = m_requestedPrepass;
+				std::cout << "Depth pre-pass: " << ( m_depthPrepass ? "on" : "off" ) << std::endl;
+			}
+
 			m_framebufferResized = false;
 			RecreateSwapchain();
-			return;
+
+			// Simulate the next frame again, it took the old extent and projection
+			StartSimulation( m_frameNumber );
 		}
 		else if ( result != VK_SUCCESS )
 			throw std::runtime_error( "Failed to present swapchain image" );
-
-		// Increment the frames (Which of the in flight frames are being rendered)
-		m_currentFrame = ( m_currentFrame + 1 ) % MAX_FRAMES_IN_FLIGHT;
 	}
 
-	void UpdateUniformBuffer( const uint32_t& currentImage )
+	void ProcessInput()
 	{
 		// std::cout << ( 1 / deltaT ) << std::endl;
 
@@ -1240,14 +1923,237 @@ private:
 
 		// glfwSetWindowTitle( m_window, ss.str().c_str() );
 
-		// Process the inputs
+		// F1 to F4 pick the low, medium, high or custom quality preset
+		for ( uint32_t i = 0; i < QUALITY_PRESET_COUNT; i++ )
+			if ( KeyboardHandler::WasReleased( GLFW_KEY_F1 + i ) )
+				m_requestedPreset = static_cast<QualityPreset>( i );
+
+		// F5 turns the depth pre-pass on or off (Forward path only)
+		if ( KeyboardHandler::WasReleased( GLFW_KEY_F5 ) && m_renderPath == RenderPath::FORWARD ) m_requestedPrepass = !m_requestedPrepass;
+
+		// Process the inputs (Only the camera is touched, which the simulation job takes a copy of)
 		ProcessCallbacks( &m_camera );
 		KeyboardHandler::ProcessInput( m_window, &m_camera, deltaT );
 
-		VertexUniformBufferObject vertUBO = m_camera.GetMVP();
-		vertUBO.lightColour				  = m_pointLights[0].GetCol();
-		vertUBO.lightPosition			  = m_pointLights[0].GetPos();
+		// Remember when the input was sampled
+		m_inputSampleTime = std::chrono::steady_clock::now();
+	}
 
+	void RecordLatency( const double& p_latency )
+	{
+		m_latencyTotal += p_latency;
+		m_latencySamples++;
+
+		// Report the average every interval
+		if ( timeElapsed - m_latencyReportTime < LATENCY_REPORT_INTERVAL ) return;
+
+		std::cout << "Input to submit latency: " << m_latencyTotal / m_latencySamples << "ms (Average of " << m_latencySamples << " frames)" << std::endl;
+
+		m_latencyTotal		= 0.0;
+		m_latencySamples	= 0;
+		m_latencyReportTime = timeElapsed;
+	}
+
+	void ReportMemoryUsage()
+	{
+		if ( timeElapsed - m_memoryReportTime < MEMORY_REPORT_INTERVAL ) return;
+		m_memoryReportTime = timeElapsed;
+
+		// Read the driver's budget, then copy the counts
+		MemoryTracker& tracker = GetMemoryTracker();
+		tracker.QueryBudget();
+		std::vector<MemoryHeapStats>				 heaps = tracker.GetHeaps();
+		std::array<MemoryTagStats, MEMORY_TAG_COUNT> tags  = tracker.GetTags();
+		const double								 mb	   = 1024.0 * 1024.0;
+
+		// One line for the heaps, and one for what the engine's allocations are for
+		std::cout << "Memory heaps" << ( tracker.IsBudgetSupported() ? "" : " (No budget extension, budget is the heap size)" ) << ":";
+		for ( uint32_t i = 0; i < heaps.size(); i++ )
+			std::cout << " " << i << ( heaps[i].deviceLocal ? " device local " : " host " ) << heaps[i].usage / mb << "/" << heaps[i].budget / mb << "MB (Engine " << heaps[i].bytes / mb << "MB in " << heaps[i].allocations << ")";
+		std::cout << std::endl;
+
+		std::cout << "Memory tags:";
+		for ( uint32_t i = 0; i < MEMORY_TAG_COUNT; i++ )
+			if ( tags[i].allocations > 0 ) std::cout << " " << MEMORY_TAG_NAMES[i] << " " << tags[i].bytes / mb << "MB in " << tags[i].allocations;
+		std::cout << std::endl;
+
+		for ( uint32_t i = 0; i < heaps.size(); i++ )
+			if ( heaps[i].IsNearBudget() )
+				std::cerr << "Memory heap " << i << " is at " << 100.0 * heaps[i].usage / heaps[i].budget << "% of its budget" << std::endl;
+	}
+
+	void ReportMemoryStats()
+	{
+		std::vector<MemoryHeapStats>				 heaps = GetMemoryTracker().GetHeaps();
+		std::array<MemoryTagStats, MEMORY_TAG_COUNT> tags  = GetMemoryTracker().GetTags();
+		const double								 mb	   = 1024.0 * 1024.0;
+
+		// The peaks, and anything that was never freed
+		std::cout << "Memory peaks:";
+		for ( uint32_t i = 0; i < heaps.size(); i++ )
+			if ( heaps[i].peakBytes > 0 ) std::cout << " heap " << i << " " << heaps[i].peakBytes / mb << "MB";
+		for ( uint32_t i = 0; i < MEMORY_TAG_COUNT; i++ )
+			if ( tags[i].allocated > 0 ) std::cout << ", " << MEMORY_TAG_NAMES[i] << " " << tags[i].peakBytes / mb << "MB (" << tags[i].allocated << " allocations, " << tags[i].allocations << " not freed)";
+		std::cout << std::endl;
+	}
+
+	void ReportPipelineStats()
+	{
+		PipelineCompileStats stats = m_pipelineCache.GetStats();
+
+		std::cout << "Pipelines: " << stats.compiled << " compiled (" << stats.failed << " failed) in " << stats.totalMilliseconds << "ms, slowest " << stats.maxMilliseconds << "ms, "
+				  << stats.hits << " cache hits, fallback drawn for " << m_fallbackFrames << " frames" << std::endl;
+	}
+
+	void ReportLightingStats()
+	{
+		const ClusteredLightingStats& stats = m_clusteredLighting.GetStats();
+
+		std::cout << "Clustered lighting: " << m_pointLights.size() << " point lights, up to " << stats.peakClusterLights << " in one cluster (The shader reads " << CLUSTER_MAX_LIGHTS_PER_CLUSTER << "), "
+				  << stats.peakLightIndices << " of " << CLUSTER_MAX_LIGHT_INDICES << " light indices used" << std::endl;
+		if ( stats.droppedLights > 0 )
+			std::cerr << "Clustered lighting dropped " << stats.droppedLights << " cluster lights over " << stats.overflowingFrames << " of " << stats.frames << " frames" << std::endl;
+	}
+
+	void ReportShadowStats()
+	{
+		std::cout << "Shadows: static casters redrawn for " << m_shadows.GetStaticRenders() << " cascades and " << m_shadows.GetLayerCopies() << " cached cascades copied over " << m_shadows.GetFrameCount() << " frames ("
+				  << SHADOW_CASCADE_COUNT << " cascades per frame)" << std::endl;
+	}
+
+	VkSampleCountFlagBits GetSceneSampleCount() const
+	{
+		// The deferred path reads its G-buffer per pixel, so it isn't multisampled
+		return m_renderPath == RenderPath::DEFERRED ? VK_SAMPLE_COUNT_1_BIT : GetUsableSampleCount( m_physicalDeviceProperties, m_quality.msaaSamples );
+	}
+
+	void ApplyTextureQuality()
+	{
+		// Anisotropy can't be below one or above the device's limit
+		float anisotropy = std::clamp( m_quality.anisotropy, 1.0f, m_physicalDeviceProperties.limits.maxSamplerAnisotropy );
+
+		// Replace every texture's sampler (The descriptor sets must be updated after)
+		m_materials.RecreateSamplers( anisotropy, m_quality.lodBias );
+	}
+
+	void SetQualityPreset( const QualityPreset& p_preset )
+	{
+		// Report what the old preset cost
+		ReportQualityCost( m_qualityPreset );
+
+		m_qualityPreset = p_preset;
+		m_quality		= GetQualitySettings( p_preset );
+
+		std::cout << "Quality: " << QUALITY_PRESET_NAMES[static_cast<uint32_t>( p_preset )] << " (" << m_quality.msaaSamples << "x MSAA, " << m_quality.sampleShading << " sample shading, "
+				  << m_quality.anisotropy << "x anisotropy, " << m_quality.lodBias << " LOD bias, " << m_quality.resolutionScale << " resolution scale)" << std::endl;
+
+		// The sample count is built into the render pass and the pipelines, which the caller recreates with the swapchain
+		m_msaaSampleCount = GetSceneSampleCount();
+		m_resolution.SetMaxScale( m_quality.resolutionScale );
+
+		// Wait for the GPU to finish with the old samplers
+		vkDeviceWaitIdle( m_logicalDevice );
+		ApplyTextureQuality();
+	}
+
+	void ReportQualityCost( const QualityPreset& p_preset )
+	{
+		const QualityCost& cost = m_qualityCosts[static_cast<uint32_t>( p_preset )];
+		if ( cost.frames == 0 ) return;
+
+		std::cout << "Quality " << QUALITY_PRESET_NAMES[static_cast<uint32_t>( p_preset )] << ": GPU frame time " << cost.totalMilliseconds / cost.frames << "ms (Average of " << cost.frames << " frames)" << std::endl;
+	}
+
+	void ReportOverdrawStats()
+	{
+		// Compare the shading with and without the depth pre-pass
+		for ( bool prepass : { false, true } )
+		{
+			const OverdrawStats& stats = m_overdraw.GetStats( prepass );
+			if ( stats.timedFrames == 0 && stats.countedFrames == 0 ) continue;
+
+			std::cout << "Depth pre-pass " << ( prepass ? "on" : "off" ) << ": ";
+			if ( stats.countedFrames > 0 && stats.pixels > 0 )
+				std::cout << static_cast<double>( stats.fragmentInvocations ) / stats.pixels << " fragments shaded per pixel, " << stats.vertexInvocations / stats.countedFrames << " shading vertices per frame, ";
+			else
+				std::cout << "no pipeline statistics, ";
+			std::cout << "GPU frame time " << ( stats.timedFrames > 0 ? stats.gpuMilliseconds / stats.timedFrames : 0.0 ) << "ms (Average of " << stats.timedFrames << " frames)" << std::endl;
+		}
+	}
+
+	void ReportMaterialStats()
+	{
+		std::cout << "Materials: " << m_materials.GetMaterialCount() << " materials sharing " << m_materials.GetTextureCount() << " textures, " << m_materials.GetUploads() << " entries uploaded" << std::endl;
+	}
+
+	void ReportTextureStreamingStats()
+	{
+		const TextureStreamingStats& stats = m_textureStreaming.GetStats();
+		const double				 mb	   = 1024.0 * 1024.0;
+
+		std::cout << "Texture streaming: " << stats.uploads << " levels uploaded (" << stats.uploadedBytes / mb << "MB copied with the levels below them), " << stats.evictions << " evicted, " << stats.residentBytes / mb << "MB resident (peak "
+				  << stats.peakResidentBytes / mb << "MB) of a " << m_textureStreaming.GetBudget() / mb << "MB budget, starved for " << stats.starvedFrames << " frames" << std::endl;
+	}
+
+	void ReportDescriptorStats()
+	{
+		const DescriptorLayoutCacheStats& layouts = m_objectCache.GetDescriptorLayouts()->GetStats();
+		const DescriptorAllocatorStats&	  sets	  = m_descriptorCollection.GetStats();
+		const DescriptorUpdateStats&	  updates = m_descriptorCollection.GetUpdateStats();
+
+		std::cout << "Descriptors: " << layouts.layouts << " layouts (" << layouts.hits << " of " << layouts.requests << " requests cached), " << sets.allocations << " sets in " << sets.pools << " pools over "
+				  << sets.resets << " resets, peak " << sets.peakSets << " of " << sets.peakCapacity << " sets used" << std::endl;
+		std::cout << "Descriptor updates: " << updates.templateUpdates << " sets written by template, " << updates.bindingWrites << " bindings rewritten in " << updates.batchedCalls << " batched calls, "
+				  << updates.skippedBindings << " unchanged bindings skipped" << std::endl;
+	}
+
+	void ReportObjectCacheStats()
+	{
+		const ObjectCacheStats& stats = m_objectCache.GetStats();
+
+		std::cout << "Object cache: " << stats.samplers.objects << " samplers (" << stats.samplers.hits << " of " << stats.samplers.requests << " requests shared, the device allows "
+				  << m_physicalDeviceProperties.limits.maxSamplerAllocationCount << "), " << stats.pipelineLayouts.objects << " pipeline layouts (" << stats.pipelineLayouts.hits << " of "
+				  << stats.pipelineLayouts.requests << " shared), " << stats.renderPasses.objects << " render passes (" << stats.renderPasses.hits << " of " << stats.renderPasses.requests << " shared)" << std::endl;
+	}
+
+	void ReportDrawListStats()
+	{
+		// Total the stats of every packet's list
+		DrawListStats stats;
+		for ( const auto& packet : m_framePackets )
+		{
+			const DrawListStats& packetStats = packet.drawList.GetStats();
+			stats.frames += packetStats.frames;
+			stats.draws += packetStats.draws;
+			stats.pipelineBinds += packetStats.pipelineBinds;
+			stats.skippedPipelineBinds += packetStats.skippedPipelineBinds;
+			stats.pipelineChanges += packetStats.pipelineChanges;
+			stats.unsortedPipelineChanges += packetStats.unsortedPipelineChanges;
+			stats.materialChanges += packetStats.materialChanges;
+			stats.unsortedMaterialChanges += packetStats.unsortedMaterialChanges;
+		}
+
+		std::cout << "Draw sorting: " << stats.draws << " draws over " << stats.frames << " frames, " << stats.pipelineBinds << " pipeline binds (" << stats.skippedPipelineBinds << " skipped), "
+				  << stats.pipelineChanges << " pipeline changes sorted against " << stats.unsortedPipelineChanges << " unsorted, " << stats.materialChanges << " material changes sorted against "
+				  << stats.unsortedMaterialChanges << " unsorted" << std::endl;
+	}
+
+	void ReportRenderGraphStats()
+	{
+		const RenderGraphStats& stats = m_renderGraph.GetStats();
+
+		std::cout << "Render graph: " << stats.passes - stats.culledPasses << " passes (" << stats.culledPasses << " culled), " << stats.barriers << " barriers per frame, " << stats.transientImages
+				  << " transient images in " << stats.allocations << " allocations (" << stats.allocatedBytes / 1024 << "KiB, " << stats.requestedBytes / 1024 << "KiB unaliased)" << std::endl;
+	}
+
+	void ReportResolutionStats()
+	{
+		std::cout << "Resolution: scale " << m_resolution.GetScale() << " (Lowest " << m_resolution.GetLowestScale() << "), GPU frame time " << m_resolution.GetGpuMilliseconds() << "ms against a budget of "
+				  << m_resolution.GetBudget() << "ms" << std::endl;
+	}
+
+	void UpdateUniformBuffer( const uint32_t& currentImage, const VertexUniformBufferObject& vertUBO )
+	{
 		// Copy the data into the uniform buffer
 		void* mappedMemPtr;
 		vkMapMemory( m_logicalDevice, m_vertexUniformBufferObjectMemory[currentImage], 0, sizeof( vertUBO ), 0, &mappedMemPtr );
@@ -1262,6 +2168,9 @@ private:
 
 	void MainLoop()
 	{
+		// Simulate the first frame
+		StartSimulation( m_frameNumber );
+
 		while ( !glfwWindowShouldClose( m_window ) ) // Loop until the window is supposed to close
 		{
 			// Process time
@@ -1272,39 +2181,40 @@ private:
 			// Increment time elapsed and frame count
 			timeElapsed += deltaT;
 
-			glfwPollEvents(); // Check for events and then call the correct callback
+			// In just in time mode the input is sampled by DrawFrame instead
+			if ( !m_justInTime )
+			{
+				glfwPollEvents(); // Check for events and then call the correct callback
+
+				// Process the inputs on this thread
+				ProcessInput();
+			}
 
 			// Draw the frame
 			DrawFrame();
 		}
 
+		// Wait for any simulation that is still running
+		for ( auto& packet : m_framePackets )
+			m_jobs.Wait( packet.ready );
+
 		// Wait until the logical device has finished all operations
 		vkDeviceWaitIdle( m_logicalDevice );
 	}
 
 	void CleanupSwapchain()
 	{
-		// Destroy the depth buffer image
-		m_depthImage.Cleanup();
-
-		// Destroy the colour buffer image
-		m_colourImage.Cleanup();
+		// Destroy the render graph's attachments, and forget its passes
+		m_renderGraph.Cleanup();
 
-		// Destroy the framebuffers
-		for ( const auto& framebuffer : m_swapchainFramebuffers )
-			vkDestroyFramebuffer( m_logicalDevice, framebuffer, nullptr );
+		// Destroy the framebuffer, then the scene target and the upscale pass
+		vkDestroyFramebuffer( m_logicalDevice, m_sceneFramebuffer, nullptr );
+		m_resolution.CleanupSwapchain();
 
 		// Destroy the command buffers (As opposed to destroying the command pool)
 		vkFreeCommandBuffers( m_logicalDevice, m_commandPool, static_cast<uint32_t>( m_commandBuffers.size() ), m_commandBuffers.data() );
 
-		// Destroy the graphics pipeline
-		vkDestroyPipeline( m_logicalDevice, m_graphicsPipeline, nullptr );
-
-		// Destroy the pipeline layout
-		vkDestroyPipelineLayout( m_logicalDevice, m_pipelineLayout, nullptr );
-
-		// Destroy the render pass
-		vkDestroyRenderPass( m_logicalDevice, m_renderPass, nullptr );
+		// The pipeline layout and the render pass belong to the object cache, which hands them back when they are asked for again (So the pipeline cache keeps every variant made with them)
 
 		// Destroy the image views
 		for ( const auto& imageView : m_swapchainImageViews )
@@ -1314,13 +2224,13 @@ private:
 		vkDestroySwapchainKHR( m_logicalDevice, m_swapchain, nullptr );
 
 		// Destroy the uniform buffers and free the memory
-		for ( size_t i = 0; i < m_swapchainImages.size(); i++ )
+		for ( size_t i = 0; i < m_vertexUniformBufferObjects.size(); i++ )
 		{
 			vkDestroyBuffer( m_logicalDevice, m_vertexUniformBufferObjects[i], nullptr );
-			vkFreeMemory( m_logicalDevice, m_vertexUniformBufferObjectMemory[i], nullptr );
+			FreeDeviceMemory( m_logicalDevice, m_vertexUniformBufferObjectMemory[i] );
 
 			// vkDestroyBuffer( m_logicalDevice, m_fragmentUniformBufferObjects[i], nullptr );
-			// vkFreeMemory( m_logicalDevice, m_fragmentUniformBufferObjectMemory[i], nullptr );
+			// FreeDeviceMemory( m_logicalDevice, m_fragmentUniformBufferObjectMemory[i] );
 		}
 
 		// Destroy the descriptor pool
@@ -1339,27 +2249,78 @@ private:
 			object.Cleanup();
 		}
 
-		// Destroy the descriptor set layout
-		m_descriptorCollection.CleanupLayout();
+		// Report how the textures were streamed, then destroy the staging buffers
+		ReportTextureStreamingStats();
+		m_textureStreaming.Cleanup();
+
+		// Report how often the materials were uploaded, then destroy them and their textures
+		ReportMaterialStats();
+		m_materials.Cleanup();
+
+		// Clear the bounding volume hierarchy and the transforms
+		m_objectTree.Clear();
+		m_transforms.Clear();
+
+		// Report how the descriptor pools were used, then destroy them
+		ReportDescriptorStats();
+		m_descriptorCollection.Cleanup();
+
+		// Report the pipeline compile times, then destroy the pipeline cache and the shader modules (Saving them for the next run)
+		ReportPipelineStats();
+		m_pipelineCache.Cleanup();
 
 		// Destroy the vertex buffer and free its memory
 		vkDestroyBuffer( m_logicalDevice, m_vertexBuffer, nullptr );
-		vkFreeMemory( m_logicalDevice, m_vertexBufferMemory, nullptr );
+		FreeDeviceMemory( m_logicalDevice, m_vertexBufferMemory );
 
 		// Destroy the index buffer an free its memory
 		vkDestroyBuffer( m_logicalDevice, m_indexBuffer, nullptr );
-		vkFreeMemory( m_logicalDevice, m_indexBufferMemory, nullptr );
+		FreeDeviceMemory( m_logicalDevice, m_indexBufferMemory );
+
+		// Report how full the light clusters got, then destroy them and the frame packets
+		ReportLightingStats();
+		for ( auto& packet : m_framePackets )
+			packet.Cleanup();
+		m_clusteredLighting.Cleanup();
+
+		// Report how often the cached shadows were redrawn, then destroy the cascades
+		ReportShadowStats();
+		m_shadows.Cleanup();
+
+		// Report the overdraw, then destroy its counters
+		ReportOverdrawStats();
+		m_overdraw.Cleanup();
+
+		// Report the state changes the draw sorting saved
+		ReportDrawListStats();
+
+		// Report how far the resolution was scaled and what each quality preset cost, then destroy the timestamps and the upscale layout
+		ReportResolutionStats();
+		for ( uint32_t i = 0; i < QUALITY_PRESET_COUNT; i++ )
+			ReportQualityCost( static_cast<QualityPreset>( i ) );
+		m_resolution.Cleanup();
+
+		// Report how many objects the cache shared, then destroy them (Everything using them has been destroyed)
+		ReportObjectCacheStats();
+		m_objectCache.Cleanup();
 
 		// Destroy the syncronisation objects for all frames
 		for ( size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
 		{
 			vkDestroySemaphore( m_logicalDevice, m_imageAvailableSemaphores[i], nullptr );
 			vkDestroySemaphore( m_logicalDevice, m_renderFinishedSemaphores[i], nullptr );
-			vkDestroyFence( m_logicalDevice, m_inFlightFences[i], nullptr );
 		}
 
-		// Destroy the command pool
+		// Destroy the frame timeline, and anything still waiting to be deleted (The device is idle)
+		m_frameTimeline.Cleanup();
+		m_deletionQueue.FlushAll();
+
+		// Report the peak memory use, and any allocation that was never freed
+		ReportMemoryStats();
+
+		// Destroy the command pools
 		vkDestroyCommandPool( m_logicalDevice, m_commandPool, nullptr );
+		vkDestroyCommandPool( m_logicalDevice, m_transferCommandPool, nullptr );
 
 		// Destroy the logical device
 		vkDestroyDevice( m_logicalDevice, nullptr );
@@ -1380,10 +2341,32 @@ private:
 	}
 
 public:
+	void ParseArguments( const int& argc, char** argv )
+	{
+		for ( int i = 1; i < argc; i++ )
+		{
+			std::string argument = argv[i];
+
+			// --device <name or uuid> forces the GPU to use
+			if ( argument == "--device" && i + 1 < argc )
+				m_deviceOverride = argv[++i];
+			else if ( argument.rfind( "--device=", 0 ) == 0 )
+				m_deviceOverride = argument.substr( 9 );
+			else
+				throw std::runtime_error( "Unknown argument \"" + argument + "\" (Usage: --device <name or uuid>)" );
+		}
+	}
+
 	void Run()
 	{
 		std::cout << "Starting Application" << std::endl;
 
+		// Start the job system
+		m_jobs.Init( JOB_WORKER_COUNT, JOB_PIN_WORKERS );
+
+		// Read the frame pacing settings
+		LoadFrameSettings();
+
 		// Initialise variables
 		InitWindow();
 		InitVulkan();
@@ -1392,5 +2375,8 @@ public:
 
 		// Destruct variables
 		Cleanup();
+
+		// Stop the job system
+		m_jobs.Cleanup();
 	}
-};
+};
\ No newline at end of file
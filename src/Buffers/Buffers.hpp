@@ -1,4 +1,5 @@
 #pragma once
+#include "../VulkanUtil/MemoryTracker.hpp"
 #include "CommandBuffer.hpp"
 
 #define GLFW_INCLUDE_VULKAN
@@ -46,8 +47,8 @@ static void CreateBuffer( const VkDevice& p_logicalDevice, const VkPhysicalDevic
 	bufferAllocInfo.allocationSize	= memRequirements.size;
 	bufferAllocInfo.memoryTypeIndex = FindMemoryType( p_physicalDevice, memRequirements.memoryTypeBits, p_properties ); // Find a memory type with the correct properties
 
-	// Allocate the memory of the buffer
-	if ( vkAllocateMemory( p_logicalDevice, &bufferAllocInfo, nullptr, p_bufferMemory ) != VK_SUCCESS )
+	// Allocate the memory of the buffer (Counted under what its usage says it is for)
+	if ( AllocateDeviceMemory( p_logicalDevice, bufferAllocInfo, GetBufferMemoryTag( p_usage ), p_bufferMemory ) != VK_SUCCESS )
 		throw std::runtime_error( "Failed to allocate buffer memory" );
 
 	// Associate the memory with the buffer
@@ -72,7 +73,62 @@ static void CopyBuffer( const VkDevice& p_logicalDevice, const VkCommandPool& p_
 	EndSingleTimeCommands( p_logicalDevice, p_graphicsQueue, p_commandPool, commandBuffer );
 }
 
-static void UpdateBufferViaStagingBuffer( const VkDevice& p_logicalDevice, const VkPhysicalDevice& p_physicalDevice, const VkCommandPool& p_commandPool, const VkQueue& p_graphicsQueue, const VkDeviceSize& p_size, const void* p_data, VkBuffer* p_buffer )
+// The queues used to upload data, the transfer queue is the graphics queue when there is no dedicated one
+struct UploadQueues
+{
+	VkCommandPool transferCommandPool;
+	VkQueue		  transferQueue;
+	uint32_t	  transferFamily;
+	VkCommandPool graphicsCommandPool;
+	VkQueue		  graphicsQueue;
+	uint32_t	  graphicsFamily;
+};
+
+static void CopyBufferAcrossQueues( const VkDevice& p_logicalDevice, const UploadQueues& p_queues, const VkBuffer& srcBuffer, const VkBuffer& dstBuffer, const VkDeviceSize& p_size, const VkPipelineStageFlags& p_dstStage, const VkAccessFlags& p_dstAccess )
+{
+	// Without a dedicated transfer queue this is a normal copy
+	if ( p_queues.transferFamily == p_queues.graphicsFamily )
+	{
+		CopyBuffer( p_logicalDevice, p_queues.graphicsCommandPool, p_queues.graphicsQueue, srcBuffer, dstBuffer, p_size );
+		return;
+	}
+
+	// Setup the ownership transfer of the buffer from the transfer family to the graphics family
+	VkBufferMemoryBarrier barrier {};
+	barrier.sType				= VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	barrier.srcQueueFamilyIndex = p_queues.transferFamily;
+	barrier.dstQueueFamilyIndex = p_queues.graphicsFamily;
+	barrier.buffer				= dstBuffer;
+	barrier.offset				= 0;
+	barrier.size				= p_size;
+
+	// Copy on the transfer queue, and release the buffer
+	VkCommandBuffer commandBuffer = BeginSingleTimeCommands( p_logicalDevice, p_queues.transferCommandPool );
+
+	VkBufferCopy copyRegion {};
+	copyRegion.srcOffset = 0;
+	copyRegion.dstOffset = 0;
+	copyRegion.size		 = p_size;
+	vkCmdCopyBuffer( commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion );
+
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = 0; // Ignored for a release
+	vkCmdPipelineBarrier( commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr );
+
+	EndSingleTimeCommands( p_logicalDevice, p_queues.transferQueue, p_queues.transferCommandPool, commandBuffer );
+
+	// Acquire the buffer on the graphics queue (The transfer queue has already been waited on)
+	commandBuffer = BeginSingleTimeCommands( p_logicalDevice, p_queues.graphicsCommandPool );
+
+	barrier.srcAccessMask = 0; // Ignored for an acquire
+	barrier.dstAccessMask = p_dstAccess;
+	vkCmdPipelineBarrier( commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, p_dstStage, 0, 0, nullptr, 1, &barrier, 0, nullptr );
+
+	EndSingleTimeCommands( p_logicalDevice, p_queues.graphicsQueue, p_queues.graphicsCommandPool, commandBuffer );
+}
+
+template<typename Writer, typename Copier>
+static void FillViaStagingBuffer( const VkDevice& p_logicalDevice, const VkPhysicalDevice& p_physicalDevice, const VkDeviceSize& p_size, const Writer& p_writer, const Copier& p_copier )
 {
 	// Setup the staging buffer
 	VkBuffer	   stagingBuffer;
@@ -85,18 +141,39 @@ static void UpdateBufferViaStagingBuffer( const VkDevice& p_logicalDevice, const
 	void* mappedMemPtr;
 	vkMapMemory( p_logicalDevice, stagingBufferMemory, 0, p_size, 0, &mappedMemPtr );
 
-	// Copy the vertices into the memory address
-	std::memcpy( mappedMemPtr, p_data, (size_t)p_size );
+	// Let the writer fill the memory address directly
+	p_writer( mappedMemPtr );
 
 	// Remove the mapping to CPU accessible memory
 	vkUnmapMemory( p_logicalDevice, stagingBufferMemory );
 
 	// Copy the data from the staging buffer to the buffer
-	CopyBuffer( p_logicalDevice, p_commandPool, p_graphicsQueue, stagingBuffer, *p_buffer, p_size );
+	p_copier( stagingBuffer );
 
 	// Destroy the staging buffer and free it's memory
 	vkDestroyBuffer( p_logicalDevice, stagingBuffer, nullptr );
-	vkFreeMemory( p_logicalDevice, stagingBufferMemory, nullptr );
+	FreeDeviceMemory( p_logicalDevice, stagingBufferMemory );
+}
+
+template<typename Writer>
+static void UpdateBufferViaStagingWriter( const VkDevice& p_logicalDevice, const VkPhysicalDevice& p_physicalDevice, const VkCommandPool& p_commandPool, const VkQueue& p_graphicsQueue, const VkDeviceSize& p_size, const Writer& p_writer, VkBuffer* p_buffer )
+{
+	// Copy on the given queue
+	FillViaStagingBuffer( p_logicalDevice, p_physicalDevice, p_size, p_writer, [&]( const VkBuffer& p_stagingBuffer ) { CopyBuffer( p_logicalDevice, p_commandPool, p_graphicsQueue, p_stagingBuffer, *p_buffer, p_size ); } );
+}
+
+template<typename Writer>
+static void UploadBufferViaTransferQueue( const VkDevice& p_logicalDevice, const VkPhysicalDevice& p_physicalDevice, const UploadQueues& p_queues, const VkDeviceSize& p_size, const Writer& p_writer, VkBuffer* p_buffer, const VkPipelineStageFlags& p_dstStage, const VkAccessFlags& p_dstAccess )
+{
+	// Copy on the transfer queue and hand the buffer to the graphics queue
+	FillViaStagingBuffer( p_logicalDevice, p_physicalDevice, p_size, p_writer, [&]( const VkBuffer& p_stagingBuffer ) { CopyBufferAcrossQueues( p_logicalDevice, p_queues, p_stagingBuffer, *p_buffer, p_size, p_dstStage, p_dstAccess ); } );
+}
+
+static void UpdateBufferViaStagingBuffer( const VkDevice& p_logicalDevice, const VkPhysicalDevice& p_physicalDevice, const VkCommandPool& p_commandPool, const VkQueue& p_graphicsQueue, const VkDeviceSize& p_size, const void* p_data, VkBuffer* p_buffer )
+{
+	// Copy the data into the staging buffer
+	UpdateBufferViaStagingWriter(
+		p_logicalDevice, p_physicalDevice, p_commandPool, p_graphicsQueue, p_size, [&]( void* p_mapped ) { std::memcpy( p_mapped, p_data, (size_t)p_size ); }, p_buffer );
 }
 
 static void CreateBufferViaStagingBuffer( const VkDevice& p_logicalDevice, const VkPhysicalDevice& p_physicalDevice, const VkCommandPool& p_commandPool, const VkQueue& p_graphicsQueue, const VkDeviceSize& p_size, const void* p_data, const VkBufferUsageFlags& p_usage, const VkMemoryPropertyFlags& p_properties, VkBuffer* p_buffer, VkDeviceMemory* p_bufferMemory )
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "../Graphics/Bounds.hpp"
+#include "../Graphics/DrawList.hpp"
+#include "../Graphics/Light.hpp"
+#include "../Jobs/JobSystem.hpp"
+#include "Buffers.hpp"
+#include "UniformBuffers.hpp"
+#include "Vertex.hpp"
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+#include <stdexcept>
+#include <vector>
+
+// Everything the render thread needs to draw a frame, produced by the simulation job for that frame
+// Once the job is done the render thread only reads the packet (Besides resampling the camera just in time), so the next frame can be simulated while this one is recorded
+class FramePacket
+{
+private:
+	VkDevice m_logicalDevice;
+
+	// A persistently mapped staging buffer the simulation writes transformed vertices into
+	VkBuffer	   m_vertexStagingBuffer;
+	VkDeviceMemory m_vertexStagingMemory;
+	Vertex*		   m_mappedVertices;
+	size_t		   m_vertexCount;
+
+public:
+	VertexUniformBufferObject ubo;		   // Camera and light data for the frame
+	glm::mat4				  view;		   // Camera view the simulation was started with
+	VkExtent2D				  extent;	   // Swapchain size the simulation was started with
+	float					  deltaT;	   // Time step the simulation was started with
+	float					  timeElapsed; // Time the simulation was started at
+	uint64_t				  reuseValue;  // Frame timeline value at which the GPU has finished with the staging buffer
+	JobCounter				  ready;	   // Reaches zero once the simulation job has filled the packet
+
+	// What the simulation left the scene as, so the render thread never reads objects the next frame's simulation is moving
+	DrawList				drawList;		 // The scene's draws, culled and sorted for the packet's camera
+	std::vector<uint32_t>	textureRequests; // Finest level of each texture the draws asked for
+	std::vector<PointLight> pointLights;	 // Sorted into the clusters when the frame is recorded
+	std::vector<AABB>		dynamicBounds;	 // World bounds of the objects that aren't static (Their shadows are drawn every frame)
+	bool					staticMoved;	 // A static object moved, so the cached shadows are out of date
+
+	void Init( const VkDevice& p_logicalDevice, const VkPhysicalDevice& p_physicalDevice, const size_t& p_vertexCount )
+	{
+		m_logicalDevice = p_logicalDevice;
+		m_vertexCount	= p_vertexCount;
+		staticMoved		= false;
+
+		// Create the staging buffer
+		VkDeviceSize size = m_vertexCount * sizeof( Vertex );
+		CreateBuffer( m_logicalDevice, p_physicalDevice, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &m_vertexStagingBuffer, &m_vertexStagingMemory );
+
+		// Keep it mapped for the lifetime of the packet
+		void* mappedMemPtr;
+		if ( vkMapMemory( m_logicalDevice, m_vertexStagingMemory, 0, size, 0, &mappedMemPtr ) != VK_SUCCESS )
+			throw std::runtime_error( "Failed to map frame packet staging buffer" );
+		m_mappedVertices = static_cast<Vertex*>( mappedMemPtr );
+	}
+
+	inline Vertex*		   GetMappedVertices() { return m_mappedVertices; }
+	inline const VkBuffer& GetVertexStagingBuffer() const { return m_vertexStagingBuffer; }
+	inline VkDeviceSize	   GetVertexSize() const { return m_vertexCount * sizeof( Vertex ); }
+
+	void Cleanup()
+	{
+		// Unmap and destroy the staging buffer
+		vkUnmapMemory( m_logicalDevice, m_vertexStagingMemory );
+		vkDestroyBuffer( m_logicalDevice, m_vertexStagingBuffer, nullptr );
+		FreeDeviceMemory( m_logicalDevice, m_vertexStagingMemory );
+	}
+};
\ No newline at end of file
@@ -13,6 +13,4 @@ struct VertexUniformBufferObject
 	alignas( 16 ) glm::mat4 model;
 	alignas( 16 ) glm::mat4 view;
 	alignas( 16 ) glm::mat4 proj;
-	alignas( 16 ) glm::vec3 lightColour;
-	alignas( 16 ) glm::vec3 lightPosition;
 };
\ No newline at end of file
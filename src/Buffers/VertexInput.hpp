@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Vertex.hpp"
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+#include <cstddef>
+#include <vector>
+
+static VkVertexInputBindingDescription GetVertexBindingDescription()
+{
+	// Setup the binding description for the vertex
+	VkVertexInputBindingDescription bindingDescription {};
+	bindingDescription.binding	 = 0;
+	bindingDescription.stride	 = sizeof( Vertex );
+	bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+	return bindingDescription;
+}
+
+static std::vector<VkVertexInputAttributeDescription> GetVertexAttributeDescriptions()
+{
+	// Setup the atttribute descriptions
+	std::vector<VkVertexInputAttributeDescription> attributeDescriptions {};
+	VkVertexInputAttributeDescription			   newDescription {};
+
+	// Position attribute
+	newDescription.binding	= 0;
+	newDescription.location = static_cast<uint32_t>( attributeDescriptions.size() );
+	newDescription.format	= VK_FORMAT_R32G32B32_SFLOAT;
+	newDescription.offset	= offsetof( Vertex, position );
+
+	// Add description to vector
+	attributeDescriptions.push_back( newDescription );
+
+	// Normal attribute
+	newDescription.binding	= 0;
+	newDescription.location = static_cast<uint32_t>( attributeDescriptions.size() );
+	newDescription.format	= VK_FORMAT_R32G32B32_SFLOAT;
+	newDescription.offset	= offsetof( Vertex, normal );
+
+	// Add description to vector
+	attributeDescriptions.push_back( newDescription );
+
+	// TexCoord attribute
+	newDescription.binding	= 0;
+	newDescription.location = static_cast<uint32_t>( attributeDescriptions.size() );
+	newDescription.format	= VK_FORMAT_R32G32_SFLOAT;
+	newDescription.offset	= offsetof( Vertex, texCoord );
+
+	// Add description to vector
+	attributeDescriptions.push_back( newDescription );
+
+	return attributeDescriptions;
+}
\ No newline at end of file
@@ -0,0 +1,144 @@
+#pragma once
+
+#include "DescriptorPool.hpp"
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#define DESCRIPTOR_POOL_MIN_SETS 4	  // Sets the first pool of a chain holds
+#define DESCRIPTOR_POOL_MAX_SETS 1024 // Each new pool holds twice the sets of the one before, up to this
+
+// Totals over the allocator's lifetime
+struct DescriptorAllocatorStats
+{
+	uint64_t allocations  = 0;
+	uint64_t resets		  = 0;
+	uint32_t pools		  = 0; // Created, including those waiting to be reused
+	uint32_t peakSets	  = 0; // Most sets allocated between two resets
+	uint32_t peakCapacity = 0; // Sets the pools in use could hold when the peak was reached
+};
+
+// Allocates descriptor sets from a chain of pools, adding a pool once the last one is full
+// Every set must use the layout the sizes were counted from, so a pool is full once it holds its maximum sets (Counted here, as Vulkan 1.0 doesn't report a pool running out)
+// Sets are never freed one at a time, Reset returns every pool to the allocator at once so they can be reused without being recreated
+class DescriptorAllocator
+{
+private:
+	std::vector<VkDescriptorPoolSize> m_sizesPerSet; // Descriptors of each type a set needs
+	VkDescriptorPoolCreateFlags		  m_flags;
+	std::vector<DescriptorPool>		  m_usedPools; // Sets are allocated from the last
+	std::vector<DescriptorPool>		  m_freePools; // Reset, waiting to be reused
+	uint32_t						  m_nextPoolSets;
+	uint32_t						  m_sets;	  // Allocated since the last reset
+	uint32_t						  m_capacity; // Sets the pools in use can hold (Every pool but the last is full)
+	DescriptorAllocatorStats		  m_stats;
+
+	const VkDevice* m_logicalDevice;
+
+	void NextPool()
+	{
+		// Reuse a reset pool if there is one
+		if ( !m_freePools.empty() )
+		{
+			m_usedPools.push_back( m_freePools.back() );
+			m_freePools.pop_back();
+		}
+		else
+		{
+			// Create a pool sized for the next pool's share of sets
+			DescriptorPool pool;
+			pool.Init( *m_logicalDevice );
+			for ( const auto& size : m_sizesPerSet )
+				pool.AddSize( size.type, size.descriptorCount * m_nextPoolSets );
+			pool.CreatePool( m_nextPoolSets, m_flags );
+
+			m_usedPools.push_back( pool );
+			m_nextPoolSets = std::min( m_nextPoolSets * 2, static_cast<uint32_t>( DESCRIPTOR_POOL_MAX_SETS ) );
+			m_stats.pools++;
+		}
+
+		m_capacity += m_usedPools.back().GetMaxSets();
+	}
+
+public:
+	DescriptorAllocator() : m_logicalDevice( nullptr ) {}
+
+	// No pool is created until the first set is allocated
+	void Init( const VkDevice& p_logicalDevice, const std::vector<VkDescriptorPoolSize>& p_sizesPerSet, const VkDescriptorPoolCreateFlags& p_flags )
+	{
+		// Set member variables
+		m_logicalDevice = &p_logicalDevice;
+		m_sizesPerSet	= p_sizesPerSet;
+		m_flags			= p_flags;
+		m_nextPoolSets	= DESCRIPTOR_POOL_MIN_SETS;
+		m_sets			= 0;
+		m_capacity		= 0;
+		m_stats			= {};
+	}
+
+	VkDescriptorSet Allocate( const VkDescriptorSetLayout& p_layout )
+	{
+		// Chain a new pool once the last one is full
+		if ( m_sets == m_capacity ) NextPool();
+
+		// Setup the allocation information for the descriptor set
+		VkDescriptorSetAllocateInfo descriptorSetAllocInfo {};
+		descriptorSetAllocInfo.sType			  = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		descriptorSetAllocInfo.descriptorPool	  = m_usedPools.back().GetPool();
+		descriptorSetAllocInfo.descriptorSetCount = 1;
+		descriptorSetAllocInfo.pSetLayouts		  = &p_layout;
+
+		// Allocate the descriptor set
+		VkDescriptorSet set;
+		if ( vkAllocateDescriptorSets( *m_logicalDevice, &descriptorSetAllocInfo, &set ) != VK_SUCCESS )
+			throw std::runtime_error( "Failed to allocate descriptor set" );
+
+		// Track the most sets in use at once
+		m_sets++;
+		m_stats.allocations++;
+		if ( m_sets > m_stats.peakSets )
+		{
+			m_stats.peakSets	 = m_sets;
+			m_stats.peakCapacity = m_capacity;
+		}
+
+		return set;
+	}
+
+	// Frees every set allocated since the last reset (The GPU must have finished with them)
+	void Reset()
+	{
+		if ( m_usedPools.empty() ) return;
+
+		for ( auto& pool : m_usedPools )
+		{
+			pool.Reset();
+			m_freePools.push_back( pool );
+		}
+		m_usedPools.clear();
+
+		m_sets	   = 0;
+		m_capacity = 0;
+		m_stats.resets++;
+	}
+
+	inline const DescriptorAllocatorStats& GetStats() const { return m_stats; }
+
+	void Cleanup()
+	{
+		// Destroy every pool, which frees their sets
+		for ( auto& pool : m_usedPools )
+			pool.Cleanup();
+		for ( auto& pool : m_freePools )
+			pool.Cleanup();
+		m_usedPools.clear();
+		m_freePools.clear();
+
+		m_sets	   = 0;
+		m_capacity = 0;
+	}
+};
\ No newline at end of file
@@ -1,34 +1,126 @@
 #pragma once
 
-#include "DescriptorPool.hpp"
+#include "DescriptorAllocator.hpp"
+#include "DescriptorLayoutCache.hpp"
 #include "DescriptorSetLayout.hpp"
 
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
-#include <tuple>
+#include <algorithm>
+#include <stdexcept>
 #include <vector>
 
+// One descriptor as the update template reads it (Every binding's descriptors are laid out one after another)
+union DescriptorInfo
+{
+	VkDescriptorBufferInfo buffer;
+	VkDescriptorImageInfo  image;
+};
+
+// Totals over every call to UpdateSets
+struct DescriptorUpdateStats
+{
+	uint64_t templateUpdates = 0; // Sets written whole through the update template
+	uint64_t bindingWrites	 = 0; // Bindings rewritten on their own, batched into one call per update
+	uint64_t batchedCalls	 = 0;
+	uint64_t skippedBindings = 0; // Unchanged since the set was last written
+};
+
+static inline bool IsBufferDescriptor( const VkDescriptorType& p_type )
+{
+	return p_type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER || p_type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER || p_type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC || p_type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+}
+
+// A layout and a set per frame in flight, written with the same buffers and images
+// The sets come from a growable allocator that is reset wholesale when they are rebuilt
+// Each set keeps a copy of what was last written to it, so an update only rewrites the bindings that changed (A set written for the first time, or changed throughout, is written whole with an update template)
 class DescriptorCollection
 {
 private:
 	DescriptorSetLayout			 m_layout;
-	DescriptorPool				 m_pool;
+	DescriptorAllocator			 m_allocator;
 	std::vector<VkDescriptorSet> m_sets;
 	uint32_t					 m_size;
-
-	std::vector<std::tuple<const std::vector<VkDescriptorBufferInfo>, const VkDescriptorType>> m_bufferTuples;
-	std::vector<std::tuple<const VkDescriptorImageInfo, const VkDescriptorType>>			   m_imageTuples;
+	DescriptorLayoutCache*		 m_layoutCache;
+	bool						 m_poolsCreated;
+
+	// What each set should hold and what it was last written with, a descriptor per element of every binding
+	std::vector<std::vector<DescriptorInfo>> m_descriptors;
+	std::vector<std::vector<DescriptorInfo>> m_written;
+	std::vector<bool>						 m_setWritten;	   // The set has been written since it was allocated
+	std::vector<uint32_t>					 m_bindingOffsets; // Of each binding's first descriptor
+	uint32_t								 m_descriptorCount;
+	uint32_t								 m_nextBinding; // Filled by the next AddBufferSets or AddImageSets
+	VkDescriptorUpdateTemplateKHR			 m_template;
+	DescriptorUpdateStats					 m_updateStats;
+
+	// The extension functions aren't exported by the loader in Vulkan 1.0
+	PFN_vkCreateDescriptorUpdateTemplateKHR	 m_vkCreateDescriptorUpdateTemplate;
+	PFN_vkDestroyDescriptorUpdateTemplateKHR m_vkDestroyDescriptorUpdateTemplate;
+	PFN_vkUpdateDescriptorSetWithTemplateKHR m_vkUpdateDescriptorSetWithTemplate;
 
 	const VkDevice* m_logicalDevice;
 
+	bool DescriptorChanged( const uint32_t& p_set, const uint32_t& p_binding, const uint32_t& p_element ) const
+	{
+		const DescriptorInfo& current = m_descriptors[p_set][m_bindingOffsets[p_binding] + p_element];
+		const DescriptorInfo& written = m_written[p_set][m_bindingOffsets[p_binding] + p_element];
+
+		if ( IsBufferDescriptor( m_layout.GetBinding( p_binding ).descriptorType ) )
+			return current.buffer.buffer != written.buffer.buffer || current.buffer.offset != written.buffer.offset || current.buffer.range != written.buffer.range;
+		return current.image.sampler != written.image.sampler || current.image.imageView != written.image.imageView || current.image.imageLayout != written.image.imageLayout;
+	}
+
+	void CreateTemplate()
+	{
+		// Load the extension functions
+		m_vkCreateDescriptorUpdateTemplate	= (PFN_vkCreateDescriptorUpdateTemplateKHR)vkGetDeviceProcAddr( *m_logicalDevice, "vkCreateDescriptorUpdateTemplateKHR" );
+		m_vkDestroyDescriptorUpdateTemplate = (PFN_vkDestroyDescriptorUpdateTemplateKHR)vkGetDeviceProcAddr( *m_logicalDevice, "vkDestroyDescriptorUpdateTemplateKHR" );
+		m_vkUpdateDescriptorSetWithTemplate = (PFN_vkUpdateDescriptorSetWithTemplateKHR)vkGetDeviceProcAddr( *m_logicalDevice, "vkUpdateDescriptorSetWithTemplateKHR" );
+		if ( m_vkCreateDescriptorUpdateTemplate == nullptr || m_vkDestroyDescriptorUpdateTemplate == nullptr || m_vkUpdateDescriptorSetWithTemplate == nullptr )
+			throw std::runtime_error( "Failed to load descriptor update template functions" );
+
+		// Generate an entry for each binding of the layout, reading its descriptors from where they sit in a set's copy
+		std::vector<VkDescriptorUpdateTemplateEntryKHR> entries {};
+		m_bindingOffsets.clear();
+		m_descriptorCount = 0;
+		for ( const auto& binding : m_layout.GetBindings() )
+		{
+			VkDescriptorUpdateTemplateEntryKHR entry {};
+			entry.dstBinding	  = binding.binding;
+			entry.dstArrayElement = 0;
+			entry.descriptorCount = binding.descriptorCount;
+			entry.descriptorType  = binding.descriptorType;
+			entry.offset		  = sizeof( DescriptorInfo ) * m_descriptorCount;
+			entry.stride		  = sizeof( DescriptorInfo );
+
+			entries.push_back( entry );
+			m_bindingOffsets.push_back( m_descriptorCount );
+			m_descriptorCount += binding.descriptorCount;
+		}
+
+		// Setup the update template create information
+		VkDescriptorUpdateTemplateCreateInfoKHR templateCreateInfo {};
+		templateCreateInfo.sType					  = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO_KHR;
+		templateCreateInfo.descriptorUpdateEntryCount = static_cast<uint32_t>( entries.size() );
+		templateCreateInfo.pDescriptorUpdateEntries	  = entries.data();
+		templateCreateInfo.templateType				  = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET_KHR;
+		templateCreateInfo.descriptorSetLayout		  = m_layout.GetLayout();
+
+		// Create the update template
+		if ( m_vkCreateDescriptorUpdateTemplate( *m_logicalDevice, &templateCreateInfo, nullptr, &m_template ) != VK_SUCCESS )
+			throw std::runtime_error( "Failed to create descriptor update template" );
+	}
+
 public:
-	DescriptorCollection() : m_logicalDevice( nullptr ) {}
+	DescriptorCollection() : m_layoutCache( nullptr ), m_poolsCreated( false ), m_template( VK_NULL_HANDLE ), m_logicalDevice( nullptr ) {}
 
-	void Init( const VkDevice& p_logicalDevice, const uint32_t& p_size )
+	void Init( const VkDevice& p_logicalDevice, const uint32_t& p_size, DescriptorLayoutCache* p_layoutCache )
 	{
 		// Set member variables
 		m_logicalDevice = const_cast<VkDevice*>( &p_logicalDevice );
 		m_size			= p_size;
+		m_layoutCache	= p_layoutCache;
 	}
 
 	void AddLayoutBinding( const VkDescriptorType& p_type, const uint32_t p_descriptorCount, const VkShaderStageFlags& p_stageFlags, const VkSampler* p_immutableSamplers )
@@ -38,142 +130,153 @@ public:
 
 	void CreateLayout()
 	{
-		m_layout.CreateLayout( *m_logicalDevice );
+		// Get the layout, then generate the update template from its bindings
+		m_layout.CreateLayout( m_layoutCache );
+		CreateTemplate();
 	}
 
 	void CreatePool( const VkDescriptorPoolCreateFlags& p_flags )
 	{
-		// Get the bindings from the layout
-		std::vector<VkDescriptorSetLayoutBinding> bindings = m_layout.GetBindings();
+		// The allocators keep their pools between rebuilds, so they are only set up once
+		if ( m_poolsCreated ) return;
 
-		// Initialise the descriptor pool
-		m_pool.Init( *m_logicalDevice );
+		// Count the descriptors of each type a set needs
+		std::vector<VkDescriptorPoolSize> sizesPerSet {};
+		for ( const auto& binding : m_layout.GetBindings() )
+		{
+			auto found = std::find_if( sizesPerSet.begin(), sizesPerSet.end(), [&]( const VkDescriptorPoolSize& p_size ) { return p_size.type == binding.descriptorType; } );
+			if ( found != sizesPerSet.end() )
+				found->descriptorCount += binding.descriptorCount;
+			else
+				sizesPerSet.push_back( { binding.descriptorType, binding.descriptorCount } );
+		}
 
-		// Add all of the correct sizes to the pool
-		for ( const auto& binding : bindings )
-			m_pool.AddSize( binding.descriptorType, m_size );
+		// Initialise the allocator (Its pools are created as sets are allocated)
+		m_allocator.Init( *m_logicalDevice, sizesPerSet, p_flags );
 
-		// Create the descriptor pool
-		m_pool.CreatePool( m_size, p_flags );
+		m_poolsCreated = true;
 	}
 
 	void InitSets()
 	{
-		// Create a vector of of descriptor set layouts and fill with m_descriptorSetLayout
-		std::vector<VkDescriptorSetLayout> layouts( m_size, m_layout.GetLayout() );
-
-		// Setup the allocation information for the descriptor sets
-		VkDescriptorSetAllocateInfo descriptorSetAllocInfo {};
-		descriptorSetAllocInfo.sType			  = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-		descriptorSetAllocInfo.descriptorPool	  = m_pool.GetPool();
-		descriptorSetAllocInfo.descriptorSetCount = m_size;
-		descriptorSetAllocInfo.pSetLayouts		  = layouts.data();
-
-		// Clear and resize the descriptor set vector
-		m_sets = {};
-		m_sets.resize( m_size );
-
-		// Clear tuple vectors
-		m_bufferTuples.clear();
-		m_imageTuples.clear();
-
-		// Allocate the descriptor sets
-		if ( vkAllocateDescriptorSets( *m_logicalDevice, &descriptorSetAllocInfo, m_sets.data() ) != VK_SUCCESS )
-			throw std::runtime_error( "Failed to allocsate descriptor sets" );
+		// Clear the descriptor set vector
+		m_sets.clear();
+
+		// Nothing has been written to the new sets, and the next binding added is the first
+		m_descriptors.assign( m_size, std::vector<DescriptorInfo>( m_descriptorCount, DescriptorInfo {} ) );
+		m_written.assign( m_size, std::vector<DescriptorInfo>( m_descriptorCount, DescriptorInfo {} ) );
+		m_setWritten.assign( m_size, false );
+		m_nextBinding = 0;
+
+		// Allocate a descriptor set for each frame in flight
+		for ( uint32_t i = 0; i < m_size; i++ )
+			m_sets.push_back( m_allocator.Allocate( m_layout.GetLayout() ) );
+	}
+
+	// Sets one of a set's buffer descriptors, it is written by the next call to UpdateSets if it changed
+	void SetBuffer( const uint32_t& p_set, const uint32_t& p_binding, const uint32_t& p_element, const VkBuffer& p_buffer, const VkDeviceSize& p_offset, const VkDeviceSize& p_range )
+	{
+		VkDescriptorBufferInfo& bufferInfo = m_descriptors[p_set][m_bindingOffsets[p_binding] + p_element].buffer;
+		bufferInfo.buffer				   = p_buffer;
+		bufferInfo.offset				   = p_offset;
+		bufferInfo.range				   = p_range;
 	}
 
+	// Sets one of a set's image descriptors, it is written by the next call to UpdateSets if it changed
+	void SetImage( const uint32_t& p_set, const uint32_t& p_binding, const uint32_t& p_element, const VkImageLayout& p_imageLayout, const VkImageView& p_imageView, const VkSampler& p_sampler )
+	{
+		VkDescriptorImageInfo& imageInfo = m_descriptors[p_set][m_bindingOffsets[p_binding] + p_element].image;
+		imageInfo.imageLayout			 = p_imageLayout;
+		imageInfo.imageView				 = p_imageView;
+		imageInfo.sampler				 = p_sampler;
+	}
+
+	// Fills the next binding with a buffer for each set
 	void AddBufferSets( const std::vector<VkBuffer>& p_buffers, const VkDeviceSize& p_offset, const uint32_t& p_bufferSize, const VkDescriptorType& p_type )
 	{
-		// Create a vector of buffer info objects
-		std::vector<VkDescriptorBufferInfo> bufferInfos {};
+		if ( m_nextBinding >= m_bindingOffsets.size() || m_layout.GetBinding( m_nextBinding ).descriptorType != p_type )
+			throw std::runtime_error( "Failed to add buffer descriptors, they don't match the layout's next binding" );
 
-		// Fill vector with buffer info objects
 		for ( uint32_t i = 0; i < m_size; i++ )
-		{
-			// Configure the descriptors using buffer information
-			VkDescriptorBufferInfo bufferInfo {};
-			bufferInfo.buffer = p_buffers[i];
-			bufferInfo.offset = p_offset;
-			bufferInfo.range  = p_bufferSize;
-
-			// Add to buffer infos vector
-			bufferInfos.push_back( bufferInfo );
-		}
-
-		// Add buffer information to the vector of buffers
-		m_bufferTuples.push_back( std::make_tuple( bufferInfos, p_type ) );
+			SetBuffer( i, m_nextBinding, 0, p_buffers[i], p_offset, p_bufferSize );
+		m_nextBinding++;
 	}
 
+	// Fills the next binding with the same image for every set
 	void AddImageSets( const VkImageLayout& p_imageLayout, const VkImageView& p_imageView, const VkSampler& p_sampler, const VkDescriptorType& p_type )
 	{
-		// Configure the descriptors using image information
-		VkDescriptorImageInfo imageInfo {};
-		imageInfo.imageLayout = p_imageLayout;
-		imageInfo.imageView	  = p_imageView;
-		imageInfo.sampler	  = p_sampler;
-
-		// Add image information to the vector of images
-		m_imageTuples.push_back( std::make_tuple( imageInfo, p_type ) );
+		if ( m_nextBinding >= m_bindingOffsets.size() || m_layout.GetBinding( m_nextBinding ).descriptorType != p_type )
+			throw std::runtime_error( "Failed to add image descriptors, they don't match the layout's next binding" );
+
+		for ( uint32_t i = 0; i < m_size; i++ )
+			SetImage( i, m_nextBinding, 0, p_imageLayout, p_imageView, p_sampler );
+		m_nextBinding++;
 	}
 
+	// Writes every descriptor that changed since its set was last written
+	// New sets, and sets where every binding changed, are written whole through the template (One call each), the rest of the changed bindings are batched into a single write over every set
 	void UpdateSets()
 	{
-		// Create a writes vector
 		std::vector<VkWriteDescriptorSet> writes {};
+		const auto&						  bindings = m_layout.GetBindings();
 
-		// Iterate over all sets
 		for ( uint32_t i = 0; i < m_size; i++ )
 		{
-			// Create a new write
-			VkWriteDescriptorSet newWrite {};
-
-			// Reset writes vector
-			writes = {};
-
-			// Add each buffer to the writes
-			for ( const auto& bufferTuple : m_bufferTuples )
+			// Find the bindings with a changed descriptor
+			std::vector<uint32_t> changed {};
+			for ( uint32_t binding = 0; binding < bindings.size(); binding++ )
 			{
-				// Clear newWrite
-				newWrite = {};
-
-				// Configure the buffer write descriptor set
-				newWrite.sType			  = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-				newWrite.dstSet			  = m_sets[i];
-				newWrite.dstBinding		  = static_cast<uint32_t>( writes.size() ); // The index of this write
-				newWrite.dstArrayElement  = 0;
-				newWrite.descriptorType	  = std::get<1>( bufferTuple );
-				newWrite.descriptorCount  = 1;
-				newWrite.pBufferInfo	  = &std::get<0>( bufferTuple )[i];
-				newWrite.pImageInfo		  = nullptr;
-				newWrite.pTexelBufferView = nullptr;
-
-				// Add newWrite to the writes vector
-				writes.push_back( newWrite );
+				bool bindingChanged = !m_setWritten[i];
+				for ( uint32_t element = 0; element < bindings[binding].descriptorCount && !bindingChanged; element++ )
+					bindingChanged = DescriptorChanged( i, binding, element );
+
+				if ( bindingChanged )
+					changed.push_back( binding );
+				else
+					m_updateStats.skippedBindings++;
 			}
+			if ( changed.empty() ) continue;
 
-			// Add each image to the writes
-			for ( const auto& imageTuple : m_imageTuples )
+			if ( changed.size() == bindings.size() )
 			{
-				// Clear newWrite
-				newWrite = {};
-
-				// Configure the image write descriptor set
-				newWrite.sType			  = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-				newWrite.dstSet			  = m_sets[i];
-				newWrite.dstBinding		  = static_cast<uint32_t>( writes.size() ); // The index of this write
-				newWrite.dstArrayElement  = 0;
-				newWrite.descriptorType	  = std::get<1>( imageTuple );
-				newWrite.descriptorCount  = 1;
-				newWrite.pBufferInfo	  = nullptr;
-				newWrite.pImageInfo		  = &std::get<0>( imageTuple );
-				newWrite.pTexelBufferView = nullptr;
-
-				// Add newWrite to the writes vector
-				writes.push_back( newWrite );
+				// Write the whole set from its copy
+				m_vkUpdateDescriptorSetWithTemplate( *m_logicalDevice, m_sets[i], m_template, m_descriptors[i].data() );
+				m_updateStats.templateUpdates++;
+			}
+			else
+			{
+				// Add a write for each changed binding (Its descriptors stay where they are until the call below)
+				for ( const auto& binding : changed )
+				{
+					VkWriteDescriptorSet newWrite {};
+					newWrite.sType			 = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+					newWrite.dstSet			 = m_sets[i];
+					newWrite.dstBinding		 = bindings[binding].binding;
+					newWrite.dstArrayElement = 0;
+					newWrite.descriptorType	 = bindings[binding].descriptorType;
+					newWrite.descriptorCount = bindings[binding].descriptorCount;
+
+					const DescriptorInfo* descriptors = &m_descriptors[i][m_bindingOffsets[binding]];
+					if ( IsBufferDescriptor( newWrite.descriptorType ) )
+						newWrite.pBufferInfo = &descriptors->buffer;
+					else
+						newWrite.pImageInfo = &descriptors->image;
+
+					writes.push_back( newWrite );
+				}
+				m_updateStats.bindingWrites += changed.size();
 			}
 
-			// Update the descriptor sets
+			// The set now holds its copy
+			m_written[i]	= m_descriptors[i];
+			m_setWritten[i] = true;
+		}
+
+		// Write every set's remaining changes at once
+		if ( !writes.empty() )
+		{
 			vkUpdateDescriptorSets( *m_logicalDevice, static_cast<uint32_t>( writes.size() ), writes.data(), 0, nullptr );
+			m_updateStats.batchedCalls++;
 		}
 	}
 
@@ -181,14 +284,21 @@ public:
 	inline const VkDescriptorSet&			   GetSet( const uint32_t& p_index ) const { return m_sets[p_index]; }
 	inline const VkDescriptorSet*			   GetSetRef( const uint32_t& p_index ) const { return &m_sets[p_index]; }
 	inline const VkDescriptorSetLayout&		   GetLayout() const { return m_layout.GetLayout(); }
+	inline const DescriptorAllocatorStats&	   GetStats() const { return m_allocator.GetStats(); }
+	inline const DescriptorUpdateStats&		   GetUpdateStats() const { return m_updateStats; }
 
 	void CleanupPool()
 	{
-		m_pool.Cleanup();
+		// Free the sets, keeping the pools for when they are allocated again
+		m_allocator.Reset();
 	}
 
-	void CleanupLayout()
+	void Cleanup()
 	{
-		m_layout.Cleanup();
+		// Destroy the update template and the pools (The layout belongs to the cache)
+		if ( m_template != VK_NULL_HANDLE ) m_vkDestroyDescriptorUpdateTemplate( *m_logicalDevice, m_template, nullptr );
+		m_template = VK_NULL_HANDLE;
+		m_allocator.Cleanup();
+		m_poolsCreated = false;
 	}
 };
\ No newline at end of file
@@ -0,0 +1,114 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+// Totals over every layout asked for
+struct DescriptorLayoutCacheStats
+{
+	uint64_t requests = 0;
+	uint64_t hits	  = 0; // An identical layout had already been created
+	uint32_t layouts  = 0;
+};
+
+// Creates each distinct descriptor set layout once, however many collections ask for it
+// Layouts are keyed by a hash of their bindings and compared in full, so a collision only costs a lookup
+class DescriptorLayoutCache
+{
+private:
+	struct LayoutKey
+	{
+		std::vector<VkDescriptorSetLayoutBinding> bindings;
+
+		bool operator==( const LayoutKey& p_other ) const
+		{
+			if ( bindings.size() != p_other.bindings.size() ) return false;
+
+			for ( size_t i = 0; i < bindings.size(); i++ )
+			{
+				const VkDescriptorSetLayoutBinding& a = bindings[i];
+				const VkDescriptorSetLayoutBinding& b = p_other.bindings[i];
+				if ( a.binding != b.binding || a.descriptorType != b.descriptorType || a.descriptorCount != b.descriptorCount || a.stageFlags != b.stageFlags || a.pImmutableSamplers != b.pImmutableSamplers )
+					return false;
+			}
+
+			return true;
+		}
+	};
+
+	struct LayoutKeyHash
+	{
+		size_t operator()( const LayoutKey& p_key ) const
+		{
+			// Combine every field of every binding
+			size_t hash = p_key.bindings.size();
+			auto   mix	= [&hash]( const size_t& p_value ) { hash ^= p_value + 0x9e3779b97f4a7c15ULL + ( hash << 6 ) + ( hash >> 2 ); };
+			for ( const auto& binding : p_key.bindings )
+			{
+				mix( binding.binding );
+				mix( static_cast<size_t>( binding.descriptorType ) );
+				mix( binding.descriptorCount );
+				mix( binding.stageFlags );
+				mix( std::hash<const void*>()( binding.pImmutableSamplers ) );
+			}
+
+			return hash;
+		}
+	};
+
+	std::unordered_map<LayoutKey, VkDescriptorSetLayout, LayoutKeyHash> m_layouts;
+	DescriptorLayoutCacheStats											m_stats;
+
+	VkDevice m_logicalDevice;
+
+public:
+	void Init( const VkDevice& p_logicalDevice )
+	{
+		m_logicalDevice = p_logicalDevice;
+		m_stats			= {};
+	}
+
+	// Returns the layout with these bindings, creating it the first time it is asked for (The cache owns it)
+	VkDescriptorSetLayout GetLayout( const std::vector<VkDescriptorSetLayoutBinding>& p_bindings )
+	{
+		m_stats.requests++;
+
+		LayoutKey key { p_bindings };
+		auto	  found = m_layouts.find( key );
+		if ( found != m_layouts.end() )
+		{
+			m_stats.hits++;
+			return found->second;
+		}
+
+		// Setup the descriptor set layout create information
+		VkDescriptorSetLayoutCreateInfo layoutCreateInfo {};
+		layoutCreateInfo.sType		  = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		layoutCreateInfo.bindingCount = static_cast<uint32_t>( p_bindings.size() );
+		layoutCreateInfo.pBindings	  = p_bindings.data();
+
+		// Create the descriptor set layout
+		VkDescriptorSetLayout layout;
+		if ( vkCreateDescriptorSetLayout( m_logicalDevice, &layoutCreateInfo, nullptr, &layout ) != VK_SUCCESS )
+			throw std::runtime_error( "Failed to create descriptor set layout" );
+
+		m_layouts.emplace( std::move( key ), layout );
+		m_stats.layouts++;
+		return layout;
+	}
+
+	inline const DescriptorLayoutCacheStats& GetStats() const { return m_stats; }
+
+	void Cleanup()
+	{
+		// Destroy every layout (Nothing may still be using them)
+		for ( const auto& layout : m_layouts )
+			vkDestroyDescriptorSetLayout( m_logicalDevice, layout.second, nullptr );
+		m_layouts.clear();
+	}
+};
\ No newline at end of file
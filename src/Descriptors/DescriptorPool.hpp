@@ -11,6 +11,7 @@ class DescriptorPool
 private:
 	std::vector<VkDescriptorPoolSize> m_poolSizes;
 	VkDescriptorPool				  m_pool;
+	uint32_t						  m_maxSets;
 
 	const VkDevice* m_logicalDevice;
 
@@ -52,9 +53,19 @@ public:
 		// Create the descriptor pool
 		if ( vkCreateDescriptorPool( *m_logicalDevice, &poolCreateInfo, nullptr, &m_pool ) != VK_SUCCESS )
 			throw std::runtime_error( "Failed to create descriptor pool" );
+
+		// Remember how many sets it holds, for the allocator's utilisation
+		m_maxSets = p_maxSets;
+	}
+
+	void Reset()
+	{
+		// Return every set allocated from the pool to it at once
+		vkResetDescriptorPool( *m_logicalDevice, m_pool, 0 );
 	}
 
 	inline const VkDescriptorPool& GetPool() const { return m_pool; }
+	inline const uint32_t&		   GetMaxSets() const { return m_maxSets; }
 
 	void Cleanup()
 	{
@@ -0,0 +1,441 @@
+#pragma once
+
+#include "Bounds.hpp"
+
+#include <cstdint>
+#include <vector>
+
+#define BVH_NULL_NODE				-1	 // Index used when a node doesn't exist
+#define BVH_AABB_MARGIN				0.1f // Amount to fatten the leaf bounds by so small movements don't cause a reinsert
+#define BVH_DISPLACEMENT_MULTIPLIER 2.0f // How far to predict movement when fattening the leaf bounds
+
+struct BVHNode
+{
+	AABB	 bounds;
+	int32_t	 parent; // Also used as the next node in the free list
+	int32_t	 child1;
+	int32_t	 child2;
+	int32_t	 height; // Leaves are 0, free nodes are -1
+	uint32_t userData;
+
+	inline bool IsLeaf() const { return child1 == BVH_NULL_NODE; }
+};
+
+// A dynamic bounding volume hierarchy of fattened AABBs, which are refit incrementally as proxies move
+class DynamicBVH
+{
+private:
+	std::vector<BVHNode> m_nodes;
+	int32_t				 m_root;
+	int32_t				 m_freeList;
+	uint32_t			 m_proxyCount;
+
+	int32_t AllocateNode()
+	{
+		// Grow the node pool when the free list is empty
+		if ( m_freeList == BVH_NULL_NODE )
+		{
+			// Remember the old size
+			int32_t oldSize = static_cast<int32_t>( m_nodes.size() );
+
+			// Double the size of the pool
+			m_nodes.resize( std::max( 16, oldSize * 2 ) );
+
+			// Build a linked list for the free list
+			for ( int32_t i = oldSize; i < static_cast<int32_t>( m_nodes.size() ); i++ )
+			{
+				m_nodes[i].parent = i + 1;
+				m_nodes[i].height = -1;
+			}
+
+			m_nodes.back().parent = BVH_NULL_NODE;
+			m_freeList			  = oldSize;
+		}
+
+		// Take a node off of the free list
+		int32_t nodeID	= m_freeList;
+		m_freeList		= m_nodes[nodeID].parent;
+		m_nodes[nodeID] = BVHNode { AABB(), BVH_NULL_NODE, BVH_NULL_NODE, BVH_NULL_NODE, 0, 0 };
+
+		return nodeID;
+	}
+
+	void FreeNode( const int32_t& p_nodeID )
+	{
+		// Return the node to the free list
+		m_nodes[p_nodeID].parent = m_freeList;
+		m_nodes[p_nodeID].height = -1;
+		m_freeList				 = p_nodeID;
+	}
+
+	void InsertLeaf( const int32_t& p_leaf )
+	{
+		// The tree is empty
+		if ( m_root == BVH_NULL_NODE )
+		{
+			m_root					= p_leaf;
+			m_nodes[m_root].parent = BVH_NULL_NODE;
+			return;
+		}
+
+		// Find the best sibling for this leaf by descending the tree using the surface area heuristic
+		AABB	leafBounds = m_nodes[p_leaf].bounds;
+		int32_t index	   = m_root;
+
+		while ( !m_nodes[index].IsLeaf() )
+		{
+			int32_t child1 = m_nodes[index].child1;
+			int32_t child2 = m_nodes[index].child2;
+
+			// Cost of creating a new parent for this node and the new leaf
+			float area		   = m_nodes[index].bounds.GetSurfaceArea();
+			float combinedArea = AABB::Combine( m_nodes[index].bounds, leafBounds ).GetSurfaceArea();
+			float cost		   = 2.0f * combinedArea;
+
+			// Minimum cost of pushing the leaf further down the tree
+			float inheritanceCost = 2.0f * ( combinedArea - area );
+
+			// Cost of descending into either child
+			float cost1 = GetDescendCost( child1, leafBounds ) + inheritanceCost;
+			float cost2 = GetDescendCost( child2, leafBounds ) + inheritanceCost;
+
+			// Stop descending if pairing with this node is cheapest
+			if ( cost < cost1 && cost < cost2 ) break;
+
+			// Descend into the cheapest child
+			index = ( cost1 < cost2 ) ? child1 : child2;
+		}
+
+		int32_t sibling = index;
+
+		// Create a new parent for the sibling and the leaf
+		int32_t oldParent = m_nodes[sibling].parent;
+		int32_t newParent = AllocateNode();
+
+		m_nodes[newParent].parent = oldParent;
+		m_nodes[newParent].bounds = AABB::Combine( leafBounds, m_nodes[sibling].bounds );
+		m_nodes[newParent].height = m_nodes[sibling].height + 1;
+		m_nodes[newParent].child1 = sibling;
+		m_nodes[newParent].child2 = p_leaf;
+		m_nodes[sibling].parent	  = newParent;
+		m_nodes[p_leaf].parent	  = newParent;
+
+		// Link the new parent into the tree
+		if ( oldParent != BVH_NULL_NODE )
+		{
+			if ( m_nodes[oldParent].child1 == sibling )
+				m_nodes[oldParent].child1 = newParent;
+			else
+				m_nodes[oldParent].child2 = newParent;
+		}
+		else
+			m_root = newParent;
+
+		// Walk back up the tree fixing heights and bounds
+		RefitAncestors( m_nodes[p_leaf].parent );
+	}
+
+	void RemoveLeaf( const int32_t& p_leaf )
+	{
+		// The leaf is the only node in the tree
+		if ( p_leaf == m_root )
+		{
+			m_root = BVH_NULL_NODE;
+			return;
+		}
+
+		int32_t parent		= m_nodes[p_leaf].parent;
+		int32_t grandParent = m_nodes[parent].parent;
+		int32_t sibling		= ( m_nodes[parent].child1 == p_leaf ) ? m_nodes[parent].child2 : m_nodes[parent].child1;
+
+		if ( grandParent != BVH_NULL_NODE )
+		{
+			// Connect the sibling to the grandparent, and destroy the parent
+			if ( m_nodes[grandParent].child1 == parent )
+				m_nodes[grandParent].child1 = sibling;
+			else
+				m_nodes[grandParent].child2 = sibling;
+
+			m_nodes[sibling].parent = grandParent;
+			FreeNode( parent );
+
+			// Walk back up the tree fixing heights and bounds
+			RefitAncestors( grandParent );
+		}
+		else
+		{
+			// The sibling becomes the root
+			m_root					= sibling;
+			m_nodes[sibling].parent = BVH_NULL_NODE;
+			FreeNode( parent );
+		}
+	}
+
+	void RefitAncestors( int32_t p_index )
+	{
+		while ( p_index != BVH_NULL_NODE )
+		{
+			// Rotate the subtree if it is unbalanced
+			p_index = Balance( p_index );
+
+			int32_t child1 = m_nodes[p_index].child1;
+			int32_t child2 = m_nodes[p_index].child2;
+
+			// Fix the height and the bounds of this node
+			m_nodes[p_index].height = 1 + std::max( m_nodes[child1].height, m_nodes[child2].height );
+			m_nodes[p_index].bounds = AABB::Combine( m_nodes[child1].bounds, m_nodes[child2].bounds );
+
+			p_index = m_nodes[p_index].parent;
+		}
+	}
+
+	inline float GetDescendCost( const int32_t& p_child, const AABB& p_leafBounds ) const
+	{
+		// The new surface area if the leaf was paired with the child
+		float newArea = AABB::Combine( p_leafBounds, m_nodes[p_child].bounds ).GetSurfaceArea();
+
+		// A leaf would need a new parent, otherwise only the growth of the child counts
+		return m_nodes[p_child].IsLeaf() ? newArea : newArea - m_nodes[p_child].bounds.GetSurfaceArea();
+	}
+
+	int32_t Balance( const int32_t& p_iA )
+	{
+		BVHNode& A = m_nodes[p_iA];
+
+		// Leaves and nodes with only leaf children can't be rotated
+		if ( A.IsLeaf() || A.height < 2 ) return p_iA;
+
+		int32_t	 iB = A.child1;
+		int32_t	 iC = A.child2;
+		BVHNode& B	= m_nodes[iB];
+		BVHNode& C	= m_nodes[iC];
+
+		int32_t balance = C.height - B.height;
+
+		// Rotate C up
+		if ( balance > 1 )
+		{
+			int32_t	 iF = C.child1;
+			int32_t	 iG = C.child2;
+			BVHNode& F	= m_nodes[iF];
+			BVHNode& G	= m_nodes[iG];
+
+			// Swap A and C
+			C.child1 = p_iA;
+			C.parent = A.parent;
+			A.parent = iC;
+
+			// A's old parent should point to C
+			if ( C.parent != BVH_NULL_NODE )
+			{
+				if ( m_nodes[C.parent].child1 == p_iA )
+					m_nodes[C.parent].child1 = iC;
+				else
+					m_nodes[C.parent].child2 = iC;
+			}
+			else
+				m_root = iC;
+
+			// Keep the taller of F and G under C
+			if ( F.height > G.height )
+			{
+				C.child2 = iF;
+				A.child2 = iG;
+				G.parent = p_iA;
+				A.bounds = AABB::Combine( B.bounds, G.bounds );
+				C.bounds = AABB::Combine( A.bounds, F.bounds );
+				A.height = 1 + std::max( B.height, G.height );
+				C.height = 1 + std::max( A.height, F.height );
+			}
+			else
+			{
+				C.child2 = iG;
+				A.child2 = iF;
+				F.parent = p_iA;
+				A.bounds = AABB::Combine( B.bounds, F.bounds );
+				C.bounds = AABB::Combine( A.bounds, G.bounds );
+				A.height = 1 + std::max( B.height, F.height );
+				C.height = 1 + std::max( A.height, G.height );
+			}
+
+			return iC;
+		}
+
+		// Rotate B up
+		if ( balance < -1 )
+		{
+			int32_t	 iD = B.child1;
+			int32_t	 iE = B.child2;
+			BVHNode& D	= m_nodes[iD];
+			BVHNode& E	= m_nodes[iE];
+
+			// Swap A and B
+			B.child1 = p_iA;
+			B.parent = A.parent;
+			A.parent = iB;
+
+			// A's old parent should point to B
+			if ( B.parent != BVH_NULL_NODE )
+			{
+				if ( m_nodes[B.parent].child1 == p_iA )
+					m_nodes[B.parent].child1 = iB;
+				else
+					m_nodes[B.parent].child2 = iB;
+			}
+			else
+				m_root = iB;
+
+			// Keep the taller of D and E under B
+			if ( D.height > E.height )
+			{
+				B.child2 = iD;
+				A.child1 = iE;
+				E.parent = p_iA;
+				A.bounds = AABB::Combine( C.bounds, E.bounds );
+				B.bounds = AABB::Combine( A.bounds, D.bounds );
+				A.height = 1 + std::max( C.height, E.height );
+				B.height = 1 + std::max( A.height, D.height );
+			}
+			else
+			{
+				B.child2 = iE;
+				A.child1 = iD;
+				D.parent = p_iA;
+				A.bounds = AABB::Combine( C.bounds, D.bounds );
+				B.bounds = AABB::Combine( A.bounds, E.bounds );
+				A.height = 1 + std::max( C.height, D.height );
+				B.height = 1 + std::max( A.height, E.height );
+			}
+
+			return iB;
+		}
+
+		return p_iA;
+	}
+
+	template<typename Callback>
+	bool VisitSubtree( const int32_t& p_index, Callback& p_callback, std::vector<int32_t>& p_stack ) const
+	{
+		// Report every leaf under this node without testing it
+		size_t base = p_stack.size();
+		p_stack.push_back( p_index );
+
+		while ( p_stack.size() > base )
+		{
+			int32_t nodeID = p_stack.back();
+			p_stack.pop_back();
+
+			if ( m_nodes[nodeID].IsLeaf() )
+			{
+				// Stop the query if the callback asks to
+				if ( !p_callback( m_nodes[nodeID].userData ) )
+					return false;
+			}
+			else
+			{
+				p_stack.push_back( m_nodes[nodeID].child1 );
+				p_stack.push_back( m_nodes[nodeID].child2 );
+			}
+		}
+
+		return true;
+	}
+
+public:
+	DynamicBVH() : m_root( BVH_NULL_NODE ), m_freeList( BVH_NULL_NODE ), m_proxyCount( 0 ) {}
+
+	int32_t CreateProxy( const AABB& p_bounds, const uint32_t& p_userData )
+	{
+		// Create a leaf with fattened bounds
+		int32_t proxyID				= AllocateNode();
+		m_nodes[proxyID].bounds		= p_bounds.Expanded( glm::vec3( BVH_AABB_MARGIN ) );
+		m_nodes[proxyID].userData	= p_userData;
+		m_nodes[proxyID].height		= 0;
+
+		// Insert it into the tree
+		InsertLeaf( proxyID );
+		m_proxyCount++;
+
+		return proxyID;
+	}
+
+	void DestroyProxy( const int32_t& p_proxyID )
+	{
+		// Remove the leaf from the tree and free it
+		RemoveLeaf( p_proxyID );
+		FreeNode( p_proxyID );
+		m_proxyCount--;
+	}
+
+	bool MoveProxy( const int32_t& p_proxyID, const AABB& p_bounds, const glm::vec3& p_displacement )
+	{
+		// Fatten the bounds, and extend them in the direction of movement
+		AABB	  fatBounds	   = p_bounds.Expanded( glm::vec3( BVH_AABB_MARGIN ) );
+		glm::vec3 displacement = BVH_DISPLACEMENT_MULTIPLIER * p_displacement;
+		fatBounds.min		   = glm::min( fatBounds.min, fatBounds.min + displacement );
+		fatBounds.max		   = glm::max( fatBounds.max, fatBounds.max + displacement );
+
+		const AABB& treeBounds = m_nodes[p_proxyID].bounds;
+
+		// The leaf still contains the object, so nothing needs to change unless the leaf has become far too large
+		if ( treeBounds.Contains( p_bounds ) )
+		{
+			AABB hugeBounds = fatBounds.Expanded( glm::vec3( 4.0f * BVH_AABB_MARGIN ) );
+			if ( hugeBounds.Contains( treeBounds ) ) return false;
+		}
+
+		// Reinsert the leaf with its new bounds
+		RemoveLeaf( p_proxyID );
+		m_nodes[p_proxyID].bounds = fatBounds;
+		InsertLeaf( p_proxyID );
+
+		return true;
+	}
+
+	template<typename Callback>
+	void QueryFrustum( const Frustum& p_frustum, Callback p_callback ) const
+	{
+		// The tree is empty
+		if ( m_root == BVH_NULL_NODE ) return;
+
+		// Create a stack of nodes to visit
+		std::vector<int32_t> stack;
+		stack.reserve( 64 );
+		stack.push_back( m_root );
+
+		while ( !stack.empty() )
+		{
+			int32_t nodeID = stack.back();
+			stack.pop_back();
+
+			FrustumTest test = p_frustum.Classify( m_nodes[nodeID].bounds );
+
+			// Skip the entire subtree
+			if ( test == FrustumTest::OUTSIDE ) continue;
+
+			// Accept the entire subtree without any more plane tests
+			if ( test == FrustumTest::INSIDE || m_nodes[nodeID].IsLeaf() )
+			{
+				if ( !VisitSubtree( nodeID, p_callback, stack ) ) return;
+				continue;
+			}
+
+			stack.push_back( m_nodes[nodeID].child1 );
+			stack.push_back( m_nodes[nodeID].child2 );
+		}
+	}
+
+	void Clear()
+	{
+		// Remove all nodes
+		m_nodes.clear();
+		m_root		 = BVH_NULL_NODE;
+		m_freeList	 = BVH_NULL_NODE;
+		m_proxyCount = 0;
+	}
+
+	inline const uint32_t& GetUserData( const int32_t& p_proxyID ) const { return m_nodes[p_proxyID].userData; }
+	inline const AABB&	   GetFatBounds( const int32_t& p_proxyID ) const { return m_nodes[p_proxyID].bounds; }
+	inline const uint32_t& GetProxyCount() const { return m_proxyCount; }
+	inline int32_t		   GetHeight() const { return ( m_root == BVH_NULL_NODE ) ? 0 : m_nodes[m_root].height; }
+};
\ No newline at end of file
@@ -0,0 +1,151 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+#include <cstdint>
+#include <stdexcept>
+
+// Every access that has to be made available before anything else can see it
+#define BARRIER_WRITE_ACCESS ( VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_HOST_WRITE_BIT | VK_ACCESS_MEMORY_WRITE_BIT )
+
+// How a resource is used, barriers are derived from the use before and the use after
+enum class ResourceUsage : uint32_t
+{
+	UNDEFINED,		   // Nothing has used it, or its contents don't matter
+	TRANSFER_SRC,	   // Copied or blitted from
+	TRANSFER_DST,	   // Copied, blitted or cleared into
+	SAMPLED,		   // Read by fragment shaders
+	DEPTH_SAMPLED,	   // A depth image read by fragment shaders
+	COLOUR_ATTACHMENT, // Rendered into
+	DEPTH_ATTACHMENT,  // Depth tested and written
+	STORAGE,		   // Read and written by compute shaders
+	VERTEX_INPUT,	   // A buffer read as vertices or indices
+	PRESENT			   // Handed to the presentation engine
+};
+
+// The layout, stages and access a use needs (Buffers ignore the layout)
+struct ResourceState
+{
+	VkImageLayout		 layout;
+	VkPipelineStageFlags stages;
+	VkAccessFlags		 access;
+	bool				 write;
+};
+
+static ResourceState GetResourceState( const ResourceUsage& p_usage )
+{
+	VkPipelineStageFlags depthStages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+
+	switch ( p_usage )
+	{
+		case ResourceUsage::UNDEFINED: return { VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0, false };
+		case ResourceUsage::TRANSFER_SRC: return { VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT, false };
+		case ResourceUsage::TRANSFER_DST: return { VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, true };
+		case ResourceUsage::SAMPLED: return { VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, false };
+		case ResourceUsage::DEPTH_SAMPLED: return { VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, false };
+		case ResourceUsage::COLOUR_ATTACHMENT:
+			return { VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, true };
+		case ResourceUsage::DEPTH_ATTACHMENT:
+			return { VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, depthStages, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, true };
+		case ResourceUsage::STORAGE: return { VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, true };
+		case ResourceUsage::VERTEX_INPUT: return { VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT, false };
+		case ResourceUsage::PRESENT: return { VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, false };
+	}
+
+	throw std::invalid_argument( "Unknown resource usage" );
+}
+
+// The use an image in a layout is most likely ready for
+static ResourceUsage GetLayoutUsage( const VkImageLayout& p_layout )
+{
+	switch ( p_layout )
+	{
+		case VK_IMAGE_LAYOUT_UNDEFINED: return ResourceUsage::UNDEFINED;
+		case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL: return ResourceUsage::TRANSFER_SRC;
+		case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL: return ResourceUsage::TRANSFER_DST;
+		case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL: return ResourceUsage::SAMPLED;
+		case VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL: return ResourceUsage::DEPTH_SAMPLED;
+		case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL: return ResourceUsage::COLOUR_ATTACHMENT;
+		case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL: return ResourceUsage::DEPTH_ATTACHMENT;
+		case VK_IMAGE_LAYOUT_GENERAL: return ResourceUsage::STORAGE;
+		case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR: return ResourceUsage::PRESENT;
+		default: break;
+	}
+
+	throw std::invalid_argument( "Unsupported layout transition" );
+}
+
+// The image usage flags an image needs to be used this way
+static VkImageUsageFlags GetImageUsageFlags( const ResourceUsage& p_usage )
+{
+	switch ( p_usage )
+	{
+		case ResourceUsage::TRANSFER_SRC: return VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+		case ResourceUsage::TRANSFER_DST: return VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+		case ResourceUsage::SAMPLED:
+		case ResourceUsage::DEPTH_SAMPLED: return VK_IMAGE_USAGE_SAMPLED_BIT;
+		case ResourceUsage::COLOUR_ATTACHMENT: return VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+		case ResourceUsage::DEPTH_ATTACHMENT: return VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+		case ResourceUsage::STORAGE: return VK_IMAGE_USAGE_STORAGE_BIT;
+		default: return 0;
+	}
+}
+
+// Fills in a barrier between two uses of an image, returning the stages it waits on and blocks
+static void GetImageBarrier( const VkImage& p_image, const VkImageSubresourceRange& p_range, const ResourceUsage& p_from, const ResourceUsage& p_to, VkImageMemoryBarrier* p_barrier, VkPipelineStageFlags* p_srcStages, VkPipelineStageFlags* p_dstStages )
+{
+	ResourceState from = GetResourceState( p_from );
+	ResourceState to   = GetResourceState( p_to );
+
+	*p_barrier = {};
+
+	p_barrier->sType			   = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	p_barrier->srcAccessMask	   = from.access & BARRIER_WRITE_ACCESS; // Reads only need the execution dependency
+	p_barrier->dstAccessMask	   = to.access;
+	p_barrier->oldLayout		   = from.layout;
+	p_barrier->newLayout		   = to.layout;
+	p_barrier->srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	p_barrier->dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	p_barrier->image			   = p_image;
+	p_barrier->subresourceRange	   = p_range;
+
+	*p_srcStages = from.stages;
+	*p_dstStages = to.stages;
+}
+
+// Records a barrier between two uses of an image
+static void RecordImageBarrier( const VkCommandBuffer& p_commandBuffer, const VkImage& p_image, const VkImageSubresourceRange& p_range, const ResourceUsage& p_from, const ResourceUsage& p_to )
+{
+	VkImageMemoryBarrier barrier;
+	VkPipelineStageFlags srcStages, dstStages;
+	GetImageBarrier( p_image, p_range, p_from, p_to, &barrier, &srcStages, &dstStages );
+
+	vkCmdPipelineBarrier( p_commandBuffer, srcStages, dstStages, 0, 0, nullptr, 0, nullptr, 1, &barrier );
+}
+
+// Records the release half of an image's move from p_srcFamily's queue to p_dstFamily's, on the source queue (The acquire must describe the same change of use)
+static void RecordImageRelease( const VkCommandBuffer& p_commandBuffer, const VkImage& p_image, const VkImageSubresourceRange& p_range, const ResourceUsage& p_from, const ResourceUsage& p_to, const uint32_t& p_srcFamily, const uint32_t& p_dstFamily )
+{
+	VkImageMemoryBarrier barrier;
+	VkPipelineStageFlags srcStages, dstStages;
+	GetImageBarrier( p_image, p_range, p_from, p_to, &barrier, &srcStages, &dstStages );
+	barrier.srcQueueFamilyIndex = p_srcFamily;
+	barrier.dstQueueFamilyIndex = p_dstFamily;
+	barrier.dstAccessMask		= 0; // Ignored for a release
+
+	vkCmdPipelineBarrier( p_commandBuffer, srcStages, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier );
+}
+
+// Records the acquire half of an image's move, on the destination queue
+// The submission must wait on a semaphore the release's submission signals, at the stages p_to uses
+static void RecordImageAcquire( const VkCommandBuffer& p_commandBuffer, const VkImage& p_image, const VkImageSubresourceRange& p_range, const ResourceUsage& p_from, const ResourceUsage& p_to, const uint32_t& p_srcFamily, const uint32_t& p_dstFamily )
+{
+	VkImageMemoryBarrier barrier;
+	VkPipelineStageFlags srcStages, dstStages;
+	GetImageBarrier( p_image, p_range, p_from, p_to, &barrier, &srcStages, &dstStages );
+	barrier.srcQueueFamilyIndex = p_srcFamily;
+	barrier.dstQueueFamilyIndex = p_dstFamily;
+	barrier.srcAccessMask		= 0; // Ignored for an acquire
+
+	vkCmdPipelineBarrier( p_commandBuffer, dstStages, dstStages, 0, 0, nullptr, 0, nullptr, 1, &barrier );
+}
\ No newline at end of file
@@ -0,0 +1,126 @@
+#pragma once
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <algorithm>
+#include <cfloat>
+#include <glm/glm.hpp>
+
+// The results of classifying a volume against a frustum
+enum class FrustumTest
+{
+	OUTSIDE,
+	INTERSECTING,
+	INSIDE
+};
+
+struct AABB
+{
+	glm::vec3 min;
+	glm::vec3 max;
+
+	AABB() : min( { FLT_MAX, FLT_MAX, FLT_MAX } ), max( { -FLT_MAX, -FLT_MAX, -FLT_MAX } ) {}
+	AABB( const glm::vec3& p_min, const glm::vec3& p_max ) : min( p_min ), max( p_max ) {}
+
+	inline bool				 IsValid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+	inline const glm::vec3 GetCentre() const { return 0.5f * ( min + max ); }
+	inline const glm::vec3 GetExtents() const { return 0.5f * ( max - min ); }
+
+	inline float GetSurfaceArea() const
+	{
+		// Get the side lengths of the box
+		glm::vec3 size = max - min;
+
+		return 2.0f * ( size.x * size.y + size.y * size.z + size.z * size.x );
+	}
+
+	inline void AddPoint( const glm::vec3& p_point )
+	{
+		// Grow the box so that it contains the point
+		min = glm::min( min, p_point );
+		max = glm::max( max, p_point );
+	}
+
+	inline bool Contains( const AABB& p_other ) const
+	{
+		// Check if the other box is fully inside of this one
+		return min.x <= p_other.min.x && min.y <= p_other.min.y && min.z <= p_other.min.z &&
+			   p_other.max.x <= max.x && p_other.max.y <= max.y && p_other.max.z <= max.z;
+	}
+
+	inline bool Overlaps( const AABB& p_other ) const
+	{
+		// Check if the boxes overlap on every axis
+		return min.x <= p_other.max.x && p_other.min.x <= max.x &&
+			   min.y <= p_other.max.y && p_other.min.y <= max.y &&
+			   min.z <= p_other.max.z && p_other.min.z <= max.z;
+	}
+
+	inline const AABB Expanded( const glm::vec3& p_amount ) const { return AABB( min - p_amount, max + p_amount ); }
+
+	const AABB Transform( const glm::mat4& p_matrix ) const
+	{
+		// Transform the centre, and project the extents onto the axis of the matrix (Arvo's method)
+		glm::vec3 centre  = glm::vec3( p_matrix * glm::vec4( GetCentre(), 1.0f ) );
+		glm::vec3 extents = glm::abs( glm::vec3( p_matrix[0] ) ) * GetExtents().x +
+							glm::abs( glm::vec3( p_matrix[1] ) ) * GetExtents().y +
+							glm::abs( glm::vec3( p_matrix[2] ) ) * GetExtents().z;
+
+		return AABB( centre - extents, centre + extents );
+	}
+
+	static inline const AABB Combine( const AABB& p_a, const AABB& p_b ) { return AABB( glm::min( p_a.min, p_b.min ), glm::max( p_a.max, p_b.max ) ); }
+};
+
+struct Frustum
+{
+	glm::vec4 planes[6]; // Left, right, bottom, top, near, far (xyz is the normal pointing inwards, w is the distance)
+
+	static const Frustum FromMatrix( const glm::mat4& p_viewProj )
+	{
+		Frustum frustum;
+
+		// Get the rows of the matrix (GLM is column major)
+		glm::vec4 rows[4];
+		for ( uint32_t i = 0; i < 4; i++ )
+			rows[i] = glm::vec4( p_viewProj[0][i], p_viewProj[1][i], p_viewProj[2][i], p_viewProj[3][i] );
+
+		// Extract the planes (Gribb-Hartmann, using a zero to one depth range)
+		frustum.planes[0] = rows[3] + rows[0];
+		frustum.planes[1] = rows[3] - rows[0];
+		frustum.planes[2] = rows[3] + rows[1];
+		frustum.planes[3] = rows[3] - rows[1];
+		frustum.planes[4] = rows[2];
+		frustum.planes[5] = rows[3] - rows[2];
+
+		// Normalise the planes so that distances are in world units
+		for ( auto& plane : frustum.planes )
+			plane /= glm::length( glm::vec3( plane ) );
+
+		return frustum;
+	}
+
+	FrustumTest Classify( const AABB& p_box ) const
+	{
+		// Assume the box is inside until a plane says otherwise
+		FrustumTest result = FrustumTest::INSIDE;
+
+		glm::vec3 centre  = p_box.GetCentre();
+		glm::vec3 extents = p_box.GetExtents();
+
+		for ( const auto& plane : planes )
+		{
+			// Get the distance to the centre, and the projected radius of the box onto the plane normal
+			float distance = glm::dot( glm::vec3( plane ), centre ) + plane.w;
+			float radius   = glm::dot( glm::abs( glm::vec3( plane ) ), extents );
+
+			// Fully behind this plane
+			if ( distance < -radius ) return FrustumTest::OUTSIDE;
+
+			// Straddling this plane
+			if ( distance < radius ) result = FrustumTest::INTERSECTING;
+		}
+
+		return result;
+	}
+};
\ No newline at end of file
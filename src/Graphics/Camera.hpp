@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../Buffers/UniformBuffers.hpp"
+#include "Bounds.hpp"
 
 // Default values
 #define MOVE_SPEED_SLOW 1.0f
@@ -9,6 +10,8 @@
 #define MOUSE_SENS		0.005f
 #define ZOOM_SENS		5.0f
 #define FOV_DEFAULT		45.0f
+#define CAMERA_NEAR		0.1f
+#define CAMERA_FAR		100.0f
 
 #define MIN_FOV 1.0f
 #define MAX_FOV 75.0f
@@ -73,15 +76,19 @@ public:
 		// Set the MVP matrix
 		m_MVP.model = glm::mat4( 1.0f );
 		m_MVP.view	= glm::lookAt( m_position, p_target, m_worldUp );
-		m_MVP.proj	= glm::perspective( glm::radians( m_fov ), p_aspectRatio, 0.1f, 100.0f );
-
-		// Flip the y axis of the projection matrix
-		m_MVP.proj[1][1] *= -1;
+		SetAspectRatio( p_aspectRatio );
 
 		// Update the vectors
 		UpdateVectors();
 	}
 
+	void SetAspectRatio( const float& p_aspectRatio )
+	{
+		// Rebuild the projection matrix, flipping its y axis
+		m_MVP.proj = glm::perspective( glm::radians( m_fov ), p_aspectRatio, CAMERA_NEAR, CAMERA_FAR );
+		m_MVP.proj[1][1] *= -1;
+	}
+
 	void ProcessKeyboard( const CameraMovement& dir, const float& deltaT )
 	{
 		// Define the velocity the camera is moving at
@@ -156,6 +163,13 @@ public:
 		m_yDirection = glm::normalize( glm::cross( m_xDirection, m_zDirection ) );
 	}
 
+	inline const Frustum GetFrustum()
+	{
+		// Build the frustum planes from the view projection matrix
+		const VertexUniformBufferObject& MVP = GetMVP();
+		return Frustum::FromMatrix( MVP.proj * MVP.view );
+	}
+
 	inline const VertexUniformBufferObject& GetMVP()
 	{
 		// Update view matrix
@@ -0,0 +1,291 @@
+#pragma once
+
+#include "../Buffers/Buffers.hpp"
+#include "../Jobs/JobSystem.hpp"
+#include "Light.hpp"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <cmath>
+#include <glm/glm.hpp>
+#include <stdexcept>
+#include <vector>
+
+// Froxel grid (Screen tiles by exponential depth slices)
+#define CLUSTER_GRID_X 16
+#define CLUSTER_GRID_Y 9
+#define CLUSTER_GRID_Z 24
+#define CLUSTER_COUNT  ( CLUSTER_GRID_X * CLUSTER_GRID_Y * CLUSTER_GRID_Z )
+
+#define CLUSTER_MAX_LIGHTS			   4096					 // Capacity of the light buffer
+#define CLUSTER_MAX_LIGHT_INDICES	   ( CLUSTER_COUNT * 32 ) // Capacity of the light index buffer (Shared by every cluster)
+#define CLUSTER_MAX_LIGHTS_PER_CLUSTER 256					 // Longest light loop the fragment shader will run
+
+// A point light as the fragment shader reads it (View space)
+struct GPUPointLight
+{
+	alignas( 16 ) glm::vec4 positionRadius; // xyz position, w radius
+	alignas( 16 ) glm::vec4 colour;
+};
+
+// Start of the cluster buffer, followed by one ClusterRange per cluster
+struct ClusterHeader
+{
+	alignas( 16 ) glm::vec4 params; // Depth slice scale and bias, tile width and height in pixels
+	alignas( 16 ) glm::uvec4 grid;	// Grid size, and the number of lights
+};
+
+// The lights of a cluster are lightIndices[offset] to lightIndices[offset + count - 1]
+struct ClusterRange
+{
+	uint32_t offset;
+	uint32_t count;
+};
+
+// Totals over every frame built
+struct ClusteredLightingStats
+{
+	uint64_t frames			   = 0;
+	uint64_t droppedLights	   = 0; // Cluster entries the fragment shader never sees, past CLUSTER_MAX_LIGHTS_PER_CLUSTER or the index buffer's capacity
+	uint64_t overflowingFrames = 0; // Frames that dropped any
+	uint32_t peakClusterLights = 0; // Most lights touching one cluster, before any were dropped
+	uint32_t peakLightIndices  = 0; // Most of the index buffer used by one frame
+};
+
+// Sorts the point lights into a grid of view space clusters every frame, so each fragment only shades the lights near it
+class ClusteredLighting
+{
+private:
+	struct FrameBuffers
+	{
+		VkBuffer	   lightBuffer;
+		VkDeviceMemory lightMemory;
+		GPUPointLight* lights;
+
+		VkBuffer	   clusterBuffer;
+		VkDeviceMemory clusterMemory;
+		void*		   clusters;
+
+		VkBuffer	   indexBuffer;
+		VkDeviceMemory indexMemory;
+		uint32_t*	   indices;
+	};
+
+	VkDevice				  m_logicalDevice;
+	std::vector<FrameBuffers> m_frames; // One set per frame in flight (Persistently mapped)
+
+	// View space bounds of the clusters, rebuilt when the projection or screen size changes
+	// A cluster's box is separable, its x range only depends on its column and slice, and its y range on its row and slice
+	glm::mat4  m_boundsProjection;
+	VkExtent2D m_boundsExtent;
+	float	   m_sliceDepth[CLUSTER_GRID_Z + 1]; // Distance to the start of each slice
+	float	   m_columnMin[CLUSTER_GRID_Z][CLUSTER_GRID_X], m_columnMax[CLUSTER_GRID_Z][CLUSTER_GRID_X];
+	float	   m_rowMin[CLUSTER_GRID_Z][CLUSTER_GRID_Y], m_rowMax[CLUSTER_GRID_Z][CLUSTER_GRID_Y];
+	glm::vec4  m_params;
+
+	// The lights in view space, as separate streams
+	std::vector<float> m_lightX, m_lightY, m_lightDepth, m_lightRadius;
+
+	std::vector<std::vector<uint32_t>> m_clusterLights; // Light indices of each cluster (Each slice is filled by one job)
+	ClusteredLightingStats			   m_stats;
+
+	static inline uint32_t GetClusterIndex( const uint32_t& p_x, const uint32_t& p_y, const uint32_t& p_z ) { return p_x + CLUSTER_GRID_X * ( p_y + CLUSTER_GRID_Y * p_z ); }
+
+	// Distance from a value to a range (Zero inside it)
+	static inline float DistanceToRange( const float& p_value, const float& p_min, const float& p_max ) { return std::max( std::max( p_min - p_value, p_value - p_max ), 0.0f ); }
+
+	void UpdateBounds( const glm::mat4& p_projection, const VkExtent2D& p_extent, const float& p_near, const float& p_far )
+	{
+		// Skip if nothing changed since the last frame
+		if ( p_extent.width == m_boundsExtent.width && p_extent.height == m_boundsExtent.height && p_projection[0][0] == m_boundsProjection[0][0] && p_projection[1][1] == m_boundsProjection[1][1] )
+			return;
+
+		m_boundsProjection = p_projection;
+		m_boundsExtent	   = p_extent;
+
+		// Slices are spaced exponentially, so clusters stay roughly cube shaped
+		float logRatio = std::log( p_far / p_near );
+		for ( uint32_t z = 0; z <= CLUSTER_GRID_Z; z++ )
+			m_sliceDepth[z] = p_near * std::pow( p_far / p_near, z / (float)CLUSTER_GRID_Z );
+
+		// Tiles are whole pixels, so the fragment shader can find its tile from gl_FragCoord
+		float tileWidth	 = std::ceil( p_extent.width / (float)CLUSTER_GRID_X );
+		float tileHeight = std::ceil( p_extent.height / (float)CLUSTER_GRID_Y );
+
+		for ( uint32_t z = 0; z < CLUSTER_GRID_Z; z++ )
+		{
+			float nearDepth = m_sliceDepth[z], farDepth = m_sliceDepth[z + 1];
+
+			// A tile edge in normalised device coordinates is at ndc * depth / projection scale in view space
+			for ( uint32_t x = 0; x < CLUSTER_GRID_X; x++ )
+			{
+				float left		  = 2.0f * std::min( x * tileWidth, (float)p_extent.width ) / p_extent.width - 1.0f;
+				float right		  = 2.0f * std::min( ( x + 1 ) * tileWidth, (float)p_extent.width ) / p_extent.width - 1.0f;
+				float edges[4]	  = { left * nearDepth, left * farDepth, right * nearDepth, right * farDepth };
+				m_columnMin[z][x] = *std::min_element( edges, edges + 4 ) / p_projection[0][0];
+				m_columnMax[z][x] = *std::max_element( edges, edges + 4 ) / p_projection[0][0];
+				if ( m_columnMin[z][x] > m_columnMax[z][x] ) std::swap( m_columnMin[z][x], m_columnMax[z][x] );
+			}
+
+			for ( uint32_t y = 0; y < CLUSTER_GRID_Y; y++ )
+			{
+				float top	   = 2.0f * std::min( y * tileHeight, (float)p_extent.height ) / p_extent.height - 1.0f;
+				float bottom   = 2.0f * std::min( ( y + 1 ) * tileHeight, (float)p_extent.height ) / p_extent.height - 1.0f;
+				float edges[4] = { top * nearDepth, top * farDepth, bottom * nearDepth, bottom * farDepth };
+				m_rowMin[z][y] = *std::min_element( edges, edges + 4 ) / p_projection[1][1];
+				m_rowMax[z][y] = *std::max_element( edges, edges + 4 ) / p_projection[1][1];
+				if ( m_rowMin[z][y] > m_rowMax[z][y] ) std::swap( m_rowMin[z][y], m_rowMax[z][y] ); // The projection's y axis is flipped
+			}
+		}
+
+		// slice = log( depth ) * scale + bias
+		m_params = glm::vec4( CLUSTER_GRID_Z / logRatio, -CLUSTER_GRID_Z * std::log( p_near ) / logRatio, tileWidth, tileHeight );
+	}
+
+	void AssignSlices( const uint32_t& p_firstSlice, const uint32_t& p_lastSlice, const uint32_t& p_lightCount )
+	{
+		for ( uint32_t z = p_firstSlice; z < p_lastSlice; z++ )
+		{
+			// Clear the slice's clusters (Keeps their capacity)
+			for ( uint32_t i = GetClusterIndex( 0, 0, z ); i < GetClusterIndex( 0, 0, z + 1 ); i++ )
+				m_clusterLights[i].clear();
+
+			for ( uint32_t light = 0; light < p_lightCount; light++ )
+			{
+				// Sphere against box, one axis at a time
+				float radiusSquared = m_lightRadius[light] * m_lightRadius[light];
+				float dz			= DistanceToRange( m_lightDepth[light], m_sliceDepth[z], m_sliceDepth[z + 1] );
+				if ( dz * dz > radiusSquared ) continue;
+
+				for ( uint32_t x = 0; x < CLUSTER_GRID_X; x++ )
+				{
+					float dx = DistanceToRange( m_lightX[light], m_columnMin[z][x], m_columnMax[z][x] );
+					if ( dz * dz + dx * dx > radiusSquared ) continue;
+
+					for ( uint32_t y = 0; y < CLUSTER_GRID_Y; y++ )
+					{
+						float dy = DistanceToRange( m_lightY[light], m_rowMin[z][y], m_rowMax[z][y] );
+						if ( dz * dz + dx * dx + dy * dy <= radiusSquared ) m_clusterLights[GetClusterIndex( x, y, z )].push_back( light );
+					}
+				}
+			}
+		}
+	}
+
+public:
+	void Init( const VkDevice& p_logicalDevice, const VkPhysicalDevice& p_physicalDevice, const uint32_t& p_frameCount )
+	{
+		m_logicalDevice	   = p_logicalDevice;
+		m_boundsExtent	   = { 0, 0 };
+		m_boundsProjection = glm::mat4( 0.0f );
+		m_stats			   = {};
+		m_clusterLights.resize( CLUSTER_COUNT );
+
+		// Create the storage buffers for every frame in flight, and keep them mapped
+		m_frames.resize( p_frameCount );
+		for ( auto& frame : m_frames )
+		{
+			void* mappedMemPtr;
+
+			CreateBuffer( m_logicalDevice, p_physicalDevice, GetLightBufferSize(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &frame.lightBuffer, &frame.lightMemory );
+			if ( vkMapMemory( m_logicalDevice, frame.lightMemory, 0, GetLightBufferSize(), 0, &mappedMemPtr ) != VK_SUCCESS )
+				throw std::runtime_error( "Failed to map light buffer" );
+			frame.lights = static_cast<GPUPointLight*>( mappedMemPtr );
+
+			CreateBuffer( m_logicalDevice, p_physicalDevice, GetClusterBufferSize(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &frame.clusterBuffer, &frame.clusterMemory );
+			if ( vkMapMemory( m_logicalDevice, frame.clusterMemory, 0, GetClusterBufferSize(), 0, &frame.clusters ) != VK_SUCCESS )
+				throw std::runtime_error( "Failed to map cluster buffer" );
+
+			CreateBuffer( m_logicalDevice, p_physicalDevice, GetIndexBufferSize(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &frame.indexBuffer, &frame.indexMemory );
+			if ( vkMapMemory( m_logicalDevice, frame.indexMemory, 0, GetIndexBufferSize(), 0, &mappedMemPtr ) != VK_SUCCESS )
+				throw std::runtime_error( "Failed to map light index buffer" );
+			frame.indices = static_cast<uint32_t*>( mappedMemPtr );
+		}
+	}
+
+	// Fills a frame's buffers (The GPU must have finished with them), p_projection and p_extent must match the frame being drawn
+	void Build( const uint32_t& p_frame, const std::vector<PointLight>& p_lights, const glm::mat4& p_view, const glm::mat4& p_projection, const VkExtent2D& p_extent, const float& p_near, const float& p_far, JobSystem* p_jobs )
+	{
+		FrameBuffers& frame = m_frames[p_frame];
+
+		UpdateBounds( p_projection, p_extent, p_near, p_far );
+
+		// Move the lights into view space
+		uint32_t lightCount = static_cast<uint32_t>( std::min<size_t>( p_lights.size(), CLUSTER_MAX_LIGHTS ) );
+		m_lightX.resize( lightCount ), m_lightY.resize( lightCount ), m_lightDepth.resize( lightCount ), m_lightRadius.resize( lightCount );
+
+		for ( uint32_t i = 0; i < lightCount; i++ )
+		{
+			glm::vec3 position = glm::vec3( p_view * glm::vec4( p_lights[i].GetPos(), 1.0f ) );
+			m_lightX[i]		   = position.x;
+			m_lightY[i]		   = position.y;
+			m_lightDepth[i]	   = -position.z; // The camera looks down negative z
+			m_lightRadius[i]   = p_lights[i].GetRadius();
+
+			frame.lights[i] = GPUPointLight { glm::vec4( position, m_lightRadius[i] ), glm::vec4( p_lights[i].GetCol(), 0.0f ) };
+		}
+
+		// Find the lights touching each cluster, one job per depth slice
+		if ( p_jobs != nullptr )
+			p_jobs->ParallelFor( CLUSTER_GRID_Z, 1, [&]( const size_t& p_first, const size_t& p_last ) { AssignSlices( static_cast<uint32_t>( p_first ), static_cast<uint32_t>( p_last ), lightCount ); } );
+		else
+			AssignSlices( 0, CLUSTER_GRID_Z, lightCount );
+
+		// Write the header
+		ClusterHeader* header = static_cast<ClusterHeader*>( frame.clusters );
+		*header				  = ClusterHeader { m_params, glm::uvec4( CLUSTER_GRID_X, CLUSTER_GRID_Y, CLUSTER_GRID_Z, lightCount ) };
+
+		// Pack the cluster lists one after the other (Clusters past the shader's loop length or that don't fit lose their extra lights)
+		ClusterRange* ranges  = reinterpret_cast<ClusterRange*>( header + 1 );
+		uint32_t	  offset  = 0;
+		uint64_t	  dropped = 0;
+		for ( uint32_t i = 0; i < CLUSTER_COUNT; i++ )
+		{
+			uint32_t touching = static_cast<uint32_t>( m_clusterLights[i].size() );
+			uint32_t count	  = std::min<uint32_t>( { touching, CLUSTER_MAX_LIGHTS_PER_CLUSTER, CLUSTER_MAX_LIGHT_INDICES - offset } );
+			std::copy( m_clusterLights[i].begin(), m_clusterLights[i].begin() + count, frame.indices + offset );
+
+			ranges[i] = ClusterRange { offset, count };
+			offset += count;
+			dropped += touching - count;
+			m_stats.peakClusterLights = std::max( m_stats.peakClusterLights, touching );
+		}
+
+		m_stats.frames++;
+		m_stats.droppedLights += dropped;
+		m_stats.overflowingFrames += dropped > 0 ? 1 : 0;
+		m_stats.peakLightIndices = std::max( m_stats.peakLightIndices, offset );
+	}
+
+	inline const VkBuffer& GetLightBuffer( const uint32_t& p_frame ) const { return m_frames[p_frame].lightBuffer; }
+	inline const VkBuffer& GetClusterBuffer( const uint32_t& p_frame ) const { return m_frames[p_frame].clusterBuffer; }
+	inline const VkBuffer& GetIndexBuffer( const uint32_t& p_frame ) const { return m_frames[p_frame].indexBuffer; }
+	inline const ClusteredLightingStats& GetStats() const { return m_stats; }
+
+	static inline VkDeviceSize GetLightBufferSize() { return sizeof( GPUPointLight ) * CLUSTER_MAX_LIGHTS; }
+	static inline VkDeviceSize GetClusterBufferSize() { return sizeof( ClusterHeader ) + sizeof( ClusterRange ) * CLUSTER_COUNT; }
+	static inline VkDeviceSize GetIndexBufferSize() { return sizeof( uint32_t ) * CLUSTER_MAX_LIGHT_INDICES; }
+
+	void Cleanup()
+	{
+		// Unmap and destroy every frame's buffers
+		for ( auto& frame : m_frames )
+		{
+			vkUnmapMemory( m_logicalDevice, frame.lightMemory );
+			vkDestroyBuffer( m_logicalDevice, frame.lightBuffer, nullptr );
+			FreeDeviceMemory( m_logicalDevice, frame.lightMemory );
+
+			vkUnmapMemory( m_logicalDevice, frame.clusterMemory );
+			vkDestroyBuffer( m_logicalDevice, frame.clusterBuffer, nullptr );
+			FreeDeviceMemory( m_logicalDevice, frame.clusterMemory );
+
+			vkUnmapMemory( m_logicalDevice, frame.indexMemory );
+			vkDestroyBuffer( m_logicalDevice, frame.indexBuffer, nullptr );
+			FreeDeviceMemory( m_logicalDevice, frame.indexMemory );
+		}
+		m_frames.clear();
+	}
+};
\ No newline at end of file
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "../Jobs/RadixSort.hpp"
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+// Widths of the draw key's fields (Ids wider than their field are truncated, which only costs sorting quality)
+#define DRAW_KEY_PASS_BITS	   2
+#define DRAW_KEY_PIPELINE_BITS 8
+#define DRAW_KEY_MATERIAL_BITS 12
+#define DRAW_KEY_MESH_BITS	   16
+#define DRAW_KEY_STATE_BITS	   ( DRAW_KEY_PIPELINE_BITS + DRAW_KEY_MATERIAL_BITS + DRAW_KEY_MESH_BITS )
+#define DRAW_KEY_DEPTH_BITS	   ( 64 - DRAW_KEY_PASS_BITS - DRAW_KEY_STATE_BITS )
+
+enum class DrawPass : uint32_t
+{
+	SOLID,	// Grouped by state, then front to back within the same state
+	BLENDED // Back to front before anything else, so blending stays correct
+};
+
+// One draw of a range of the index buffer, submitted in the order of its key
+struct DrawItem
+{
+	uint64_t key;
+	uint32_t firstIndex;
+	uint32_t indexCount;
+	uint32_t material; // Passed as the first instance (The key's material field may be truncated)
+};
+
+// Totals over every frame drawn
+struct DrawListStats
+{
+	uint64_t frames					 = 0;
+	uint64_t draws					 = 0;
+	uint64_t pipelineBinds			 = 0;
+	uint64_t skippedPipelineBinds	 = 0; // The draw before used the same pipeline
+	uint64_t pipelineChanges		 = 0; // Of the key's pipeline between consecutive draws once sorted
+	uint64_t unsortedPipelineChanges = 0; // Between consecutive draws in the order they were added
+	uint64_t materialChanges		 = 0;
+	uint64_t unsortedMaterialChanges = 0;
+};
+
+// Solid keys are pass | pipeline | material | mesh | depth, blended keys are pass | inverted depth | pipeline | material | mesh
+// p_depth is the distance from the camera scaled to [0, 1]
+static uint64_t MakeDrawKey( const DrawPass& p_pass, const uint32_t& p_pipeline, const uint32_t& p_material, const uint32_t& p_mesh, const float& p_depth )
+{
+	uint64_t maxDepth = ( 1ull << DRAW_KEY_DEPTH_BITS ) - 1;
+	uint64_t depth	  = static_cast<uint64_t>( std::clamp( p_depth, 0.0f, 1.0f ) * static_cast<float>( maxDepth ) );
+	uint64_t pass	  = static_cast<uint64_t>( p_pass ) << ( 64 - DRAW_KEY_PASS_BITS );
+
+	// Pack the state fields together, so both layouts can move them as one
+	uint64_t state = static_cast<uint64_t>( p_pipeline & ( ( 1u << DRAW_KEY_PIPELINE_BITS ) - 1 ) ) << ( DRAW_KEY_MATERIAL_BITS + DRAW_KEY_MESH_BITS );
+	state |= static_cast<uint64_t>( p_material & ( ( 1u << DRAW_KEY_MATERIAL_BITS ) - 1 ) ) << DRAW_KEY_MESH_BITS;
+	state |= static_cast<uint64_t>( p_mesh & ( ( 1u << DRAW_KEY_MESH_BITS ) - 1 ) );
+
+	if ( p_pass == DrawPass::BLENDED ) return pass | ( maxDepth - depth ) << DRAW_KEY_STATE_BITS | state;
+	return pass | state << DRAW_KEY_DEPTH_BITS | depth;
+}
+
+static uint64_t GetDrawKeyState( const uint64_t& p_key )
+{
+	bool blended = ( p_key >> ( 64 - DRAW_KEY_PASS_BITS ) ) == static_cast<uint64_t>( DrawPass::BLENDED );
+	return ( blended ? p_key : p_key >> DRAW_KEY_DEPTH_BITS ) & ( ( 1ull << DRAW_KEY_STATE_BITS ) - 1 );
+}
+
+static inline uint32_t GetDrawKeyPipeline( const uint64_t& p_key ) { return static_cast<uint32_t>( GetDrawKeyState( p_key ) >> ( DRAW_KEY_MATERIAL_BITS + DRAW_KEY_MESH_BITS ) ); }
+static inline uint32_t GetDrawKeyMaterial( const uint64_t& p_key ) { return static_cast<uint32_t>( GetDrawKeyState( p_key ) >> DRAW_KEY_MESH_BITS ) & ( ( 1u << DRAW_KEY_MATERIAL_BITS ) - 1 ); }
+
+// A frame's draws, radix sorted by their keys on the job system so consecutive draws share as much state as possible
+// Each frame packet has its own list, so the next frame's draws can be sorted while this frame's are recorded
+class DrawList
+{
+private:
+	std::vector<DrawItem> m_items;
+	std::vector<DrawItem> m_scratch; // The other buffer of the sort
+	DrawListStats		  m_stats;
+
+	// Counts the consecutive draws whose keys differ in the field p_field reads
+	template<typename Field>
+	static uint64_t CountChanges( const std::vector<DrawItem>& p_items, const Field& p_field )
+	{
+		uint64_t changes = 0;
+		for ( size_t i = 1; i < p_items.size(); i++ )
+			if ( p_field( p_items[i].key ) != p_field( p_items[i - 1].key ) ) changes++;
+
+		return changes;
+	}
+
+public:
+	// Empties the list, ready for the frame's draws to be added
+	inline void Begin() { m_items.clear(); }
+	inline void Add( const DrawItem& p_item ) { m_items.push_back( p_item ); }
+
+	void Sort( JobSystem* p_jobs )
+	{
+		// Count the pipeline and material changes either side of the sort, to see what it saved
+		m_stats.unsortedPipelineChanges += CountChanges( m_items, GetDrawKeyPipeline );
+		m_stats.unsortedMaterialChanges += CountChanges( m_items, GetDrawKeyMaterial );
+		RadixSort( &m_items, &m_scratch, p_jobs );
+		m_stats.pipelineChanges += CountChanges( m_items, GetDrawKeyPipeline );
+		m_stats.materialChanges += CountChanges( m_items, GetDrawKeyMaterial );
+
+		m_stats.frames++;
+		m_stats.draws += m_items.size();
+	}
+
+	// Records the draws with the pipeline their key picks from p_pipelines, only binding it when it differs from the one already bound (The vertex and index buffers must already be bound)
+	// A pass can map several of the key's pipelines to the same one (The depth pre-pass draws every material the same way)
+	// Each draw's material index is its first instance, so the shaders can find it without a per draw bind
+	void Record( const VkCommandBuffer& p_commandBuffer, const VkPipeline* p_pipelines, const uint32_t& p_pipelineCount )
+	{
+		VkPipeline boundPipeline = VK_NULL_HANDLE;
+		for ( const DrawItem& item : m_items )
+		{
+			uint32_t index = GetDrawKeyPipeline( item.key );
+			if ( index >= p_pipelineCount )
+				throw std::runtime_error( "Failed to record draw, its key's pipeline has no variant" );
+
+			if ( p_pipelines[index] != boundPipeline )
+			{
+				vkCmdBindPipeline( p_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, p_pipelines[index] );
+				boundPipeline = p_pipelines[index];
+				m_stats.pipelineBinds++;
+			}
+			else
+				m_stats.skippedPipelineBinds++;
+
+			vkCmdDrawIndexed( p_commandBuffer, item.indexCount, 1, item.firstIndex, 0, item.material );
+		}
+	}
+
+	inline const DrawListStats& GetStats() const { return m_stats; }
+};
\ No newline at end of file
@@ -0,0 +1,335 @@
+#pragma once
+
+#include "../Descriptors/DescriptorCollection.hpp"
+#include "../VulkanUtil/ObjectCache.hpp"
+#include "Images.hpp"
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <cmath>
+#include <glm/glm.hpp>
+#include <stdexcept>
+#include <vector>
+
+#define RESOLUTION_MIN_SCALE	  0.5f	// Smallest fraction of the swapchain's width and height the scene is rendered at
+#define RESOLUTION_MAX_STEP		  0.05f // Largest change to the scale in one frame
+#define RESOLUTION_DEADBAND		  0.05f // GPU times within this fraction of the budget leave the scale alone (Stops it hunting)
+#define RESOLUTION_TIME_SMOOTHING 0.1f	// Weight of the newest GPU time in the running average
+#define RESOLUTION_SHARPNESS	  0.2f	// Strength of the sharpen applied while upscaling
+
+#define RESOLUTION_PIPELINE_PASS "upscale" // Pipeline cache pass of the upscale variant
+
+// Push constants of the upscale pass (Must match the fragment shader)
+struct UpscalePushConstants
+{
+	glm::vec2 renderScale;
+	glm::vec2 texelSize;
+	float	  sharpness;
+};
+
+// Renders the scene into a target the size of the swapchain, but only into the part of it the scale allows
+// The scale is adjusted from the GPU time of each frame's scene and upscale passes (Measured with timestamps) so frames stay within a budget, then an upscale and sharpen pass fills the swapchain image
+// The target is never reallocated as the scale changes, only the viewport does
+class DynamicResolution
+{
+private:
+	VkDevice m_logicalDevice;
+
+	// The scene target, sampled by the upscale pass
+	Image				 m_sceneImage;
+	VkSampler			 m_sampler;
+	DescriptorCollection m_descriptorCollection; // A single set
+	ObjectCache*		 m_objects;				 // Owns the sampler, the layouts and the render pass
+	VkExtent2D			 m_maxExtent;
+
+	// The upscale pass writes straight to the swapchain images
+	VkRenderPass			   m_renderPass;
+	VkPipelineLayout		   m_pipelineLayout;
+	std::vector<VkFramebuffer> m_framebuffers; // One per swapchain image
+
+	// Two timestamps per frame in flight, around the scene and upscale passes
+	VkQueryPool		  m_queryPool;
+	std::vector<bool> m_queryWritten; // The frame's timestamps have been written at least once
+	bool			  m_timestampsSupported;
+	float			  m_timestampPeriod; // Nanoseconds per tick
+
+	// Controller state
+	float	 m_scale;
+	float	 m_budget; // Milliseconds, zero keeps the largest scale
+	float	 m_minScale;
+	float	 m_maxScale; // Set by the quality settings
+	float	 m_sharpness;
+	float	 m_gpuMilliseconds;		// Running average
+	float	 m_lastGpuMilliseconds; // The most recent frame read back
+	float	 m_lowestScale;			// Lowest scale reached
+	uint32_t m_samples;
+
+	void CreateQueryPool( const uint32_t& p_frameCount )
+	{
+		VkQueryPoolCreateInfo queryPoolCreateInfo {};
+		queryPoolCreateInfo.sType	   = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		queryPoolCreateInfo.queryType  = VK_QUERY_TYPE_TIMESTAMP;
+		queryPoolCreateInfo.queryCount = p_frameCount * 2;
+
+		if ( vkCreateQueryPool( m_logicalDevice, &queryPoolCreateInfo, nullptr, &m_queryPool ) != VK_SUCCESS )
+			throw std::runtime_error( "Failed to create resolution timestamp query pool" );
+
+		m_queryWritten.assign( p_frameCount, false );
+	}
+
+	void CreateSampler()
+	{
+		// Bilinear, clamped to the edge of the target (The shader keeps to the rendered region itself)
+		VkSamplerCreateInfo samplerCreateInfo {};
+		samplerCreateInfo.sType					  = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+		samplerCreateInfo.magFilter				  = VK_FILTER_LINEAR;
+		samplerCreateInfo.minFilter				  = VK_FILTER_LINEAR;
+		samplerCreateInfo.addressModeU			  = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerCreateInfo.addressModeV			  = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerCreateInfo.addressModeW			  = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerCreateInfo.anisotropyEnable		  = VK_FALSE;
+		samplerCreateInfo.maxAnisotropy			  = 1.0f;
+		samplerCreateInfo.borderColor			  = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+		samplerCreateInfo.unnormalizedCoordinates = VK_FALSE;
+		samplerCreateInfo.compareEnable			  = VK_FALSE;
+		samplerCreateInfo.compareOp				  = VK_COMPARE_OP_ALWAYS;
+		samplerCreateInfo.mipmapMode			  = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+		samplerCreateInfo.mipLodBias			  = 0.0f;
+		samplerCreateInfo.minLod				  = 0.0f;
+		samplerCreateInfo.maxLod				  = 0.0f;
+
+		m_sampler = m_objects->GetSampler( samplerCreateInfo );
+	}
+
+	void CreatePipelineLayout()
+	{
+		// The scene target
+		m_descriptorCollection.Init( m_logicalDevice, 1, m_objects->GetDescriptorLayouts() );
+		m_descriptorCollection.AddLayoutBinding( VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr );
+		m_descriptorCollection.CreateLayout();
+
+		VkPushConstantRange pushConstantRange {};
+		pushConstantRange.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+		pushConstantRange.offset	 = 0;
+		pushConstantRange.size		 = sizeof( UpscalePushConstants );
+
+		VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo {};
+		pipelineLayoutCreateInfo.sType					= VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutCreateInfo.setLayoutCount			= 1;
+		pipelineLayoutCreateInfo.pSetLayouts			= &m_descriptorCollection.GetLayout();
+		pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+		pipelineLayoutCreateInfo.pPushConstantRanges	= &pushConstantRange;
+
+		m_pipelineLayout = m_objects->GetPipelineLayout( pipelineLayoutCreateInfo );
+	}
+
+	void UpdateScale( const float& p_gpuMilliseconds )
+	{
+		// Smooth out single slow frames
+		m_lastGpuMilliseconds = p_gpuMilliseconds;
+		m_gpuMilliseconds	  = m_samples == 0 ? p_gpuMilliseconds : m_gpuMilliseconds + ( p_gpuMilliseconds - m_gpuMilliseconds ) * RESOLUTION_TIME_SMOOTHING;
+		m_samples++;
+
+		if ( m_budget <= 0.0f || std::abs( 1.0f - m_gpuMilliseconds / m_budget ) < RESOLUTION_DEADBAND ) return;
+
+		// The cost of the scene grows with its pixel count, so with the square of the scale
+		float target = m_scale * std::sqrt( m_budget / m_gpuMilliseconds );
+		m_scale		 = std::clamp( m_scale + std::clamp( target - m_scale, -RESOLUTION_MAX_STEP, RESOLUTION_MAX_STEP ), std::min( m_minScale, m_maxScale ), m_maxScale );
+
+		m_lowestScale = std::min( m_lowestScale, m_scale );
+	}
+
+public:
+	void Init( const VkDevice& p_logicalDevice, const VkPhysicalDeviceProperties& p_properties, ObjectCache* p_objects, const uint32_t& p_frameCount, const float& p_budget, const float& p_minScale, const float& p_sharpness )
+	{
+		m_logicalDevice		  = p_logicalDevice;
+		m_objects			  = p_objects;
+		m_timestampsSupported = p_properties.limits.timestampComputeAndGraphics;
+		m_timestampPeriod	  = p_properties.limits.timestampPeriod;
+		m_budget			  = m_timestampsSupported ? p_budget : 0.0f; // Without timestamps there is nothing to scale from
+		m_minScale			  = std::clamp( p_minScale, 0.1f, 1.0f );
+		m_maxScale			  = 1.0f;
+		m_sharpness			  = p_sharpness;
+		m_scale				  = 1.0f;
+		m_lowestScale		  = 1.0f;
+		m_gpuMilliseconds	  = 0.0f;
+		m_lastGpuMilliseconds = 0.0f;
+		m_samples			  = 0;
+
+		CreateQueryPool( p_frameCount );
+		CreateSampler();
+		CreatePipelineLayout();
+	}
+
+	void CreateRenderPass( const VkFormat& p_swapchainFormat )
+	{
+		// Every pixel of the swapchain image is written, so nothing is loaded
+		VkAttachmentDescription colourAttachment {};
+		colourAttachment.format			= p_swapchainFormat;
+		colourAttachment.samples		= VK_SAMPLE_COUNT_1_BIT;
+		colourAttachment.loadOp			= VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		colourAttachment.storeOp		= VK_ATTACHMENT_STORE_OP_STORE;
+		colourAttachment.stencilLoadOp	= VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		colourAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		colourAttachment.initialLayout	= VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		colourAttachment.finalLayout	= VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+		VkAttachmentReference colourAttachmentRef { 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+
+		VkSubpassDescription subpass {};
+		subpass.pipelineBindPoint	 = VK_PIPELINE_BIND_POINT_GRAPHICS;
+		subpass.colorAttachmentCount = 1;
+		subpass.pColorAttachments	 = &colourAttachmentRef;
+
+		// No dependencies, the render graph waits for the image to be acquired and hands it to the presentation engine
+		VkRenderPassCreateInfo renderPassCreateInfo {};
+		renderPassCreateInfo.sType			 = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+		renderPassCreateInfo.attachmentCount = 1;
+		renderPassCreateInfo.pAttachments	 = &colourAttachment;
+		renderPassCreateInfo.subpassCount	 = 1;
+		renderPassCreateInfo.pSubpasses		 = &subpass;
+		renderPassCreateInfo.dependencyCount = 0;
+
+		m_renderPass = m_objects->GetRenderPass( renderPassCreateInfo );
+	}
+
+	// Creates the scene target at the largest size it can be drawn at, and the upscale pass's framebuffers
+	void CreateTargets( const VkPhysicalDevice& p_physicalDevice, const VkFormat& p_swapchainFormat, const VkExtent2D& p_swapchainExtent, const std::vector<VkImageView>& p_swapchainImageViews )
+	{
+		m_maxExtent = p_swapchainExtent;
+
+		m_sceneImage.Init( m_logicalDevice, p_physicalDevice, m_maxExtent.width, m_maxExtent.height, 1, VK_SAMPLE_COUNT_1_BIT, p_swapchainFormat, VK_IMAGE_TILING_OPTIMAL,
+						   VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_IMAGE_ASPECT_COLOR_BIT );
+
+		// Point the set at the new target
+		m_descriptorCollection.CreatePool( 0 );
+		m_descriptorCollection.InitSets();
+		m_descriptorCollection.AddImageSets( VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, m_sceneImage.GetImageView(), m_sampler, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER );
+		m_descriptorCollection.UpdateSets();
+
+		VkFramebufferCreateInfo framebufferCreateInfo {};
+		framebufferCreateInfo.sType			  = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+		framebufferCreateInfo.renderPass	  = m_renderPass;
+		framebufferCreateInfo.attachmentCount = 1;
+		framebufferCreateInfo.width			  = m_maxExtent.width;
+		framebufferCreateInfo.height		  = m_maxExtent.height;
+		framebufferCreateInfo.layers		  = 1;
+
+		m_framebuffers.resize( p_swapchainImageViews.size() );
+		for ( size_t i = 0; i < p_swapchainImageViews.size(); i++ )
+		{
+			framebufferCreateInfo.pAttachments = &p_swapchainImageViews[i];
+			if ( vkCreateFramebuffer( m_logicalDevice, &framebufferCreateInfo, nullptr, &m_framebuffers[i] ) != VK_SUCCESS )
+				throw std::runtime_error( "Failed to create upscale framebuffer" );
+		}
+	}
+
+	// Reads the frame's timestamps from the last time it was drawn and updates the scale, then resets them (Outside of any render pass, the GPU must have finished with the frame)
+	// Returns whether a GPU time was read back
+	bool BeginFrame( const VkCommandBuffer& p_commandBuffer, const uint32_t& p_frame )
+	{
+		if ( !m_timestampsSupported ) return false;
+
+		uint64_t timestamps[2];
+		bool	 measured = m_queryWritten[p_frame] && vkGetQueryPoolResults( m_logicalDevice, m_queryPool, p_frame * 2, 2, sizeof( timestamps ), timestamps, sizeof( uint64_t ), VK_QUERY_RESULT_64_BIT ) == VK_SUCCESS;
+		if ( measured )
+			UpdateScale( ( timestamps[1] - timestamps[0] ) * m_timestampPeriod / 1000000.0f );
+
+		vkCmdResetQueryPool( p_commandBuffer, m_queryPool, p_frame * 2, 2 );
+
+		return measured;
+	}
+
+	// Starts timing the frame, just before the scene's render pass
+	// Written at the colour output stage, which the submission waits on for the swapchain image, so the time spent waiting for the image to be presented (Vsync) isn't counted as GPU time
+	void StartTiming( const VkCommandBuffer& p_commandBuffer, const uint32_t& p_frame )
+	{
+		if ( !m_timestampsSupported ) return;
+
+		vkCmdWriteTimestamp( p_commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, m_queryPool, p_frame * 2 );
+	}
+
+	// Stops timing the frame, once the upscale has been recorded
+	void EndFrame( const VkCommandBuffer& p_commandBuffer, const uint32_t& p_frame )
+	{
+		if ( !m_timestampsSupported ) return;
+
+		vkCmdWriteTimestamp( p_commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_queryPool, p_frame * 2 + 1 );
+		m_queryWritten[p_frame] = true;
+	}
+
+	// Records the upscale from the rendered region of the scene target into a swapchain image
+	void RecordUpscale( const VkCommandBuffer& p_commandBuffer, const VkPipeline& p_pipeline, const uint32_t& p_imageIndex, const VkExtent2D& p_renderExtent )
+	{
+		VkRenderPassBeginInfo renderPassBeginInfo {};
+		renderPassBeginInfo.sType			  = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+		renderPassBeginInfo.renderPass		  = m_renderPass;
+		renderPassBeginInfo.framebuffer		  = m_framebuffers[p_imageIndex];
+		renderPassBeginInfo.renderArea.offset = { 0, 0 };
+		renderPassBeginInfo.renderArea.extent = m_maxExtent;
+		renderPassBeginInfo.clearValueCount	  = 0;
+
+		VkViewport viewport { 0.0f, 0.0f, (float)m_maxExtent.width, (float)m_maxExtent.height, 0.0f, 1.0f };
+		VkRect2D   scissor { { 0, 0 }, m_maxExtent };
+
+		UpscalePushConstants pushConstants {};
+		pushConstants.renderScale = { p_renderExtent.width / (float)m_maxExtent.width, p_renderExtent.height / (float)m_maxExtent.height };
+		pushConstants.texelSize	  = { 1.0f / m_maxExtent.width, 1.0f / m_maxExtent.height };
+		pushConstants.sharpness	  = m_sharpness;
+
+		vkCmdBeginRenderPass( p_commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE );
+		vkCmdBindPipeline( p_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, p_pipeline );
+		vkCmdSetViewport( p_commandBuffer, 0, 1, &viewport );
+		vkCmdSetScissor( p_commandBuffer, 0, 1, &scissor );
+		vkCmdBindDescriptorSets( p_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 0, 1, m_descriptorCollection.GetSetRef( 0 ), 0, nullptr );
+		vkCmdPushConstants( p_commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof( UpscalePushConstants ), &pushConstants );
+		vkCmdDraw( p_commandBuffer, 3, 1, 0, 0 );
+		vkCmdEndRenderPass( p_commandBuffer );
+	}
+
+	// Limits the scale, the controller only scales down from here
+	void SetMaxScale( const float& p_maxScale )
+	{
+		m_maxScale	  = std::clamp( p_maxScale, 0.1f, 1.0f );
+		m_scale		  = m_budget > 0.0f ? std::min( m_scale, m_maxScale ) : m_maxScale;
+		m_lowestScale = std::min( m_lowestScale, m_scale );
+	}
+
+	// The region of the scene target to render into this frame
+	VkExtent2D GetRenderExtent() const
+	{
+		return { std::max( 1u, static_cast<uint32_t>( m_maxExtent.width * m_scale ) ), std::max( 1u, static_cast<uint32_t>( m_maxExtent.height * m_scale ) ) };
+	}
+
+	inline const VkImage&		   GetSceneImage() const { return m_sceneImage.GetImage(); }
+	inline const VkImageView&	   GetSceneImageView() const { return m_sceneImage.GetImageView(); }
+	inline const VkRenderPass&	   GetRenderPass() const { return m_renderPass; }
+	inline const VkPipelineLayout& GetPipelineLayout() const { return m_pipelineLayout; }
+	inline const float&			   GetScale() const { return m_scale; }
+	inline const float&			   GetLowestScale() const { return m_lowestScale; }
+	inline const float&			   GetGpuMilliseconds() const { return m_gpuMilliseconds; }
+	inline const float&			   GetLastGpuMilliseconds() const { return m_lastGpuMilliseconds; }
+	inline const float&			   GetBudget() const { return m_budget; }
+
+	void CleanupSwapchain()
+	{
+		// Destroy the framebuffers and the scene target, and free its set (The render pass belongs to the object cache, which hands it back if the format hasn't changed)
+		for ( const auto& framebuffer : m_framebuffers )
+			vkDestroyFramebuffer( m_logicalDevice, framebuffer, nullptr );
+		m_framebuffers.clear();
+
+		m_sceneImage.Cleanup();
+		m_descriptorCollection.CleanupPool();
+
+		// Times from before the swapchain changed don't describe the frames after it
+		m_queryWritten.assign( m_queryWritten.size(), false );
+	}
+
+	void Cleanup()
+	{
+		// Destroy the set's pools and the timestamp queries (The sampler and the layouts belong to the object cache)
+		m_descriptorCollection.Cleanup();
+		vkDestroyQueryPool( m_logicalDevice, m_queryPool, nullptr );
+	}
+};
\ No newline at end of file
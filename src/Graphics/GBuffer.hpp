@@ -0,0 +1,58 @@
+#pragma once
+
+#include "RenderGraph.hpp"
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+#include <array>
+#include <stdexcept>
+#include <string>
+
+#define GBUFFER_ATTACHMENT_COUNT 3 // Albedo, normal and position (Must match the input attachments in the lighting shader)
+
+#define GBUFFER_ALBEDO_FORMAT	VK_FORMAT_R8G8B8A8_UNORM
+#define GBUFFER_NORMAL_FORMAT	VK_FORMAT_R16G16B16A16_SFLOAT // View space
+#define GBUFFER_POSITION_FORMAT VK_FORMAT_R16G16B16A16_SFLOAT // View space, w is zero where nothing was drawn
+
+// How the scene is drawn, picked at startup
+enum class RenderPath
+{
+	FORWARD, // One subpass shades every fragment as it is drawn (Multisampled)
+	DEFERRED // The first subpass fills the G-buffer, the second shades each pixel once from it (Not multisampled)
+};
+
+static RenderPath ParseRenderPath( const std::string& p_name )
+{
+	// Match the name to a path
+	if ( p_name == "forward" ) return RenderPath::FORWARD;
+	if ( p_name == "deferred" ) return RenderPath::DEFERRED;
+
+	throw std::runtime_error( "Unknown render path \"" + p_name + "\" (Expected forward or deferred)" );
+}
+
+// The deferred path's G-buffer, only ever read as input attachments within the render pass
+// The render graph creates the images, as transient attachments so tile based GPUs can keep them on chip and never back them with memory
+class GBuffer
+{
+private:
+	std::array<RenderGraphResource, GBUFFER_ATTACHMENT_COUNT> m_resources;
+	std::array<VkFormat, GBUFFER_ATTACHMENT_COUNT>			  m_formats;
+	const RenderGraph*										  m_graph;
+
+public:
+	GBuffer() : m_formats( { GBUFFER_ALBEDO_FORMAT, GBUFFER_NORMAL_FORMAT, GBUFFER_POSITION_FORMAT } ), m_graph( nullptr ) {}
+
+	// Adds the attachments to the graph, their views exist once it has been compiled
+	void Declare( RenderGraph* p_graph, const VkExtent2D& p_extent )
+	{
+		static const std::array<const char*, GBUFFER_ATTACHMENT_COUNT> names = { "G-buffer albedo", "G-buffer normal", "G-buffer position" };
+
+		m_graph = p_graph;
+		for ( size_t i = 0; i < m_resources.size(); i++ )
+			m_resources[i] = p_graph->CreateImage( names[i], { m_formats[i], p_extent, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT } );
+	}
+
+	inline const RenderGraphResource& GetResource( const size_t& p_index ) const { return m_resources[p_index]; }
+	inline const VkImageView&		  GetImageView( const size_t& p_index ) const { return m_graph->GetImageView( m_resources[p_index] ); }
+	inline const VkFormat&			  GetFormat( const size_t& p_index ) const { return m_formats[p_index]; }
+};
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include "../Buffers/Buffers.hpp"
 #include "../Buffers/CommandBuffer.hpp"
 #include "../VulkanUtil/ImageView.hpp"
+#include "Barriers.hpp"
 
 #define STB_IMAGE_IMPLEMENTATION
 #define GLFW_INCLUDE_VULKAN
@@ -20,77 +21,19 @@ static void TransitionImageLayout( const VkDevice& p_logicalDevice, const VkComm
 	// Create a one-time command buffer
 	VkCommandBuffer commandBuffer = BeginSingleTimeCommands( p_logicalDevice, p_commandPool );
 
-	// Declare the stage flags for the source and destination
-	VkPipelineStageFlags srcStage;
-	VkPipelineStageFlags dstStage;
-
-	// Create a memory barrier to transition the layout
-	VkImageMemoryBarrier barrier {};
-	barrier.sType							= VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-	barrier.oldLayout						= p_oldLayout;
-	barrier.newLayout						= p_newLayout;
-	barrier.srcQueueFamilyIndex				= VK_QUEUE_FAMILY_IGNORED;
-	barrier.dstQueueFamilyIndex				= VK_QUEUE_FAMILY_IGNORED;
-	barrier.image							= p_image;
-	barrier.subresourceRange.baseMipLevel	= 0;
-	barrier.subresourceRange.levelCount		= p_mipLevels;
-	barrier.subresourceRange.baseArrayLayer = 0;
-	barrier.subresourceRange.layerCount		= 1;
-
-	// Set subresource range aspect mask according to the transition
+	// Set subresource range aspect mask according to the new layout
+	VkImageSubresourceRange range { VK_IMAGE_ASPECT_COLOR_BIT, 0, p_mipLevels, 0, 1 };
 	if ( p_newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL )
 	{
 		// Set aspect as depth
-		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+		range.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
 
 		// Set aspect as stencil if it has a stencil component
-		if ( HasStencilComponent( p_format ) ) barrier.subresourceRange.aspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
+		if ( HasStencilComponent( p_format ) ) range.aspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
 	}
-	else
-		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
 
-	// Set the barrier access mask according to the transition
-	if ( p_oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && p_newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL )
-	{
-		// Set the masks
-		barrier.srcAccessMask = 0;
-		barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-
-		// Set the stages
-		srcStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-		dstStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-	}
-	else if ( p_oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && p_newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL )
-	{
-		// Set the masks
-		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-		// Set the stages
-		srcStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-		dstStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-	}
-	else if ( p_oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && p_newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL )
-	{
-		// Set the masks
-		barrier.srcAccessMask = 0;
-		barrier.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-
-		// Set the stages
-		srcStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-		dstStage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-	}
-	else
-		throw std::invalid_argument( "Unsupported layer transition" );
-
-	// Submit the barrier
-	vkCmdPipelineBarrier(
-		commandBuffer,
-		srcStage, dstStage,
-		0, // VK_DEPENDENCY_BY_REGION_BIT, // (Consider this)
-		0, nullptr,
-		0, nullptr,
-		1, &barrier );
+	// Record the barrier between the uses the layouts are for (Throws for a layout without one)
+	RecordImageBarrier( commandBuffer, p_image, range, GetLayoutUsage( p_oldLayout ), GetLayoutUsage( p_newLayout ) );
 
 	// End the command buffer recording and free the memory
 	EndSingleTimeCommands( p_logicalDevice, p_graphicsQueue, p_commandPool, commandBuffer );
@@ -120,7 +63,7 @@ static void CopyBufferToImage( const VkDevice& p_logicalDevice, const VkCommandP
 	EndSingleTimeCommands( p_logicalDevice, p_graphicsQueue, p_commandPool, commandBuffer );
 }
 
-static void CreateImage( const VkDevice& p_logicalDevice, const VkPhysicalDevice& p_physicalDevice, const uint32_t& p_width, const uint32_t& p_height, const uint32_t& p_mipLevels, const VkFormat& p_format, const VkImageTiling& p_tiling, const VkImageUsageFlags& p_usage, const VkMemoryPropertyFlags& p_properties, const VkSampleCountFlagBits& p_sampleCount, VkImage* p_image, VkDeviceMemory* p_imageMemory )
+static void CreateImage( const VkDevice& p_logicalDevice, const VkPhysicalDevice& p_physicalDevice, const uint32_t& p_width, const uint32_t& p_height, const uint32_t& p_mipLevels, const VkFormat& p_format, const VkImageTiling& p_tiling, const VkImageUsageFlags& p_usage, const VkMemoryPropertyFlags& p_properties, const VkSampleCountFlagBits& p_sampleCount, VkImage* p_image, VkDeviceMemory* p_imageMemory, const uint32_t& p_arrayLayers = 1 )
 {
 	// Setup the create information for the image
 	VkImageCreateInfo imageCreateInfo {};
@@ -130,7 +73,7 @@ static void CreateImage( const VkDevice& p_logicalDevice, const VkPhysicalDevice
 	imageCreateInfo.extent.height = p_height;
 	imageCreateInfo.extent.depth  = 1;
 	imageCreateInfo.mipLevels	  = p_mipLevels;
-	imageCreateInfo.arrayLayers	  = 1;
+	imageCreateInfo.arrayLayers	  = p_arrayLayers;
 	imageCreateInfo.format		  = p_format;
 	imageCreateInfo.tiling		  = p_tiling;
 	imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
@@ -153,14 +96,29 @@ static void CreateImage( const VkDevice& p_logicalDevice, const VkPhysicalDevice
 	imageAllocInfo.allocationSize  = memRequirements.size;
 	imageAllocInfo.memoryTypeIndex = FindMemoryType( p_physicalDevice, memRequirements.memoryTypeBits, p_properties );
 
-	// Allocate memory for the image
-	if ( vkAllocateMemory( p_logicalDevice, &imageAllocInfo, nullptr, p_imageMemory ) != VK_SUCCESS )
+	// Allocate memory for the image (Counted under what its usage says it is for)
+	if ( AllocateDeviceMemory( p_logicalDevice, imageAllocInfo, GetImageMemoryTag( p_usage ), p_imageMemory ) != VK_SUCCESS )
 		throw std::runtime_error( "Failed to allocate image memory" );
 
 	// Bind the image memory
 	vkBindImageMemory( p_logicalDevice, *p_image, *p_imageMemory, 0 );
 }
 
+static VkMemoryPropertyFlags GetTransientMemoryProperties( const VkPhysicalDevice& p_physicalDevice )
+{
+	// Get the GPU memory properties
+	VkPhysicalDeviceMemoryProperties memProperties;
+	vkGetPhysicalDeviceMemoryProperties( p_physicalDevice, &memProperties );
+
+	// Prefer lazily allocated memory for transient attachments (Tile based GPUs only back it when it has to leave the chip)
+	VkMemoryPropertyFlags lazyProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
+	for ( uint32_t i = 0; i < memProperties.memoryTypeCount; i++ )
+		if ( ( memProperties.memoryTypes[i].propertyFlags & lazyProperties ) == lazyProperties ) return lazyProperties;
+
+	// Desktop GPUs don't have it
+	return VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+}
+
 static VkFormat FindSupportedFormat( const VkPhysicalDevice& p_physicalDevice, const std::vector<VkFormat>& p_candidates, const VkImageTiling& p_tiling, const VkFormatFeatureFlags& p_features )
 {
 	// Iterate the format candidates
@@ -221,6 +179,7 @@ public:
 		TransitionImageLayout( *m_logicalDevice, p_commandPool, p_graphicsQueue, m_image, *m_format, p_oldLayout, p_newLayout, 1 );
 	}
 
+	inline const VkImage&	  GetImage() const { return m_image; }
 	inline const VkImageView& GetImageView() const { return *m_imageView; }
 
 	virtual void Cleanup()
@@ -233,6 +192,6 @@ public:
 
 		// Destroy the image and free its memory
 		vkDestroyImage( *m_logicalDevice, m_image, nullptr );
-		vkFreeMemory( *m_logicalDevice, m_imageMemory, nullptr );
+		FreeDeviceMemory( *m_logicalDevice, m_imageMemory );
 	}
 };
\ No newline at end of file
@@ -18,29 +18,43 @@ public:
 class DirLight : public Light
 {
 private:
-	// glm::vec3 m_direction;
+	glm::vec3 m_direction; // Direction the light travels in (Normalised)
 
 public:
+	DirLight() : m_direction( { 0.0f, -1.0f, 0.0f } ) {}
+	DirLight( const glm::vec3& p_colour, const glm::vec3& p_direction ) : m_direction( glm::normalize( p_direction ) )
+	{
+		// Set member variables
+		m_colour = p_colour;
+	}
+
+	inline const glm::vec3& GetDir() const { return m_direction; }
+	inline void				SetDir( const glm::vec3& p_direction ) { m_direction = glm::normalize( p_direction ); }
 };
 
+#define POINT_LIGHT_DEFAULT_RADIUS 10.0f
+
 class PointLight : public Light
 {
 private:
 	glm::vec3 m_position;
+	float	  m_radius; // Distance at which the light fades out completely
 
 public:
-	PointLight() : m_position( { 0.0f, 0.0f, 0.0f } )
+	PointLight() : m_position( { 0.0f, 0.0f, 0.0f } ), m_radius( POINT_LIGHT_DEFAULT_RADIUS )
 	{
 		// Set member variables
 		m_colour = { 1.0f, 1.0f, 1.0f };
 	}
-	PointLight( const glm::vec3& p_colour, const glm::vec3& p_position )
-		: m_position( p_position )
+	PointLight( const glm::vec3& p_colour, const glm::vec3& p_position, const float& p_radius = POINT_LIGHT_DEFAULT_RADIUS )
+		: m_position( p_position ), m_radius( p_radius )
 	{
 		// Set member variables
 		m_colour = p_colour;
 	}
 
 	inline const glm::vec3& GetPos() const { return m_position; }
+	inline const float&		GetRadius() const { return m_radius; }
 	inline void				SetPos( const glm::vec3& p_position ) { m_position = p_position; }
+	inline void				SetRadius( const float& p_radius ) { m_radius = p_radius; }
 };
\ No newline at end of file
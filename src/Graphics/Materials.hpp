@@ -0,0 +1,190 @@
+#pragma once
+
+#include "../Buffers/Buffers.hpp"
+#include "Textures.hpp"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#define MATERIAL_MAX_COUNT 256 // Capacity of the material buffer
+
+// The scene's pipeline variants a material can be drawn with
+#define MATERIAL_PIPELINE_DIFFUSE  0
+#define MATERIAL_PIPELINE_SPECULAR 1 // Adds a specular term, scaled by the material's specular
+#define MATERIAL_PIPELINE_COUNT	   2
+
+// How a surface looks, shared by every object drawn with it
+struct Material
+{
+	uint32_t  texture	 = 0;						  // Index into the library's textures
+	glm::vec4 baseColour = glm::vec4( 1.0f );		  // Multiplies the texture's colour
+	float	  specular	 = 0.5f;					  // Strength of the specular highlights (Only drawn by the specular variant)
+	uint32_t  pipeline	 = MATERIAL_PIPELINE_DIFFUSE; // Which of the scene's pipeline variants draws it (Sorted on and bound per draw, the shaders never see it)
+};
+
+// A material as the fragment shader reads it (Indexed by the draw's first instance)
+struct GPUMaterial
+{
+	alignas( 16 ) glm::vec4 baseColour;
+	uint32_t texture;
+	float	 specular;
+	uint32_t padding[2];
+};
+
+// Owns the scene's textures and materials, loading each texture once however many materials use it
+// Every frame in flight has its own persistently mapped copy of the material table, and only the materials edited since a frame's copy was last written are written again
+class MaterialLibrary
+{
+private:
+	struct FrameBuffer
+	{
+		VkBuffer			  buffer;
+		VkDeviceMemory		  memory;
+		GPUMaterial*		  materials;
+		std::vector<uint32_t> versions; // Of each material when it was last written to this copy
+	};
+
+	VkDevice				   m_logicalDevice;
+	VkPhysicalDevice		   m_physicalDevice;
+	VkCommandPool			   m_commandPool;
+	VkQueue					   m_graphicsQueue;
+	VkPhysicalDeviceProperties m_physicalDeviceProperties;
+	VkFormat				   m_textureFormat; // Textures keep a pointer to their format
+	ObjectCache*			   m_objects;		// Owns the textures' samplers
+
+	std::vector<Texture>					  m_textures;
+	std::unordered_map<std::string, uint32_t> m_textureIndices;	 // By path
+	std::vector<Material>					  m_materials;
+	std::vector<uint32_t>					  m_versions;		 // Bumped by every edit
+	std::unordered_map<std::string, uint32_t> m_materialIndices; // By name
+	std::vector<FrameBuffer>				  m_frames;
+	uint64_t								  m_uploads;		 // Material entries written to any frame's copy
+
+public:
+	void Init( const VkDevice& p_logicalDevice, const VkPhysicalDevice& p_physicalDevice, const VkCommandPool& p_commandPool, const VkQueue& p_graphicsQueue, const VkPhysicalDeviceProperties& p_physicalDeviceProperties, ObjectCache* p_objects, const uint32_t& p_frameCount )
+	{
+		m_logicalDevice			   = p_logicalDevice;
+		m_physicalDevice		   = p_physicalDevice;
+		m_commandPool			   = p_commandPool;
+		m_graphicsQueue			   = p_graphicsQueue;
+		m_physicalDeviceProperties = p_physicalDeviceProperties;
+		m_textureFormat			   = VK_FORMAT_R8G8B8A8_SRGB;
+		m_objects				   = p_objects;
+		m_uploads				   = 0;
+
+		// Create the material buffer for every frame in flight, and keep them mapped
+		m_frames.resize( p_frameCount );
+		for ( auto& frame : m_frames )
+		{
+			void* mappedMemPtr;
+
+			CreateBuffer( m_logicalDevice, m_physicalDevice, GetBufferSize(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &frame.buffer, &frame.memory );
+			if ( vkMapMemory( m_logicalDevice, frame.memory, 0, GetBufferSize(), 0, &mappedMemPtr ) != VK_SUCCESS )
+				throw std::runtime_error( "Failed to map material buffer" );
+			frame.materials = static_cast<GPUMaterial*>( mappedMemPtr );
+
+			// Nothing has been written yet (Materials start at version one)
+			frame.versions.assign( MATERIAL_MAX_COUNT, 0 );
+		}
+	}
+
+	// Returns the index of the texture at p_path, loading it the first time it is asked for
+	uint32_t LoadTexture( const std::string& p_path )
+	{
+		auto found = m_textureIndices.find( p_path );
+		if ( found != m_textureIndices.end() ) return found->second;
+
+		// Load the image with its mipmaps, only the tail is uploaded until the streamer asks for more (Its index doubles as its sampler ID)
+		uint32_t index = static_cast<uint32_t>( m_textures.size() );
+		m_textures.emplace_back();
+		m_textures.back().Init( m_logicalDevice, m_physicalDevice, m_commandPool, m_graphicsQueue, m_physicalDeviceProperties, p_path.c_str(), VK_SAMPLE_COUNT_1_BIT, m_textureFormat, VK_IMAGE_TILING_OPTIMAL,
+								VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_IMAGE_ASPECT_COLOR_BIT, index, m_objects );
+
+		m_textureIndices[p_path] = index;
+		return index;
+	}
+
+	// Returns the index of the material called p_name, creating it from p_material if there isn't one yet
+	uint32_t CreateMaterial( const std::string& p_name, const Material& p_material )
+	{
+		auto found = m_materialIndices.find( p_name );
+		if ( found != m_materialIndices.end() ) return found->second;
+
+		if ( m_materials.size() >= MATERIAL_MAX_COUNT )
+			throw std::runtime_error( "Failed to create material \"" + p_name + "\", the material buffer is full" );
+
+		uint32_t index = static_cast<uint32_t>( m_materials.size() );
+		m_materials.push_back( p_material );
+		m_versions.push_back( 1 );
+
+		m_materialIndices[p_name] = index;
+		return index;
+	}
+
+	// Replaces a material, it is written to each frame's copy the next time that frame is uploaded
+	void UpdateMaterial( const uint32_t& p_material, const Material& p_value )
+	{
+		m_materials[p_material] = p_value;
+		m_versions[p_material]++;
+	}
+
+	// Writes the materials edited since the frame's copy was last written (The GPU must have finished with the frame)
+	void Upload( const uint32_t& p_frame )
+	{
+		FrameBuffer& frame = m_frames[p_frame];
+
+		for ( uint32_t i = 0; i < m_materials.size(); i++ )
+		{
+			if ( frame.versions[i] == m_versions[i] ) continue;
+
+			// Materials drawn without the specular variant have no highlight, which the deferred path reads per pixel
+			const Material& material = m_materials[i];
+			float			specular = material.pipeline == MATERIAL_PIPELINE_SPECULAR ? material.specular : 0.0f;
+			frame.materials[i]		 = GPUMaterial { material.baseColour, material.texture, specular, { 0, 0 } };
+			frame.versions[i]		 = m_versions[i];
+			m_uploads++;
+		}
+	}
+
+	void RecreateSamplers( const float& p_anisotropy, const float& p_lodBias )
+	{
+		// Replace every texture's sampler (The descriptor sets must be updated after)
+		for ( auto& texture : m_textures )
+			texture.RecreateSampler( p_anisotropy, p_lodBias );
+	}
+
+	inline const Material&	   GetMaterial( const uint32_t& p_material ) const { return m_materials[p_material]; }
+	inline uint32_t			   GetMaterialCount() const { return static_cast<uint32_t>( m_materials.size() ); }
+	inline const Texture&	   GetTexture( const uint32_t& p_texture ) const { return m_textures[p_texture]; }
+	inline Texture&			   GetTexture( const uint32_t& p_texture ) { return m_textures[p_texture]; } // For the streamer to change which levels are resident
+	inline uint32_t			   GetTextureCount() const { return static_cast<uint32_t>( m_textures.size() ); }
+	inline const VkBuffer&	   GetBuffer( const uint32_t& p_frame ) const { return m_frames[p_frame].buffer; }
+	inline const uint64_t&	   GetUploads() const { return m_uploads; }
+	static inline VkDeviceSize GetBufferSize() { return sizeof( GPUMaterial ) * MATERIAL_MAX_COUNT; }
+
+	void Cleanup()
+	{
+		for ( auto& texture : m_textures )
+			texture.Cleanup();
+		m_textures.clear();
+		m_textureIndices.clear();
+		m_materials.clear();
+		m_versions.clear();
+		m_materialIndices.clear();
+
+		for ( auto& frame : m_frames )
+		{
+			vkUnmapMemory( m_logicalDevice, frame.memory );
+			vkDestroyBuffer( m_logicalDevice, frame.buffer, nullptr );
+			FreeDeviceMemory( m_logicalDevice, frame.memory );
+		}
+		m_frames.clear();
+	}
+};
\ No newline at end of file
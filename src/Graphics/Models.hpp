@@ -2,7 +2,8 @@
 #define GLM_ENABLE_EXPERIMENTAL
 
 #include "../Buffers/Vertex.hpp"
-#include "../Graphics/Textures.hpp"
+#include "../Graphics/Bounds.hpp"
+#include "../Graphics/VertexTransform.hpp"
 
 #include <glm/gtx/hash.hpp>
 #include <stdexcept>
@@ -22,8 +23,7 @@ namespace std
 	{
 		size_t operator()( Vertex const& vertex ) const
 		{
-			return ( ( hash<glm::vec3>()( vertex.position ) ^ ( hash<glm::vec3>()( vertex.normal ) << 1 ) ) >> 1 ) ^
-				   ( ( ( hash<glm::vec2>()( vertex.texCoord ) << 1 ) ^ ( hash<uint32_t>()( vertex.samplerID ) << 2 ) ) >> 2 );
+			return ( ( hash<glm::vec3>()( vertex.position ) ^ ( hash<glm::vec3>()( vertex.normal ) << 1 ) ) >> 1 ) ^ ( hash<glm::vec2>()( vertex.texCoord ) << 1 );
 		}
 	};
 } // namespace std
@@ -33,7 +33,16 @@ class Model
 private:
 	std::vector<Vertex>			 m_vertices;
 	std::vector<IndexBufferType> m_indices;
-	Texture						 m_texture;
+	AABB						 m_bounds;
+	VertexStreams				 m_streams; // Positions and normals split into streams for the transform kernel
+
+	void CalculateBounds()
+	{
+		// Reset the bounds and grow them to fit every vertex
+		m_bounds = AABB();
+		for ( const auto& vertex : m_vertices )
+			m_bounds.AddPoint( vertex.position );
+	}
 
 public:
 	void LoadModel( const char* path )
@@ -78,9 +87,6 @@ public:
 					1.0f - attrib.texcoords[2 * index.texcoord_index + 1]
 				};
 
-				// Get the samplerID
-				vertex.samplerID = m_texture.GetSamplerID();
-
 				// Add to vertices if it is unique
 				if ( uniqueVertices.count( vertex ) == 0 )
 				{
@@ -91,81 +97,69 @@ public:
 				m_indices.push_back( uniqueVertices[vertex] );
 			}
 		}
-	}
 
-	void LoadTexture( const VkDevice& p_logicalDevice, const VkPhysicalDevice& p_physicalDevice, const VkCommandPool& p_commandPool, const VkQueue& p_graphicsQueue,
-					  const VkPhysicalDeviceProperties& p_physicalDeviceProperties, const char* path, const VkSampleCountFlagBits& p_sampleCount, const VkFormat& p_format, const VkImageTiling& p_tiling,
-					  const VkImageUsageFlags& p_usage, const VkMemoryPropertyFlags& p_properties,
-					  const VkImageAspectFlags& p_aspectFlags, const uint32_t& p_samplerID )
-	{
-		m_texture.Init( p_logicalDevice, p_physicalDevice, p_commandPool, p_graphicsQueue, p_physicalDeviceProperties, path, p_sampleCount, p_format, p_tiling, p_usage, p_properties,
-						p_aspectFlags, p_samplerID );
+		// Find the local bounds of the model
+		CalculateBounds();
+
+		// Split the positions and normals into streams
+		m_streams.Build( m_vertices );
 	}
 
-	void Init( const char* modelPath, const char* texturePath, const VkSampleCountFlagBits& p_sampleCount, const VkDevice& p_logicalDevice, const VkPhysicalDevice& p_physicalDevice, const VkCommandPool& p_commandPool, const VkQueue& p_graphicsQueue,
-			   const VkPhysicalDeviceProperties& p_physicalDeviceProperties, const VkFormat& p_format, const VkImageTiling& p_tiling,
-			   const VkImageUsageFlags& p_usage, const VkMemoryPropertyFlags& p_properties,
-			   const VkImageAspectFlags& p_aspectFlags, const uint32_t& p_samplerID )
+	void Init( const char* modelPath )
 	{
-		// Reset vertices and indices
-		m_vertices = {};
-		m_indices  = {};
-
-		// Load the texture
-		LoadTexture( p_logicalDevice, p_physicalDevice, p_commandPool, p_graphicsQueue, p_physicalDeviceProperties, texturePath, p_sampleCount, p_format, p_tiling, p_usage, p_properties,
-					 p_aspectFlags, p_samplerID );
-
 		// Load the vertices and indices
 		LoadModel( modelPath );
 	}
 
-	void TransitionTextureLayout( const VkCommandPool& p_commandPool, const VkQueue& p_graphicsQueue, const VkImageLayout& p_oldLayout, const VkImageLayout& p_newLayout )
-	{
-		m_texture.TransitionLayout( p_commandPool, p_graphicsQueue, p_oldLayout, p_newLayout );
-	}
-
 	void SetVerticesAndIndices( const std::vector<Vertex>& p_vertices, const std::vector<IndexBufferType>& p_indices )
 	{
 		// Clear and resize the vertices vector
 		m_vertices.clear();
 		m_vertices.resize( p_vertices.size() );
 
-		// Copy all vertices and change the sampler ID
+		// Copy all vertices
 		for ( uint32_t i = 0; i < p_vertices.size(); i++ )
 		{
 			m_vertices[i] = p_vertices[i];
 			// m_vertices[i].position.y = -m_vertices[i].position.y; // Flip vertically
 			// m_vertices[i].normal.y	 = -m_vertices[i].normal.y;	  // Flip vertically
-			m_vertices[i].samplerID = m_texture.GetSamplerID();
 		}
 
 		m_indices = p_indices;
+
+		// Find the local bounds of the model
+		CalculateBounds();
+
+		// Split the positions and normals into streams
+		m_streams.Build( m_vertices );
 	}
 
 	void ApplyMatrix( const glm::mat4& p_modelMatrix, const glm::mat3& p_normalMatrix )
 	{
-		// Iterate through the vertices and apply the matrix
-		for ( uint32_t i = 0; i < m_vertices.size(); i++ )
-		{
-			m_vertices[i].position = glm::vec3( p_modelMatrix * glm::vec4( m_vertices[i].position, 1.0f ) );
-			m_vertices[i].normal   = glm::vec3( p_normalMatrix * m_vertices[i].normal );
-		}
+		// Apply the matrix to the vertices in place
+		TransformVertices( m_streams, m_vertices.data(), p_modelMatrix, p_normalMatrix, m_vertices.data() );
+
+		// The transformed vertices are the new local space
+		CalculateBounds();
+		m_streams.Build( m_vertices );
 	}
 
 	std::vector<Vertex> GetVerticesAfterMatrix( const glm::mat4& p_modelMatrix, const glm::mat3& p_normalMatrix ) const
 	{
-		std::vector<Vertex> modifiedVertices = m_vertices;
+		std::vector<Vertex> modifiedVertices( m_vertices.size() );
 
-		// Iterate through the modifiedVertices and apply the matrix
-		for ( uint32_t i = 0; i < m_vertices.size(); i++ )
-		{
-			modifiedVertices[i].position = glm::vec3( p_modelMatrix * glm::vec4( m_vertices[i].position, 1.0f ) );
-			modifiedVertices[i].normal	 = glm::vec3( p_normalMatrix * m_vertices[i].normal );
-		}
+		// Apply the matrix to a copy of the vertices
+		WriteVerticesAfterMatrix( p_modelMatrix, p_normalMatrix, modifiedVertices.data() );
 
 		return modifiedVertices;
 	}
 
+	inline void WriteVerticesAfterMatrix( const glm::mat4& p_modelMatrix, const glm::mat3& p_normalMatrix, Vertex* p_destination, JobSystem* p_jobs = nullptr ) const
+	{
+		// Transform the vertices straight into the destination (Usually mapped staging memory)
+		TransformVertices( m_streams, m_vertices.data(), p_modelMatrix, p_normalMatrix, p_destination, p_jobs );
+	}
+
 	inline const std::vector<Vertex>&		   GetVertices() const { return m_vertices; }
 	inline const std::vector<IndexBufferType>& GetIndices() const { return m_indices; }
 
@@ -175,18 +169,19 @@ public:
 		std::vector<IndexBufferType> adjustedIndices( m_indices.size() );
 
 		// Add the offset to the indices
-		for ( uint16_t i = 0; i < m_indices.size(); i++ )
-			adjustedIndices[i] = m_indices[i] + offset;
+		WriteAdjustedIndices( offset, adjustedIndices.data() );
 
 		return adjustedIndices;
 	}
 
-	inline const Texture& GetTexture() const { return m_texture; }
-
-	inline void Cleanup()
+	inline void WriteAdjustedIndices( const IndexBufferType& offset, IndexBufferType* p_destination ) const
 	{
-		m_texture.Cleanup();
+		// Add the offset to the indices
+		for ( size_t i = 0; i < m_indices.size(); i++ )
+			p_destination[i] = m_indices[i] + offset;
 	}
+
+	inline const AABB& GetBounds() const { return m_bounds; }
 };
 
 // clang-format off
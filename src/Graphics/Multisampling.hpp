@@ -2,17 +2,17 @@
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
 
-static VkSampleCountFlagBits GetMaxUsableSampleCount( const VkPhysicalDeviceProperties& p_physicalDeviceProperties )
+static VkSampleCountFlagBits GetUsableSampleCount( const VkPhysicalDeviceProperties& p_physicalDeviceProperties, const uint32_t& p_requestedCount )
 {
 	// Set the bitmask for the counts
 	VkSampleCountFlags counts = p_physicalDeviceProperties.limits.framebufferColorSampleCounts & p_physicalDeviceProperties.limits.framebufferDepthSampleCounts;
 
-	// Pick the correct sample count
-	if ( counts & VK_SAMPLE_COUNT_64_BIT ) return VK_SAMPLE_COUNT_64_BIT;
-	if ( counts & VK_SAMPLE_COUNT_32_BIT ) return VK_SAMPLE_COUNT_32_BIT;
-	if ( counts & VK_SAMPLE_COUNT_16_BIT ) return VK_SAMPLE_COUNT_16_BIT;
-	if ( counts & VK_SAMPLE_COUNT_8_BIT ) return VK_SAMPLE_COUNT_8_BIT;
-	if ( counts & VK_SAMPLE_COUNT_4_BIT ) return VK_SAMPLE_COUNT_4_BIT;
-	if ( counts & VK_SAMPLE_COUNT_2_BIT ) return VK_SAMPLE_COUNT_2_BIT;
+	// Pick the highest supported count that isn't above the requested one
+	if ( p_requestedCount >= 64 && ( counts & VK_SAMPLE_COUNT_64_BIT ) ) return VK_SAMPLE_COUNT_64_BIT;
+	if ( p_requestedCount >= 32 && ( counts & VK_SAMPLE_COUNT_32_BIT ) ) return VK_SAMPLE_COUNT_32_BIT;
+	if ( p_requestedCount >= 16 && ( counts & VK_SAMPLE_COUNT_16_BIT ) ) return VK_SAMPLE_COUNT_16_BIT;
+	if ( p_requestedCount >= 8 && ( counts & VK_SAMPLE_COUNT_8_BIT ) ) return VK_SAMPLE_COUNT_8_BIT;
+	if ( p_requestedCount >= 4 && ( counts & VK_SAMPLE_COUNT_4_BIT ) ) return VK_SAMPLE_COUNT_4_BIT;
+	if ( p_requestedCount >= 2 && ( counts & VK_SAMPLE_COUNT_2_BIT ) ) return VK_SAMPLE_COUNT_2_BIT;
 	return VK_SAMPLE_COUNT_1_BIT;
 }
\ No newline at end of file
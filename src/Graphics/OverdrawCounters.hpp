@@ -0,0 +1,115 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+// What the scene's shading cost while the depth pre-pass was off or on
+struct OverdrawStats
+{
+	uint32_t timedFrames		 = 0; // Frames with a GPU time
+	uint32_t countedFrames		 = 0; // Frames with pipeline statistics (Zero when the device can't count them)
+	uint64_t vertexInvocations	 = 0; // Of the shading subpass (The pre-pass runs the vertex shader again)
+	uint64_t fragmentInvocations = 0; // Of the shading subpass
+	uint64_t pixels				 = 0; // Rendered over the counted frames
+	double	 gpuMilliseconds	 = 0.0; // Over the timed frames
+};
+
+// Counts the fragment shader invocations of the scene's shading subpass with pipeline statistics queries
+// Fragments per rendered pixel is the overdraw, kept separately for frames drawn with and without the depth pre-pass along with their GPU time, so the two can be compared
+class OverdrawCounters
+{
+private:
+	// The mode and size each frame in flight was last recorded with
+	struct FrameRecord
+	{
+		bool	 recorded = false;
+		bool	 counted  = false; // A query was written
+		bool	 prepass  = false;
+		uint64_t pixels	  = 0;
+	};
+
+	VkDevice					 m_logicalDevice;
+	VkQueryPool					 m_queryPool; // One query per frame in flight
+	bool						 m_supported;
+	std::vector<FrameRecord>	 m_frames;
+	std::array<OverdrawStats, 2> m_stats; // Without and with the pre-pass
+
+public:
+	void Init( const VkDevice& p_logicalDevice, const bool& p_supported, const uint32_t& p_frameCount )
+	{
+		m_logicalDevice = p_logicalDevice;
+		m_supported		= p_supported;
+		m_queryPool		= VK_NULL_HANDLE;
+		m_frames.assign( p_frameCount, FrameRecord() );
+
+		if ( !m_supported ) return;
+
+		VkQueryPoolCreateInfo queryPoolCreateInfo {};
+		queryPoolCreateInfo.sType			   = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		queryPoolCreateInfo.queryType		   = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+		queryPoolCreateInfo.queryCount		   = p_frameCount;
+		queryPoolCreateInfo.pipelineStatistics = VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT | VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+
+		if ( vkCreateQueryPool( m_logicalDevice, &queryPoolCreateInfo, nullptr, &m_queryPool ) != VK_SUCCESS )
+			throw std::runtime_error( "Failed to create overdraw query pool" );
+	}
+
+	// Adds the GPU time the frame took the last time it was drawn
+	void AddGpuTime( const uint32_t& p_frame, const float& p_milliseconds )
+	{
+		if ( !m_frames[p_frame].recorded ) return;
+
+		OverdrawStats& stats = m_stats[m_frames[p_frame].prepass];
+		stats.timedFrames++;
+		stats.gpuMilliseconds += p_milliseconds;
+	}
+
+	// Reads the frame's counters from the last time it was drawn, then resets its query for this frame (Outside of any render pass, the GPU must have finished with the frame)
+	void BeginFrame( const VkCommandBuffer& p_commandBuffer, const uint32_t& p_frame, const bool& p_prepass, const uint64_t& p_pixels )
+	{
+		// Vertex then fragment invocations, in the order of their bits
+		FrameRecord& record = m_frames[p_frame];
+		uint64_t	 results[2];
+		if ( record.counted && vkGetQueryPoolResults( m_logicalDevice, m_queryPool, p_frame, 1, sizeof( results ), results, sizeof( results ), VK_QUERY_RESULT_64_BIT ) == VK_SUCCESS )
+		{
+			OverdrawStats& stats = m_stats[record.prepass];
+			stats.countedFrames++;
+			stats.vertexInvocations += results[0];
+			stats.fragmentInvocations += results[1];
+			stats.pixels += record.pixels;
+		}
+
+		record.recorded = true;
+		record.counted	= false;
+		record.prepass	= p_prepass;
+		record.pixels	= p_pixels;
+
+		if ( m_supported ) vkCmdResetQueryPool( p_commandBuffer, m_queryPool, p_frame, 1 );
+	}
+
+	// Wraps the shading subpass (A query can't span subpasses, so the pre-pass isn't counted)
+	void BeginQuery( const VkCommandBuffer& p_commandBuffer, const uint32_t& p_frame )
+	{
+		if ( m_supported ) vkCmdBeginQuery( p_commandBuffer, m_queryPool, p_frame, 0 );
+	}
+
+	void EndQuery( const VkCommandBuffer& p_commandBuffer, const uint32_t& p_frame )
+	{
+		if ( !m_supported ) return;
+
+		vkCmdEndQuery( p_commandBuffer, m_queryPool, p_frame );
+		m_frames[p_frame].counted = true;
+	}
+
+	inline const OverdrawStats& GetStats( const bool& p_prepass ) const { return m_stats[p_prepass]; }
+	inline const bool&			IsSupported() const { return m_supported; }
+
+	void Cleanup()
+	{
+		if ( m_queryPool != VK_NULL_HANDLE ) vkDestroyQueryPool( m_logicalDevice, m_queryPool, nullptr );
+	}
+};
\ No newline at end of file
@@ -0,0 +1,582 @@
+#pragma once
+
+#include "../Buffers/VertexInput.hpp"
+#include "../Jobs/JobSystem.hpp"
+#include "Shaders.hpp"
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#define PIPELINE_MAX_SPECIALIZATION_CONSTANTS 4 // Constant IDs 0 to 3, shared by every shader stage
+
+// Specialization constant IDs (Must match the constant_id layouts in the shaders)
+#define SPEC_SAMPLER_COUNT	 0 // Number of texture samplers the fragment shader can select from
+#define SPEC_LIGHT_COUNT	 1 // Most lights shaded per fragment (Zero draws unlit)
+#define SPEC_ENABLE_SPECULAR 2 // Adds a specular term to the lighting
+#define SPEC_ENABLE_SHADOWS	 3 // Samples the directional light's shadow cascades
+
+#define PIPELINE_PASS_SCENE			"scene"	   // Variants drawn in the scene's forward render pass
+#define PIPELINE_PASS_SCENE_PREPASS "prepass"  // Variants drawn in the scene's forward render pass after a depth pre-pass
+#define PIPELINE_PASS_DEFERRED		"deferred" // Variants drawn in the scene's deferred render pass
+#define PIPELINE_NO_SHADER			"-"		   // Written in place of a missing fragment shader
+
+// Layouts of the vertex data a pipeline can read
+enum class VertexLayout : uint32_t
+{
+	STANDARD, // Vertex (Position, normal, texture coordinate, and sampler ID)
+	POSITION, // Only the position of each Vertex (Depth only passes)
+	NONE	  // No vertex buffers (Fullscreen passes make their vertices in the shader)
+};
+
+// Everything that makes one pipeline variant different from another
+struct PipelineKey
+{
+	std::string pass = PIPELINE_PASS_SCENE; // Which render pass and layout the variant is made for
+	std::string vertexShader;				// Path to the compiled vertex shader
+	std::string fragmentShader;				// Path to the compiled fragment shader (Empty for depth only variants)
+
+	std::array<uint32_t, PIPELINE_MAX_SPECIALIZATION_CONSTANTS> specialization {};
+
+	VertexLayout		  vertexLayout			= VertexLayout::STANDARD;
+	VkCullModeFlags		  cullMode				= VK_CULL_MODE_NONE;
+	VkFrontFace			  frontFace				= VK_FRONT_FACE_COUNTER_CLOCKWISE;
+	VkBool32			  blendEnable			= VK_TRUE;
+	VkBool32			  depthTestEnable		= VK_TRUE;
+	VkBool32			  depthWriteEnable		= VK_TRUE;
+	VkCompareOp			  depthCompareOp		= VK_COMPARE_OP_LESS;
+	VkBool32			  depthBiasEnable		= VK_FALSE; // The bias is dynamic state, set when recording
+	VkSampleCountFlagBits sampleCount			= VK_SAMPLE_COUNT_1_BIT;
+	uint32_t			  sampleShading			= 0; // Percent of each pixel's samples shaded per fragment (Zero disables sample shading)
+	uint32_t			  colourAttachmentCount = 1; // Zero for depth only passes
+
+	VkPipelineLayout layout		= VK_NULL_HANDLE;
+	VkRenderPass	 renderPass = VK_NULL_HANDLE;
+	uint32_t		 subpass	= 0;
+
+	bool operator==( const PipelineKey& p_other ) const
+	{
+		return pass == p_other.pass && vertexShader == p_other.vertexShader && fragmentShader == p_other.fragmentShader && specialization == p_other.specialization &&
+			   vertexLayout == p_other.vertexLayout && cullMode == p_other.cullMode && frontFace == p_other.frontFace && blendEnable == p_other.blendEnable &&
+			   depthTestEnable == p_other.depthTestEnable && depthWriteEnable == p_other.depthWriteEnable && depthCompareOp == p_other.depthCompareOp &&
+			   depthBiasEnable == p_other.depthBiasEnable && sampleCount == p_other.sampleCount && sampleShading == p_other.sampleShading &&
+			   colourAttachmentCount == p_other.colourAttachmentCount && layout == p_other.layout && renderPass == p_other.renderPass && subpass == p_other.subpass;
+	}
+};
+
+static inline void HashCombine( size_t* p_seed, const size_t& p_value )
+{
+	*p_seed ^= p_value + 0x9e3779b97f4a7c15ULL + ( *p_seed << 6 ) + ( *p_seed >> 2 );
+}
+
+// Writes the parts of a key that stay the same between runs (The layout and render pass handles are left out)
+static std::string SerialiseKey( const PipelineKey& p_key )
+{
+	std::ostringstream stream;
+	stream << p_key.pass << ' ' << p_key.vertexShader << ' ' << ( p_key.fragmentShader.empty() ? PIPELINE_NO_SHADER : p_key.fragmentShader );
+	for ( const auto& value : p_key.specialization )
+		stream << ' ' << value;
+	stream << ' ' << static_cast<uint32_t>( p_key.vertexLayout ) << ' ' << p_key.cullMode << ' ' << p_key.frontFace << ' ' << p_key.blendEnable << ' ' << p_key.depthTestEnable << ' '
+		   << p_key.depthWriteEnable << ' ' << p_key.depthCompareOp << ' ' << p_key.depthBiasEnable << ' ' << p_key.sampleCount << ' ' << p_key.sampleShading << ' ' << p_key.colourAttachmentCount << ' '
+		   << p_key.subpass;
+
+	return stream.str();
+}
+
+static bool ParseKey( const std::string& p_line, PipelineKey* p_key )
+{
+	std::istringstream stream( p_line );
+	uint32_t		   vertexLayout, frontFace, depthCompareOp, sampleCount;
+
+	// Read the fields in the order they were written
+	stream >> p_key->pass >> p_key->vertexShader >> p_key->fragmentShader;
+	for ( auto& value : p_key->specialization )
+		stream >> value;
+	stream >> vertexLayout >> p_key->cullMode >> frontFace >> p_key->blendEnable >> p_key->depthTestEnable >> p_key->depthWriteEnable >> depthCompareOp >> p_key->depthBiasEnable >> sampleCount >>
+		p_key->sampleShading >> p_key->colourAttachmentCount >> p_key->subpass;
+
+	if ( p_key->fragmentShader == PIPELINE_NO_SHADER ) p_key->fragmentShader.clear();
+
+	p_key->vertexLayout	  = static_cast<VertexLayout>( vertexLayout );
+	p_key->frontFace	  = static_cast<VkFrontFace>( frontFace );
+	p_key->depthCompareOp = static_cast<VkCompareOp>( depthCompareOp );
+	p_key->sampleCount	  = static_cast<VkSampleCountFlagBits>( sampleCount );
+
+	return !stream.fail();
+}
+
+struct PipelineKeyHash
+{
+	size_t operator()( const PipelineKey& p_key ) const
+	{
+		size_t seed = 0;
+
+		// Shader set
+		HashCombine( &seed, std::hash<std::string>()( p_key.pass ) );
+		HashCombine( &seed, std::hash<std::string>()( p_key.vertexShader ) );
+		HashCombine( &seed, std::hash<std::string>()( p_key.fragmentShader ) );
+
+		// Specialization constants
+		for ( const auto& value : p_key.specialization )
+			HashCombine( &seed, value );
+
+		// Fixed function state
+		HashCombine( &seed, static_cast<size_t>( p_key.vertexLayout ) );
+		HashCombine( &seed, p_key.cullMode );
+		HashCombine( &seed, p_key.frontFace );
+		HashCombine( &seed, p_key.blendEnable );
+		HashCombine( &seed, p_key.depthTestEnable );
+		HashCombine( &seed, p_key.depthWriteEnable );
+		HashCombine( &seed, p_key.depthCompareOp );
+		HashCombine( &seed, p_key.depthBiasEnable );
+		HashCombine( &seed, p_key.sampleCount );
+		HashCombine( &seed, p_key.sampleShading );
+		HashCombine( &seed, p_key.colourAttachmentCount );
+
+		// Layout and render pass
+		HashCombine( &seed, std::hash<VkPipelineLayout>()( p_key.layout ) );
+		HashCombine( &seed, std::hash<VkRenderPass>()( p_key.renderPass ) );
+		HashCombine( &seed, p_key.subpass );
+
+		return seed;
+	}
+};
+
+struct PipelineCompileStats
+{
+	uint32_t compiled;		// Variants created
+	uint32_t failed;		// Variants that failed to compile (Their draws always use the fallback)
+	uint32_t hits;			// Lookups that found a ready variant
+	double	 totalMilliseconds;
+	double	 maxMilliseconds;
+};
+
+// Creates pipeline variants the first time they are asked for, and hands back the same pipeline for every matching key after that
+// Variants can be compiled on the job system, and every variant used is recorded so the next run can compile it ahead of time
+class PipelineCache
+{
+private:
+	VkDevice		m_logicalDevice;
+	VkPipelineCache m_driverCache; // Lets the driver reuse compiled shader code between variants (Saved between runs)
+	JobSystem*		m_jobs;
+	JobCounter		m_compiling; // Background compiles still running
+
+	std::string m_driverCachePath;
+	std::string m_precompileListPath;
+
+	std::mutex													 m_mutex; // Guards everything below (Compiles finish on worker threads)
+	std::unordered_map<PipelineKey, VkPipeline, PipelineKeyHash> m_pipelines;
+	std::unordered_set<PipelineKey, PipelineKeyHash>			 m_pending;		  // Queued or compiling in the background
+	std::unordered_map<std::string, VkShaderModule>				 m_shaderModules; // Shared by every variant that uses the shader
+	std::set<std::string>										 m_usedKeys;	  // Serialised keys of every variant asked for
+	std::vector<PipelineKey>									 m_precompileList;
+	PipelineCompileStats										 m_stats;
+
+	VkShaderModule GetShaderModule( const std::string& p_path )
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+
+		// Reuse the module if the shader has already been loaded
+		auto it = m_shaderModules.find( p_path );
+		if ( it != m_shaderModules.end() ) return it->second;
+
+		// Read the shader and create the module
+		VkShaderModule module = CreateShaderModule( ReadFile( p_path ), m_logicalDevice );
+		m_shaderModules.emplace( p_path, module );
+		return module;
+	}
+
+	static void GetVertexInput( const VertexLayout& p_layout, std::vector<VkVertexInputBindingDescription>* p_bindings, std::vector<VkVertexInputAttributeDescription>* p_attributes )
+	{
+		switch ( p_layout )
+		{
+		case VertexLayout::STANDARD:
+			*p_bindings	  = { GetVertexBindingDescription() };
+			*p_attributes = GetVertexAttributeDescriptions();
+			break;
+		case VertexLayout::POSITION:
+			*p_bindings	  = { GetVertexBindingDescription() };
+			*p_attributes = { GetVertexAttributeDescriptions()[0] }; // Position is the first attribute
+			break;
+		case VertexLayout::NONE:
+			p_bindings->clear();
+			p_attributes->clear();
+			break;
+		default: throw std::runtime_error( "Failed to find vertex layout" );
+		}
+	}
+
+	VkPipeline CreatePipeline( const PipelineKey& p_key )
+	{
+		// Every constant is 32 bits, stored one after the other
+		std::array<VkSpecializationMapEntry, PIPELINE_MAX_SPECIALIZATION_CONSTANTS> mapEntries;
+		for ( uint32_t i = 0; i < PIPELINE_MAX_SPECIALIZATION_CONSTANTS; i++ )
+			mapEntries[i] = { i, static_cast<uint32_t>( i * sizeof( uint32_t ) ), sizeof( uint32_t ) };
+
+		// Every stage gets the same constants (IDs a stage doesn't declare are ignored)
+		VkSpecializationInfo specializationInfo {};
+		specializationInfo.mapEntryCount = static_cast<uint32_t>( mapEntries.size() );
+		specializationInfo.pMapEntries	 = mapEntries.data();
+		specializationInfo.dataSize		 = sizeof( p_key.specialization );
+		specializationInfo.pData		 = p_key.specialization.data();
+
+		// Set the create info for the shader stages
+		VkPipelineShaderStageCreateInfo shaderStages[2] {};
+		shaderStages[0].sType				= VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		shaderStages[0].stage				= VK_SHADER_STAGE_VERTEX_BIT;
+		shaderStages[0].module				= GetShaderModule( p_key.vertexShader );
+		shaderStages[0].pName				= "main"; // Entry point
+		shaderStages[0].pSpecializationInfo = &specializationInfo;
+		shaderStages[1]						= shaderStages[0];
+		shaderStages[1].stage				= VK_SHADER_STAGE_FRAGMENT_BIT;
+		shaderStages[1].module				= p_key.fragmentShader.empty() ? VK_NULL_HANDLE : GetShaderModule( p_key.fragmentShader );
+
+		// Get the vertex binding and attribute descriptions
+		std::vector<VkVertexInputBindingDescription>   bindingDescriptions;
+		std::vector<VkVertexInputAttributeDescription> attributeDescriptions;
+		GetVertexInput( p_key.vertexLayout, &bindingDescriptions, &attributeDescriptions );
+
+		// Setup structure of the vertex data using create information
+		VkPipelineVertexInputStateCreateInfo vertexInputInfo {};
+		vertexInputInfo.sType							= VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+		vertexInputInfo.vertexBindingDescriptionCount	= static_cast<uint32_t>( bindingDescriptions.size() );
+		vertexInputInfo.pVertexBindingDescriptions		= bindingDescriptions.data();
+		vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>( attributeDescriptions.size() );
+		vertexInputInfo.pVertexAttributeDescriptions	= attributeDescriptions.data();
+
+		// Describe the primitive which will be drawn and if primitive restart should be enabled
+		VkPipelineInputAssemblyStateCreateInfo inputAssemblyCreateInfo {};
+		inputAssemblyCreateInfo.sType				   = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+		inputAssemblyCreateInfo.topology			   = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+		inputAssemblyCreateInfo.primitiveRestartEnable = VK_FALSE;
+
+		// One viewport and scissor, set when recording (So variants don't depend on the swapchain size)
+		VkPipelineViewportStateCreateInfo viewportStateCreateInfo {};
+		viewportStateCreateInfo.sType		  = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+		viewportStateCreateInfo.viewportCount = 1;
+		viewportStateCreateInfo.scissorCount  = 1;
+
+		// Setup the rasteriser
+		VkPipelineRasterizationStateCreateInfo rasteriserCreateInfo {};
+		rasteriserCreateInfo.sType					 = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+		rasteriserCreateInfo.depthClampEnable		 = VK_FALSE;
+		rasteriserCreateInfo.rasterizerDiscardEnable = VK_FALSE;
+		rasteriserCreateInfo.polygonMode			 = VK_POLYGON_MODE_FILL;
+		rasteriserCreateInfo.lineWidth				 = 1.0f;
+		rasteriserCreateInfo.cullMode				 = p_key.cullMode;
+		rasteriserCreateInfo.frontFace				 = p_key.frontFace;
+		rasteriserCreateInfo.depthBiasEnable		 = p_key.depthBiasEnable;
+
+		// Configure multisampling
+		VkPipelineMultisampleStateCreateInfo multisamplingCreateInfo {};
+		multisamplingCreateInfo.sType				  = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+		multisamplingCreateInfo.sampleShadingEnable	  = p_key.sampleCount != VK_SAMPLE_COUNT_1_BIT && p_key.sampleShading > 0;
+		multisamplingCreateInfo.rasterizationSamples  = p_key.sampleCount;
+		multisamplingCreateInfo.minSampleShading	  = p_key.sampleShading / 100.0f; // Closer to 1 is smoother, but shades more samples
+		multisamplingCreateInfo.pSampleMask			  = nullptr;
+		multisamplingCreateInfo.alphaToCoverageEnable = VK_FALSE;
+		multisamplingCreateInfo.alphaToOneEnable	  = VK_FALSE;
+
+		// Configure the depth test
+		VkPipelineDepthStencilStateCreateInfo depthStencilCreateInfo {};
+		depthStencilCreateInfo.sType				 = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+		depthStencilCreateInfo.depthTestEnable		 = p_key.depthTestEnable;
+		depthStencilCreateInfo.depthWriteEnable		 = p_key.depthWriteEnable;
+		depthStencilCreateInfo.depthCompareOp		 = p_key.depthCompareOp;
+		depthStencilCreateInfo.depthBoundsTestEnable = VK_FALSE;
+		depthStencilCreateInfo.minDepthBounds		 = 0.0f;
+		depthStencilCreateInfo.maxDepthBounds		 = 1.0f;
+		depthStencilCreateInfo.stencilTestEnable	 = VK_FALSE;
+
+		// Setup the colour blending stage (Per Framebuffer)
+		VkPipelineColorBlendAttachmentState colourBlendAttatchment {};
+		colourBlendAttatchment.colorWriteMask	   = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+		colourBlendAttatchment.blendEnable		   = p_key.blendEnable;
+		colourBlendAttatchment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+		colourBlendAttatchment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+		colourBlendAttatchment.colorBlendOp		   = VK_BLEND_OP_ADD;
+		colourBlendAttatchment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+		colourBlendAttatchment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+		colourBlendAttatchment.alphaBlendOp		   = VK_BLEND_OP_ADD;
+
+		VkPipelineColorBlendStateCreateInfo colourBlendCreateInfo {};
+		colourBlendCreateInfo.sType			  = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+		colourBlendCreateInfo.logicOpEnable	  = VK_FALSE;
+		colourBlendCreateInfo.logicOp		  = VK_LOGIC_OP_COPY;
+		// Every colour attachment of the subpass blends the same way
+		std::vector<VkPipelineColorBlendAttachmentState> colourBlendAttatchments( p_key.colourAttachmentCount, colourBlendAttatchment );
+
+		colourBlendCreateInfo.attachmentCount = p_key.colourAttachmentCount;
+		colourBlendCreateInfo.pAttachments	  = colourBlendAttatchments.data();
+
+		// The viewport and scissor are dynamic, and so is the depth bias when it is enabled
+		VkDynamicState dynamicStates[] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR, VK_DYNAMIC_STATE_DEPTH_BIAS };
+
+		VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo {};
+		dynamicStateCreateInfo.sType			 = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+		dynamicStateCreateInfo.dynamicStateCount = p_key.depthBiasEnable ? 3 : 2;
+		dynamicStateCreateInfo.pDynamicStates	 = dynamicStates;
+
+		// Setup the graphics pipeline create information
+		VkGraphicsPipelineCreateInfo graphicsPipelineCreateInfo {};
+		graphicsPipelineCreateInfo.sType			   = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+		graphicsPipelineCreateInfo.stageCount		   = p_key.fragmentShader.empty() ? 1 : 2; // Depth only variants have no fragment stage
+		graphicsPipelineCreateInfo.pStages			   = shaderStages;
+		graphicsPipelineCreateInfo.pVertexInputState   = &vertexInputInfo;
+		graphicsPipelineCreateInfo.pInputAssemblyState = &inputAssemblyCreateInfo;
+		graphicsPipelineCreateInfo.pViewportState	   = &viewportStateCreateInfo;
+		graphicsPipelineCreateInfo.pRasterizationState = &rasteriserCreateInfo;
+		graphicsPipelineCreateInfo.pMultisampleState   = &multisamplingCreateInfo;
+		graphicsPipelineCreateInfo.pDepthStencilState  = &depthStencilCreateInfo;
+		graphicsPipelineCreateInfo.pColorBlendState	   = &colourBlendCreateInfo;
+		graphicsPipelineCreateInfo.pDynamicState	   = &dynamicStateCreateInfo;
+		graphicsPipelineCreateInfo.layout			   = p_key.layout;
+		graphicsPipelineCreateInfo.renderPass		   = p_key.renderPass;
+		graphicsPipelineCreateInfo.subpass			   = p_key.subpass;
+		graphicsPipelineCreateInfo.basePipelineHandle  = VK_NULL_HANDLE;
+		graphicsPipelineCreateInfo.basePipelineIndex   = -1;
+
+		// Create the graphics pipeline
+		VkPipeline pipeline;
+		if ( vkCreateGraphicsPipelines( m_logicalDevice, m_driverCache, 1, &graphicsPipelineCreateInfo, nullptr, &pipeline ) != VK_SUCCESS )
+			throw std::runtime_error( "Failed to create graphics pipeline" );
+
+		return pipeline;
+	}
+
+	VkPipeline CompileVariant( const PipelineKey& p_key )
+	{
+		auto start = std::chrono::steady_clock::now();
+
+		// Failed variants are stored as null so they aren't retried every frame
+		VkPipeline pipeline = VK_NULL_HANDLE;
+		try
+		{
+			pipeline = CreatePipeline( p_key );
+		}
+		catch ( const std::exception& e )
+		{
+			std::cerr << e.what() << " (" << p_key.vertexShader << ", " << p_key.fragmentShader << ")" << std::endl;
+		}
+
+		double milliseconds = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+
+		// Store the variant (Another thread may have created the same one in the meantime)
+		std::lock_guard<std::mutex> lock( m_mutex );
+		m_pending.erase( p_key );
+
+		auto [it, inserted] = m_pipelines.emplace( p_key, pipeline );
+		if ( !inserted )
+		{
+			vkDestroyPipeline( m_logicalDevice, pipeline, nullptr );
+			return it->second;
+		}
+
+		// Record the compile time
+		if ( pipeline == VK_NULL_HANDLE )
+			m_stats.failed++;
+		else
+			m_stats.compiled++;
+		m_stats.totalMilliseconds += milliseconds;
+		m_stats.maxMilliseconds = std::max( m_stats.maxMilliseconds, milliseconds );
+
+		return pipeline;
+	}
+
+	void LoadDriverCache( std::vector<char>* p_data )
+	{
+		// Read the cache data from the last run (The driver ignores data from a different driver or device)
+		std::ifstream fs( m_driverCachePath, std::ios::binary );
+		if ( fs.is_open() ) p_data->assign( std::istreambuf_iterator<char>( fs ), std::istreambuf_iterator<char>() );
+	}
+
+	void SaveDriverCache()
+	{
+		// Get the size of the cache data, then the data
+		size_t dataSize = 0;
+		if ( vkGetPipelineCacheData( m_logicalDevice, m_driverCache, &dataSize, nullptr ) != VK_SUCCESS || dataSize == 0 ) return;
+
+		std::vector<char> data( dataSize );
+		if ( vkGetPipelineCacheData( m_logicalDevice, m_driverCache, &dataSize, data.data() ) != VK_SUCCESS ) return;
+
+		// Write it to disk
+		std::ofstream fs( m_driverCachePath, std::ios::binary | std::ios::trunc );
+		if ( fs.is_open() ) fs.write( data.data(), dataSize );
+	}
+
+	void LoadPrecompileList()
+	{
+		// Read one key per line
+		std::ifstream fs( m_precompileListPath );
+		std::string	  line;
+		while ( std::getline( fs, line ) )
+		{
+			PipelineKey key;
+			if ( ParseKey( line, &key ) ) m_precompileList.push_back( key );
+		}
+	}
+
+	void SavePrecompileList()
+	{
+		// Write every variant used this run
+		std::ofstream fs( m_precompileListPath, std::ios::trunc );
+		if ( !fs.is_open() ) return;
+
+		for ( const auto& line : m_usedKeys )
+			fs << line << '\n';
+	}
+
+public:
+	// Loads the driver cache and the list of variants to precompile from previous runs (Without a job system every compile blocks)
+	void Init( const VkDevice& p_logicalDevice, JobSystem* p_jobs, const std::string& p_driverCachePath, const std::string& p_precompileListPath )
+	{
+		m_logicalDevice		 = p_logicalDevice;
+		m_jobs				 = p_jobs;
+		m_driverCachePath	 = p_driverCachePath;
+		m_precompileListPath = p_precompileListPath;
+		m_stats				 = {};
+
+		// Create the driver cache from the last run's data
+		std::vector<char> initialData;
+		LoadDriverCache( &initialData );
+
+		VkPipelineCacheCreateInfo cacheCreateInfo {};
+		cacheCreateInfo.sType			= VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+		cacheCreateInfo.initialDataSize = initialData.size();
+		cacheCreateInfo.pInitialData	= initialData.empty() ? nullptr : initialData.data();
+
+		if ( vkCreatePipelineCache( m_logicalDevice, &cacheCreateInfo, nullptr, &m_driverCache ) != VK_SUCCESS )
+			throw std::runtime_error( "Failed to create pipeline cache" );
+
+		// Read the variants to compile ahead of time
+		LoadPrecompileList();
+	}
+
+	// Returns the pipeline for the key, creating it on this thread if no matching variant exists yet
+	VkPipeline GetPipeline( const PipelineKey& p_key )
+	{
+		{
+			std::lock_guard<std::mutex> lock( m_mutex );
+			m_usedKeys.insert( SerialiseKey( p_key ) );
+
+			// Reuse an existing variant
+			auto it = m_pipelines.find( p_key );
+			if ( it != m_pipelines.end() )
+			{
+				m_stats.hits++;
+				return it->second;
+			}
+		}
+
+		// Create the variant
+		return CompileVariant( p_key );
+	}
+
+	// Returns the pipeline for the key if it is ready, otherwise queues it to compile in the background and returns null
+	VkPipeline RequestPipeline( const PipelineKey& p_key )
+	{
+		// Without background workers the compile happens now
+		if ( m_jobs == nullptr || m_jobs->GetWorkerCount() == 0 ) return GetPipeline( p_key );
+
+		std::lock_guard<std::mutex> lock( m_mutex );
+		m_usedKeys.insert( SerialiseKey( p_key ) );
+
+		// Reuse an existing variant
+		auto it = m_pipelines.find( p_key );
+		if ( it != m_pipelines.end() )
+		{
+			m_stats.hits++;
+			return it->second;
+		}
+
+		// Queue the compile, unless it already is
+		if ( m_pending.insert( p_key ).second )
+			m_jobs->RunBackground( [this, p_key]() { CompileVariant( p_key ); }, &m_compiling );
+
+		return VK_NULL_HANDLE;
+	}
+
+	// Queues every variant of the pass recorded by previous runs, made with the given layout and render pass (Only those matching its sample count are compatible)
+	void Precompile( const std::string& p_pass, const VkSampleCountFlagBits& p_sampleCount, const VkPipelineLayout& p_layout, const VkRenderPass& p_renderPass )
+	{
+		for ( auto key : m_precompileList )
+		{
+			if ( key.pass != p_pass || key.sampleCount != p_sampleCount ) continue;
+
+			key.layout	   = p_layout;
+			key.renderPass = p_renderPass;
+
+			// Not recorded as used, so variants that are no longer asked for drop out of the list
+			std::unique_lock<std::mutex> lock( m_mutex );
+			if ( m_pipelines.find( key ) != m_pipelines.end() || !m_pending.insert( key ).second ) continue;
+
+			// Without background workers the compile happens now
+			if ( m_jobs == nullptr || m_jobs->GetWorkerCount() == 0 )
+			{
+				lock.unlock();
+				CompileVariant( key );
+			}
+			else
+				m_jobs->RunBackground( [this, key]() { CompileVariant( key ); }, &m_compiling );
+		}
+	}
+
+	// Blocks until every background compile has finished
+	void WaitForCompiles()
+	{
+		if ( m_jobs != nullptr ) m_jobs->Wait( m_compiling );
+	}
+
+	inline uint32_t GetVariantCount()
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+		return static_cast<uint32_t>( m_pipelines.size() );
+	}
+
+	inline PipelineCompileStats GetStats()
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+		return m_stats;
+	}
+
+	// Destroys every variant (Needed when the render passes or layouts they were made with are destroyed)
+	void Clear()
+	{
+		// Let the background compiles finish first, they use the render pass
+		WaitForCompiles();
+
+		for ( const auto& [key, pipeline] : m_pipelines )
+			vkDestroyPipeline( m_logicalDevice, pipeline, nullptr );
+		m_pipelines.clear();
+	}
+
+	void Cleanup()
+	{
+		// Destroy the variants
+		Clear();
+
+		// Save the driver cache and the variants used for the next run
+		SaveDriverCache();
+		SavePrecompileList();
+
+		// Destroy the shader modules
+		for ( const auto& [path, module] : m_shaderModules )
+			vkDestroyShaderModule( m_logicalDevice, module, nullptr );
+		m_shaderModules.clear();
+
+		// Destroy the driver cache
+		vkDestroyPipelineCache( m_logicalDevice, m_driverCache, nullptr );
+	}
+};
\ No newline at end of file
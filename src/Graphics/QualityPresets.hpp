@@ -0,0 +1,68 @@
+#pragma once
+
+#include "../VulkanUtil/Config.hpp"
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#define QUALITY_PRESET_COUNT 4
+
+enum class QualityPreset : uint32_t
+{
+	LOW,
+	MEDIUM,
+	HIGH,
+	CUSTOM // Medium, with any of the ENGINE_QUALITY_* settings replacing its values
+};
+
+// Everything a preset controls
+struct QualitySettings
+{
+	uint32_t msaaSamples;	  // Requested sample count, lowered to what the device supports (The deferred path isn't multisampled)
+	float	 sampleShading;	  // Fraction of each pixel's samples shaded per fragment (Zero disables sample shading)
+	float	 anisotropy;	  // Most texture anisotropy, lowered to the device's limit (One disables it)
+	float	 lodBias;		  // Added to the texture mip level (Positive is blurrier, but reads less memory)
+	float	 resolutionScale; // Largest fraction of the swapchain's size the scene is rendered at
+};
+
+// The GPU time measured while a preset was in use
+struct QualityCost
+{
+	uint32_t frames			  = 0;
+	double	 totalMilliseconds = 0.0;
+};
+
+static const std::array<const char*, QUALITY_PRESET_COUNT> QUALITY_PRESET_NAMES = { "low", "medium", "high", "custom" };
+
+static QualityPreset ParseQualityPreset( const std::string& p_name )
+{
+	// Match the name to a preset
+	for ( uint32_t i = 0; i < QUALITY_PRESET_COUNT; i++ )
+		if ( p_name == QUALITY_PRESET_NAMES[i] ) return static_cast<QualityPreset>( i );
+
+	throw std::runtime_error( "Unknown quality preset \"" + p_name + "\" (Expected low, medium, high or custom)" );
+}
+
+static QualitySettings GetQualitySettings( const QualityPreset& p_preset )
+{
+	// MSAA, sample shading, anisotropy, LOD bias, resolution scale
+	switch ( p_preset )
+	{
+		case QualityPreset::LOW: return { 1, 0.0f, 1.0f, 0.5f, 0.75f };
+		case QualityPreset::MEDIUM: return { 4, 0.0f, 4.0f, 0.0f, 1.0f };
+		case QualityPreset::HIGH: return { 8, 0.25f, 16.0f, 0.0f, 1.0f };
+		case QualityPreset::CUSTOM: break;
+	}
+
+	// Start from medium, replacing whichever values are set
+	QualitySettings settings = GetQualitySettings( QualityPreset::MEDIUM );
+	settings.msaaSamples	 = static_cast<uint32_t>( GetConfigFloat( "ENGINE_QUALITY_MSAA", static_cast<float>( settings.msaaSamples ) ) );
+	settings.sampleShading	 = GetConfigFloat( "ENGINE_QUALITY_SAMPLE_SHADING", settings.sampleShading );
+	settings.anisotropy		 = GetConfigFloat( "ENGINE_QUALITY_ANISOTROPY", settings.anisotropy );
+	settings.lodBias		 = GetConfigFloat( "ENGINE_QUALITY_LOD_BIAS", settings.lodBias );
+	settings.resolutionScale = GetConfigFloat( "ENGINE_QUALITY_RESOLUTION_SCALE", settings.resolutionScale );
+
+	return settings;
+}
\ No newline at end of file
@@ -0,0 +1,585 @@
+#pragma once
+
+#include "../Buffers/Buffers.hpp"
+#include "../VulkanUtil/ImageView.hpp"
+#include "Barriers.hpp"
+#include "Images.hpp"
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+typedef uint32_t RenderGraphResource;
+
+// An image the graph creates, and only keeps for the passes that use it within a frame
+struct RenderGraphImageDesc
+{
+	VkFormat			  format;
+	VkExtent2D			  extent;
+	VkSampleCountFlagBits samples;
+	VkImageAspectFlags	  aspect;
+	VkImageUsageFlags	  extraUsage = 0; // Uses within a pass the graph can't see (Such as input attachments)
+};
+
+// What the last compile produced
+struct RenderGraphStats
+{
+	uint32_t	 passes			 = 0;
+	uint32_t	 culledPasses	 = 0;
+	uint32_t	 barriers		 = 0; // Recorded per frame
+	uint32_t	 transientImages = 0;
+	uint32_t	 allocations	 = 0; // Memory shared by the transient images
+	VkDeviceSize requestedBytes	 = 0; // Every transient image with its own memory
+	VkDeviceSize allocatedBytes	 = 0; // With images whose lifetimes don't overlap sharing memory
+};
+
+// Orders a frame's passes by the resources they declare reading and writing
+// Compiling culls the passes nothing needed depends on, works out the fewest barriers and layout transitions between the rest, and lets transient images whose lifetimes don't overlap share memory
+// Passes still synchronise whatever they do within themselves (Such as between subpasses), the graph only sees what they start and finish with
+class RenderGraph
+{
+public:
+	typedef std::function<void( const VkCommandBuffer& )> RecordCallback;
+
+private:
+	struct Resource
+	{
+		std::string				name;
+		bool					imported;
+		bool					buffer;
+		bool					output; // Kept, along with every pass it depends on
+		RenderGraphImageDesc	desc;
+		VkImageSubresourceRange range;
+		VkImage					image;
+		VkBuffer				bufferHandle;
+		VkImageView				view;
+		ResourceUsage			initialUsage, finalUsage; // Imported only, what the resource is left in between frames
+		ResourceUsage			lastUsage;				  // Transient only, what the last pass to use it leaves it in
+		uint32_t				firstPass, lastPass;
+		uint32_t				slot;
+		VkMemoryRequirements	requirements;
+		VkMemoryPropertyFlags	properties;
+	};
+
+	struct Access
+	{
+		RenderGraphResource resource;
+		ResourceUsage		usage;
+		ResourceUsage		endUsage; // What the pass leaves it in (Passes that transition within themselves)
+		bool				write;
+		bool				discard;  // The previous contents don't matter
+	};
+
+	struct Pass
+	{
+		std::string			name;
+		std::vector<Access> accesses;
+		RecordCallback		record;
+		bool				culled;
+	};
+
+	struct Barrier
+	{
+		RenderGraphResource	 resource;
+		VkImageLayout		 oldLayout, newLayout;
+		VkPipelineStageFlags srcStages, dstStages;
+		VkAccessFlags		 srcAccess, dstAccess;
+	};
+
+	// Memory shared by transient images that are never alive at once
+	struct Slot
+	{
+		VkDeviceMemory					 memory;
+		VkDeviceSize					 size;
+		uint32_t						 memoryTypeBits;
+		VkMemoryPropertyFlags			 properties;
+		uint32_t						 lastPass;
+		std::vector<RenderGraphResource> occupants; // In the order they use it
+	};
+
+	// Where a resource is up to while the barriers are worked out
+	struct TrackedState
+	{
+		VkImageLayout		 layout;
+		VkPipelineStageFlags writeStages, readStages; // Of the last write, and of the reads since
+		VkAccessFlags		 writeAccess;			  // Of the last write
+		VkPipelineStageFlags visibleStages;			  // Have seen the last write
+		VkAccessFlags		 visibleAccess;
+	};
+
+	VkDevice		 m_logicalDevice;
+	VkPhysicalDevice m_physicalDevice;
+
+	std::vector<Resource>			  m_resources;
+	std::vector<Pass>				  m_passes;
+	std::vector<Slot>				  m_slots;
+	std::vector<std::vector<Barrier>> m_passBarriers;  // Recorded before each pass
+	std::vector<Barrier>			  m_finalBarriers; // Recorded after the last pass, leaving the imported resources as the next frame expects
+	bool							  m_compiled;
+	RenderGraphStats				  m_stats;
+
+	RenderGraphResource AddResource( const std::string& p_name, const bool& p_imported, const bool& p_buffer )
+	{
+		if ( m_compiled ) throw std::runtime_error( "Failed to add render graph resource \"" + p_name + "\", the graph is already compiled" );
+
+		Resource resource {};
+		resource.name		  = p_name;
+		resource.imported	  = p_imported;
+		resource.buffer		  = p_buffer;
+		resource.output		  = false;
+		resource.image		  = VK_NULL_HANDLE;
+		resource.bufferHandle = VK_NULL_HANDLE;
+		resource.view		  = VK_NULL_HANDLE;
+		resource.initialUsage = ResourceUsage::UNDEFINED;
+		resource.finalUsage	  = ResourceUsage::UNDEFINED;
+		resource.lastUsage	  = ResourceUsage::UNDEFINED;
+		resource.firstPass	  = UINT32_MAX;
+		resource.lastPass	  = 0;
+		resource.slot		  = UINT32_MAX;
+		m_resources.push_back( resource );
+
+		return static_cast<RenderGraphResource>( m_resources.size() - 1 );
+	}
+
+	void AddAccess( const uint32_t& p_pass, const RenderGraphResource& p_resource, const ResourceUsage& p_usage, const ResourceUsage& p_endUsage, const bool& p_write, const bool& p_discard )
+	{
+		if ( m_compiled ) throw std::runtime_error( "Failed to add render graph access, the graph is already compiled" );
+		if ( p_pass >= m_passes.size() || p_resource >= m_resources.size() ) throw std::invalid_argument( "Unknown render graph pass or resource" );
+
+		m_passes[p_pass].accesses.push_back( { p_resource, p_usage, p_endUsage, p_write, p_discard } );
+	}
+
+	void CullPasses()
+	{
+		// Walk back from the outputs, keeping every pass that writes something a kept pass (Or the frame) needs
+		std::vector<bool> needed( m_resources.size(), false );
+		for ( size_t i = 0; i < m_resources.size(); i++ )
+			needed[i] = m_resources[i].output;
+
+		for ( size_t i = m_passes.size(); i-- > 0; )
+		{
+			Pass& pass = m_passes[i];
+			pass.culled = true;
+			for ( const Access& access : pass.accesses )
+				if ( access.write && needed[access.resource] ) pass.culled = false;
+
+			if ( pass.culled )
+			{
+				m_stats.culledPasses++;
+				continue;
+			}
+
+			// Passes before this one only matter for what it doesn't overwrite
+			for ( const Access& access : pass.accesses )
+				if ( access.discard ) needed[access.resource] = false;
+
+			// Everything the pass reads is needed, as is anything it writes without discarding (It keeps what was there)
+			for ( const Access& access : pass.accesses )
+				if ( !access.discard ) needed[access.resource] = true;
+		}
+	}
+
+	void FindLifetimes()
+	{
+		// The first and last kept pass to use each resource
+		for ( uint32_t i = 0; i < m_passes.size(); i++ )
+		{
+			if ( m_passes[i].culled ) continue;
+
+			for ( const Access& access : m_passes[i].accesses )
+			{
+				Resource& resource = m_resources[access.resource];
+				resource.firstPass = std::min( resource.firstPass, i );
+				resource.lastPass  = std::max( resource.lastPass, i );
+				resource.lastUsage = access.endUsage;
+			}
+		}
+	}
+
+	void CreateTransientImages()
+	{
+		VkMemoryPropertyFlags lazyProperties = GetTransientMemoryProperties( m_physicalDevice );
+
+		// Transient images in the order they are first used
+		std::vector<RenderGraphResource> order;
+		for ( RenderGraphResource i = 0; i < m_resources.size(); i++ )
+			if ( !m_resources[i].imported && m_resources[i].firstPass != UINT32_MAX ) order.push_back( i );
+		std::stable_sort( order.begin(), order.end(), [this]( const RenderGraphResource& a, const RenderGraphResource& b ) { return m_resources[a].firstPass < m_resources[b].firstPass; } );
+
+		for ( const RenderGraphResource& index : order )
+		{
+			Resource& resource = m_resources[index];
+
+			// Gather the image usage from every access, images only ever used as attachments can be transient attachments
+			VkImageUsageFlags usage		 = resource.desc.extraUsage;
+			bool			  attachment = true;
+			for ( const Pass& pass : m_passes )
+			{
+				if ( pass.culled ) continue;
+
+				for ( const Access& access : pass.accesses )
+				{
+					if ( access.resource != index ) continue;
+
+					usage |= GetImageUsageFlags( access.usage ) | GetImageUsageFlags( access.endUsage );
+					attachment &= access.usage == ResourceUsage::COLOUR_ATTACHMENT || access.usage == ResourceUsage::DEPTH_ATTACHMENT;
+				}
+			}
+			attachment &= ( usage & ~( VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT ) ) == 0;
+			if ( attachment ) usage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+
+			VkImageCreateInfo imageCreateInfo {};
+			imageCreateInfo.sType		  = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+			imageCreateInfo.imageType	  = VK_IMAGE_TYPE_2D;
+			imageCreateInfo.extent		  = { resource.desc.extent.width, resource.desc.extent.height, 1 };
+			imageCreateInfo.mipLevels	  = 1;
+			imageCreateInfo.arrayLayers	  = 1;
+			imageCreateInfo.format		  = resource.desc.format;
+			imageCreateInfo.tiling		  = VK_IMAGE_TILING_OPTIMAL;
+			imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			imageCreateInfo.usage		  = usage;
+			imageCreateInfo.sharingMode	  = VK_SHARING_MODE_EXCLUSIVE;
+			imageCreateInfo.samples		  = resource.desc.samples;
+
+			if ( vkCreateImage( m_logicalDevice, &imageCreateInfo, nullptr, &resource.image ) != VK_SUCCESS )
+				throw std::runtime_error( "Failed to create render graph image \"" + resource.name + "\"" );
+
+			vkGetImageMemoryRequirements( m_logicalDevice, resource.image, &resource.requirements );
+			resource.properties = attachment ? lazyProperties : VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+			// Share the memory of an image whose last pass is over, picking the closest in size
+			VkDeviceSize size			= resource.requirements.size;
+			auto		 sizeDifference = [&]( const Slot& p_slot ) { return p_slot.size > size ? p_slot.size - size : size - p_slot.size; };
+
+			uint32_t best = UINT32_MAX;
+			for ( uint32_t i = 0; i < m_slots.size(); i++ )
+			{
+				const Slot& slot = m_slots[i];
+				if ( slot.lastPass >= resource.firstPass || slot.properties != resource.properties || !( slot.memoryTypeBits & resource.requirements.memoryTypeBits ) ) continue;
+
+				if ( best == UINT32_MAX || sizeDifference( slot ) < sizeDifference( m_slots[best] ) ) best = i;
+			}
+
+			if ( best == UINT32_MAX )
+			{
+				m_slots.push_back( { VK_NULL_HANDLE, 0, resource.requirements.memoryTypeBits, resource.properties, 0, {} } );
+				best = static_cast<uint32_t>( m_slots.size() - 1 );
+			}
+
+			// Every image starts at the beginning of its slot, so the slot only has to be as big as the biggest
+			Slot& slot = m_slots[best];
+			slot.memoryTypeBits &= resource.requirements.memoryTypeBits;
+			slot.size	  = std::max( slot.size, size );
+			slot.lastPass = resource.lastPass;
+			resource.slot = best;
+			slot.occupants.push_back( index );
+
+			m_stats.transientImages++;
+			m_stats.requestedBytes += size;
+		}
+
+		// Allocate each slot, then bind its images and create their views
+		for ( Slot& slot : m_slots )
+		{
+			VkMemoryAllocateInfo allocateInfo {};
+			allocateInfo.sType			 = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+			allocateInfo.allocationSize	 = slot.size;
+			allocateInfo.memoryTypeIndex = FindMemoryType( m_physicalDevice, slot.memoryTypeBits, slot.properties );
+
+			if ( AllocateDeviceMemory( m_logicalDevice, allocateInfo, MemoryTag::ATTACHMENT, &slot.memory ) != VK_SUCCESS )
+				throw std::runtime_error( "Failed to allocate render graph memory" );
+
+			for ( const RenderGraphResource& index : slot.occupants )
+			{
+				Resource& resource = m_resources[index];
+				vkBindImageMemory( m_logicalDevice, resource.image, slot.memory, 0 );
+				resource.view = CreateImageView( m_logicalDevice, resource.image, resource.desc.format, resource.desc.aspect, 1 );
+			}
+
+			m_stats.allocations++;
+			m_stats.allocatedBytes += slot.size;
+		}
+	}
+
+	TrackedState GetInitialState( const RenderGraphResource& p_index ) const
+	{
+		// Imported resources are in whatever the last frame left them in
+		// Transient images start undefined, but have to wait for whatever last used their memory (The previous occupant, or the last one from the frame before)
+		const Resource& resource = m_resources[p_index];
+		ResourceUsage	previous = resource.initialUsage;
+		if ( !resource.imported )
+		{
+			const std::vector<RenderGraphResource>& occupants = m_slots[resource.slot].occupants;
+
+			size_t position = std::find( occupants.begin(), occupants.end(), p_index ) - occupants.begin();
+			previous		= m_resources[occupants[position == 0 ? occupants.size() - 1 : position - 1]].lastUsage;
+		}
+
+		ResourceState state = GetResourceState( previous );
+		TrackedState  tracked {};
+		tracked.layout		  = resource.imported ? state.layout : VK_IMAGE_LAYOUT_UNDEFINED;
+		tracked.writeStages	  = state.write ? state.stages : 0;
+		tracked.writeAccess	  = state.access & BARRIER_WRITE_ACCESS;
+		tracked.readStages	  = state.write ? 0 : state.stages;
+		tracked.visibleStages = state.stages;
+		tracked.visibleAccess = state.access;
+		return tracked;
+	}
+
+	// Moves a resource on to its next use, adding a barrier if the use needs one
+	void Transition( const RenderGraphResource& p_index, TrackedState* p_state, const ResourceUsage& p_usage, const bool& p_write, const bool& p_discard, std::vector<Barrier>* p_barriers )
+	{
+		const Resource& resource = m_resources[p_index];
+		ResourceState	next	 = GetResourceState( p_usage );
+		VkImageLayout	layout	 = resource.buffer ? VK_IMAGE_LAYOUT_UNDEFINED : next.layout;
+		bool			relayout = !resource.buffer && ( p_discard || p_state->layout != layout );
+
+		// Reads in the same layout only wait if the last write hasn't been made visible to them yet
+		if ( !p_write && !relayout )
+		{
+			if ( p_state->writeStages != 0 && ( ( next.stages & ~p_state->visibleStages ) != 0 || ( next.access & ~p_state->visibleAccess ) != 0 ) )
+			{
+				p_barriers->push_back( { p_index, layout, layout, p_state->writeStages, next.stages, p_state->writeAccess, next.access } );
+				p_state->visibleStages |= next.stages;
+				p_state->visibleAccess |= next.access;
+			}
+			p_state->readStages |= next.stages;
+			return;
+		}
+
+		// Writes and layout changes wait for every read and write since the last one
+		VkPipelineStageFlags srcStages = p_state->writeStages | p_state->readStages;
+		p_barriers->push_back( { p_index, p_discard ? VK_IMAGE_LAYOUT_UNDEFINED : p_state->layout, layout, srcStages ? srcStages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, next.stages,
+								 p_state->writeAccess, next.access } );
+
+		p_state->layout		   = layout;
+		p_state->writeStages   = p_write ? next.stages : 0;
+		p_state->writeAccess   = p_write ? next.access & BARRIER_WRITE_ACCESS : 0;
+		p_state->readStages	   = p_write ? 0 : next.stages;
+		p_state->visibleStages = next.stages;
+		p_state->visibleAccess = next.access;
+	}
+
+	void PlanBarriers()
+	{
+		std::vector<TrackedState> states( m_resources.size() );
+		for ( RenderGraphResource i = 0; i < m_resources.size(); i++ )
+			if ( m_resources[i].imported || m_resources[i].firstPass != UINT32_MAX ) states[i] = GetInitialState( i );
+
+		m_passBarriers.assign( m_passes.size(), {} );
+		for ( size_t i = 0; i < m_passes.size(); i++ )
+		{
+			if ( m_passes[i].culled ) continue;
+
+			for ( const Access& access : m_passes[i].accesses )
+				Transition( access.resource, &states[access.resource], access.usage, access.write, access.discard, &m_passBarriers[i] );
+
+			// Passes that transition within themselves leave the resource as if they had last written it in its end use
+			for ( const Access& access : m_passes[i].accesses )
+			{
+				if ( access.endUsage == access.usage ) continue;
+
+				ResourceState end	= GetResourceState( access.endUsage );
+				TrackedState& state = states[access.resource];
+
+				state.layout		= m_resources[access.resource].buffer ? VK_IMAGE_LAYOUT_UNDEFINED : end.layout;
+				state.writeStages	= end.stages;
+				state.writeAccess	= end.access & BARRIER_WRITE_ACCESS;
+				state.readStages	= 0;
+				state.visibleStages = end.stages;
+				state.visibleAccess = end.access;
+			}
+
+			m_stats.barriers += static_cast<uint32_t>( m_passBarriers[i].size() );
+		}
+
+		// Leave the imported resources as the next frame expects them
+		m_finalBarriers.clear();
+		for ( RenderGraphResource i = 0; i < m_resources.size(); i++ )
+			if ( m_resources[i].imported ) Transition( i, &states[i], m_resources[i].finalUsage, false, false, &m_finalBarriers );
+		m_stats.barriers += static_cast<uint32_t>( m_finalBarriers.size() );
+	}
+
+	void RecordBarriers( const VkCommandBuffer& p_commandBuffer, const std::vector<Barrier>& p_barriers ) const
+	{
+		if ( p_barriers.empty() ) return;
+
+		// Merge every barrier into one call
+		std::vector<VkImageMemoryBarrier>  imageBarriers;
+		std::vector<VkBufferMemoryBarrier> bufferBarriers;
+		VkPipelineStageFlags			   srcStages = 0, dstStages = 0;
+		for ( const Barrier& barrier : p_barriers )
+		{
+			const Resource& resource = m_resources[barrier.resource];
+			srcStages |= barrier.srcStages;
+			dstStages |= barrier.dstStages;
+
+			if ( resource.buffer )
+			{
+				VkBufferMemoryBarrier bufferBarrier {};
+				bufferBarrier.sType				  = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+				bufferBarrier.srcAccessMask		  = barrier.srcAccess;
+				bufferBarrier.dstAccessMask		  = barrier.dstAccess;
+				bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				bufferBarrier.buffer			  = resource.bufferHandle;
+				bufferBarrier.offset			  = 0;
+				bufferBarrier.size				  = VK_WHOLE_SIZE;
+				bufferBarriers.push_back( bufferBarrier );
+				continue;
+			}
+
+			VkImageMemoryBarrier imageBarrier {};
+			imageBarrier.sType				 = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			imageBarrier.srcAccessMask		 = barrier.srcAccess;
+			imageBarrier.dstAccessMask		 = barrier.dstAccess;
+			imageBarrier.oldLayout			 = barrier.oldLayout;
+			imageBarrier.newLayout			 = barrier.newLayout;
+			imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			imageBarrier.image				 = resource.image;
+			imageBarrier.subresourceRange	 = resource.range;
+			imageBarriers.push_back( imageBarrier );
+		}
+
+		vkCmdPipelineBarrier( p_commandBuffer, srcStages, dstStages, 0, 0, nullptr, static_cast<uint32_t>( bufferBarriers.size() ), bufferBarriers.data(),
+							  static_cast<uint32_t>( imageBarriers.size() ), imageBarriers.data() );
+	}
+
+public:
+	RenderGraph() : m_logicalDevice( VK_NULL_HANDLE ), m_physicalDevice( VK_NULL_HANDLE ), m_compiled( false ) {}
+
+	void Init( const VkDevice& p_logicalDevice, const VkPhysicalDevice& p_physicalDevice )
+	{
+		m_logicalDevice	 = p_logicalDevice;
+		m_physicalDevice = p_physicalDevice;
+		m_compiled		 = false;
+	}
+
+	// An image the graph doesn't own, p_initialUsage is what it is in when the frame starts and p_finalUsage what it has to be left in
+	RenderGraphResource ImportImage( const std::string& p_name, const VkImage& p_image, const VkImageView& p_view, const VkImageSubresourceRange& p_range, const ResourceUsage& p_initialUsage,
+									 const ResourceUsage& p_finalUsage )
+	{
+		RenderGraphResource index = AddResource( p_name, true, false );
+
+		m_resources[index].image		= p_image;
+		m_resources[index].view			= p_view;
+		m_resources[index].range		= p_range;
+		m_resources[index].initialUsage = p_initialUsage;
+		m_resources[index].finalUsage	= p_finalUsage;
+
+		return index;
+	}
+
+	RenderGraphResource ImportBuffer( const std::string& p_name, const VkBuffer& p_buffer, const ResourceUsage& p_initialUsage, const ResourceUsage& p_finalUsage )
+	{
+		RenderGraphResource index = AddResource( p_name, true, true );
+
+		m_resources[index].bufferHandle = p_buffer;
+		m_resources[index].initialUsage = p_initialUsage;
+		m_resources[index].finalUsage	= p_finalUsage;
+
+		return index;
+	}
+
+	// Swaps the image behind an imported resource, such as the swapchain image acquired for the frame (The barriers stay the same)
+	void SetImportedImage( const RenderGraphResource& p_resource, const VkImage& p_image, const VkImageView& p_view )
+	{
+		m_resources[p_resource].image = p_image;
+		m_resources[p_resource].view  = p_view;
+	}
+
+	void SetImportedBuffer( const RenderGraphResource& p_resource, const VkBuffer& p_buffer ) { m_resources[p_resource].bufferHandle = p_buffer; }
+
+	RenderGraphResource CreateImage( const std::string& p_name, const RenderGraphImageDesc& p_desc )
+	{
+		RenderGraphResource index = AddResource( p_name, false, false );
+
+		m_resources[index].desc	 = p_desc;
+		m_resources[index].range = { p_desc.aspect, 0, 1, 0, 1 };
+
+		return index;
+	}
+
+	// Something outside of the graph needs the resource at the end of the frame
+	void MarkOutput( const RenderGraphResource& p_resource ) { m_resources[p_resource].output = true; }
+
+	// Passes run in the order they are added
+	uint32_t AddPass( const std::string& p_name, const RecordCallback& p_record )
+	{
+		if ( m_compiled ) throw std::runtime_error( "Failed to add render graph pass \"" + p_name + "\", the graph is already compiled" );
+
+		m_passes.push_back( { p_name, {}, p_record, false } );
+		return static_cast<uint32_t>( m_passes.size() - 1 );
+	}
+
+	void Read( const uint32_t& p_pass, const RenderGraphResource& p_resource, const ResourceUsage& p_usage ) { AddAccess( p_pass, p_resource, p_usage, p_usage, false, false ); }
+
+	// p_discard when the pass overwrites everything without reading it (Such as clearing)
+	void Write( const uint32_t& p_pass, const RenderGraphResource& p_resource, const ResourceUsage& p_usage, const bool& p_discard = false )
+	{
+		AddAccess( p_pass, p_resource, p_usage, p_usage, true, p_discard );
+	}
+
+	// For a pass that starts with the resource in one use and transitions it to another itself
+	void Write( const uint32_t& p_pass, const RenderGraphResource& p_resource, const ResourceUsage& p_usage, const ResourceUsage& p_endUsage, const bool& p_discard )
+	{
+		AddAccess( p_pass, p_resource, p_usage, p_endUsage, true, p_discard );
+	}
+
+	void Compile()
+	{
+		m_stats		   = {};
+		m_stats.passes = static_cast<uint32_t>( m_passes.size() );
+
+		CullPasses();
+		FindLifetimes();
+		CreateTransientImages();
+		PlanBarriers();
+
+		m_compiled = true;
+	}
+
+	void Execute( const VkCommandBuffer& p_commandBuffer ) const
+	{
+		for ( size_t i = 0; i < m_passes.size(); i++ )
+		{
+			if ( m_passes[i].culled ) continue;
+
+			RecordBarriers( p_commandBuffer, m_passBarriers[i] );
+			m_passes[i].record( p_commandBuffer );
+		}
+
+		RecordBarriers( p_commandBuffer, m_finalBarriers );
+	}
+
+	inline const VkImageView&	   GetImageView( const RenderGraphResource& p_resource ) const { return m_resources[p_resource].view; }
+	inline const RenderGraphStats& GetStats() const { return m_stats; }
+
+	// Destroys the transient images and forgets every pass and resource, ready to build the graph again
+	void Cleanup()
+	{
+		for ( Resource& resource : m_resources )
+		{
+			if ( resource.imported || resource.image == VK_NULL_HANDLE ) continue;
+
+			vkDestroyImageView( m_logicalDevice, resource.view, nullptr );
+			vkDestroyImage( m_logicalDevice, resource.image, nullptr );
+		}
+
+		for ( Slot& slot : m_slots )
+			FreeDeviceMemory( m_logicalDevice, slot.memory );
+
+		m_resources.clear();
+		m_passes.clear();
+		m_slots.clear();
+		m_passBarriers.clear();
+		m_finalBarriers.clear();
+		m_compiled = false;
+	}
+};
\ No newline at end of file
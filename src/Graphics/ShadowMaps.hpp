@@ -0,0 +1,502 @@
+#pragma once
+
+#include "../Buffers/Buffers.hpp"
+#include "../Buffers/CommandBuffer.hpp"
+#include "../VulkanUtil/ImageView.hpp"
+#include "../VulkanUtil/ObjectCache.hpp"
+#include "Barriers.hpp"
+#include "Bounds.hpp"
+#include "Images.hpp"
+#include "Light.hpp"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <stdexcept>
+#include <vector>
+
+#define SHADOW_CASCADE_COUNT 4	  // Must match the size of the cascade arrays in the fragment shader
+#define SHADOW_MAP_SIZE		 2048 // Width and height of each cascade in texels
+
+#define SHADOW_DISTANCE		   50.0f // Distance from the camera the last cascade ends at
+#define SHADOW_SPLIT_LAMBDA	   0.75f // Blend between logarithmic (One) and uniform (Zero) cascade splits
+#define SHADOW_CASCADE_SLACK   0.25f // Extra cascade size, the camera can move this fraction of a cascade before its static casters are rendered again
+#define SHADOW_CASTER_DISTANCE 50.0f // How far towards the light from a cascade casters are still caught
+#define SHADOW_LIGHT_THRESHOLD 0.9999f // Cosine of the angle the light has to turn through before the static casters are rendered again
+
+#define SHADOW_DEPTH_BIAS_CONSTANT 1.25f
+#define SHADOW_DEPTH_BIAS_SLOPE	   1.75f
+
+#define SHADOW_PIPELINE_PASS "shadow" // Pipeline cache pass of the shadow variants
+
+// The directional light and its cascades as the fragment shader reads them
+struct ShadowUniformBufferObject
+{
+	alignas( 16 ) glm::mat4 viewToShadow[SHADOW_CASCADE_COUNT]; // From the camera's view space to each cascade's shadow map
+	alignas( 16 ) glm::vec4 splits;								// Distance from the camera each cascade ends at
+	alignas( 16 ) glm::vec4 lightDirection;						// View space, towards the light
+	alignas( 16 ) glm::vec4 lightColour;
+};
+
+// Cascaded shadow maps for a directional light
+// Each cascade keeps a cached layer of the static casters, which is only rendered again when the light turns or the cascade has to move
+// A cascade with dynamic casters has its cached layer copied into the sampled map and only the dynamic casters drawn on top, the others keep what the map already holds
+class ShadowCascades
+{
+public:
+	typedef std::function<void( const VkCommandBuffer& )> DrawCallback;
+	typedef std::function<bool( const Frustum& )>		  CasterTest; // Whether any dynamic caster is inside the region
+
+private:
+	struct Cascade
+	{
+		glm::mat4	  viewProjection; // Light view projection the layers are rendered with
+		glm::vec3	  centre;		  // Light space centre of the region the cascade covers (Snapped to whole texels)
+		float		  extent;		  // Half the width of the region
+		bool		  staticValid;	  // The static layer matches the cascade
+		bool		  shadowStatic;	  // The sampled layer holds just the static layer (No dynamic casters drawn over it since the copy)
+		VkImageView	  staticView, shadowView;
+		VkFramebuffer staticFramebuffer, dynamicFramebuffer;
+	};
+
+	struct FrameBuffer
+	{
+		VkBuffer				   buffer;
+		VkDeviceMemory			   memory;
+		ShadowUniformBufferObject* mapped;
+	};
+
+	VkDevice	 m_logicalDevice;
+	VkFormat	 m_format;
+	ObjectCache* m_objects; // Owns the sampler, the render passes and the pipeline layout
+
+	// The sampled shadow map, and the cached static casters, one layer per cascade
+	VkImage		   m_shadowImage, m_staticImage;
+	VkDeviceMemory m_shadowMemory, m_staticMemory;
+	VkImageView	   m_shadowArrayView;
+	VkSampler	   m_sampler;
+
+	// Both passes only have a depth attachment, so they are compatible and share pipelines
+	VkRenderPass	 m_staticRenderPass;  // Clears the static layer, then leaves it ready to copy from
+	VkRenderPass	 m_dynamicRenderPass; // Loads the copied static casters, then leaves the map as a depth attachment
+	VkPipelineLayout m_pipelineLayout;	  // The light view projection is a push constant
+
+	std::array<Cascade, SHADOW_CASCADE_COUNT> m_cascades;
+	float									  m_splits[SHADOW_CASCADE_COUNT];
+	glm::vec3								  m_lightDirection; // Direction the light view was built with
+	glm::mat4								  m_lightView;
+	bool									  m_lightValid;
+	bool									  m_staticChanged; // A static caster moved since the last frame
+
+	std::vector<FrameBuffer> m_frames; // One uniform buffer per frame in flight (Persistently mapped)
+
+	uint32_t m_staticRenders; // Cascades whose static casters have been rendered
+	uint32_t m_layerCopies;	  // Cached layers copied into the sampled map
+	uint32_t m_frameCount;	  // Frames recorded
+
+	void CreateImages( const VkPhysicalDevice& p_physicalDevice, const VkCommandPool& p_commandPool, const VkQueue& p_graphicsQueue )
+	{
+		// Find a depth format that can also be sampled
+		m_format = FindSupportedFormat( p_physicalDevice, { VK_FORMAT_D32_SFLOAT, VK_FORMAT_D16_UNORM }, VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT );
+
+		// Create the images (The static layers are copied into the sampled map)
+		CreateImage( m_logicalDevice, p_physicalDevice, SHADOW_MAP_SIZE, SHADOW_MAP_SIZE, 1, m_format, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+					 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_SAMPLE_COUNT_1_BIT, &m_shadowImage, &m_shadowMemory, SHADOW_CASCADE_COUNT );
+		CreateImage( m_logicalDevice, p_physicalDevice, SHADOW_MAP_SIZE, SHADOW_MAP_SIZE, 1, m_format, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+					 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_SAMPLE_COUNT_1_BIT, &m_staticImage, &m_staticMemory, SHADOW_CASCADE_COUNT );
+
+		// Create a view of every cascade for sampling, and one of each layer to render into
+		m_shadowArrayView = CreateImageView( m_logicalDevice, m_shadowImage, m_format, VK_IMAGE_ASPECT_DEPTH_BIT, 1, VK_IMAGE_VIEW_TYPE_2D_ARRAY, 0, SHADOW_CASCADE_COUNT );
+		for ( uint32_t i = 0; i < SHADOW_CASCADE_COUNT; i++ )
+		{
+			m_cascades[i].shadowView = CreateImageView( m_logicalDevice, m_shadowImage, m_format, VK_IMAGE_ASPECT_DEPTH_BIT, 1, VK_IMAGE_VIEW_TYPE_2D, i, 1 );
+			m_cascades[i].staticView = CreateImageView( m_logicalDevice, m_staticImage, m_format, VK_IMAGE_ASPECT_DEPTH_BIT, 1, VK_IMAGE_VIEW_TYPE_2D, i, 1 );
+		}
+
+		// Clear the map to the far plane, so it reads as unshadowed until the first frame renders into it
+		VkCommandBuffer commandBuffer = BeginSingleTimeCommands( m_logicalDevice, p_commandPool );
+
+		VkImageSubresourceRange range = GetSubresourceRange();
+		RecordImageBarrier( commandBuffer, m_shadowImage, range, ResourceUsage::UNDEFINED, ResourceUsage::TRANSFER_DST );
+
+		VkClearDepthStencilValue clearValue { 1.0f, 0 };
+		vkCmdClearDepthStencilImage( commandBuffer, m_shadowImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &clearValue, 1, &range );
+
+		RecordImageBarrier( commandBuffer, m_shadowImage, range, ResourceUsage::TRANSFER_DST, ResourceUsage::DEPTH_SAMPLED );
+
+		EndSingleTimeCommands( m_logicalDevice, p_graphicsQueue, p_commandPool, commandBuffer );
+	}
+
+	void CreateSampler()
+	{
+		// Compare against the stored depth, filtering the results (Outside of the map is unshadowed)
+		VkSamplerCreateInfo samplerCreateInfo {};
+		samplerCreateInfo.sType					  = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+		samplerCreateInfo.magFilter				  = VK_FILTER_LINEAR;
+		samplerCreateInfo.minFilter				  = VK_FILTER_LINEAR;
+		samplerCreateInfo.addressModeU			  = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
+		samplerCreateInfo.addressModeV			  = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
+		samplerCreateInfo.addressModeW			  = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
+		samplerCreateInfo.anisotropyEnable		  = VK_FALSE;
+		samplerCreateInfo.maxAnisotropy			  = 1.0f;
+		samplerCreateInfo.borderColor			  = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
+		samplerCreateInfo.unnormalizedCoordinates = VK_FALSE;
+		samplerCreateInfo.compareEnable			  = VK_TRUE;
+		samplerCreateInfo.compareOp				  = VK_COMPARE_OP_LESS_OR_EQUAL;
+		samplerCreateInfo.mipmapMode			  = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+		samplerCreateInfo.mipLodBias			  = 0.0f;
+		samplerCreateInfo.minLod				  = 0.0f;
+		samplerCreateInfo.maxLod				  = 0.0f;
+
+		m_sampler = m_objects->GetSampler( samplerCreateInfo );
+	}
+
+	void CreateRenderPass( const VkAttachmentLoadOp& p_loadOp, const VkImageLayout& p_initialLayout, const VkImageLayout& p_finalLayout, const std::vector<VkSubpassDependency>& p_dependencies, VkRenderPass* p_renderPass )
+	{
+		// A single depth attachment
+		VkAttachmentDescription depthAttachment {};
+		depthAttachment.format		   = m_format;
+		depthAttachment.samples		   = VK_SAMPLE_COUNT_1_BIT;
+		depthAttachment.loadOp		   = p_loadOp;
+		depthAttachment.storeOp		   = VK_ATTACHMENT_STORE_OP_STORE;
+		depthAttachment.stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		depthAttachment.initialLayout  = p_initialLayout;
+		depthAttachment.finalLayout	   = p_finalLayout;
+
+		VkAttachmentReference depthAttachmentRef {};
+		depthAttachmentRef.attachment = 0;
+		depthAttachmentRef.layout	  = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+		VkSubpassDescription subpass {};
+		subpass.pipelineBindPoint		= VK_PIPELINE_BIND_POINT_GRAPHICS;
+		subpass.colorAttachmentCount	= 0;
+		subpass.pDepthStencilAttachment = &depthAttachmentRef;
+
+		VkRenderPassCreateInfo renderPassCreateInfo {};
+		renderPassCreateInfo.sType			 = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+		renderPassCreateInfo.attachmentCount = 1;
+		renderPassCreateInfo.pAttachments	 = &depthAttachment;
+		renderPassCreateInfo.subpassCount	 = 1;
+		renderPassCreateInfo.pSubpasses		 = &subpass;
+		renderPassCreateInfo.dependencyCount = static_cast<uint32_t>( p_dependencies.size() );
+		renderPassCreateInfo.pDependencies	 = p_dependencies.data();
+
+		*p_renderPass = m_objects->GetRenderPass( renderPassCreateInfo );
+	}
+
+	void CreateRenderPasses()
+	{
+		VkPipelineStageFlags depthStages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+		VkAccessFlags		 depthAccess = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+		// The static pass waits for the last copy out of the layer, and the next copy waits for it
+		std::vector<VkSubpassDependency> dependencies( 2 );
+		dependencies[0] = { VK_SUBPASS_EXTERNAL, 0, VK_PIPELINE_STAGE_TRANSFER_BIT, depthStages, 0, depthAccess, 0 };
+		dependencies[1] = { 0, VK_SUBPASS_EXTERNAL, VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT, 0 };
+		CreateRenderPass( VK_ATTACHMENT_LOAD_OP_CLEAR, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, dependencies, &m_staticRenderPass );
+
+		// The dynamic pass waits for the copy into the map (The render graph makes it ready to sample once the pass is done)
+		dependencies = { { VK_SUBPASS_EXTERNAL, 0, VK_PIPELINE_STAGE_TRANSFER_BIT, depthStages, VK_ACCESS_TRANSFER_WRITE_BIT, depthAccess, 0 } };
+		CreateRenderPass( VK_ATTACHMENT_LOAD_OP_LOAD, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, dependencies, &m_dynamicRenderPass );
+	}
+
+	void CreateFramebuffers()
+	{
+		VkFramebufferCreateInfo framebufferCreateInfo {};
+		framebufferCreateInfo.sType			  = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+		framebufferCreateInfo.attachmentCount = 1;
+		framebufferCreateInfo.width			  = SHADOW_MAP_SIZE;
+		framebufferCreateInfo.height		  = SHADOW_MAP_SIZE;
+		framebufferCreateInfo.layers		  = 1;
+
+		for ( auto& cascade : m_cascades )
+		{
+			framebufferCreateInfo.renderPass   = m_staticRenderPass;
+			framebufferCreateInfo.pAttachments = &cascade.staticView;
+			if ( vkCreateFramebuffer( m_logicalDevice, &framebufferCreateInfo, nullptr, &cascade.staticFramebuffer ) != VK_SUCCESS )
+				throw std::runtime_error( "Failed to create shadow framebuffer" );
+
+			framebufferCreateInfo.renderPass   = m_dynamicRenderPass;
+			framebufferCreateInfo.pAttachments = &cascade.shadowView;
+			if ( vkCreateFramebuffer( m_logicalDevice, &framebufferCreateInfo, nullptr, &cascade.dynamicFramebuffer ) != VK_SUCCESS )
+				throw std::runtime_error( "Failed to create shadow framebuffer" );
+		}
+	}
+
+	void CreatePipelineLayout()
+	{
+		VkPushConstantRange pushConstantRange {};
+		pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+		pushConstantRange.offset	 = 0;
+		pushConstantRange.size		 = sizeof( glm::mat4 );
+
+		VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo {};
+		pipelineLayoutCreateInfo.sType					= VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutCreateInfo.setLayoutCount			= 0;
+		pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+		pipelineLayoutCreateInfo.pPushConstantRanges	= &pushConstantRange;
+
+		m_pipelineLayout = m_objects->GetPipelineLayout( pipelineLayoutCreateInfo );
+	}
+
+	void UpdateSplits( const float& p_near )
+	{
+		// Blend logarithmic splits (Even texel density) with uniform ones (Less detail wasted up close)
+		for ( uint32_t i = 0; i < SHADOW_CASCADE_COUNT; i++ )
+		{
+			float fraction	= ( i + 1 ) / (float)SHADOW_CASCADE_COUNT;
+			float logarithm = p_near * std::pow( SHADOW_DISTANCE / p_near, fraction );
+			float uniform	= p_near + ( SHADOW_DISTANCE - p_near ) * fraction;
+
+			m_splits[i] = SHADOW_SPLIT_LAMBDA * logarithm + ( 1.0f - SHADOW_SPLIT_LAMBDA ) * uniform;
+		}
+	}
+
+	void InvalidateCascades()
+	{
+		// Force every cascade to be refit, and its static casters rendered again
+		for ( auto& cascade : m_cascades )
+		{
+			cascade.extent		 = 0.0f;
+			cascade.staticValid	 = false;
+			cascade.shadowStatic = false;
+		}
+	}
+
+	void FitCascade( Cascade* p_cascade, const glm::vec3& p_centre, const float& p_radius )
+	{
+		// Keep the cascade while the slice's bounding sphere still fits inside it
+		float extent = p_radius * ( 1.0f + SHADOW_CASCADE_SLACK );
+		float slack	 = extent - p_radius;
+		if ( p_cascade->extent == extent && std::abs( p_centre.x - p_cascade->centre.x ) <= slack && std::abs( p_centre.y - p_cascade->centre.y ) <= slack &&
+			 std::abs( p_centre.z - p_cascade->centre.z ) <= slack )
+			return;
+
+		// Move the cascade in whole texels, so the casters rasterise the same way wherever it is (No shimmering edges)
+		float	  texel	 = 2.0f * extent / SHADOW_MAP_SIZE;
+		glm::vec3 centre = glm::vec3( std::floor( p_centre.x / texel ) * texel, std::floor( p_centre.y / texel ) * texel, p_centre.z );
+
+		p_cascade->centre	   = centre;
+		p_cascade->extent	   = extent;
+		p_cascade->staticValid = false;
+
+		// The light looks down negative z, casters up to the caster distance in front of the cascade are caught
+		p_cascade->viewProjection = glm::ortho( centre.x - extent, centre.x + extent, centre.y - extent, centre.y + extent, -( centre.z + extent + SHADOW_CASTER_DISTANCE ), -( centre.z - extent ) ) * m_lightView;
+	}
+
+public:
+	ShadowCascades() : m_staticChanged( false ) {}
+
+	void Init( const VkDevice& p_logicalDevice, const VkPhysicalDevice& p_physicalDevice, const VkCommandPool& p_commandPool, const VkQueue& p_graphicsQueue, ObjectCache* p_objects, const uint32_t& p_frameCount )
+	{
+		m_logicalDevice = p_logicalDevice;
+		m_objects		= p_objects;
+		m_lightValid	= false;
+		m_staticRenders = 0;
+		m_layerCopies	= 0;
+		m_frameCount	= 0;
+		m_staticChanged = false;
+		InvalidateCascades();
+
+		// Create the maps and everything needed to render into them
+		CreateImages( p_physicalDevice, p_commandPool, p_graphicsQueue );
+		CreateSampler();
+		CreateRenderPasses();
+		CreateFramebuffers();
+		CreatePipelineLayout();
+
+		// Create the uniform buffers for every frame in flight, and keep them mapped
+		m_frames.resize( p_frameCount );
+		for ( auto& frame : m_frames )
+		{
+			CreateBuffer( m_logicalDevice, p_physicalDevice, sizeof( ShadowUniformBufferObject ), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &frame.buffer, &frame.memory );
+
+			void* mappedMemPtr;
+			if ( vkMapMemory( m_logicalDevice, frame.memory, 0, sizeof( ShadowUniformBufferObject ), 0, &mappedMemPtr ) != VK_SUCCESS )
+				throw std::runtime_error( "Failed to map shadow uniform buffer" );
+			frame.mapped = static_cast<ShadowUniformBufferObject*>( mappedMemPtr );
+		}
+	}
+
+	// Fits the cascades to the camera and fills a frame's uniform buffer (The GPU must have finished with it), p_view and p_projection must match the frame being drawn
+	void Update( const uint32_t& p_frame, const glm::mat4& p_view, const glm::mat4& p_projection, const float& p_near, const DirLight& p_light )
+	{
+		UpdateSplits( p_near );
+
+		// Only turn the light view once the light has turned far enough (Every cached layer is invalid after)
+		if ( !m_lightValid || glm::dot( p_light.GetDir(), m_lightDirection ) < SHADOW_LIGHT_THRESHOLD )
+		{
+			m_lightDirection = p_light.GetDir();
+			m_lightView		 = glm::lookAt( glm::vec3( 0.0f ), m_lightDirection, std::abs( m_lightDirection.y ) > 0.99f ? glm::vec3( 0.0f, 0.0f, 1.0f ) : glm::vec3( 0.0f, 1.0f, 0.0f ) );
+			m_lightValid	 = true;
+			InvalidateCascades();
+		}
+
+		// A static caster moved since the last frame
+		if ( m_staticChanged )
+			for ( auto& cascade : m_cascades )
+				cascade.staticValid = false;
+		m_staticChanged = false;
+
+		// Squared slope of the frustum's corners (x / z and y / z)
+		float slope = 1.0f / ( p_projection[0][0] * p_projection[0][0] ) + 1.0f / ( p_projection[1][1] * p_projection[1][1] );
+
+		glm::mat4 inverseView = glm::inverse( p_view );
+		for ( uint32_t i = 0; i < SHADOW_CASCADE_COUNT; i++ )
+		{
+			float nearDepth = i == 0 ? p_near : m_splits[i - 1], farDepth = m_splits[i];
+
+			// Smallest sphere around the slice of the frustum (Its size doesn't change as the camera turns, so neither does the cascade's)
+			float centreDepth = std::min( 0.5f * ( farDepth + nearDepth ) * ( 1.0f + slope ), farDepth );
+			float radius	  = std::max( std::sqrt( ( centreDepth - nearDepth ) * ( centreDepth - nearDepth ) + nearDepth * nearDepth * slope ),
+										  std::sqrt( ( farDepth - centreDepth ) * ( farDepth - centreDepth ) + farDepth * farDepth * slope ) );
+
+			radius = std::ceil( radius * 16.0f ) / 16.0f; // Stop rounding error from changing the size
+
+			glm::vec4 centre = m_lightView * inverseView * glm::vec4( 0.0f, 0.0f, -centreDepth, 1.0f );
+			FitCascade( &m_cascades[i], glm::vec3( centre ), radius );
+		}
+
+		// Fill the uniform buffer
+		ShadowUniformBufferObject* ubo = m_frames[p_frame].mapped;
+		for ( uint32_t i = 0; i < SHADOW_CASCADE_COUNT; i++ )
+			ubo->viewToShadow[i] = m_cascades[i].viewProjection * inverseView;
+		ubo->splits			= glm::vec4( m_splits[0], m_splits[1], m_splits[2], m_splits[3] );
+		ubo->lightDirection = glm::vec4( glm::normalize( glm::mat3( p_view ) * -p_light.GetDir() ), 0.0f );
+		ubo->lightColour	= glm::vec4( p_light.GetCol(), 0.0f );
+	}
+
+	// Records the shadow passes, the vertex and index buffers must already be bound
+	// The map must be ready to copy into when this starts (Keeping its contents), and is left as a depth attachment
+	void Record( const VkCommandBuffer& p_commandBuffer, const VkPipeline& p_pipeline, const DrawCallback& p_drawStatic, const DrawCallback& p_drawDynamic, const CasterTest& p_hasDynamic )
+	{
+		VkViewport viewport { 0.0f, 0.0f, (float)SHADOW_MAP_SIZE, (float)SHADOW_MAP_SIZE, 0.0f, 1.0f };
+		VkRect2D   scissor { { 0, 0 }, { SHADOW_MAP_SIZE, SHADOW_MAP_SIZE } };
+
+		VkClearValue clearValue {};
+		clearValue.depthStencil = { 1.0f, 0 };
+
+		VkRenderPassBeginInfo renderPassBeginInfo {};
+		renderPassBeginInfo.sType			  = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+		renderPassBeginInfo.renderArea.offset = { 0, 0 };
+		renderPassBeginInfo.renderArea.extent = { SHADOW_MAP_SIZE, SHADOW_MAP_SIZE };
+		renderPassBeginInfo.clearValueCount	  = 1;
+		renderPassBeginInfo.pClearValues	  = &clearValue;
+
+		auto drawCascade = [&]( const Cascade& p_cascade, const DrawCallback& p_draw )
+		{
+			vkCmdBeginRenderPass( p_commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE );
+			vkCmdBindPipeline( p_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, p_pipeline );
+			vkCmdSetViewport( p_commandBuffer, 0, 1, &viewport );
+			vkCmdSetScissor( p_commandBuffer, 0, 1, &scissor );
+			vkCmdSetDepthBias( p_commandBuffer, SHADOW_DEPTH_BIAS_CONSTANT, 0.0f, SHADOW_DEPTH_BIAS_SLOPE );
+			vkCmdPushConstants( p_commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof( glm::mat4 ), &p_cascade.viewProjection );
+			p_draw( p_commandBuffer );
+			vkCmdEndRenderPass( p_commandBuffer );
+		};
+
+		// Render the static casters of the cascades whose cached layer is out of date
+		for ( auto& cascade : m_cascades )
+		{
+			if ( cascade.staticValid ) continue;
+
+			renderPassBeginInfo.renderPass	= m_staticRenderPass;
+			renderPassBeginInfo.framebuffer = cascade.staticFramebuffer;
+			drawCascade( cascade, p_drawStatic );
+
+			cascade.staticValid	 = true;
+			cascade.shadowStatic = false;
+			m_staticRenders++;
+		}
+
+		// Find the cascades with dynamic casters
+		std::array<bool, SHADOW_CASCADE_COUNT> hasDynamic;
+		for ( uint32_t i = 0; i < SHADOW_CASCADE_COUNT; i++ )
+			hasDynamic[i] = p_hasDynamic( Frustum::FromMatrix( m_cascades[i].viewProjection ) );
+
+		// Copy the cached layers under dynamic casters, or that the map doesn't hold yet (The render graph has already waited for the last frame to finish sampling it)
+		std::vector<VkImageCopy> copyRegions;
+		for ( uint32_t i = 0; i < SHADOW_CASCADE_COUNT; i++ )
+		{
+			if ( !hasDynamic[i] && m_cascades[i].shadowStatic ) continue;
+
+			VkImageCopy copyRegion {};
+			copyRegion.srcSubresource = { VK_IMAGE_ASPECT_DEPTH_BIT, 0, i, 1 };
+			copyRegion.dstSubresource = { VK_IMAGE_ASPECT_DEPTH_BIT, 0, i, 1 };
+			copyRegion.extent		  = { SHADOW_MAP_SIZE, SHADOW_MAP_SIZE, 1 };
+			copyRegions.push_back( copyRegion );
+
+			m_cascades[i].shadowStatic = !hasDynamic[i];
+		}
+		if ( !copyRegions.empty() )
+			vkCmdCopyImage( p_commandBuffer, m_staticImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, m_shadowImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>( copyRegions.size() ), copyRegions.data() );
+		m_layerCopies += static_cast<uint32_t>( copyRegions.size() );
+
+		// Render the dynamic casters on top, the other layers just move to the layout the pass leaves the map in
+		renderPassBeginInfo.renderPass = m_dynamicRenderPass;
+		for ( uint32_t i = 0; i < SHADOW_CASCADE_COUNT; i++ )
+		{
+			if ( hasDynamic[i] )
+			{
+				renderPassBeginInfo.framebuffer = m_cascades[i].dynamicFramebuffer;
+				drawCascade( m_cascades[i], p_drawDynamic );
+			}
+			else
+				RecordImageBarrier( p_commandBuffer, m_shadowImage, { VK_IMAGE_ASPECT_DEPTH_BIT, 0, 1, i, 1 }, ResourceUsage::TRANSFER_DST, ResourceUsage::DEPTH_ATTACHMENT );
+		}
+
+		m_frameCount++;
+	}
+
+	// Every cascade of the sampled map
+	inline VkImageSubresourceRange GetSubresourceRange() const { return { VK_IMAGE_ASPECT_DEPTH_BIT, 0, 1, 0, SHADOW_CASCADE_COUNT }; }
+
+	// Call when a static caster moves, the cached layers are rendered again by the next Update
+	inline void InvalidateStatic() { m_staticChanged = true; }
+
+	inline const VkRenderPass&	   GetRenderPass() const { return m_staticRenderPass; }
+	inline const VkPipelineLayout& GetPipelineLayout() const { return m_pipelineLayout; }
+	inline const VkImage&		   GetImage() const { return m_shadowImage; }
+	inline const VkImageView&	   GetImageView() const { return m_shadowArrayView; }
+	inline const VkSampler&		   GetSampler() const { return m_sampler; }
+	inline const VkBuffer&		   GetUniformBuffer( const uint32_t& p_frame ) const { return m_frames[p_frame].buffer; }
+	inline const uint32_t&		   GetStaticRenders() const { return m_staticRenders; }
+	inline const uint32_t&		   GetLayerCopies() const { return m_layerCopies; }
+	inline const uint32_t&		   GetFrameCount() const { return m_frameCount; }
+
+	void Cleanup()
+	{
+		// Unmap and destroy every frame's uniform buffer
+		for ( auto& frame : m_frames )
+		{
+			vkUnmapMemory( m_logicalDevice, frame.memory );
+			vkDestroyBuffer( m_logicalDevice, frame.buffer, nullptr );
+			FreeDeviceMemory( m_logicalDevice, frame.memory );
+		}
+		m_frames.clear();
+
+		// Destroy the framebuffers and the layer views
+		for ( auto& cascade : m_cascades )
+		{
+			vkDestroyFramebuffer( m_logicalDevice, cascade.staticFramebuffer, nullptr );
+			vkDestroyFramebuffer( m_logicalDevice, cascade.dynamicFramebuffer, nullptr );
+			vkDestroyImageView( m_logicalDevice, cascade.staticView, nullptr );
+			vkDestroyImageView( m_logicalDevice, cascade.shadowView, nullptr );
+		}
+
+		// Destroy the images and free their memory (The layout, render passes and sampler belong to the object cache)
+		vkDestroyImageView( m_logicalDevice, m_shadowArrayView, nullptr );
+		vkDestroyImage( m_logicalDevice, m_shadowImage, nullptr );
+		FreeDeviceMemory( m_logicalDevice, m_shadowMemory );
+		vkDestroyImage( m_logicalDevice, m_staticImage, nullptr );
+		FreeDeviceMemory( m_logicalDevice, m_staticMemory );
+	}
+};
\ No newline at end of file
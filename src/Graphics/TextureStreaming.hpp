@@ -0,0 +1,315 @@
+#pragma once
+
+#include "../Buffers/Buffers.hpp"
+#include "../VulkanUtil/DeletionQueue.hpp"
+#include "../VulkanUtil/TimelineSemaphore.hpp"
+#include "Materials.hpp"
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#define TEXTURE_STREAM_BUDGET_MB 256.0f		// Device memory the textures may take, tails included
+#define TEXTURE_STREAM_UPLOAD_MB 8.0f		// Pixels uploaded per frame, the lower levels of each new image included (A bigger image is still uploaded, on its own)
+#define TEXTURE_STREAM_NOT_SEEN	 UINT32_MAX // Level of a texture no draw asked for
+
+// Totals over every frame streamed
+struct TextureStreamingStats
+{
+	uint64_t	 uploads		   = 0; // Levels made resident
+	uint64_t	 evictions		   = 0; // Levels dropped to make room for others
+	uint64_t	 uploadedBytes	   = 0; // Every level of the new images, including the ones that were already resident
+	uint64_t	 starvedFrames	   = 0; // Frames a wanted level didn't fit in the budget, even after evicting
+	VkDeviceSize residentBytes	   = 0;
+	VkDeviceSize peakResidentBytes = 0;
+};
+
+// The level a texture p_textureSize texels across needs to be drawn p_pixels across, without more than one texel per pixel
+static uint32_t GetStreamLevel( const uint32_t& p_textureSize, const float& p_pixels )
+{
+	float ratio = p_textureSize / std::max( p_pixels, 1.0f );
+	return ratio <= 1.0f ? 0 : static_cast<uint32_t>( std::floor( std::log2( ratio ) ) );
+}
+
+// Streams the levels above each texture's tail in and out of device memory, by the size the textures are seen at
+// Every frame the draws ask for the level each texture needs, and the missing levels of the most recently seen textures are uploaded, one level per texture, until the frame's upload allowance is spent
+// When a level doesn't fit in the budget, the top level of the least recently seen texture is evicted to make room (A texture seen this frame only loses levels finer than it needs)
+// The uploads run on the transfer queue while earlier frames render, and the frame that first samples them waits on the upload timeline
+class TextureStreamer
+{
+private:
+	struct FrameState
+	{
+		VkBuffer		staging; // Persistently mapped, grown when the frame's uploads don't fit
+		VkDeviceMemory	memory;
+		void*			mapped;
+		VkDeviceSize	capacity;
+		VkCommandBuffer commands;	 // Records the frame's uploads for the transfer queue
+		uint64_t		uploadValue; // Upload timeline value the frame's draws wait on (0 when it uploaded nothing)
+		bool			swapped;	 // A texture changed image since the frame's descriptor set was last updated
+	};
+
+	struct TextureState
+	{
+		uint32_t wanted	  = TEXTURE_STREAM_NOT_SEEN;
+		uint64_t lastSeen = 0; // Frame number
+	};
+
+	VkDevice				  m_logicalDevice;
+	VkPhysicalDevice		  m_physicalDevice;
+	VkDeviceSize			  m_budgetBytes;
+	VkDeviceSize			  m_uploadBytes;
+	UploadQueues			  m_queues;
+	VkCommandPool			  m_commandPool; // On the transfer family, so each frame's command buffer can be recorded again
+	TimelineSemaphore		  m_uploads;	 // Reaches each frame's upload value once its uploads have finished
+	uint64_t				  m_uploadValue; // Last value an upload was submitted to signal
+	std::vector<FrameState>	  m_frames;
+	std::vector<TextureState> m_textures;
+	TextureStreamingStats	  m_stats;
+
+	// The texture whose top level is evicted to make room for p_texture's, or TEXTURE_STREAM_NOT_SEEN if none can spare one
+	uint32_t FindVictim( const MaterialLibrary& p_materials, const uint32_t& p_texture, const std::vector<bool>& p_changed, const uint64_t& p_frameNumber ) const
+	{
+		uint32_t victim = TEXTURE_STREAM_NOT_SEEN;
+		for ( uint32_t i = 0; i < m_textures.size(); i++ )
+		{
+			// Each texture changes image at most once a frame, and the tail stays
+			const Texture& texture = p_materials.GetTexture( i );
+			if ( i == p_texture || p_changed[i] || texture.GetResidentTop() >= texture.GetTailLevel() ) continue;
+
+			// Textures seen this frame keep the levels they need
+			const TextureState& state = m_textures[i];
+			if ( state.lastSeen == p_frameNumber && texture.GetResidentTop() >= state.wanted ) continue;
+
+			if ( victim == TEXTURE_STREAM_NOT_SEEN || state.lastSeen < m_textures[victim].lastSeen ) victim = i;
+		}
+
+		return victim;
+	}
+
+public:
+	void Init( const VkDevice& p_logicalDevice, const VkPhysicalDevice& p_physicalDevice, const UploadQueues& p_queues, const VkDeviceSize& p_budgetBytes, const VkDeviceSize& p_uploadBytes, const uint32_t& p_frameCount )
+	{
+		m_logicalDevice	 = p_logicalDevice;
+		m_physicalDevice = p_physicalDevice;
+		m_queues		 = p_queues;
+		m_budgetBytes	 = p_budgetBytes;
+		m_uploadBytes	 = p_uploadBytes;
+		m_uploadValue	 = 0;
+		m_stats			 = {};
+
+		// No staging buffer is created until a frame first uploads
+		m_frames.assign( p_frameCount, { VK_NULL_HANDLE, VK_NULL_HANDLE, nullptr, 0, VK_NULL_HANDLE, 0, false } );
+
+		// Create the command pool on the transfer family, and a command buffer for each frame
+		VkCommandPoolCreateInfo poolCreateInfo {};
+		poolCreateInfo.sType			= VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		poolCreateInfo.queueFamilyIndex = m_queues.transferFamily;
+		poolCreateInfo.flags			= VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+		if ( vkCreateCommandPool( m_logicalDevice, &poolCreateInfo, nullptr, &m_commandPool ) != VK_SUCCESS )
+			throw std::runtime_error( "Failed to create texture streaming command pool" );
+
+		for ( auto& frame : m_frames )
+		{
+			VkCommandBufferAllocateInfo allocateInfo {};
+			allocateInfo.sType				= VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			allocateInfo.commandPool		= m_commandPool;
+			allocateInfo.level				= VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			allocateInfo.commandBufferCount = 1;
+			if ( vkAllocateCommandBuffers( m_logicalDevice, &allocateInfo, &frame.commands ) != VK_SUCCESS )
+				throw std::runtime_error( "Failed to allocate texture streaming command buffer" );
+		}
+
+		// Create the upload timeline, nothing has been uploaded yet
+		m_uploads.Init( m_logicalDevice, 0 );
+	}
+
+	// Uploads and evicts levels by what the frame's draws asked for, submitting the copies to the transfer queue (The GPU must have finished with the frame)
+	// Any ownership acquires are recorded into the frame's command buffer, whose submission must wait on the upload timeline for GetUploadValue
+	// p_requests holds the finest level each texture was asked for, or TEXTURE_STREAM_NOT_SEEN
+	// The old images are destroyed once the timeline reaches p_frameNumber + 1, which the frame signals
+	void Update( const VkCommandBuffer& p_commandBuffer, const uint32_t& p_frame, const uint64_t& p_frameNumber, const std::vector<uint32_t>& p_requests, MaterialLibrary* p_materials, DeletionQueue* p_deletions )
+	{
+		FrameState& frame		 = m_frames[p_frame];
+		uint32_t	textureCount = p_materials->GetTextureCount();
+		m_textures.resize( textureCount );
+
+		// Take the levels the frame's draws asked for
+		for ( uint32_t i = 0; i < textureCount && i < p_requests.size(); i++ )
+		{
+			if ( p_requests[i] == TEXTURE_STREAM_NOT_SEEN ) continue;
+
+			m_textures[i].wanted   = p_requests[i];
+			m_textures[i].lastSeen = p_frameNumber;
+		}
+
+		// Add up the device memory already taken, and find the textures missing a level they want
+		VkDeviceSize		  resident = 0;
+		std::vector<uint32_t> missing;
+		for ( uint32_t i = 0; i < textureCount; i++ )
+		{
+			const Texture& texture = p_materials->GetTexture( i );
+			resident += texture.GetResidentSize();
+			if ( texture.GetResidentTop() > m_textures[i].wanted ) missing.push_back( i );
+		}
+
+		// Serve the most recently seen textures first, then those furthest from the level they want
+		std::sort( missing.begin(), missing.end(), [&]( const uint32_t& p_a, const uint32_t& p_b ) {
+			if ( m_textures[p_a].lastSeen != m_textures[p_b].lastSeen ) return m_textures[p_a].lastSeen > m_textures[p_b].lastSeen;
+			return p_materials->GetTexture( p_a ).GetResidentTop() - m_textures[p_a].wanted > p_materials->GetTexture( p_b ).GetResidentTop() - m_textures[p_b].wanted;
+		} );
+
+		// Pick each texture's new top level (Resident sizes are estimated by the levels' pixel sizes until the images are created)
+		// Each new image is uploaded whole, so an eviction uploads the levels the texture keeps
+		std::vector<std::pair<uint32_t, uint32_t>> changes; // Texture and its new top level
+		std::vector<bool>						   changed( textureCount, false );
+		VkDeviceSize							   uploadSize = 0;
+		for ( const uint32_t& i : missing )
+		{
+			// A texture that was evicted this frame waits for the next
+			if ( changed[i] ) continue;
+
+			const Texture& texture	 = p_materials->GetTexture( i );
+			VkDeviceSize   levelSize = texture.GetLevelSize( texture.GetResidentTop() - 1 );
+			VkDeviceSize   imageSize = texture.GetLevelsSize( texture.GetResidentTop() - 1, texture.GetMipLevels() );
+			if ( uploadSize > 0 && uploadSize + imageSize > m_uploadBytes ) break;
+
+			// Evict the top levels of the least recently seen textures until the level fits
+			while ( resident + levelSize > m_budgetBytes )
+			{
+				uint32_t victim = FindVictim( *p_materials, i, changed, p_frameNumber );
+				if ( victim == TEXTURE_STREAM_NOT_SEEN ) break;
+
+				const Texture& victimTexture = p_materials->GetTexture( victim );
+				uint32_t	   victimTop	 = victimTexture.GetResidentTop();
+				changes.push_back( { victim, victimTop + 1 } );
+				changed[victim] = true;
+				resident -= std::min( resident, victimTexture.GetLevelSize( victimTop ) );
+				uploadSize += victimTexture.GetLevelsSize( victimTop + 1, victimTexture.GetMipLevels() );
+				m_stats.evictions++;
+			}
+			if ( resident + levelSize > m_budgetBytes )
+			{
+				m_stats.starvedFrames++;
+				break;
+			}
+
+			changes.push_back( { i, texture.GetResidentTop() - 1 } );
+			changed[i] = true;
+			resident += levelSize;
+			uploadSize += imageSize;
+		}
+
+		// The frame's draws have nothing to wait for unless it uploads
+		frame.uploadValue = 0;
+
+		if ( !changes.empty() )
+		{
+			// Grow the frame's staging buffer if the uploads don't fit (Its last uploads have finished)
+			if ( uploadSize > frame.capacity )
+			{
+				if ( frame.staging != VK_NULL_HANDLE )
+				{
+					vkUnmapMemory( m_logicalDevice, frame.memory );
+					vkDestroyBuffer( m_logicalDevice, frame.staging, nullptr );
+					FreeDeviceMemory( m_logicalDevice, frame.memory );
+				}
+
+				frame.capacity = std::max( uploadSize, m_uploadBytes );
+				CreateBuffer( m_logicalDevice, m_physicalDevice, frame.capacity, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &frame.staging, &frame.memory );
+				if ( vkMapMemory( m_logicalDevice, frame.memory, 0, frame.capacity, 0, &frame.mapped ) != VK_SUCCESS )
+					throw std::runtime_error( "Failed to map texture staging buffer" );
+			}
+
+			// Begin the frame's uploads (Its last ones have finished)
+			VkCommandBufferBeginInfo beginInfo {};
+			beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+			beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+			if ( vkBeginCommandBuffer( frame.commands, &beginInfo ) != VK_SUCCESS )
+				throw std::runtime_error( "Failed to begin texture streaming command buffer" );
+
+			// Write every level of the new images into the staging buffer, and record the move of each texture into its new image
+			VkDeviceSize offset = 0;
+			for ( const auto& change : changes )
+			{
+				Texture&	 texture = p_materials->GetTexture( change.first );
+				VkDeviceSize size	 = texture.GetLevelsSize( change.second, texture.GetMipLevels() );
+				texture.WriteLevels( change.second, texture.GetMipLevels(), static_cast<char*>( frame.mapped ) + offset );
+				if ( change.second < texture.GetResidentTop() ) m_stats.uploads += texture.GetResidentTop() - change.second;
+				m_stats.uploadedBytes += size;
+
+				texture.RecordResidency( frame.commands, p_commandBuffer, m_queues, change.second, frame.staging, offset, p_deletions, p_frameNumber + 1 );
+				offset += size;
+			}
+
+			if ( vkEndCommandBuffer( frame.commands ) != VK_SUCCESS )
+				throw std::runtime_error( "Failed to record texture streaming command buffer" );
+
+			// Submit the uploads to the transfer queue, signalling the frame's upload value once they have finished
+			frame.uploadValue = ++m_uploadValue;
+
+			VkTimelineSemaphoreSubmitInfoKHR timelineSubmitInfo {};
+			timelineSubmitInfo.sType					 = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+			timelineSubmitInfo.signalSemaphoreValueCount = 1;
+			timelineSubmitInfo.pSignalSemaphoreValues	 = &frame.uploadValue;
+
+			VkSubmitInfo submitInfo {};
+			submitInfo.sType				= VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			submitInfo.pNext				= &timelineSubmitInfo;
+			submitInfo.commandBufferCount	= 1;
+			submitInfo.pCommandBuffers		= &frame.commands;
+			submitInfo.signalSemaphoreCount = 1;
+			submitInfo.pSignalSemaphores	= &m_uploads.GetSemaphore();
+
+			if ( vkQueueSubmit( m_queues.transferQueue, 1, &submitInfo, VK_NULL_HANDLE ) != VK_SUCCESS )
+				throw std::runtime_error( "Failed to submit texture streaming uploads" );
+
+			// Every frame's descriptor set points at an old image now
+			for ( auto& other : m_frames )
+				other.swapped = true;
+		}
+
+		// Track the device memory the resident levels take
+		m_stats.residentBytes = 0;
+		for ( uint32_t i = 0; i < textureCount; i++ )
+			m_stats.residentBytes += p_materials->GetTexture( i ).GetResidentSize();
+		m_stats.peakResidentBytes = std::max( m_stats.peakResidentBytes, m_stats.residentBytes );
+	}
+
+	// Returns whether a texture changed image since the frame's descriptor set was last updated, and clears it
+	bool TakeSwapped( const uint32_t& p_frame )
+	{
+		bool swapped			  = m_frames[p_frame].swapped;
+		m_frames[p_frame].swapped = false;
+		return swapped;
+	}
+
+	inline const VkSemaphore&			GetUploadSemaphore() const { return m_uploads.GetSemaphore(); }
+	inline const uint64_t&				GetUploadValue( const uint32_t& p_frame ) const { return m_frames[p_frame].uploadValue; }
+	inline const VkDeviceSize&			GetBudget() const { return m_budgetBytes; }
+	inline const TextureStreamingStats& GetStats() const { return m_stats; }
+
+	void Cleanup()
+	{
+		// Destroy the staging buffers
+		for ( auto& frame : m_frames )
+		{
+			if ( frame.staging == VK_NULL_HANDLE ) continue;
+
+			vkUnmapMemory( m_logicalDevice, frame.memory );
+			vkDestroyBuffer( m_logicalDevice, frame.staging, nullptr );
+			FreeDeviceMemory( m_logicalDevice, frame.memory );
+		}
+		m_frames.clear();
+		m_textures.clear();
+
+		// Destroy the command pool (Freeing the frames' command buffers) and the upload timeline
+		vkDestroyCommandPool( m_logicalDevice, m_commandPool, nullptr );
+		m_uploads.Cleanup();
+	}
+};
\ No newline at end of file
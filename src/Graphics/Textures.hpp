@@ -1,113 +1,106 @@
 #pragma once
+#include "../VulkanUtil/DeletionQueue.hpp"
+#include "../VulkanUtil/ObjectCache.hpp"
 #include "Images.hpp"
 
-static void GenerateMipmaps( const VkDevice& p_logicalDevice, const VkPhysicalDevice& p_physicalDevice, const VkCommandPool& p_commandPool, const VkQueue& p_graphicsQueue, const VkImage& p_image, const VkFormat& p_format, const uint32_t& p_width, const uint32_t& p_height, const uint32_t& p_mipLevels )
-{
-	// Check if the image format allows linear filtering
-	VkFormatProperties formatProperties;
-	vkGetPhysicalDeviceFormatProperties( p_physicalDevice, p_format, &formatProperties );
-
-	if ( !( formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT ) )
-		throw std::runtime_error( "Image format does not support linear blitting" );
-
-	// Start a command buffer
-	VkCommandBuffer commandBuffer = BeginSingleTimeCommands( p_logicalDevice, p_commandPool );
-
-	// Create a reusable barrier
-	VkImageMemoryBarrier barrier {};
-	barrier.sType							= VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-	barrier.image							= p_image;
-	barrier.srcQueueFamilyIndex				= VK_QUEUE_FAMILY_IGNORED;
-	barrier.dstQueueFamilyIndex				= VK_QUEUE_FAMILY_IGNORED;
-	barrier.subresourceRange.aspectMask		= VK_IMAGE_ASPECT_COLOR_BIT;
-	barrier.subresourceRange.baseArrayLayer = 0;
-	barrier.subresourceRange.layerCount		= 1;
-	barrier.subresourceRange.levelCount		= 1;
-
-	// Setup the width of each mip level
-	int32_t mipWidth  = (int32_t)p_width;
-	int32_t mipHeight = (int32_t)p_height;
-
-	// Iterate the mip levels to record the VkCmdBlitImage commands
-	for ( uint32_t i = 1; i < p_mipLevels; i++ )
-	{
-		// Modify the barrier to transition from dst to src
-		barrier.subresourceRange.baseMipLevel = i - 1;
-		barrier.oldLayout					  = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-		barrier.newLayout					  = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-		barrier.srcAccessMask				  = VK_ACCESS_TRANSFER_WRITE_BIT;
-		barrier.dstAccessMask				  = VK_ACCESS_TRANSFER_READ_BIT;
-
-		// Record the barrier to wait for the i-1 level to be filled
-		vkCmdPipelineBarrier( commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
-							  0, nullptr,
-							  0, nullptr,
-							  1, &barrier );
-
-		// Create the blit
-		VkImageBlit blit {};
-		blit.srcOffsets[0]				   = { 0, 0, 0 };
-		blit.srcOffsets[1]				   = { mipWidth, mipHeight, 1 };
-		blit.srcSubresource.aspectMask	   = VK_IMAGE_ASPECT_COLOR_BIT;
-		blit.srcSubresource.mipLevel	   = i - 1;
-		blit.srcSubresource.baseArrayLayer = 0;
-		blit.srcSubresource.layerCount	   = 1;
-		blit.dstOffsets[0]				   = { 0, 0, 0 };
-		blit.dstOffsets[1]				   = { mipWidth > 1 ? ( mipWidth / 2 ) : 1, mipHeight > 1 ? ( mipHeight / 2 ) : 1, 1 };
-		blit.dstSubresource.aspectMask	   = VK_IMAGE_ASPECT_COLOR_BIT;
-		blit.dstSubresource.mipLevel	   = i;
-		blit.dstSubresource.baseArrayLayer = 0;
-		blit.dstSubresource.layerCount	   = 1;
-
-		// Record the blit command
-		vkCmdBlitImage( commandBuffer,
-						p_image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-						p_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-						1, &blit,
-						VK_FILTER_LINEAR );
-
-		// Modify the barrier again to transition from src to shader optimal
-		barrier.oldLayout	  = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-		barrier.newLayout	  = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-		// Record the barrier transition
-		vkCmdPipelineBarrier( commandBuffer,
-							  VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
-							  0, nullptr,
-							  0, nullptr,
-							  1, &barrier );
-
-		// Half the mip dimensions
-		if ( mipWidth > 1 ) mipWidth /= 2;
-		if ( mipHeight > 1 ) mipHeight /= 2;
-	}
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+#define TEXTURE_TAIL_SIZE 64 // Levels this wide and high or smaller are always resident
 
-	// Modify the barrier again to transition the final mip level to shader optimal
-	barrier.subresourceRange.baseMipLevel = p_mipLevels - 1;
-	barrier.oldLayout					  = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-	barrier.newLayout					  = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-	barrier.srcAccessMask				  = VK_ACCESS_TRANSFER_WRITE_BIT;
-	barrier.dstAccessMask				  = VK_ACCESS_SHADER_READ_BIT;
-
-	// Record the barrier
-	vkCmdPipelineBarrier( commandBuffer,
-						  VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
-						  0, nullptr,
-						  0, nullptr,
-						  1, &barrier );
-
-	// End the command buffer
-	EndSingleTimeCommands( p_logicalDevice, p_graphicsQueue, p_commandPool, commandBuffer );
+// Halves a level of sRGB pixels with a box filter, averaging the colours in linear space (An odd edge repeats its last row or column)
+static std::vector<stbi_uc> DownsampleLevel( const std::vector<stbi_uc>& p_pixels, const uint32_t& p_width, const uint32_t& p_height )
+{
+	// Build the table that decodes sRGB to linear
+	static const std::array<float, 256> toLinear = []() {
+		std::array<float, 256> table;
+		for ( uint32_t i = 0; i < 256; i++ )
+		{
+			float value = i / 255.0f;
+			table[i]	= value <= 0.04045f ? value / 12.92f : std::pow( ( value + 0.055f ) / 1.055f, 2.4f );
+		}
+		return table;
+	}();
+
+	uint32_t			 width	= std::max( p_width / 2, 1u );
+	uint32_t			 height = std::max( p_height / 2, 1u );
+	std::vector<stbi_uc> result( static_cast<size_t>( width ) * height * 4 );
+
+	for ( uint32_t y = 0; y < height; y++ )
+		for ( uint32_t x = 0; x < width; x++ )
+			for ( uint32_t channel = 0; channel < 4; channel++ )
+			{
+				// Average the 2x2 block (Alpha is already linear)
+				float sum = 0.0f;
+				for ( uint32_t dy = 0; dy < 2; dy++ )
+					for ( uint32_t dx = 0; dx < 2; dx++ )
+					{
+						uint32_t sx	   = std::min( x * 2 + dx, p_width - 1 );
+						uint32_t sy	   = std::min( y * 2 + dy, p_height - 1 );
+						stbi_uc	 value = p_pixels[( static_cast<size_t>( sy ) * p_width + sx ) * 4 + channel];
+						sum += channel == 3 ? value / 255.0f : toLinear[value];
+					}
+				float average = sum * 0.25f;
+
+				// Encode the colour back to sRGB
+				if ( channel != 3 ) average = average <= 0.0031308f ? average * 12.92f : 1.055f * std::pow( average, 1.0f / 2.4f ) - 0.055f;
+				result[( static_cast<size_t>( y ) * width + x ) * 4 + channel] = static_cast<stbi_uc>( std::clamp( average, 0.0f, 1.0f ) * 255.0f + 0.5f );
+			}
+
+	return result;
 }
 
+// A mipmapped texture whose smallest levels are always in device memory, while the levels above them can be streamed in and evicted
+// Every level's pixels stay in system memory, so an evicted level can be uploaded again without reloading the file
 class Texture : public Image
 {
 private:
-	uint32_t  m_mipLevels;
-	VkSampler m_sampler;
-	uint32_t  m_samplerID;
+	uint32_t						  m_mipLevels; // Of the whole chain, resident or not
+	uint32_t						  m_width;
+	uint32_t						  m_height;
+	std::vector<std::vector<stbi_uc>> m_levels;		  // The pixels of every level
+	uint32_t						  m_residentTop;  // Most detailed level in device memory, the image's first level
+	VkDeviceSize					  m_residentSize; // Device memory the resident levels take
+	VkSampler						  m_sampler;	  // Owned by the object cache, and shared by every texture with the same filtering
+	uint32_t						  m_samplerID;
+	ObjectCache*					  m_objects;
+
+	// Needed to recreate the image whenever the resident levels change
+	VkPhysicalDevice	  m_physicalDevice;
+	VkSampleCountFlagBits m_sampleCount;
+	VkImageTiling		  m_tiling;
+	VkImageUsageFlags	  m_usage;
+	VkMemoryPropertyFlags m_properties;
+	VkImageAspectFlags	  m_aspectFlags;
+
+	// Records copies of levels [p_first, p_last) out of a buffer holding their pixels back to back, into an image whose first level is p_top
+	void RecordLevelUploads( const VkCommandBuffer& p_commandBuffer, const VkImage& p_image, const uint32_t& p_top, const uint32_t& p_first, const uint32_t& p_last, const VkBuffer& p_buffer, const VkDeviceSize& p_offset ) const
+	{
+		std::vector<VkBufferImageCopy> regions;
+		VkDeviceSize				   offset = p_offset;
+		for ( uint32_t level = p_first; level < p_last; level++ )
+		{
+			VkBufferImageCopy region {};
+			region.bufferOffset		= offset;
+			region.imageSubresource = { m_aspectFlags, level - p_top, 0, 1 };
+			region.imageOffset		= { 0, 0, 0 };
+			region.imageExtent		= { GetLevelWidth( level ), GetLevelHeight( level ), 1 };
+			regions.push_back( region );
+
+			offset += GetLevelSize( level );
+		}
+
+		vkCmdCopyBufferToImage( p_commandBuffer, p_buffer, p_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>( regions.size() ), regions.data() );
+	}
+
+	VkDeviceSize GetImageSize( const VkImage& p_image ) const
+	{
+		VkMemoryRequirements memoryRequirements;
+		vkGetImageMemoryRequirements( *m_logicalDevice, p_image, &memoryRequirements );
+		return memoryRequirements.size;
+	}
 
 public:
 	void
@@ -118,74 +111,147 @@ public:
 	void Init( const VkDevice& p_logicalDevice, const VkPhysicalDevice& p_physicalDevice, const VkCommandPool& p_commandPool, const VkQueue& p_graphicsQueue,
 			   const VkPhysicalDeviceProperties& p_physicalDeviceProperties, const char* path, const VkSampleCountFlagBits& p_sampleCount, const VkFormat& p_format,
 			   const VkImageTiling& p_tiling, const VkImageUsageFlags& p_usage, const VkMemoryPropertyFlags& p_properties,
-			   const VkImageAspectFlags& p_aspectFlags, const uint32_t& p_samplerID )
+			   const VkImageAspectFlags& p_aspectFlags, const uint32_t& p_samplerID, ObjectCache* p_objects )
 	{
 		// Set the member variables using the parameters
-		m_logicalDevice = const_cast<VkDevice*>( &p_logicalDevice );
-		m_format		= const_cast<VkFormat*>( &p_format );
-		m_samplerID		= p_samplerID;
+		m_logicalDevice	 = const_cast<VkDevice*>( &p_logicalDevice );
+		m_format		 = const_cast<VkFormat*>( &p_format );
+		m_samplerID		 = p_samplerID;
+		m_objects		 = p_objects;
+		m_physicalDevice = p_physicalDevice;
+		m_sampleCount	 = p_sampleCount;
+		m_tiling		 = p_tiling;
+		m_usage			 = p_usage;
+		m_properties	 = p_properties;
+		m_aspectFlags	 = p_aspectFlags;
 
 		// Get the pixels
 		int		 texWidth, texHeight, texChannels;
 		stbi_uc* pixels = stbi_load( path, &texWidth, &texHeight, &texChannels, STBI_rgb_alpha );
 
+		// Throw an error if the image wasn't loaded
+		if ( !pixels )
+			throw std::runtime_error( "Failed to load image" );
+
 		// Calculate the number of mip levels
+		m_width		= static_cast<uint32_t>( texWidth );
+		m_height	= static_cast<uint32_t>( texHeight );
 		m_mipLevels = static_cast<uint32_t>( std::floor( std::log2( std::max( texWidth, texHeight ) ) ) ) + 1;
 
-		// Get the size of the image
-		VkDeviceSize imageSize = texWidth * texHeight * 4;
+		// Keep the pixels, then free the original pixel array
+		m_levels.resize( m_mipLevels );
+		m_levels[0].assign( pixels, pixels + static_cast<size_t>( texWidth ) * texHeight * 4 );
+		stbi_image_free( pixels );
 
-		// Throw an error if the image wasn't loaded
-		if ( !pixels )
-			throw std::runtime_error( "Failed to load image" );
+		// Generate the mipmaps on the CPU, so any of them can be uploaded on its own
+		for ( uint32_t i = 1; i < m_mipLevels; i++ )
+			m_levels[i] = DownsampleLevel( m_levels[i - 1], GetLevelWidth( i - 1 ), GetLevelHeight( i - 1 ) );
 
-		// Create a staging buffer and some memory for the image
+		// Only the tail starts resident, the streamer brings the levels above it in once they are seen
+		m_residentTop = GetTailLevel();
+
+		// Create a staging buffer and some memory for the tail
+		VkDeviceSize   tailSize = GetLevelsSize( m_residentTop, m_mipLevels );
 		VkBuffer	   stagingBuffer;
 		VkDeviceMemory stagingBufferMemory;
-		CreateBuffer( *m_logicalDevice, p_physicalDevice, imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &stagingBuffer, &stagingBufferMemory );
+		CreateBuffer( *m_logicalDevice, p_physicalDevice, tailSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &stagingBuffer, &stagingBufferMemory );
 
-		// Copy the data (Map memory to CPU accessible memory, copy, un-map CPU accessible memory)
+		// Copy the levels back to back (Map memory to CPU accessible memory, copy, un-map CPU accessible memory)
 		void* mappedMemPtr;
-		vkMapMemory( *m_logicalDevice, stagingBufferMemory, 0, imageSize, 0, &mappedMemPtr );
-		memcpy( mappedMemPtr, pixels, static_cast<uint32_t>( imageSize ) );
+		vkMapMemory( *m_logicalDevice, stagingBufferMemory, 0, tailSize, 0, &mappedMemPtr );
+		WriteLevels( m_residentTop, m_mipLevels, mappedMemPtr );
 		vkUnmapMemory( *m_logicalDevice, stagingBufferMemory );
 
-		// Free the original pixel array
-		stbi_image_free( pixels );
-
 		// Create the image
-		CreateImage( *m_logicalDevice, p_physicalDevice, texWidth, texHeight, m_mipLevels, p_format, p_tiling, p_usage, p_properties, p_sampleCount, &m_image, &m_imageMemory );
-
-		// Transition the layout to the first format
-		TransitionLayout( p_commandPool, p_graphicsQueue, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL );
-
-		// Copy the buffer to the image
-		CopyBufferToImage( *m_logicalDevice, p_commandPool, p_graphicsQueue, stagingBuffer, m_image, static_cast<uint32_t>( texWidth ), static_cast<uint32_t>( texHeight ) );
-
-		if ( m_mipLevels > 1 )
-		{
-			// Generate the mipmaps for the image (LOD)
-			GenerateMipmaps( *m_logicalDevice, p_physicalDevice, p_commandPool, p_graphicsQueue, m_image, p_format, texWidth, texHeight, m_mipLevels );
-		}
+		uint32_t levelCount = m_mipLevels - m_residentTop;
+		CreateImage( *m_logicalDevice, p_physicalDevice, GetLevelWidth( m_residentTop ), GetLevelHeight( m_residentTop ), levelCount, p_format, p_tiling, p_usage, p_properties, p_sampleCount, &m_image, &m_imageMemory );
+		m_residentSize = GetImageSize( m_image );
+
+		// Copy the tail into the image, and transition it to be sampled
+		VkCommandBuffer			commandBuffer = BeginSingleTimeCommands( *m_logicalDevice, p_commandPool );
+		VkImageSubresourceRange range { p_aspectFlags, 0, levelCount, 0, 1 };
+		RecordImageBarrier( commandBuffer, m_image, range, ResourceUsage::UNDEFINED, ResourceUsage::TRANSFER_DST );
+		RecordLevelUploads( commandBuffer, m_image, m_residentTop, m_residentTop, m_mipLevels, stagingBuffer, 0 );
+		RecordImageBarrier( commandBuffer, m_image, range, ResourceUsage::TRANSFER_DST, ResourceUsage::SAMPLED );
+		EndSingleTimeCommands( *m_logicalDevice, p_graphicsQueue, p_commandPool, commandBuffer );
 
 		// Destroy the staging buffer and free its memory
 		vkDestroyBuffer( *m_logicalDevice, stagingBuffer, nullptr );
-		vkFreeMemory( *m_logicalDevice, stagingBufferMemory, nullptr );
+		FreeDeviceMemory( *m_logicalDevice, stagingBufferMemory );
 
 		// Create image view
-		m_imageView = std::make_unique<VkImageView>( CreateImageView( *m_logicalDevice, m_image, p_format, p_aspectFlags, m_mipLevels ) );
+		m_imageView = std::make_unique<VkImageView>( CreateImageView( *m_logicalDevice, m_image, p_format, p_aspectFlags, levelCount ) );
 
-		// Generate the texture sampler
-		CreateSampler( p_physicalDeviceProperties );
+		// Generate the texture sampler (At the device's most anisotropy, until it is given quality settings)
+		CreateSampler( p_physicalDeviceProperties.limits.maxSamplerAnisotropy, 0.0f );
 	}
 
 	void TransitionLayout( const VkCommandPool& p_commandPool, const VkQueue& p_graphicsQueue, const VkImageLayout& p_oldLayout, const VkImageLayout& p_newLayout ) override
 	{
-		// Transition the layout of the image
-		TransitionImageLayout( *m_logicalDevice, p_commandPool, p_graphicsQueue, m_image, *m_format, p_oldLayout, p_newLayout, m_mipLevels );
+		// Transition the layout of the resident levels
+		TransitionImageLayout( *m_logicalDevice, p_commandPool, p_graphicsQueue, m_image, *m_format, p_oldLayout, p_newLayout, m_mipLevels - m_residentTop );
+	}
+
+	// Copies the pixels of levels [p_first, p_last) back to back, in the order RecordResidency uploads them
+	void WriteLevels( const uint32_t& p_first, const uint32_t& p_last, void* p_destination ) const
+	{
+		stbi_uc* destination = static_cast<stbi_uc*>( p_destination );
+		for ( uint32_t level = p_first; level < p_last; level++ )
+		{
+			memcpy( destination, m_levels[level].data(), m_levels[level].size() );
+			destination += m_levels[level].size();
+		}
+	}
+
+	// Records the upload that moves the texture into a new image holding p_top and every level below it, then retires the old image once the timeline reaches p_timelineValue
+	// Every level of the new image is copied from p_staging, where WriteLevels put them at p_stagingOffset, so the old image is never read off the graphics queue
+	// The copies are recorded into p_transferCommands, and a dedicated transfer queue hands the image to the graphics queue through p_graphicsCommands (Its submission must wait on the transfer's)
+	// The descriptor sets still point at the old image's view, and must be updated before they are next used
+	void RecordResidency( const VkCommandBuffer& p_transferCommands, const VkCommandBuffer& p_graphicsCommands, const UploadQueues& p_queues, const uint32_t& p_top, const VkBuffer& p_staging, const VkDeviceSize& p_stagingOffset, DeletionQueue* p_deletions, const uint64_t& p_timelineValue )
+	{
+		if ( p_top == m_residentTop ) return;
+
+		// Create the image for the new levels, and its view
+		VkImage		   image;
+		VkDeviceMemory imageMemory;
+		uint32_t	   levelCount = m_mipLevels - p_top;
+		CreateImage( *m_logicalDevice, m_physicalDevice, GetLevelWidth( p_top ), GetLevelHeight( p_top ), levelCount, *m_format, m_tiling, m_usage, m_properties, m_sampleCount, &image, &imageMemory );
+		VkImageView imageView = CreateImageView( *m_logicalDevice, image, *m_format, m_aspectFlags, levelCount );
+
+		// Upload every level of the new image
+		VkImageSubresourceRange range { m_aspectFlags, 0, levelCount, 0, 1 };
+		RecordImageBarrier( p_transferCommands, image, range, ResourceUsage::UNDEFINED, ResourceUsage::TRANSFER_DST );
+		RecordLevelUploads( p_transferCommands, image, p_top, p_top, m_mipLevels, p_staging, p_stagingOffset );
+
+		// Let the new image be sampled, moving it to the graphics queue if it was uploaded on another family's
+		if ( p_queues.transferFamily == p_queues.graphicsFamily )
+			RecordImageBarrier( p_transferCommands, image, range, ResourceUsage::TRANSFER_DST, ResourceUsage::SAMPLED );
+		else
+		{
+			RecordImageRelease( p_transferCommands, image, range, ResourceUsage::TRANSFER_DST, ResourceUsage::SAMPLED, p_queues.transferFamily, p_queues.graphicsFamily );
+			RecordImageAcquire( p_graphicsCommands, image, range, ResourceUsage::TRANSFER_DST, ResourceUsage::SAMPLED, p_queues.transferFamily, p_queues.graphicsFamily );
+		}
+
+		// Destroy the old image once the frames sampling it have finished
+		VkDevice	   logicalDevice = *m_logicalDevice;
+		VkImage		   oldImage		 = m_image;
+		VkDeviceMemory oldMemory	 = m_imageMemory;
+		VkImageView	   oldView		 = *m_imageView;
+		p_deletions->Push( p_timelineValue, [logicalDevice, oldImage, oldMemory, oldView]() {
+			vkDestroyImageView( logicalDevice, oldView, nullptr );
+			vkDestroyImage( logicalDevice, oldImage, nullptr );
+			FreeDeviceMemory( logicalDevice, oldMemory );
+		} );
+
+		// Switch to the new image
+		m_image		   = image;
+		m_imageMemory  = imageMemory;
+		m_imageView	   = std::make_shared<VkImageView>( imageView );
+		m_residentTop  = p_top;
+		m_residentSize = GetImageSize( image );
 	}
 
-	void CreateSampler( const VkPhysicalDeviceProperties& p_physicalDeviceProperties )
+	void CreateSampler( const float& p_anisotropy, const float& p_lodBias )
 	{
 		// Setup the create information for the texture sampler
 		VkSamplerCreateInfo samplerCreateInfo {};
@@ -195,31 +261,58 @@ public:
 		samplerCreateInfo.addressModeU			  = VK_SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT;
 		samplerCreateInfo.addressModeV			  = VK_SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT;
 		samplerCreateInfo.addressModeW			  = VK_SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT;
-		samplerCreateInfo.anisotropyEnable		  = VK_TRUE;
-		samplerCreateInfo.maxAnisotropy			  = p_physicalDeviceProperties.limits.maxSamplerAnisotropy;
+		samplerCreateInfo.anisotropyEnable		  = p_anisotropy > 1.0f;
+		samplerCreateInfo.maxAnisotropy			  = p_anisotropy;
 		samplerCreateInfo.borderColor			  = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
 		samplerCreateInfo.unnormalizedCoordinates = VK_FALSE;
 		samplerCreateInfo.compareEnable			  = VK_FALSE;
 		samplerCreateInfo.compareOp				  = VK_COMPARE_OP_ALWAYS;
 		samplerCreateInfo.mipmapMode			  = VK_SAMPLER_MIPMAP_MODE_LINEAR;
-		samplerCreateInfo.mipLodBias			  = 0.0f;
+		samplerCreateInfo.mipLodBias			  = p_lodBias;
 		samplerCreateInfo.minLod				  = 0.0f;
-		samplerCreateInfo.maxLod				  = static_cast<float>( m_mipLevels );
+		samplerCreateInfo.maxLod				  = VK_LOD_CLAMP_NONE; // The image view already limits the levels, so textures with different mip counts can share the sampler
 
-		// Create the texture sampler
-		if ( vkCreateSampler( *m_logicalDevice, &samplerCreateInfo, nullptr, &m_sampler ) != VK_SUCCESS )
-			throw std::runtime_error( "Failed to create texture sampler" );
+		// Get the texture sampler from the cache
+		m_sampler = m_objects->GetSampler( samplerCreateInfo );
 	}
 
-	inline const uint32_t&	GetMipLevels() const { return m_mipLevels; }
-	inline const VkSampler& GetSampler() const { return m_sampler; }
-	inline const uint32_t&	GetSamplerID() const { return m_samplerID; }
+	void RecreateSampler( const float& p_anisotropy, const float& p_lodBias )
+	{
+		// The old sampler stays in the cache, the descriptor sets have to be updated after
+		CreateSampler( p_anisotropy, p_lodBias );
+	}
 
-	void Cleanup() override
+	inline const uint32_t&	   GetMipLevels() const { return m_mipLevels; }
+	inline const uint32_t&	   GetWidth() const { return m_width; }
+	inline const uint32_t&	   GetHeight() const { return m_height; }
+	inline uint32_t			   GetLevelWidth( const uint32_t& p_level ) const { return std::max( m_width >> p_level, 1u ); }
+	inline uint32_t			   GetLevelHeight( const uint32_t& p_level ) const { return std::max( m_height >> p_level, 1u ); }
+	inline VkDeviceSize		   GetLevelSize( const uint32_t& p_level ) const { return m_levels[p_level].size(); }
+	inline const uint32_t&	   GetResidentTop() const { return m_residentTop; }
+	inline const VkDeviceSize& GetResidentSize() const { return m_residentSize; }
+	inline const VkSampler&	   GetSampler() const { return m_sampler; }
+	inline const uint32_t&	   GetSamplerID() const { return m_samplerID; }
+
+	// The pixel size of levels [p_first, p_last)
+	VkDeviceSize GetLevelsSize( const uint32_t& p_first, const uint32_t& p_last ) const
 	{
-		// Destroy the sampler
-		vkDestroySampler( *m_logicalDevice, m_sampler, nullptr );
+		VkDeviceSize size = 0;
+		for ( uint32_t level = p_first; level < p_last; level++ )
+			size += GetLevelSize( level );
+		return size;
+	}
 
+	// The first level that fits in the tail, which never leaves device memory
+	uint32_t GetTailLevel() const
+	{
+		uint32_t level = 0;
+		while ( level + 1 < m_mipLevels && std::max( GetLevelWidth( level ), GetLevelHeight( level ) ) > TEXTURE_TAIL_SIZE )
+			level++;
+		return level;
+	}
+
+	void Cleanup() override
+	{
 		// Destroy the image view
 		vkDestroyImageView( *m_logicalDevice, *m_imageView, nullptr );
 
@@ -228,6 +321,9 @@ public:
 
 		// Destroy the image and free its memory
 		vkDestroyImage( *m_logicalDevice, m_image, nullptr );
-		vkFreeMemory( *m_logicalDevice, m_imageMemory, nullptr );
+		FreeDeviceMemory( *m_logicalDevice, m_imageMemory );
+
+		// Free the pixels
+		m_levels.clear();
 	}
 };
\ No newline at end of file
@@ -0,0 +1,298 @@
+#pragma once
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <stdexcept>
+#include <vector>
+
+#if defined( __SSE__ )
+#	include <xmmintrin.h>
+#endif
+
+#define TRANSFORM_NO_PARENT UINT32_MAX // Parent index used by root transforms
+#define TRANSFORM_BATCH		4		   // Number of transforms recomputed together in one SIMD batch
+
+// Stores the transforms of every object in structure of arrays form, and caches their world and normal matrices
+class TransformStore
+{
+private:
+	// Local components (One array per component so a batch can be loaded with a single instruction)
+	std::vector<float> m_positionX, m_positionY, m_positionZ;
+	std::vector<float> m_rotationX, m_rotationY, m_rotationZ;
+	std::vector<float> m_scaleX, m_scaleY, m_scaleZ;
+
+	// Hierarchy and change tracking
+	std::vector<uint32_t> m_parents;
+	std::vector<uint8_t>  m_localDirty;
+	std::vector<uint8_t>  m_worldChanged;
+	bool				  m_anyDirty;
+
+	// Cached matrices
+	std::vector<glm::mat4> m_localMatrices;
+	std::vector<glm::mat3> m_localNormalMatrices;
+	std::vector<glm::mat4> m_worldMatrices;
+	std::vector<glm::mat3> m_normalMatrices;
+
+	inline void MarkDirty( const uint32_t& p_id )
+	{
+		m_localDirty[p_id] = 1;
+		m_anyDirty		   = true;
+	}
+
+	void UpdateLocalBatch( const uint32_t& p_base )
+	{
+		// The number of transforms in this batch (The final batch may be partial)
+		uint32_t count = std::min<uint32_t>( TRANSFORM_BATCH, static_cast<uint32_t>( m_parents.size() ) - p_base );
+
+		// Sines and cosines of the rotations for each lane (Padded lanes are left as the identity rotation)
+		alignas( 16 ) float sinA[TRANSFORM_BATCH] = {}, cosA[TRANSFORM_BATCH] = { 1.0f, 1.0f, 1.0f, 1.0f };
+		alignas( 16 ) float sinB[TRANSFORM_BATCH] = {}, cosB[TRANSFORM_BATCH] = { 1.0f, 1.0f, 1.0f, 1.0f };
+		alignas( 16 ) float sinC[TRANSFORM_BATCH] = {}, cosC[TRANSFORM_BATCH] = { 1.0f, 1.0f, 1.0f, 1.0f };
+		alignas( 16 ) float scaleX[TRANSFORM_BATCH] = { 1.0f, 1.0f, 1.0f, 1.0f }, scaleY[TRANSFORM_BATCH] = { 1.0f, 1.0f, 1.0f, 1.0f }, scaleZ[TRANSFORM_BATCH] = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+		for ( uint32_t lane = 0; lane < count; lane++ )
+		{
+			uint32_t id = p_base + lane;
+
+			// Rotation order matches the previous model matrix (X about x, then Z about y, then Y about z)
+			sinA[lane]	 = std::sin( m_rotationX[id] );
+			cosA[lane]	 = std::cos( m_rotationX[id] );
+			sinB[lane]	 = std::sin( m_rotationY[id] );
+			cosB[lane]	 = std::cos( m_rotationY[id] );
+			sinC[lane]	 = std::sin( m_rotationZ[id] );
+			cosC[lane]	 = std::cos( m_rotationZ[id] );
+			scaleX[lane] = m_scaleX[id];
+			scaleY[lane] = m_scaleY[id];
+			scaleZ[lane] = m_scaleZ[id];
+		}
+
+		// Rotation matrix elements for every lane, written as R = Rx(a) * Ry(c) * Rz(b)
+		alignas( 16 ) float r[9][TRANSFORM_BATCH];
+
+#if defined( __SSE__ )
+		__m128 sa = _mm_load_ps( sinA ), ca = _mm_load_ps( cosA );
+		__m128 sb = _mm_load_ps( sinB ), cb = _mm_load_ps( cosB );
+		__m128 sc = _mm_load_ps( sinC ), cc = _mm_load_ps( cosC );
+
+		// Shared products
+		__m128 scCb = _mm_mul_ps( sc, cb );
+		__m128 scSb = _mm_mul_ps( sc, sb );
+
+		// Column 0
+		_mm_store_ps( r[0], _mm_mul_ps( cc, cb ) );
+		_mm_store_ps( r[1], _mm_add_ps( _mm_mul_ps( ca, sb ), _mm_mul_ps( sa, scCb ) ) );
+		_mm_store_ps( r[2], _mm_sub_ps( _mm_mul_ps( sa, sb ), _mm_mul_ps( ca, scCb ) ) );
+
+		// Column 1
+		_mm_store_ps( r[3], _mm_sub_ps( _mm_setzero_ps(), _mm_mul_ps( cc, sb ) ) );
+		_mm_store_ps( r[4], _mm_sub_ps( _mm_mul_ps( ca, cb ), _mm_mul_ps( sa, scSb ) ) );
+		_mm_store_ps( r[5], _mm_add_ps( _mm_mul_ps( sa, cb ), _mm_mul_ps( ca, scSb ) ) );
+
+		// Column 2
+		_mm_store_ps( r[6], sc );
+		_mm_store_ps( r[7], _mm_sub_ps( _mm_setzero_ps(), _mm_mul_ps( sa, cc ) ) );
+		_mm_store_ps( r[8], _mm_mul_ps( ca, cc ) );
+#else
+		for ( uint32_t lane = 0; lane < TRANSFORM_BATCH; lane++ )
+		{
+			// Column 0
+			r[0][lane] = cosC[lane] * cosB[lane];
+			r[1][lane] = cosA[lane] * sinB[lane] + sinA[lane] * sinC[lane] * cosB[lane];
+			r[2][lane] = sinA[lane] * sinB[lane] - cosA[lane] * sinC[lane] * cosB[lane];
+
+			// Column 1
+			r[3][lane] = -cosC[lane] * sinB[lane];
+			r[4][lane] = cosA[lane] * cosB[lane] - sinA[lane] * sinC[lane] * sinB[lane];
+			r[5][lane] = sinA[lane] * cosB[lane] + cosA[lane] * sinC[lane] * sinB[lane];
+
+			// Column 2
+			r[6][lane] = sinC[lane];
+			r[7][lane] = -sinA[lane] * cosC[lane];
+			r[8][lane] = cosA[lane] * cosC[lane];
+		}
+#endif
+
+		// Write the matrices of the dirty transforms
+		for ( uint32_t lane = 0; lane < count; lane++ )
+		{
+			uint32_t id = p_base + lane;
+			if ( !m_localDirty[id] ) continue;
+
+			glm::vec3 column0( r[0][lane], r[1][lane], r[2][lane] );
+			glm::vec3 column1( r[3][lane], r[4][lane], r[5][lane] );
+			glm::vec3 column2( r[6][lane], r[7][lane], r[8][lane] );
+
+			// Model matrix is T * R * S
+			m_localMatrices[id][0] = glm::vec4( column0 * scaleX[lane], 0.0f );
+			m_localMatrices[id][1] = glm::vec4( column1 * scaleY[lane], 0.0f );
+			m_localMatrices[id][2] = glm::vec4( column2 * scaleZ[lane], 0.0f );
+			m_localMatrices[id][3] = glm::vec4( m_positionX[id], m_positionY[id], m_positionZ[id], 1.0f );
+
+			// The inverse transpose of R * S is R * S^-1, so no general inverse is needed
+			m_localNormalMatrices[id] = glm::mat3( column0 / scaleX[lane], column1 / scaleY[lane], column2 / scaleZ[lane] );
+		}
+	}
+
+	static inline void MultiplyMatrices( const glm::mat4& p_a, const glm::mat4& p_b, glm::mat4* p_result )
+	{
+#if defined( __SSE__ )
+		// Load the columns of A
+		__m128 a0 = _mm_loadu_ps( &p_a[0][0] );
+		__m128 a1 = _mm_loadu_ps( &p_a[1][0] );
+		__m128 a2 = _mm_loadu_ps( &p_a[2][0] );
+		__m128 a3 = _mm_loadu_ps( &p_a[3][0] );
+
+		// Each column of the result is A multiplied by the matching column of B
+		for ( uint32_t i = 0; i < 4; i++ )
+		{
+			__m128 column = _mm_mul_ps( a0, _mm_set1_ps( p_b[i][0] ) );
+			column		  = _mm_add_ps( column, _mm_mul_ps( a1, _mm_set1_ps( p_b[i][1] ) ) );
+			column		  = _mm_add_ps( column, _mm_mul_ps( a2, _mm_set1_ps( p_b[i][2] ) ) );
+			column		  = _mm_add_ps( column, _mm_mul_ps( a3, _mm_set1_ps( p_b[i][3] ) ) );
+			_mm_storeu_ps( &( *p_result )[i][0], column );
+		}
+#else
+		*p_result = p_a * p_b;
+#endif
+	}
+
+public:
+	TransformStore() : m_anyDirty( false ) {}
+
+	uint32_t Create( const glm::vec3& p_position, const glm::vec3& p_rotation, const glm::vec3& p_scale, const uint32_t& p_parent = TRANSFORM_NO_PARENT )
+	{
+		// The new transform's index
+		uint32_t id = static_cast<uint32_t>( m_parents.size() );
+
+		// Parents must be created before their children so a single forward pass can update the hierarchy
+		if ( p_parent != TRANSFORM_NO_PARENT && p_parent >= id )
+			throw std::invalid_argument( "Transform parent must be created before its children" );
+
+		// Add the components
+		m_positionX.push_back( p_position.x );
+		m_positionY.push_back( p_position.y );
+		m_positionZ.push_back( p_position.z );
+		m_rotationX.push_back( p_rotation.x );
+		m_rotationY.push_back( p_rotation.y );
+		m_rotationZ.push_back( p_rotation.z );
+		m_scaleX.push_back( p_scale.x );
+		m_scaleY.push_back( p_scale.y );
+		m_scaleZ.push_back( p_scale.z );
+		m_parents.push_back( p_parent );
+		m_worldChanged.push_back( 0 );
+
+		// Add the cached matrices
+		m_localMatrices.push_back( glm::mat4( 1.0f ) );
+		m_localNormalMatrices.push_back( glm::mat3( 1.0f ) );
+		m_worldMatrices.push_back( glm::mat4( 1.0f ) );
+		m_normalMatrices.push_back( glm::mat3( 1.0f ) );
+
+		// The new transform needs computing
+		m_localDirty.push_back( 0 );
+		MarkDirty( id );
+
+		return id;
+	}
+
+	void Update()
+	{
+		// Clear the changes from the last update
+		std::fill( m_worldChanged.begin(), m_worldChanged.end(), 0 );
+
+		// Nothing has moved
+		if ( !m_anyDirty ) return;
+
+		uint32_t count = static_cast<uint32_t>( m_parents.size() );
+
+		// Recompute the local matrices in batches, skipping batches where nothing has changed
+		for ( uint32_t base = 0; base < count; base += TRANSFORM_BATCH )
+		{
+			bool batchDirty = false;
+			for ( uint32_t id = base; id < std::min( base + TRANSFORM_BATCH, count ); id++ )
+				batchDirty |= m_localDirty[id];
+
+			if ( batchDirty ) UpdateLocalBatch( base );
+		}
+
+		// Recompute the world matrices (Parents always come before children, so they are already up to date)
+		for ( uint32_t id = 0; id < count; id++ )
+		{
+			uint32_t parent = m_parents[id];
+
+			// Only update if this transform or its parent changed
+			if ( !m_localDirty[id] && ( parent == TRANSFORM_NO_PARENT || !m_worldChanged[parent] ) )
+				continue;
+
+			if ( parent == TRANSFORM_NO_PARENT )
+			{
+				m_worldMatrices[id]	 = m_localMatrices[id];
+				m_normalMatrices[id] = m_localNormalMatrices[id];
+			}
+			else
+			{
+				MultiplyMatrices( m_worldMatrices[parent], m_localMatrices[id], &m_worldMatrices[id] );
+				m_normalMatrices[id] = m_normalMatrices[parent] * m_localNormalMatrices[id];
+			}
+
+			m_worldChanged[id] = 1;
+			m_localDirty[id]   = 0;
+		}
+
+		m_anyDirty = false;
+	}
+
+	void SetParent( const uint32_t& p_id, const uint32_t& p_parent )
+	{
+		// Parents must come before their children
+		if ( p_parent != TRANSFORM_NO_PARENT && p_parent >= p_id )
+			throw std::invalid_argument( "Transform parent must be created before its children" );
+
+		m_parents[p_id] = p_parent;
+		MarkDirty( p_id );
+	}
+
+	void Clear()
+	{
+		// Remove all of the transforms
+		m_positionX.clear(), m_positionY.clear(), m_positionZ.clear();
+		m_rotationX.clear(), m_rotationY.clear(), m_rotationZ.clear();
+		m_scaleX.clear(), m_scaleY.clear(), m_scaleZ.clear();
+		m_parents.clear();
+		m_localDirty.clear();
+		m_worldChanged.clear();
+		m_localMatrices.clear();
+		m_localNormalMatrices.clear();
+		m_worldMatrices.clear();
+		m_normalMatrices.clear();
+		m_anyDirty = false;
+	}
+
+	inline const glm::vec3 GetPosition( const uint32_t& p_id ) const { return glm::vec3( m_positionX[p_id], m_positionY[p_id], m_positionZ[p_id] ); }
+	inline const glm::vec3 GetRotation( const uint32_t& p_id ) const { return glm::vec3( m_rotationX[p_id], m_rotationY[p_id], m_rotationZ[p_id] ); }
+	inline const glm::vec3 GetScale( const uint32_t& p_id ) const { return glm::vec3( m_scaleX[p_id], m_scaleY[p_id], m_scaleZ[p_id] ); }
+	inline const uint32_t& GetParent( const uint32_t& p_id ) const { return m_parents[p_id]; }
+	inline const glm::mat4& GetWorldMatrix( const uint32_t& p_id ) const { return m_worldMatrices[p_id]; }
+	inline const glm::mat3& GetNormalMatrix( const uint32_t& p_id ) const { return m_normalMatrices[p_id]; }
+	inline bool				HasChanged( const uint32_t& p_id ) const { return m_worldChanged[p_id] != 0; }
+	inline uint32_t			GetCount() const { return static_cast<uint32_t>( m_parents.size() ); }
+
+	inline void SetPosition( const uint32_t& p_id, const glm::vec3& p_position )
+	{
+		m_positionX[p_id] = p_position.x, m_positionY[p_id] = p_position.y, m_positionZ[p_id] = p_position.z;
+		MarkDirty( p_id );
+	}
+	inline void SetRotation( const uint32_t& p_id, const glm::vec3& p_rotation )
+	{
+		m_rotationX[p_id] = p_rotation.x, m_rotationY[p_id] = p_rotation.y, m_rotationZ[p_id] = p_rotation.z;
+		MarkDirty( p_id );
+	}
+	inline void SetScale( const uint32_t& p_id, const glm::vec3& p_scale )
+	{
+		m_scaleX[p_id] = p_scale.x, m_scaleY[p_id] = p_scale.y, m_scaleZ[p_id] = p_scale.z;
+		MarkDirty( p_id );
+	}
+};
\ No newline at end of file
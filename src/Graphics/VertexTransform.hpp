@@ -0,0 +1,217 @@
+#pragma once
+
+#include "../Buffers/Vertex.hpp"
+#include "../Jobs/JobSystem.hpp"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <algorithm>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+// The AVX2 kernel is built for its own target and picked at runtime, so the engine runs on CPUs without it
+#if ( defined( __x86_64__ ) || defined( __i386__ ) ) && ( defined( __GNUC__ ) || defined( __clang__ ) )
+#	include <immintrin.h>
+#	define VERTEX_TRANSFORM_AVX2
+#elif defined( __SSE__ )
+#	include <xmmintrin.h>
+#endif
+
+#define VERTEX_TRANSFORM_PARALLEL_THRESHOLD 16384 // Number of vertices in each job when splitting a mesh (A multiple of every kernel's width)
+
+// Positions and normals of a mesh stored as separate streams, so that many vertices can be loaded into one register
+struct VertexStreams
+{
+	std::vector<float> positionX, positionY, positionZ;
+	std::vector<float> normalX, normalY, normalZ;
+
+	void Build( const std::vector<Vertex>& p_vertices )
+	{
+		// Resize every stream
+		size_t count = p_vertices.size();
+		positionX.resize( count ), positionY.resize( count ), positionZ.resize( count );
+		normalX.resize( count ), normalY.resize( count ), normalZ.resize( count );
+
+		// Split the vertices into the streams
+		for ( size_t i = 0; i < count; i++ )
+		{
+			positionX[i] = p_vertices[i].position.x;
+			positionY[i] = p_vertices[i].position.y;
+			positionZ[i] = p_vertices[i].position.z;
+			normalX[i]	 = p_vertices[i].normal.x;
+			normalY[i]	 = p_vertices[i].normal.y;
+			normalZ[i]	 = p_vertices[i].normal.z;
+		}
+	}
+
+	inline size_t GetCount() const { return positionX.size(); }
+};
+
+// The instruction sets a range of vertices can be transformed with
+enum class VertexTransformKernel : uint32_t
+{
+	SCALAR,
+	SSE,
+	AVX2
+};
+
+const char* const VERTEX_TRANSFORM_KERNEL_NAMES[] = { "scalar", "SSE", "AVX2" };
+
+// Whether this build and the CPU it runs on can use p_kernel
+static bool IsVertexTransformKernelSupported( const VertexTransformKernel& p_kernel )
+{
+	switch ( p_kernel )
+	{
+#if defined( VERTEX_TRANSFORM_AVX2 )
+	case VertexTransformKernel::AVX2:
+		__builtin_cpu_init();
+		return __builtin_cpu_supports( "avx2" ) && __builtin_cpu_supports( "fma" );
+#endif
+#if defined( __SSE__ )
+	case VertexTransformKernel::SSE: return true;
+#endif
+	case VertexTransformKernel::SCALAR: return true;
+	default: return false;
+	}
+}
+
+// The widest kernel the CPU supports (Checked once, the first time a mesh is transformed)
+static VertexTransformKernel GetVertexTransformKernel()
+{
+	static const VertexTransformKernel kernel = IsVertexTransformKernelSupported( VertexTransformKernel::AVX2 ) ? VertexTransformKernel::AVX2
+											  : IsVertexTransformKernelSupported( VertexTransformKernel::SSE )	? VertexTransformKernel::SSE
+																												: VertexTransformKernel::SCALAR;
+	return kernel;
+}
+
+// Transforms the vertices one at a time
+static void TransformVertexRangeScalar( const VertexStreams& p_streams, const Vertex* p_source, const glm::mat4& p_modelMatrix, const glm::mat3& p_normalMatrix, Vertex* p_destination, const size_t& p_first, const size_t& p_last )
+{
+	for ( size_t i = p_first; i < p_last; i++ )
+	{
+		glm::vec3 position = glm::vec3( p_modelMatrix * glm::vec4( p_streams.positionX[i], p_streams.positionY[i], p_streams.positionZ[i], 1.0f ) );
+		glm::vec3 normal   = p_normalMatrix * glm::vec3( p_streams.normalX[i], p_streams.normalY[i], p_streams.normalZ[i] );
+
+		p_destination[i] = Vertex { position, normal, p_source[i].texCoord };
+	}
+}
+
+#if defined( __SSE__ )
+// Transforms four vertices at a time, returning the first vertex left over
+static size_t TransformVertexRangeSSE( const VertexStreams& p_streams, const Vertex* p_source, const glm::mat4& p_modelMatrix, const glm::mat3& p_normalMatrix, Vertex* p_destination, const size_t& p_first, const size_t& p_last )
+{
+	// Broadcast every matrix element into its own register
+	__m128 m00 = _mm_set1_ps( p_modelMatrix[0][0] ), m01 = _mm_set1_ps( p_modelMatrix[0][1] ), m02 = _mm_set1_ps( p_modelMatrix[0][2] );
+	__m128 m10 = _mm_set1_ps( p_modelMatrix[1][0] ), m11 = _mm_set1_ps( p_modelMatrix[1][1] ), m12 = _mm_set1_ps( p_modelMatrix[1][2] );
+	__m128 m20 = _mm_set1_ps( p_modelMatrix[2][0] ), m21 = _mm_set1_ps( p_modelMatrix[2][1] ), m22 = _mm_set1_ps( p_modelMatrix[2][2] );
+	__m128 m30 = _mm_set1_ps( p_modelMatrix[3][0] ), m31 = _mm_set1_ps( p_modelMatrix[3][1] ), m32 = _mm_set1_ps( p_modelMatrix[3][2] );
+	__m128 n00 = _mm_set1_ps( p_normalMatrix[0][0] ), n01 = _mm_set1_ps( p_normalMatrix[0][1] ), n02 = _mm_set1_ps( p_normalMatrix[0][2] );
+	__m128 n10 = _mm_set1_ps( p_normalMatrix[1][0] ), n11 = _mm_set1_ps( p_normalMatrix[1][1] ), n12 = _mm_set1_ps( p_normalMatrix[1][2] );
+	__m128 n20 = _mm_set1_ps( p_normalMatrix[2][0] ), n21 = _mm_set1_ps( p_normalMatrix[2][1] ), n22 = _mm_set1_ps( p_normalMatrix[2][2] );
+
+	alignas( 16 ) float out[6][4];
+
+	size_t i = p_first;
+	for ( ; i + 4 <= p_last; i += 4 )
+	{
+		// Load four positions and normals
+		__m128 px = _mm_loadu_ps( &p_streams.positionX[i] ), py = _mm_loadu_ps( &p_streams.positionY[i] ), pz = _mm_loadu_ps( &p_streams.positionZ[i] );
+		__m128 nx = _mm_loadu_ps( &p_streams.normalX[i] ), ny = _mm_loadu_ps( &p_streams.normalY[i] ), nz = _mm_loadu_ps( &p_streams.normalZ[i] );
+
+		// Position = model * (p, 1)
+		_mm_store_ps( out[0], _mm_add_ps( _mm_add_ps( _mm_mul_ps( m00, px ), _mm_mul_ps( m10, py ) ), _mm_add_ps( _mm_mul_ps( m20, pz ), m30 ) ) );
+		_mm_store_ps( out[1], _mm_add_ps( _mm_add_ps( _mm_mul_ps( m01, px ), _mm_mul_ps( m11, py ) ), _mm_add_ps( _mm_mul_ps( m21, pz ), m31 ) ) );
+		_mm_store_ps( out[2], _mm_add_ps( _mm_add_ps( _mm_mul_ps( m02, px ), _mm_mul_ps( m12, py ) ), _mm_add_ps( _mm_mul_ps( m22, pz ), m32 ) ) );
+
+		// Normal = normalMatrix * n
+		_mm_store_ps( out[3], _mm_add_ps( _mm_add_ps( _mm_mul_ps( n00, nx ), _mm_mul_ps( n10, ny ) ), _mm_mul_ps( n20, nz ) ) );
+		_mm_store_ps( out[4], _mm_add_ps( _mm_add_ps( _mm_mul_ps( n01, nx ), _mm_mul_ps( n11, ny ) ), _mm_mul_ps( n21, nz ) ) );
+		_mm_store_ps( out[5], _mm_add_ps( _mm_add_ps( _mm_mul_ps( n02, nx ), _mm_mul_ps( n12, ny ) ), _mm_mul_ps( n22, nz ) ) );
+
+		// Write whole vertices so the destination (Which may be write combined memory) is filled sequentially
+		for ( uint32_t lane = 0; lane < 4; lane++ )
+			p_destination[i + lane] = Vertex { { out[0][lane], out[1][lane], out[2][lane] }, { out[3][lane], out[4][lane], out[5][lane] }, p_source[i + lane].texCoord };
+	}
+
+	return i;
+}
+#endif
+
+#if defined( VERTEX_TRANSFORM_AVX2 )
+// Transforms eight vertices at a time, returning the first vertex left over (Only called once the CPU is known to support AVX2 and FMA)
+__attribute__( ( target( "avx2,fma" ) ) ) static size_t TransformVertexRangeAVX2( const VertexStreams& p_streams, const Vertex* p_source, const glm::mat4& p_modelMatrix, const glm::mat3& p_normalMatrix, Vertex* p_destination, const size_t& p_first, const size_t& p_last )
+{
+	// Broadcast every matrix element into its own register
+	__m256 m00 = _mm256_set1_ps( p_modelMatrix[0][0] ), m01 = _mm256_set1_ps( p_modelMatrix[0][1] ), m02 = _mm256_set1_ps( p_modelMatrix[0][2] );
+	__m256 m10 = _mm256_set1_ps( p_modelMatrix[1][0] ), m11 = _mm256_set1_ps( p_modelMatrix[1][1] ), m12 = _mm256_set1_ps( p_modelMatrix[1][2] );
+	__m256 m20 = _mm256_set1_ps( p_modelMatrix[2][0] ), m21 = _mm256_set1_ps( p_modelMatrix[2][1] ), m22 = _mm256_set1_ps( p_modelMatrix[2][2] );
+	__m256 m30 = _mm256_set1_ps( p_modelMatrix[3][0] ), m31 = _mm256_set1_ps( p_modelMatrix[3][1] ), m32 = _mm256_set1_ps( p_modelMatrix[3][2] );
+	__m256 n00 = _mm256_set1_ps( p_normalMatrix[0][0] ), n01 = _mm256_set1_ps( p_normalMatrix[0][1] ), n02 = _mm256_set1_ps( p_normalMatrix[0][2] );
+	__m256 n10 = _mm256_set1_ps( p_normalMatrix[1][0] ), n11 = _mm256_set1_ps( p_normalMatrix[1][1] ), n12 = _mm256_set1_ps( p_normalMatrix[1][2] );
+	__m256 n20 = _mm256_set1_ps( p_normalMatrix[2][0] ), n21 = _mm256_set1_ps( p_normalMatrix[2][1] ), n22 = _mm256_set1_ps( p_normalMatrix[2][2] );
+
+	alignas( 32 ) float out[6][8];
+
+	size_t i = p_first;
+	for ( ; i + 8 <= p_last; i += 8 )
+	{
+		// Load eight positions and normals
+		__m256 px = _mm256_loadu_ps( &p_streams.positionX[i] ), py = _mm256_loadu_ps( &p_streams.positionY[i] ), pz = _mm256_loadu_ps( &p_streams.positionZ[i] );
+		__m256 nx = _mm256_loadu_ps( &p_streams.normalX[i] ), ny = _mm256_loadu_ps( &p_streams.normalY[i] ), nz = _mm256_loadu_ps( &p_streams.normalZ[i] );
+
+		// Position = model * (p, 1)
+		_mm256_store_ps( out[0], _mm256_fmadd_ps( m00, px, _mm256_fmadd_ps( m10, py, _mm256_fmadd_ps( m20, pz, m30 ) ) ) );
+		_mm256_store_ps( out[1], _mm256_fmadd_ps( m01, px, _mm256_fmadd_ps( m11, py, _mm256_fmadd_ps( m21, pz, m31 ) ) ) );
+		_mm256_store_ps( out[2], _mm256_fmadd_ps( m02, px, _mm256_fmadd_ps( m12, py, _mm256_fmadd_ps( m22, pz, m32 ) ) ) );
+
+		// Normal = normalMatrix * n
+		_mm256_store_ps( out[3], _mm256_fmadd_ps( n00, nx, _mm256_fmadd_ps( n10, ny, _mm256_mul_ps( n20, nz ) ) ) );
+		_mm256_store_ps( out[4], _mm256_fmadd_ps( n01, nx, _mm256_fmadd_ps( n11, ny, _mm256_mul_ps( n21, nz ) ) ) );
+		_mm256_store_ps( out[5], _mm256_fmadd_ps( n02, nx, _mm256_fmadd_ps( n12, ny, _mm256_mul_ps( n22, nz ) ) ) );
+
+		// Write whole vertices so the destination (Which may be write combined memory) is filled sequentially
+		for ( uint32_t lane = 0; lane < 8; lane++ )
+			p_destination[i + lane] = Vertex { { out[0][lane], out[1][lane], out[2][lane] }, { out[3][lane], out[4][lane], out[5][lane] }, p_source[i + lane].texCoord };
+	}
+
+	return i;
+}
+#endif
+
+// Transforms a range of vertices with p_kernel, which must be supported (See IsVertexTransformKernelSupported)
+static void TransformVertexRange( const VertexStreams& p_streams, const Vertex* p_source, const glm::mat4& p_modelMatrix, const glm::mat3& p_normalMatrix, Vertex* p_destination, const size_t& p_first, const size_t& p_last, const VertexTransformKernel& p_kernel = GetVertexTransformKernel() )
+{
+	size_t i = p_first;
+
+	switch ( p_kernel )
+	{
+#if defined( VERTEX_TRANSFORM_AVX2 )
+	case VertexTransformKernel::AVX2: i = TransformVertexRangeAVX2( p_streams, p_source, p_modelMatrix, p_normalMatrix, p_destination, p_first, p_last ); break;
+#endif
+#if defined( __SSE__ )
+	case VertexTransformKernel::SSE: i = TransformVertexRangeSSE( p_streams, p_source, p_modelMatrix, p_normalMatrix, p_destination, p_first, p_last ); break;
+#endif
+	default: break;
+	}
+
+	// Transform the remaining vertices one at a time
+	TransformVertexRangeScalar( p_streams, p_source, p_modelMatrix, p_normalMatrix, p_destination, i, p_last );
+}
+
+static void TransformVertices( const VertexStreams& p_streams, const Vertex* p_source, const glm::mat4& p_modelMatrix, const glm::mat3& p_normalMatrix, Vertex* p_destination, JobSystem* p_jobs = nullptr )
+{
+	size_t count = p_streams.GetCount();
+
+	// Without a job system the mesh is transformed on this thread
+	if ( p_jobs == nullptr )
+	{
+		TransformVertexRange( p_streams, p_source, p_modelMatrix, p_normalMatrix, p_destination, 0, count );
+		return;
+	}
+
+	// Split large meshes into jobs
+	p_jobs->ParallelFor( count, VERTEX_TRANSFORM_PARALLEL_THRESHOLD, [&]( const size_t& p_first, const size_t& p_last ) {
+		TransformVertexRange( p_streams, p_source, p_modelMatrix, p_normalMatrix, p_destination, p_first, p_last );
+	} );
+}
\ No newline at end of file
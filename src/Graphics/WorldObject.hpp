@@ -1,6 +1,8 @@
 #pragma once
 
+#include "./BVH.hpp"
 #include "./Models.hpp"
+#include "./Transforms.hpp"
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -10,83 +12,106 @@
 class WorldObject
 {
 private:
-	Model	  m_model;
-	glm::vec3 m_position;
-	glm::vec3 m_rotation;
-	glm::vec3 m_scale;
+	Model			m_model;
+	TransformStore* m_transforms;
+	uint32_t		m_transformID;
+
+	DynamicBVH* m_tree;
+	int32_t		m_proxyID;
+	glm::vec3	m_treePosition; // World position when the proxy was last refit
+
+	uint32_t m_material; // Index into the material library (Shared with other objects)
+	bool	 m_static;	 // Expected to stay still (Its shadows are cached)
 
 public:
-	void Init( const char* modelPath, const char* texturePath, const glm::vec3& p_position, const glm::vec3& p_rotation, const glm::vec3& p_scale, const VkSampleCountFlagBits& p_sampleCount, const VkDevice& p_logicalDevice, const VkPhysicalDevice& p_physicalDevice, const VkCommandPool& p_commandPool, const VkQueue& p_graphicsQueue,
-			   const VkPhysicalDeviceProperties& p_physicalDeviceProperties, const VkFormat& p_format, const VkImageTiling& p_tiling,
-			   const VkImageUsageFlags& p_usage, const VkMemoryPropertyFlags& p_properties,
-			   const VkImageAspectFlags& p_aspectFlags, const uint32_t& p_samplerID )
+	WorldObject() : m_transforms( nullptr ), m_transformID( 0 ), m_tree( nullptr ), m_proxyID( BVH_NULL_NODE ), m_material( 0 ), m_static( true ) {}
+
+	void Init( const char* modelPath, const uint32_t& p_material, const glm::vec3& p_position, const glm::vec3& p_rotation, const glm::vec3& p_scale, TransformStore* p_transforms )
 	{
-		// Set member variables
-		m_position = p_position;
-		m_rotation = p_rotation;
-		m_scale	   = p_scale;
-
-		// Initialise the model
-		InitModel( modelPath, texturePath, p_sampleCount, p_logicalDevice, p_physicalDevice, p_commandPool, p_graphicsQueue, p_physicalDeviceProperties, p_format, p_tiling,
-				   p_usage, p_properties, p_aspectFlags, p_samplerID );
+		// Create the object's transform in the store
+		m_transforms  = p_transforms;
+		m_transformID = m_transforms->Create( p_position, p_rotation, p_scale );
+
+		// Initialise the model, drawn with a material from the library
+		m_model.Init( modelPath );
+		m_material = p_material;
 	}
 
-	void InitModel( const char* modelPath, const char* texturePath, const VkSampleCountFlagBits& p_sampleCount, const VkDevice& p_logicalDevice, const VkPhysicalDevice& p_physicalDevice, const VkCommandPool& p_commandPool, const VkQueue& p_graphicsQueue,
-					const VkPhysicalDeviceProperties& p_physicalDeviceProperties, const VkFormat& p_format, const VkImageTiling& p_tiling,
-					const VkImageUsageFlags& p_usage, const VkMemoryPropertyFlags& p_properties,
-					const VkImageAspectFlags& p_aspectFlags, const uint32_t& p_samplerID )
+	void ApplyModelMatrix()
 	{
-		// Initialise the model
-		m_model.Init( modelPath, texturePath, p_sampleCount, p_logicalDevice, p_physicalDevice, p_commandPool, p_graphicsQueue, p_physicalDeviceProperties, p_format, p_tiling,
-					  p_usage, p_properties, p_aspectFlags, p_samplerID );
+		// Translate, rotate, and scale the vertices
+		m_model.ApplyMatrix( this->GetModelMatrix(), this->GetNormalMatrix() );
 	}
 
-	void ApplyModelMatrix( const glm::mat4& p_viewMat )
+	std::vector<Vertex> GetVerticesAfterModelMatrix() const
 	{
 		// Translate, rotate, and scale the vertices
-		m_model.ApplyMatrix( this->GetModelMatrix(), this->GetNormalMatrix( p_viewMat ) );
+		return m_model.GetVerticesAfterMatrix( this->GetModelMatrix(), this->GetNormalMatrix() );
 	}
 
-	std::vector<Vertex> GetVerticesAfterModelMatrix( const glm::mat4& p_viewMat ) const
+	inline void WriteVerticesAfterModelMatrix( Vertex* p_destination, JobSystem* p_jobs = nullptr ) const
 	{
-		// Translate, rotate, and scale the vertices
-		return m_model.GetVerticesAfterMatrix( this->GetModelMatrix(), this->GetNormalMatrix( p_viewMat ) );
+		// Translate, rotate, and scale the vertices into the destination
+		m_model.WriteVerticesAfterMatrix( this->GetModelMatrix(), this->GetNormalMatrix(), p_destination, p_jobs );
 	}
 
 	inline const Model&		GetModel() const { return m_model; }
 	inline Model&			GetModelRef() { return m_model; }
-	inline const glm::vec3& GetPos() const { return m_position; }
-	inline const glm::vec3& GetRot() const { return m_rotation; }
-	inline const glm::vec3& GetScale() const { return m_scale; }
+	inline const glm::vec3	GetPos() const { return m_transforms->GetPosition( m_transformID ); }
+	inline const glm::vec3	GetRot() const { return m_transforms->GetRotation( m_transformID ); }
+	inline const glm::vec3	GetScale() const { return m_transforms->GetScale( m_transformID ); }
+	inline const uint32_t&	GetTransformID() const { return m_transformID; }
+	inline const AABB		GetBounds() const { return m_model.GetBounds().Transform( GetModelMatrix() ); }
+	inline const int32_t&	GetProxyID() const { return m_proxyID; }
+	inline const uint32_t&	GetMaterial() const { return m_material; }
+	inline void				SetMaterial( const uint32_t& p_material ) { m_material = p_material; }
+	inline bool				IsStatic() const { return m_static; }
+	inline bool				HasMoved() const { return m_transforms->HasChanged( m_transformID ); } // In the last transform update
+	inline void				SetStatic( const bool& p_static ) { m_static = p_static; }
 
-	inline const glm::mat4 GetModelMatrix() const
+	void AttachToTree( DynamicBVH* p_tree, const uint32_t& p_userData )
 	{
-		return glm::scale(												 // Scale
-			glm::rotate(												 // Rotate X
-				glm::rotate(											 // Rotate Z
-					glm::rotate(										 // Rotate Y
-						glm::translate( glm::mat4( 1.0f ), m_position ), // Translate
-						m_rotation.x, glm::vec3( 1.0f, 0.0f, 0.0f ) ),	 // Rotate X
-					m_rotation.z, glm::vec3( 0.0f, 1.0f, 0.0f ) ),		 // Rotate Z
-				m_rotation.y, glm::vec3( 0.0f, 0.0f, 1.0f ) ),			 // Rotate Y
-			m_scale );													 // Scale
+		// Add the object's world bounds to the tree
+		m_tree		   = p_tree;
+		m_proxyID	   = m_tree->CreateProxy( GetBounds(), p_userData );
+		m_treePosition = glm::vec3( GetModelMatrix()[3] );
 	}
 
-	inline const glm::mat3 GetNormalMatrix( const glm::mat4& p_viewMat ) const
+	void RefitIfMoved()
 	{
-		return glm::transpose( glm::inverse( p_viewMat * this->GetModelMatrix() ) );
+		// Only refit objects whose world matrix changed in the last transform update
+		if ( m_tree == nullptr || !HasMoved() ) return;
+
+		// Move the object's proxy in the tree (Only reinserts when it leaves its fattened bounds)
+		glm::vec3 position = glm::vec3( GetModelMatrix()[3] );
+		m_tree->MoveProxy( m_proxyID, GetBounds(), position - m_treePosition );
+		m_treePosition = position;
 	}
 
-	inline void SetPos( const glm::vec3& p_position ) { m_position = p_position; }
-	inline void SetRot( const glm::vec3& p_rotation ) { m_rotation = p_rotation; }
-	inline void SetScale( const glm::vec3& p_scale ) { m_scale = p_scale; }
+	// The cached world matrix (Only valid after the transform store has been updated)
+	inline const glm::mat4& GetModelMatrix() const { return m_transforms->GetWorldMatrix( m_transformID ); }
+
+	// Takes the normals to world space, the vertex shader rotates them into the view of the frame being drawn
+	inline const glm::mat3& GetNormalMatrix() const { return m_transforms->GetNormalMatrix( m_transformID ); }
+
+	inline void SetParent( const WorldObject& p_parent ) { m_transforms->SetParent( m_transformID, p_parent.GetTransformID() ); }
+
+	inline void SetPos( const glm::vec3& p_position ) { m_transforms->SetPosition( m_transformID, p_position ); }
+	inline void SetRot( const glm::vec3& p_rotation ) { m_transforms->SetRotation( m_transformID, p_rotation ); }
+	inline void SetScale( const glm::vec3& p_scale ) { m_transforms->SetScale( m_transformID, p_scale ); }
 
-	inline void ChangePos( const glm::vec3& p_deltaPosition ) { m_position += p_deltaPosition; }
-	inline void ChangeRot( const glm::vec3& p_deltaRotation ) { m_rotation += p_deltaRotation; }
-	inline void ChangeScale( const glm::vec3& p_deltaScale ) { m_scale += p_deltaScale; }
+	inline void ChangePos( const glm::vec3& p_deltaPosition ) { m_transforms->SetPosition( m_transformID, GetPos() + p_deltaPosition ); }
+	inline void ChangeRot( const glm::vec3& p_deltaRotation ) { m_transforms->SetRotation( m_transformID, GetRot() + p_deltaRotation ); }
+	inline void ChangeScale( const glm::vec3& p_deltaScale ) { m_transforms->SetScale( m_transformID, GetScale() + p_deltaScale ); }
 
 	void Cleanup()
 	{
-		m_model.Cleanup();
+		// Remove the object from the tree
+		if ( m_tree != nullptr )
+		{
+			m_tree->DestroyProxy( m_proxyID );
+			m_tree	  = nullptr;
+			m_proxyID = BVH_NULL_NODE;
+		}
 	}
 };
\ No newline at end of file
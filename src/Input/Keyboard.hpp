@@ -89,6 +89,9 @@ public:
 		}
 	}
 
+	// Whether the key was released since the last call to ProcessInput
+	static inline bool WasReleased( const int &key ) { return Key.count( (char)key ) > 0U && m_releasedMap[Key[(char)key]]; }
+
 	static void ProcessInput( GLFWwindow *p_window, Camera *p_camera, const float &deltaT )
 	{
 		// When escape is pressed, close the window
@@ -0,0 +1,293 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#	include <pthread.h>
+#	include <sched.h>
+#endif
+
+#define JOB_MAIN_THREAD_INDEX 0 // The thread that initialised the job system uses the first queue
+
+struct JobCounter;
+
+struct Job
+{
+	std::function<void()> function;
+	JobCounter*			  counter; // Decremented when the job finishes (Can be nullptr)
+};
+
+// Counts unfinished jobs, and holds jobs that can't start until it reaches zero
+struct JobCounter
+{
+	std::atomic<int32_t> value { 0 };
+	mutable std::mutex	 mutex;
+	std::vector<Job>	 continuations;
+
+	inline bool IsDone() const { return value.load( std::memory_order_acquire ) == 0; }
+};
+
+// A double ended queue per worker, the owner pushes and pops from the back and other workers steal from the front
+struct WorkerQueue
+{
+	std::mutex		mutex;
+	std::deque<Job> jobs;
+
+	void Push( Job&& p_job )
+	{
+		std::lock_guard<std::mutex> lock( mutex );
+		jobs.push_back( std::move( p_job ) );
+	}
+
+	bool Pop( Job* p_job )
+	{
+		std::lock_guard<std::mutex> lock( mutex );
+		if ( jobs.empty() ) return false;
+
+		// Take the newest job (Most likely to still be in the cache)
+		*p_job = std::move( jobs.back() );
+		jobs.pop_back();
+		return true;
+	}
+
+	bool Steal( Job* p_job )
+	{
+		std::lock_guard<std::mutex> lock( mutex );
+		if ( jobs.empty() ) return false;
+
+		// Take the oldest job (Usually the largest piece of work)
+		*p_job = std::move( jobs.front() );
+		jobs.pop_front();
+		return true;
+	}
+};
+
+class JobSystem
+{
+private:
+	std::vector<WorkerQueue*> m_queues;			 // One per worker, plus one for the main thread
+	WorkerQueue				  m_backgroundQueue; // Shared, only taken by workers with nothing else to do
+	std::vector<std::thread>  m_workers;
+
+	std::atomic<bool>		m_running { false };
+	std::atomic<int32_t>	m_queuedJobs { 0 }; // Jobs waiting in any queue (Used to put idle workers to sleep)
+	std::mutex				m_sleepMutex;
+	std::condition_variable m_sleepCondition;
+
+	static inline thread_local uint32_t t_queueIndex = JOB_MAIN_THREAD_INDEX;
+
+	void Submit( Job&& p_job, const bool& p_background = false )
+	{
+		// Push onto this thread's queue (Or the background queue) and wake a sleeping worker
+		m_queuedJobs.fetch_add( 1, std::memory_order_release );
+		( p_background ? &m_backgroundQueue : m_queues[t_queueIndex] )->Push( std::move( p_job ) );
+
+		// Take the sleep lock so a worker can't miss the wake up between checking for jobs and sleeping
+		{
+			std::lock_guard<std::mutex> lock( m_sleepMutex );
+		}
+		m_sleepCondition.notify_one();
+	}
+
+	bool FindJob( Job* p_job, const bool& p_background )
+	{
+		// Check this thread's own queue first
+		if ( m_queues[t_queueIndex]->Pop( p_job ) ) return true;
+
+		// Try to steal from every other queue, starting at the next one along
+		for ( uint32_t i = 1; i < m_queues.size(); i++ )
+			if ( m_queues[( t_queueIndex + i ) % m_queues.size()]->Steal( p_job ) ) return true;
+
+		// Background jobs come last, and only when allowed
+		return p_background && m_backgroundQueue.Steal( p_job );
+	}
+
+	void Execute( Job& p_job )
+	{
+		m_queuedJobs.fetch_sub( 1, std::memory_order_relaxed );
+
+		// Run the job
+		p_job.function();
+
+		// Signal the counter, and release anything that was waiting on it
+		if ( p_job.counter != nullptr ) Decrement( p_job.counter );
+	}
+
+	void Decrement( JobCounter* p_counter )
+	{
+		std::vector<Job> continuations;
+		{
+			// Decrement under the lock, so a waiter can't destroy the counter while it is still in use
+			std::lock_guard<std::mutex> lock( p_counter->mutex );
+
+			// Only the job that finishes last releases the continuations
+			if ( p_counter->value.fetch_sub( 1, std::memory_order_acq_rel ) != 1 ) return;
+			continuations.swap( p_counter->continuations );
+		}
+
+		for ( auto& continuation : continuations )
+			Submit( std::move( continuation ) );
+	}
+
+	void WorkerLoop( const uint32_t& p_queueIndex )
+	{
+		t_queueIndex = p_queueIndex;
+
+		while ( m_running.load( std::memory_order_acquire ) )
+		{
+			// Only a worker that isn't waiting on anything runs background jobs
+			Job job;
+			if ( FindJob( &job, true ) )
+			{
+				Execute( job );
+				continue;
+			}
+
+			// Sleep until there is something to steal
+			std::unique_lock<std::mutex> lock( m_sleepMutex );
+			m_sleepCondition.wait( lock, [this]() { return !m_running.load( std::memory_order_acquire ) || m_queuedJobs.load( std::memory_order_acquire ) > 0; } );
+		}
+	}
+
+	static void PinToCore( std::thread& p_thread, const uint32_t& p_core )
+	{
+#ifdef __linux__
+		// Restrict the thread to a single core
+		cpu_set_t cpuSet;
+		CPU_ZERO( &cpuSet );
+		CPU_SET( p_core, &cpuSet );
+
+		if ( pthread_setaffinity_np( p_thread.native_handle(), sizeof( cpu_set_t ), &cpuSet ) != 0 )
+			throw std::runtime_error( "Failed to pin worker thread to core" );
+#endif
+	}
+
+public:
+	// Starts one worker per extra core when p_workerCount is zero, pinning each worker to its own core if requested
+	void Init( uint32_t p_workerCount = 0, const bool& p_pinWorkers = false )
+	{
+		// Leave a core for the main thread
+		if ( p_workerCount == 0 )
+			p_workerCount = std::max( 1U, std::thread::hardware_concurrency() ) - 1;
+
+		// Create the queues (The main thread's queue comes first)
+		for ( uint32_t i = 0; i <= p_workerCount; i++ )
+			m_queues.push_back( new WorkerQueue() );
+
+		// Start the workers
+		m_running = true;
+		for ( uint32_t i = 1; i <= p_workerCount; i++ )
+		{
+			m_workers.emplace_back( &JobSystem::WorkerLoop, this, i );
+
+			// Leave core zero for the main thread
+			if ( p_pinWorkers ) PinToCore( m_workers.back(), i % std::max( 1U, std::thread::hardware_concurrency() ) );
+		}
+	}
+
+	// Runs a job, once p_dependency (If given) reaches zero, and decrements p_counter (If given) when it finishes
+	void Run( std::function<void()> p_function, JobCounter* p_counter = nullptr, JobCounter* p_dependency = nullptr )
+	{
+		Job job { std::move( p_function ), p_counter };
+
+		// Count the job before it can possibly run
+		if ( p_counter != nullptr ) p_counter->value.fetch_add( 1, std::memory_order_relaxed );
+
+		// Park the job on the dependency if it hasn't finished yet
+		if ( p_dependency != nullptr )
+		{
+			std::lock_guard<std::mutex> lock( p_dependency->mutex );
+			if ( !p_dependency->IsDone() )
+			{
+				p_dependency->continuations.push_back( std::move( job ) );
+				return;
+			}
+		}
+
+		Submit( std::move( job ) );
+	}
+
+	// Runs a long job that nothing waits on soon (Like a pipeline compile), and decrements p_counter (If given) when it finishes
+	// Only idle workers take background jobs, a thread helping out in Wait never does, so they can't hold up the frame
+	void RunBackground( std::function<void()> p_function, JobCounter* p_counter = nullptr )
+	{
+		// Without workers nothing else would ever run it
+		if ( m_workers.empty() )
+		{
+			p_function();
+			return;
+		}
+
+		if ( p_counter != nullptr ) p_counter->value.fetch_add( 1, std::memory_order_relaxed );
+		Submit( Job { std::move( p_function ), p_counter }, true );
+	}
+
+	void Wait( const JobCounter& p_counter )
+	{
+		// Help with other jobs rather than blocking (Never background jobs, which could take far longer than what is waited on)
+		while ( !p_counter.IsDone() )
+		{
+			Job job;
+			if ( FindJob( &job, false ) )
+				Execute( job );
+			else
+				std::this_thread::yield();
+		}
+
+		// Wait for the last job to release the counter
+		std::lock_guard<std::mutex> lock( p_counter.mutex );
+	}
+
+	// Splits [0, p_count) into ranges of at most p_grainSize and runs p_function( first, last ) on each, returning once they are all done
+	template<typename Function>
+	void ParallelFor( const size_t& p_count, const size_t& p_grainSize, const Function& p_function )
+	{
+		// Not worth splitting
+		if ( p_count <= p_grainSize || m_workers.empty() )
+		{
+			if ( p_count > 0 ) p_function( size_t( 0 ), p_count );
+			return;
+		}
+
+		// Queue every range but the first
+		JobCounter counter;
+		for ( size_t first = p_grainSize; first < p_count; first += p_grainSize )
+		{
+			size_t last = std::min( first + p_grainSize, p_count );
+			Run( [&p_function, first, last]() { p_function( first, last ); }, &counter );
+		}
+
+		// Run the first range on this thread, then help with the rest
+		p_function( size_t( 0 ), std::min( p_grainSize, p_count ) );
+		Wait( counter );
+	}
+
+	inline uint32_t GetWorkerCount() const { return static_cast<uint32_t>( m_workers.size() ); }
+
+	void Cleanup()
+	{
+		// Wake and stop the workers
+		{
+			std::lock_guard<std::mutex> lock( m_sleepMutex );
+			m_running = false;
+		}
+		m_sleepCondition.notify_all();
+
+		for ( auto& worker : m_workers )
+			worker.join();
+		m_workers.clear();
+
+		// Destroy the queues
+		for ( auto queue : m_queues )
+			delete queue;
+		m_queues.clear();
+	}
+};
\ No newline at end of file
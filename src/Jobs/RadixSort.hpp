@@ -0,0 +1,86 @@
+#pragma once
+
+#include "JobSystem.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#define RADIX_SORT_DIGIT_BITS 8
+#define RADIX_SORT_BUCKETS	  ( 1 << RADIX_SORT_DIGIT_BITS )
+#define RADIX_SORT_BLOCK_SIZE 4096 // Items counted and scattered by each job
+
+// Stable least significant digit radix sort of anything with a 64 bit key member, spread over the job system a block of items at a time
+// Each pass counts the digits of every block, turns the counts into where each block writes each digit, then scatters the blocks in parallel
+// Passes whose digit is the same for every key are skipped, so keys with unused or constant high bits only pay for the bits that vary
+template<typename Item>
+void RadixSort( std::vector<Item>* p_items, std::vector<Item>* p_scratch, JobSystem* p_jobs = nullptr )
+{
+	size_t count = p_items->size();
+	if ( count < 2 ) return;
+
+	p_scratch->resize( count );
+	size_t blockCount = ( count + RADIX_SORT_BLOCK_SIZE - 1 ) / RADIX_SORT_BLOCK_SIZE;
+
+	// Each block's digit counts, then where it writes each digit
+	std::vector<std::array<size_t, RADIX_SORT_BUCKETS>> offsets( blockCount );
+
+	Item* source	  = p_items->data();
+	Item* destination = p_scratch->data();
+
+	// Runs p_function( block, first, last ) on every block
+	auto forEachBlock = [&]( const auto& p_function ) {
+		auto runBlocks = [&]( const size_t& p_firstBlock, const size_t& p_lastBlock ) {
+			for ( size_t block = p_firstBlock; block < p_lastBlock; block++ )
+				p_function( block, block * RADIX_SORT_BLOCK_SIZE, std::min( count, ( block + 1 ) * RADIX_SORT_BLOCK_SIZE ) );
+		};
+
+		if ( p_jobs != nullptr )
+			p_jobs->ParallelFor( blockCount, 1, runBlocks );
+		else
+			runBlocks( 0, blockCount );
+	};
+
+	for ( uint32_t shift = 0; shift < 64; shift += RADIX_SORT_DIGIT_BITS )
+	{
+		// Count the digits of each block
+		forEachBlock( [&]( const size_t& p_block, const size_t& p_first, const size_t& p_last ) {
+			std::array<size_t, RADIX_SORT_BUCKETS>& counts = offsets[p_block];
+			counts.fill( 0 );
+			for ( size_t i = p_first; i < p_last; i++ )
+				counts[( source[i].key >> shift ) & ( RADIX_SORT_BUCKETS - 1 )]++;
+		} );
+
+		// Skip the pass if every key has the same digit
+		uint32_t firstDigit = ( source[0].key >> shift ) & ( RADIX_SORT_BUCKETS - 1 );
+		size_t	 firstTotal = 0;
+		for ( size_t block = 0; block < blockCount; block++ )
+			firstTotal += offsets[block][firstDigit];
+		if ( firstTotal == count ) continue;
+
+		// Turn the counts into where each block writes each digit (Every block's smaller digits come first, then earlier blocks' equal digits, which keeps the sort stable)
+		size_t offset = 0;
+		for ( uint32_t digit = 0; digit < RADIX_SORT_BUCKETS; digit++ )
+		{
+			for ( size_t block = 0; block < blockCount; block++ )
+			{
+				size_t digitCount	  = offsets[block][digit];
+				offsets[block][digit] = offset;
+				offset += digitCount;
+			}
+		}
+
+		// Scatter each block into the other buffer
+		forEachBlock( [&]( const size_t& p_block, const size_t& p_first, const size_t& p_last ) {
+			std::array<size_t, RADIX_SORT_BUCKETS>& blockOffsets = offsets[p_block];
+			for ( size_t i = p_first; i < p_last; i++ )
+				destination[blockOffsets[( source[i].key >> shift ) & ( RADIX_SORT_BUCKETS - 1 )]++] = source[i];
+		} );
+
+		std::swap( source, destination );
+	}
+
+	// An odd number of passes leaves the result in the scratch buffer
+	if ( source != p_items->data() ) p_items->swap( *p_scratch );
+}
\ No newline at end of file
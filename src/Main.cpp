@@ -1,11 +1,12 @@
 #include "Application.hpp"
 
-int main()
+int main( int argc, char** argv )
 {
 	Application app;
 
 	try // Run the applicaton and catch errors
 	{
+		app.ParseArguments( argc, argv );
 		app.Run();
 	}
 	catch ( const std::exception& e )
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+// Settings are read from environment variables, so they can be changed without rebuilding
+
+static std::string GetConfigString( const char* p_name, const std::string& p_default )
+{
+	// Use the default when the variable isn't set
+	const char* value = std::getenv( p_name );
+	return value != nullptr && value[0] != '\0' ? std::string( value ) : p_default;
+}
+
+static float GetConfigFloat( const char* p_name, const float& p_default )
+{
+	std::string value = GetConfigString( p_name, "" );
+	if ( value.empty() ) return p_default;
+
+	// Parse the value
+	try
+	{
+		return std::stof( value );
+	}
+	catch ( const std::exception& )
+	{
+		throw std::runtime_error( std::string( "Failed to parse " ) + p_name + " as a number" );
+	}
+}
+
+static bool GetConfigBool( const char* p_name, const bool& p_default )
+{
+	std::string value = GetConfigString( p_name, "" );
+	if ( value.empty() ) return p_default;
+
+	// Anything other than a false value enables the setting
+	return !( value == "0" || value == "false" || value == "off" );
+}
\ No newline at end of file
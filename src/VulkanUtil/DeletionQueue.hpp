@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <utility>
+
+// Destroys resources once the GPU has passed the timeline value they were last used at
+class DeletionQueue
+{
+private:
+	std::deque<std::pair<uint64_t, std::function<void()>>> m_deletions; // Ordered by timeline value
+
+public:
+	inline void Push( const uint64_t& p_timelineValue, std::function<void()>&& p_deletion ) { m_deletions.emplace_back( p_timelineValue, std::move( p_deletion ) ); }
+
+	void Flush( const uint64_t& p_completedValue )
+	{
+		// Run every deletion the GPU has finished with
+		while ( !m_deletions.empty() && m_deletions.front().first <= p_completedValue )
+		{
+			m_deletions.front().second();
+			m_deletions.pop_front();
+		}
+	}
+
+	void FlushAll()
+	{
+		// Only call once the device is idle
+		for ( auto& deletion : m_deletions )
+			deletion.second();
+		m_deletions.clear();
+	}
+};
\ No newline at end of file
@@ -4,18 +4,22 @@
 
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
 #include <cstring>
 #include <iostream>
 #include <set>
 #include <string>
+#include <vector>
 
 #define ENABLE_VALIDATION_LAYERS 1 // When in debug mode enable validation layers
 
 const char*	   validationLayers[]	= { "VK_LAYER_KHRONOS_validation" }; // The names of the validation layers
 const uint32_t validationLayerCount = 1;
 
-const char*	   deviceExtensions[]	= { VK_KHR_SWAPCHAIN_EXTENSION_NAME }; // The names of the required extensions
-const uint32_t deviceExtensionCount = 1;
+const char*	   deviceExtensions[]	= { VK_KHR_SWAPCHAIN_EXTENSION_NAME, VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME, VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME }; // The names of the required extensions
+const uint32_t deviceExtensionCount = 3;
 
 static bool CheckDeviceExtensionSupport( const VkPhysicalDevice& p_device )
 {
@@ -37,6 +41,20 @@ static bool CheckDeviceExtensionSupport( const VkPhysicalDevice& p_device )
 	return requiredExtensions.empty();
 }
 
+static bool IsDeviceExtensionSupported( const VkPhysicalDevice& p_device, const char* p_name )
+{
+	// Get the supported device extensions
+	uint32_t extensionCount = 0;
+	vkEnumerateDeviceExtensionProperties( p_device, nullptr, &extensionCount, nullptr );
+	std::vector<VkExtensionProperties> supportedExtensions( extensionCount );
+	vkEnumerateDeviceExtensionProperties( p_device, nullptr, &extensionCount, supportedExtensions.data() );
+
+	for ( const auto& extension : supportedExtensions )
+		if ( strcmp( extension.extensionName, p_name ) == 0 ) return true;
+
+	return false;
+}
+
 static bool IsDeviceSuitable( const VkPhysicalDevice& p_device, const VkSurfaceKHR& p_surface )
 {
 	// Get the queue family indices
@@ -64,6 +82,122 @@ static bool IsDeviceSuitable( const VkPhysicalDevice& p_device, const VkSurfaceK
 	return indices.IsComplete() && extensionSupported && swapchainSufficient && supportedFeatures.samplerAnisotropy;
 }
 
+// Device type scores, chosen so the type always outweighs the other factors
+#define DEVICE_SCORE_DISCRETE	 1000000
+#define DEVICE_SCORE_INTEGRATED	 500000
+#define DEVICE_SCORE_VIRTUAL	 200000
+#define DEVICE_SCORE_CPU		 1000
+#define DEVICE_SCORE_PER_GIB	 1000 // Per GiB of device local memory
+#define DEVICE_SCORE_PER_FEATURE 500  // Per supported optional feature
+
+static VkDeviceSize GetDeviceLocalMemorySize( const VkPhysicalDevice& p_device )
+{
+	// Get the memory heaps
+	VkPhysicalDeviceMemoryProperties memProperties;
+	vkGetPhysicalDeviceMemoryProperties( p_device, &memProperties );
+
+	// Use the largest device local heap (Integrated GPUs report shared system memory here too)
+	VkDeviceSize size = 0;
+	for ( uint32_t i = 0; i < memProperties.memoryHeapCount; i++ )
+		if ( memProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT )
+			size = std::max( size, memProperties.memoryHeaps[i].size );
+
+	return size;
+}
+
+static uint64_t ScorePhysicalDevice( const VkPhysicalDevice& p_device )
+{
+	// Get the device properties and features
+	VkPhysicalDeviceProperties properties;
+	VkPhysicalDeviceFeatures   features;
+	vkGetPhysicalDeviceProperties( p_device, &properties );
+	vkGetPhysicalDeviceFeatures( p_device, &features );
+
+	uint64_t score = 0;
+
+	// Score the type of device
+	switch ( properties.deviceType )
+	{
+		case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU: score += DEVICE_SCORE_DISCRETE; break;
+		case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU: score += DEVICE_SCORE_INTEGRATED; break;
+		case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU: score += DEVICE_SCORE_VIRTUAL; break;
+		case VK_PHYSICAL_DEVICE_TYPE_CPU: score += DEVICE_SCORE_CPU; break;
+		default: break;
+	}
+
+	// Score the amount of device local memory
+	score += GetDeviceLocalMemorySize( p_device ) * DEVICE_SCORE_PER_GIB / ( 1024 * 1024 * 1024 );
+
+	// Score the limits that affect quality
+	score += properties.limits.maxImageDimension2D / 1024;
+	score += static_cast<uint64_t>( properties.limits.maxSamplerAnisotropy );
+	score += properties.limits.framebufferColorSampleCounts & properties.limits.framebufferDepthSampleCounts;
+
+	// Score the optional features the renderer can make use of
+	score += features.sampleRateShading ? DEVICE_SCORE_PER_FEATURE : 0;
+	score += features.pipelineStatisticsQuery ? DEVICE_SCORE_PER_FEATURE : 0;
+	score += properties.limits.timestampComputeAndGraphics ? DEVICE_SCORE_PER_FEATURE : 0;
+
+	return score;
+}
+
+static const char* GetDeviceTypeName( const VkPhysicalDeviceType& p_type )
+{
+	switch ( p_type )
+	{
+		case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU: return "Discrete";
+		case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU: return "Integrated";
+		case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU: return "Virtual";
+		case VK_PHYSICAL_DEVICE_TYPE_CPU: return "CPU";
+		default: return "Other";
+	}
+}
+
+static std::string FormatUUID( const uint8_t* p_uuid )
+{
+	// Format as lower case hex in the usual 8-4-4-4-12 groups
+	std::string uuid;
+	char		byte[3];
+	for ( uint32_t i = 0; i < VK_UUID_SIZE; i++ )
+	{
+		if ( i == 4 || i == 6 || i == 8 || i == 10 ) uuid += '-';
+		std::snprintf( byte, sizeof( byte ), "%02x", p_uuid[i] );
+		uuid += byte;
+	}
+
+	return uuid;
+}
+
+static bool DeviceMatchesOverride( const std::string& p_override, const char* p_name, const std::string& p_uuid )
+{
+	// Compare case insensitively, ignoring dashes so UUIDs can be given in either form
+	auto normalise = []( const std::string& p_text ) {
+		std::string result;
+		for ( char c : p_text )
+			if ( c != '-' ) result += static_cast<char>( std::tolower( static_cast<unsigned char>( c ) ) );
+		return result;
+	};
+
+	std::string target = normalise( p_override );
+
+	// Match the whole UUID, or any part of the name
+	return ( !p_uuid.empty() && target == normalise( p_uuid ) ) || normalise( p_name ).find( target ) != std::string::npos;
+}
+
+static bool IsInstanceExtensionSupported( const char* p_name )
+{
+	// Get the supported instance extensions
+	uint32_t extensionCount = 0;
+	vkEnumerateInstanceExtensionProperties( nullptr, &extensionCount, nullptr );
+	std::vector<VkExtensionProperties> supportedExtensions( extensionCount );
+	vkEnumerateInstanceExtensionProperties( nullptr, &extensionCount, supportedExtensions.data() );
+
+	for ( const auto& extension : supportedExtensions )
+		if ( strcmp( extension.extensionName, p_name ) == 0 ) return true;
+
+	return false;
+}
+
 static bool CheckValidationLayerSupport()
 {
 	// Get the amount of instance layers supported
@@ -113,8 +247,15 @@ static std::vector<const char*> GetRequiredExtensions( uint32_t* glfwExtensionCo
 	if ( ENABLE_VALIDATION_LAYERS )
 		extensions.push_back( VK_EXT_DEBUG_UTILS_EXTENSION_NAME );
 
-	// Increment glfwExtensionCount because another extension was added
-	*glfwExtensionCount += 1;
+	// Add the extension that device extensions such as timeline semaphores depend on
+	extensions.push_back( VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME );
+
+	// Add the extension that exposes device UUIDs when it is available (Used to pick a device by UUID)
+	if ( IsInstanceExtensionSupported( VK_KHR_EXTERNAL_MEMORY_CAPABILITIES_EXTENSION_NAME ) )
+		extensions.push_back( VK_KHR_EXTERNAL_MEMORY_CAPABILITIES_EXTENSION_NAME );
+
+	// Update glfwExtensionCount because more extensions were added
+	*glfwExtensionCount = static_cast<uint32_t>( extensions.size() );
 
 	return extensions;
-}
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <chrono>
+#include <thread>
+
+#define FRAME_LIMITER_SPIN_TIME std::chrono::microseconds( 1500 ) // Time before the deadline to stop sleeping and spin (Covers the scheduler's wake up jitter)
+
+// Caps the frame rate by sleeping for most of the frame and spinning for the rest on a high resolution clock
+class FrameLimiter
+{
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	Clock::duration	  m_period;
+	Clock::time_point m_deadline;
+	bool			  m_enabled;
+
+public:
+	FrameLimiter() : m_period( 0 ), m_enabled( false ) {}
+
+	void Init( const float& p_targetFPS )
+	{
+		// A target of zero or less disables the limiter
+		m_enabled = p_targetFPS > 0.0f;
+		if ( !m_enabled ) return;
+
+		m_period   = std::chrono::duration_cast<Clock::duration>( std::chrono::duration<double>( 1.0 / p_targetFPS ) );
+		m_deadline = Clock::now() + m_period;
+	}
+
+	void Wait()
+	{
+		if ( !m_enabled ) return;
+
+		// Sleep until shortly before the deadline
+		Clock::time_point now = Clock::now();
+		if ( m_deadline - now > FRAME_LIMITER_SPIN_TIME )
+			std::this_thread::sleep_for( m_deadline - now - FRAME_LIMITER_SPIN_TIME );
+
+		// Spin for the rest of the time
+		while ( Clock::now() < m_deadline )
+			std::this_thread::yield();
+
+		// Schedule the next frame, resynchronising if more than a frame behind so missed frames aren't made up with a burst
+		m_deadline += m_period;
+		now = Clock::now();
+		if ( now > m_deadline ) m_deadline = now + m_period;
+	}
+
+	inline bool IsEnabled() const { return m_enabled; }
+};
\ No newline at end of file
@@ -2,20 +2,21 @@
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
 
-static VkImageView CreateImageView( const VkDevice& p_logicalDevice, const VkImage& p_image, const VkFormat& p_format, const VkImageAspectFlags& p_aspectFlags, const uint32_t& p_mipLevels )
+static VkImageView CreateImageView( const VkDevice& p_logicalDevice, const VkImage& p_image, const VkFormat& p_format, const VkImageAspectFlags& p_aspectFlags, const uint32_t& p_mipLevels,
+									const VkImageViewType& p_viewType = VK_IMAGE_VIEW_TYPE_2D, const uint32_t& p_baseArrayLayer = 0, const uint32_t& p_layerCount = 1 )
 {
 	// Setup the creation information for the image view
 	VkImageViewCreateInfo viewCreateInfo {};
 	viewCreateInfo.sType	= VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
 	viewCreateInfo.image	= p_image;
-	viewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+	viewCreateInfo.viewType = p_viewType;
 	viewCreateInfo.format	= p_format;
 	// viewCreateInfo.components					   = VK_COMPONENT_SWIZZLE_IDENTITY;
 	viewCreateInfo.subresourceRange.aspectMask	   = p_aspectFlags;
 	viewCreateInfo.subresourceRange.baseMipLevel   = 0;
 	viewCreateInfo.subresourceRange.levelCount	   = p_mipLevels;
-	viewCreateInfo.subresourceRange.baseArrayLayer = 0;
-	viewCreateInfo.subresourceRange.layerCount	   = 1;
+	viewCreateInfo.subresourceRange.baseArrayLayer = p_baseArrayLayer;
+	viewCreateInfo.subresourceRange.layerCount	   = p_layerCount;
 
 	// Create the image view
 	VkImageView imageView;
@@ -0,0 +1,222 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#define MEMORY_BUDGET_WARNING 0.9f // Fraction of a heap's budget in use before it is warned about
+
+// What an allocation is used for, worked out from the usage it was created with
+enum class MemoryTag : uint32_t
+{
+	VERTEX,
+	INDEX,
+	UNIFORM,
+	STORAGE,
+	TEXTURE,
+	ATTACHMENT,
+	STAGING,
+	OTHER
+};
+
+#define MEMORY_TAG_COUNT 8
+
+const char* const MEMORY_TAG_NAMES[MEMORY_TAG_COUNT] = { "vertex", "index", "uniform", "storage", "texture", "attachment", "staging", "other" };
+
+static MemoryTag GetBufferMemoryTag( const VkBufferUsageFlags& p_usage )
+{
+	if ( p_usage & VK_BUFFER_USAGE_VERTEX_BUFFER_BIT ) return MemoryTag::VERTEX;
+	if ( p_usage & VK_BUFFER_USAGE_INDEX_BUFFER_BIT ) return MemoryTag::INDEX;
+	if ( p_usage & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT ) return MemoryTag::UNIFORM;
+	if ( p_usage & VK_BUFFER_USAGE_STORAGE_BUFFER_BIT ) return MemoryTag::STORAGE;
+	if ( p_usage == VK_BUFFER_USAGE_TRANSFER_SRC_BIT ) return MemoryTag::STAGING;
+	return MemoryTag::OTHER;
+}
+
+static MemoryTag GetImageMemoryTag( const VkImageUsageFlags& p_usage )
+{
+	// Anything rendered into is an attachment, even if it is sampled after (Shadow maps)
+	if ( p_usage & ( VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT ) ) return MemoryTag::ATTACHMENT;
+	if ( p_usage & VK_IMAGE_USAGE_SAMPLED_BIT ) return MemoryTag::TEXTURE;
+	return MemoryTag::OTHER;
+}
+
+struct MemoryTagStats
+{
+	VkDeviceSize bytes		 = 0;
+	VkDeviceSize peakBytes	 = 0;
+	uint32_t	 allocations = 0; // Live
+	uint64_t	 allocated	 = 0; // Over the whole run
+};
+
+struct MemoryHeapStats
+{
+	VkDeviceSize size		 = 0;
+	bool		 deviceLocal = false;
+	VkDeviceSize bytes		 = 0; // Allocated by the engine
+	VkDeviceSize peakBytes	 = 0;
+	uint32_t	 allocations = 0;
+	VkDeviceSize budget		 = 0; // What the process can use before it affects the system, the heap's size without the budget extension
+	VkDeviceSize usage		 = 0; // Used by the whole process as the driver sees it, the engine's bytes without the budget extension
+
+	// Whether the usage has reached MEMORY_BUDGET_WARNING of the budget
+	inline bool IsNearBudget() const { return budget > 0 && usage >= budget * MEMORY_BUDGET_WARNING; }
+};
+
+// Counts every device memory allocation by its tag and the heap it comes from, and reads the driver's budget for each heap when VK_EXT_memory_budget is enabled
+// Allocations go through AllocateDeviceMemory and FreeDeviceMemory, which may be called from any thread
+class MemoryTracker
+{
+private:
+	struct Allocation
+	{
+		VkDeviceSize size;
+		uint32_t	 heap;
+		MemoryTag	 tag;
+	};
+
+	mutable std::mutex							   m_mutex;
+	std::unordered_map<VkDeviceMemory, Allocation> m_allocations;
+	std::vector<MemoryHeapStats>				   m_heaps;
+	std::array<MemoryTagStats, MEMORY_TAG_COUNT>   m_tags;
+	VkPhysicalDeviceMemoryProperties			   m_memoryProperties;
+	VkPhysicalDevice							   m_physicalDevice;
+	PFN_vkGetPhysicalDeviceMemoryProperties2KHR	   m_vkGetPhysicalDeviceMemoryProperties2; // Null without the budget extension
+	bool										   m_budgetSupported;
+
+public:
+	MemoryTracker() : m_physicalDevice( VK_NULL_HANDLE ), m_vkGetPhysicalDeviceMemoryProperties2( nullptr ), m_budgetSupported( false ) {}
+
+	// p_budgetSupported is whether VK_EXT_memory_budget was enabled on the device
+	void Init( const VkInstance& p_instance, const VkPhysicalDevice& p_physicalDevice, const bool& p_budgetSupported )
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+
+		m_physicalDevice = p_physicalDevice;
+		vkGetPhysicalDeviceMemoryProperties( m_physicalDevice, &m_memoryProperties );
+
+		// Load the function the budget is read with (The instance enables the properties 2 extension)
+		m_vkGetPhysicalDeviceMemoryProperties2 = p_budgetSupported ? (PFN_vkGetPhysicalDeviceMemoryProperties2KHR)vkGetInstanceProcAddr( p_instance, "vkGetPhysicalDeviceMemoryProperties2KHR" ) : nullptr;
+		m_budgetSupported					   = m_vkGetPhysicalDeviceMemoryProperties2 != nullptr;
+
+		m_heaps.assign( m_memoryProperties.memoryHeapCount, {} );
+		for ( uint32_t i = 0; i < m_memoryProperties.memoryHeapCount; i++ )
+		{
+			m_heaps[i].size		   = m_memoryProperties.memoryHeaps[i].size;
+			m_heaps[i].deviceLocal = m_memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT;
+		}
+		m_tags = {};
+	}
+
+	void Track( const VkDeviceMemory& p_memory, const VkDeviceSize& p_size, const uint32_t& p_memoryType, const MemoryTag& p_tag )
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+		if ( m_heaps.empty() ) return;
+
+		// Remember the allocation, so freeing it can take it off the right counts
+		uint32_t heap			= m_memoryProperties.memoryTypes[p_memoryType].heapIndex;
+		m_allocations[p_memory] = { p_size, heap, p_tag };
+
+		MemoryHeapStats& heapStats = m_heaps[heap];
+		heapStats.bytes += p_size;
+		heapStats.peakBytes = std::max( heapStats.peakBytes, heapStats.bytes );
+		heapStats.allocations++;
+
+		MemoryTagStats& tagStats = m_tags[static_cast<uint32_t>( p_tag )];
+		tagStats.bytes += p_size;
+		tagStats.peakBytes = std::max( tagStats.peakBytes, tagStats.bytes );
+		tagStats.allocations++;
+		tagStats.allocated++;
+	}
+
+	void Untrack( const VkDeviceMemory& p_memory )
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+
+		auto found = m_allocations.find( p_memory );
+		if ( found == m_allocations.end() ) return;
+
+		const Allocation& allocation = found->second;
+		m_heaps[allocation.heap].bytes -= allocation.size;
+		m_heaps[allocation.heap].allocations--;
+		m_tags[static_cast<uint32_t>( allocation.tag )].bytes -= allocation.size;
+		m_tags[static_cast<uint32_t>( allocation.tag )].allocations--;
+		m_allocations.erase( found );
+	}
+
+	// Reads each heap's budget and the process's usage from the driver (Costs a driver call, so is done when reporting rather than per allocation)
+	void QueryBudget()
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+
+		if ( !m_budgetSupported )
+		{
+			// Fall back to the heaps' sizes and what the engine allocated
+			for ( auto& heap : m_heaps )
+			{
+				heap.budget = heap.size;
+				heap.usage	= heap.bytes;
+			}
+			return;
+		}
+
+		// Chain the budget onto the memory properties query
+		VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties {};
+		budgetProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+		VkPhysicalDeviceMemoryProperties2KHR memoryProperties {};
+		memoryProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2_KHR;
+		memoryProperties.pNext = &budgetProperties;
+		m_vkGetPhysicalDeviceMemoryProperties2( m_physicalDevice, &memoryProperties );
+
+		for ( uint32_t i = 0; i < m_heaps.size(); i++ )
+		{
+			m_heaps[i].budget = budgetProperties.heapBudget[i];
+			m_heaps[i].usage  = budgetProperties.heapUsage[i];
+		}
+	}
+
+	// The counts are copied, so they can be read while other threads allocate (The budget is as of the last QueryBudget)
+	std::vector<MemoryHeapStats> GetHeaps() const
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+		return m_heaps;
+	}
+
+	std::array<MemoryTagStats, MEMORY_TAG_COUNT> GetTags() const
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+		return m_tags;
+	}
+
+	inline const bool& IsBudgetSupported() const { return m_budgetSupported; }
+};
+
+// The tracker every allocation is counted by (Inline rather than static, so every file that includes this shares the one tracker)
+inline MemoryTracker& GetMemoryTracker()
+{
+	static MemoryTracker tracker;
+	return tracker;
+}
+
+// Allocates device memory and counts it under p_tag
+static VkResult AllocateDeviceMemory( const VkDevice& p_logicalDevice, const VkMemoryAllocateInfo& p_allocateInfo, const MemoryTag& p_tag, VkDeviceMemory* p_memory )
+{
+	VkResult result = vkAllocateMemory( p_logicalDevice, &p_allocateInfo, nullptr, p_memory );
+	if ( result == VK_SUCCESS )
+		GetMemoryTracker().Track( *p_memory, p_allocateInfo.allocationSize, p_allocateInfo.memoryTypeIndex, p_tag );
+
+	return result;
+}
+
+// Frees device memory allocated by AllocateDeviceMemory
+static void FreeDeviceMemory( const VkDevice& p_logicalDevice, const VkDeviceMemory& p_memory )
+{
+	GetMemoryTracker().Untrack( p_memory );
+	vkFreeMemory( p_logicalDevice, p_memory, nullptr );
+}
\ No newline at end of file
@@ -0,0 +1,230 @@
+#pragma once
+
+#include "../Descriptors/DescriptorLayoutCache.hpp"
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+// How often one kind of object was asked for
+struct ObjectCacheCounts
+{
+	uint64_t requests = 0;
+	uint64_t hits	  = 0; // An identical object had already been created
+	uint32_t objects  = 0;
+};
+
+struct ObjectCacheStats
+{
+	ObjectCacheCounts samplers;
+	ObjectCacheCounts pipelineLayouts;
+	ObjectCacheCounts renderPasses;
+};
+
+// Creates each distinct sampler, pipeline layout and render pass once, handing the same handle to every identical create info (Descriptor set layouts have their own cache, which this owns)
+// The key is every field of the create info and of the arrays it points to, so two keys only match if the objects would be interchangeable
+// Objects live until Cleanup, nothing else may destroy them
+class ObjectCache
+{
+private:
+	std::unordered_map<std::string, VkSampler>		  m_samplers;
+	std::unordered_map<std::string, VkPipelineLayout> m_pipelineLayouts;
+	std::unordered_map<std::string, VkRenderPass>	  m_renderPasses;
+	DescriptorLayoutCache							  m_descriptorLayouts;
+	ObjectCacheStats								  m_stats;
+
+	VkDevice m_logicalDevice;
+
+	// Appends the bytes of a value to a key (Only used for values without padding)
+	template<typename Value>
+	static void AppendKey( std::string* p_key, const Value& p_value )
+	{
+		p_key->append( reinterpret_cast<const char*>( &p_value ), sizeof( Value ) );
+	}
+
+	static void AppendReference( std::string* p_key, const VkAttachmentReference* p_reference )
+	{
+		// Write whether there is a reference, so a missing one can't match attachment zero
+		AppendKey( p_key, p_reference != nullptr );
+		if ( p_reference == nullptr ) return;
+
+		AppendKey( p_key, p_reference->attachment );
+		AppendKey( p_key, p_reference->layout );
+	}
+
+	// Returns the cached object for the key, calling p_create to make it the first time
+	template<typename Handle, typename Create>
+	static Handle GetObject( std::unordered_map<std::string, Handle>* p_objects, ObjectCacheCounts* p_counts, std::string&& p_key, const Create& p_create )
+	{
+		p_counts->requests++;
+
+		auto found = p_objects->find( p_key );
+		if ( found != p_objects->end() )
+		{
+			p_counts->hits++;
+			return found->second;
+		}
+
+		Handle object = p_create();
+		p_objects->emplace( std::move( p_key ), object );
+		p_counts->objects++;
+		return object;
+	}
+
+public:
+	void Init( const VkDevice& p_logicalDevice )
+	{
+		m_logicalDevice = p_logicalDevice;
+		m_stats			= {};
+		m_descriptorLayouts.Init( p_logicalDevice );
+	}
+
+	VkSampler GetSampler( const VkSamplerCreateInfo& p_createInfo )
+	{
+		if ( p_createInfo.pNext != nullptr )
+			throw std::runtime_error( "Failed to cache sampler, its create info has an extension chain" );
+
+		std::string key;
+		AppendKey( &key, p_createInfo.flags );
+		AppendKey( &key, p_createInfo.magFilter );
+		AppendKey( &key, p_createInfo.minFilter );
+		AppendKey( &key, p_createInfo.mipmapMode );
+		AppendKey( &key, p_createInfo.addressModeU );
+		AppendKey( &key, p_createInfo.addressModeV );
+		AppendKey( &key, p_createInfo.addressModeW );
+		AppendKey( &key, p_createInfo.mipLodBias );
+		AppendKey( &key, p_createInfo.anisotropyEnable );
+		AppendKey( &key, p_createInfo.maxAnisotropy );
+		AppendKey( &key, p_createInfo.compareEnable );
+		AppendKey( &key, p_createInfo.compareOp );
+		AppendKey( &key, p_createInfo.minLod );
+		AppendKey( &key, p_createInfo.maxLod );
+		AppendKey( &key, p_createInfo.borderColor );
+		AppendKey( &key, p_createInfo.unnormalizedCoordinates );
+
+		return GetObject( &m_samplers, &m_stats.samplers, std::move( key ), [&]() {
+			VkSampler sampler;
+			if ( vkCreateSampler( m_logicalDevice, &p_createInfo, nullptr, &sampler ) != VK_SUCCESS )
+				throw std::runtime_error( "Failed to create sampler" );
+			return sampler;
+		} );
+	}
+
+	VkPipelineLayout GetPipelineLayout( const VkPipelineLayoutCreateInfo& p_createInfo )
+	{
+		if ( p_createInfo.pNext != nullptr )
+			throw std::runtime_error( "Failed to cache pipeline layout, its create info has an extension chain" );
+
+		// The set layouts come from their own cache, so equal handles mean equal layouts
+		std::string key;
+		AppendKey( &key, p_createInfo.flags );
+		AppendKey( &key, p_createInfo.setLayoutCount );
+		for ( uint32_t i = 0; i < p_createInfo.setLayoutCount; i++ )
+			AppendKey( &key, p_createInfo.pSetLayouts[i] );
+		AppendKey( &key, p_createInfo.pushConstantRangeCount );
+		for ( uint32_t i = 0; i < p_createInfo.pushConstantRangeCount; i++ )
+		{
+			AppendKey( &key, p_createInfo.pPushConstantRanges[i].stageFlags );
+			AppendKey( &key, p_createInfo.pPushConstantRanges[i].offset );
+			AppendKey( &key, p_createInfo.pPushConstantRanges[i].size );
+		}
+
+		return GetObject( &m_pipelineLayouts, &m_stats.pipelineLayouts, std::move( key ), [&]() {
+			VkPipelineLayout pipelineLayout;
+			if ( vkCreatePipelineLayout( m_logicalDevice, &p_createInfo, nullptr, &pipelineLayout ) != VK_SUCCESS )
+				throw std::runtime_error( "Failed to create pipeline layout" );
+			return pipelineLayout;
+		} );
+	}
+
+	VkRenderPass GetRenderPass( const VkRenderPassCreateInfo& p_createInfo )
+	{
+		if ( p_createInfo.pNext != nullptr )
+			throw std::runtime_error( "Failed to cache render pass, its create info has an extension chain" );
+
+		std::string key;
+		AppendKey( &key, p_createInfo.flags );
+
+		// The attachments
+		AppendKey( &key, p_createInfo.attachmentCount );
+		for ( uint32_t i = 0; i < p_createInfo.attachmentCount; i++ )
+		{
+			const VkAttachmentDescription& attachment = p_createInfo.pAttachments[i];
+			AppendKey( &key, attachment.flags );
+			AppendKey( &key, attachment.format );
+			AppendKey( &key, attachment.samples );
+			AppendKey( &key, attachment.loadOp );
+			AppendKey( &key, attachment.storeOp );
+			AppendKey( &key, attachment.stencilLoadOp );
+			AppendKey( &key, attachment.stencilStoreOp );
+			AppendKey( &key, attachment.initialLayout );
+			AppendKey( &key, attachment.finalLayout );
+		}
+
+		// The subpasses and every attachment they reference
+		AppendKey( &key, p_createInfo.subpassCount );
+		for ( uint32_t i = 0; i < p_createInfo.subpassCount; i++ )
+		{
+			const VkSubpassDescription& subpass = p_createInfo.pSubpasses[i];
+			AppendKey( &key, subpass.flags );
+			AppendKey( &key, subpass.pipelineBindPoint );
+			AppendKey( &key, subpass.inputAttachmentCount );
+			for ( uint32_t j = 0; j < subpass.inputAttachmentCount; j++ )
+				AppendReference( &key, &subpass.pInputAttachments[j] );
+			AppendKey( &key, subpass.colorAttachmentCount );
+			for ( uint32_t j = 0; j < subpass.colorAttachmentCount; j++ )
+			{
+				AppendReference( &key, &subpass.pColorAttachments[j] );
+				AppendReference( &key, subpass.pResolveAttachments != nullptr ? &subpass.pResolveAttachments[j] : nullptr );
+			}
+			AppendReference( &key, subpass.pDepthStencilAttachment );
+			AppendKey( &key, subpass.preserveAttachmentCount );
+			for ( uint32_t j = 0; j < subpass.preserveAttachmentCount; j++ )
+				AppendKey( &key, subpass.pPreserveAttachments[j] );
+		}
+
+		// The dependencies
+		AppendKey( &key, p_createInfo.dependencyCount );
+		for ( uint32_t i = 0; i < p_createInfo.dependencyCount; i++ )
+		{
+			const VkSubpassDependency& dependency = p_createInfo.pDependencies[i];
+			AppendKey( &key, dependency.srcSubpass );
+			AppendKey( &key, dependency.dstSubpass );
+			AppendKey( &key, dependency.srcStageMask );
+			AppendKey( &key, dependency.dstStageMask );
+			AppendKey( &key, dependency.srcAccessMask );
+			AppendKey( &key, dependency.dstAccessMask );
+			AppendKey( &key, dependency.dependencyFlags );
+		}
+
+		return GetObject( &m_renderPasses, &m_stats.renderPasses, std::move( key ), [&]() {
+			VkRenderPass renderPass;
+			if ( vkCreateRenderPass( m_logicalDevice, &p_createInfo, nullptr, &renderPass ) != VK_SUCCESS )
+				throw std::runtime_error( "Failed to create render pass" );
+			return renderPass;
+		} );
+	}
+
+	inline DescriptorLayoutCache*  GetDescriptorLayouts() { return &m_descriptorLayouts; }
+	inline const ObjectCacheStats& GetStats() const { return m_stats; }
+
+	void Cleanup()
+	{
+		// Destroy every object (Nothing may still be using them)
+		for ( const auto& sampler : m_samplers )
+			vkDestroySampler( m_logicalDevice, sampler.second, nullptr );
+		for ( const auto& pipelineLayout : m_pipelineLayouts )
+			vkDestroyPipelineLayout( m_logicalDevice, pipelineLayout.second, nullptr );
+		for ( const auto& renderPass : m_renderPasses )
+			vkDestroyRenderPass( m_logicalDevice, renderPass.second, nullptr );
+		m_samplers.clear();
+		m_pipelineLayouts.clear();
+		m_renderPasses.clear();
+
+		// Destroy the descriptor set layouts
+		m_descriptorLayouts.Cleanup();
+	}
+};
\ No newline at end of file
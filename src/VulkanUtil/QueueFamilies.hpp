@@ -7,11 +7,15 @@ struct QueueFamilyIndices
 {
 	std::optional<uint32_t> graphicsFamily;
 	std::optional<uint32_t> presentFamily;
+	std::optional<uint32_t> transferFamily; // A family without graphics, so uploads go through the dedicated copy engine (Optional)
 
 	bool IsComplete()
 	{
 		return graphicsFamily.has_value() && presentFamily.has_value();
 	}
+
+	// The family to copy on, falling back to the graphics family when there is no dedicated one
+	inline uint32_t GetTransferFamily() const { return transferFamily.value_or( graphicsFamily.value() ); }
 };
 
 static QueueFamilyIndices FindQueueFamilies( const VkPhysicalDevice& p_physicalDevice, const VkSurfaceKHR& p_surface )
@@ -30,19 +34,27 @@ static QueueFamilyIndices FindQueueFamilies( const VkPhysicalDevice& p_physicalD
 		VkBool32 presentSupport = false;
 		for ( uint32_t i = 0; i < queueFamilyCount; i++ ) // Iterate over queue families
 		{
+			VkQueueFlags flags = queueFamilies[i].queueFlags;
+
 			// Look for a graphics queue
-			if ( queueFamilies[i].queueFlags & VK_QUEUE_GRAPHICS_BIT )
+			if ( !indices.graphicsFamily.has_value() && flags & VK_QUEUE_GRAPHICS_BIT )
 				indices.graphicsFamily = i; // Set the graphics family to this index
 
-			// Query the queue family for window surface support
+			// Query the queue family for window surface support (Preferring the graphics family)
 			vkGetPhysicalDeviceSurfaceSupportKHR( p_physicalDevice, i, p_surface, &presentSupport );
-			if ( presentSupport ) indices.presentFamily = i; // Set the presentation family to this index
-
-			// Exit loop if the indices are complete
-			if ( indices.IsComplete() ) return indices;
+			if ( presentSupport && ( !indices.presentFamily.has_value() || indices.graphicsFamily == i ) )
+				indices.presentFamily = i; // Set the presentation family to this index
+
+			// Look for a transfer queue that isn't a graphics queue (Every graphics or compute queue supports transfers)
+			if ( !( flags & VK_QUEUE_GRAPHICS_BIT ) && flags & ( VK_QUEUE_TRANSFER_BIT | VK_QUEUE_COMPUTE_BIT ) )
+			{
+				// Prefer a transfer only queue (Usually a dedicated DMA engine)
+				bool transferOnly = !( flags & VK_QUEUE_COMPUTE_BIT );
+				if ( !indices.transferFamily.has_value() || ( transferOnly && queueFamilies[indices.transferFamily.value()].queueFlags & VK_QUEUE_COMPUTE_BIT ) )
+					indices.transferFamily = i;
+			}
 		}
 	}
 
-	// This is an incomplete set of indices
 	return indices;
 }
\ No newline at end of file
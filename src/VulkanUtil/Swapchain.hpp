@@ -2,12 +2,23 @@
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
 #include <algorithm>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
 #define PREFERRED_COLOUR_SPACE	VK_COLOR_SPACE_SRGB_NONLINEAR_KHR
 #define PREFERRED_COLOUR_FORMAT VK_FORMAT_B8G8R8A8_SRGB
 
-#define PREFERRED_PRESENT_MODE VK_PRESENT_MODE_MAILBOX_KHR
+// How frames are handed to the display, each falls back to the next closest supported mode
+enum class PresentPolicy
+{
+	FIFO,		  // Vsync, never tears
+	FIFO_RELAXED, // Vsync, but tears instead of waiting when a frame is late
+	MAILBOX,	  // Latest frame replaces the queued one, never tears
+	IMMEDIATE	  // No vsync, lowest latency, can tear
+};
+
+#define PREFERRED_PRESENT_POLICY PresentPolicy::MAILBOX
 
 struct SwapchainSupportDetails
 {
@@ -61,16 +72,37 @@ static VkSurfaceFormatKHR ChooseSwapSurfaceFormat( const std::vector<VkSurfaceFo
 	return supportedFormats[0];
 }
 
-static VkPresentModeKHR ChooseSwapPresentMode( const std::vector<VkPresentModeKHR> &supportedPresentModes )
+static PresentPolicy ParsePresentPolicy( const std::string &p_name )
+{
+	// Match the name to a policy
+	if ( p_name == "fifo" ) return PresentPolicy::FIFO;
+	if ( p_name == "fifo_relaxed" ) return PresentPolicy::FIFO_RELAXED;
+	if ( p_name == "mailbox" ) return PresentPolicy::MAILBOX;
+	if ( p_name == "immediate" ) return PresentPolicy::IMMEDIATE;
+
+	throw std::runtime_error( "Unknown present policy \"" + p_name + "\" (Expected fifo, fifo_relaxed, mailbox or immediate)" );
+}
+
+static VkPresentModeKHR ChooseSwapPresentMode( const std::vector<VkPresentModeKHR> &supportedPresentModes, const PresentPolicy &p_policy )
 {
-	for ( const auto &supportedPresentMode : supportedPresentModes )
+	// The modes to try in order for each policy (Only an explicit immediate policy may tear, mailbox falls back to FIFO)
+	std::vector<VkPresentModeKHR> fallbacks;
+	switch ( p_policy )
+	{
+		case PresentPolicy::FIFO: fallbacks = { VK_PRESENT_MODE_FIFO_KHR }; break;
+		case PresentPolicy::FIFO_RELAXED: fallbacks = { VK_PRESENT_MODE_FIFO_RELAXED_KHR }; break;
+		case PresentPolicy::MAILBOX: fallbacks = { VK_PRESENT_MODE_MAILBOX_KHR }; break;
+		case PresentPolicy::IMMEDIATE: fallbacks = { VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_MAILBOX_KHR }; break;
+	}
+
+	for ( const auto &fallback : fallbacks )
 	{
-		// If the present mode matches the preferred present mode
-		if ( supportedPresentMode == PREFERRED_PRESENT_MODE )
-			return supportedPresentMode;
+		// If the present mode is supported
+		if ( std::find( supportedPresentModes.begin(), supportedPresentModes.end(), fallback ) != supportedPresentModes.end() )
+			return fallback;
 	}
 
-	// If an ideal present mode wasn't found, use the one guaranteed to be supported
+	// If none of the modes were supported, use the one guaranteed to be supported
 	return VK_PRESENT_MODE_FIFO_KHR;
 }
 
@@ -0,0 +1,78 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+#include <stdexcept>
+
+// A monotonically increasing counter shared between the CPU and GPU (VK_KHR_timeline_semaphore)
+class TimelineSemaphore
+{
+private:
+	VkDevice	m_logicalDevice;
+	VkSemaphore m_semaphore;
+
+	// The extension functions aren't exported by the loader in Vulkan 1.0
+	PFN_vkWaitSemaphoresKHR			  m_vkWaitSemaphores;
+	PFN_vkGetSemaphoreCounterValueKHR m_vkGetSemaphoreCounterValue;
+
+public:
+	TimelineSemaphore() : m_logicalDevice( VK_NULL_HANDLE ), m_semaphore( VK_NULL_HANDLE ) {}
+
+	void Init( const VkDevice& p_logicalDevice, const uint64_t& p_initialValue )
+	{
+		m_logicalDevice = p_logicalDevice;
+
+		// Load the extension functions
+		m_vkWaitSemaphores			 = (PFN_vkWaitSemaphoresKHR)vkGetDeviceProcAddr( m_logicalDevice, "vkWaitSemaphoresKHR" );
+		m_vkGetSemaphoreCounterValue = (PFN_vkGetSemaphoreCounterValueKHR)vkGetDeviceProcAddr( m_logicalDevice, "vkGetSemaphoreCounterValueKHR" );
+		if ( m_vkWaitSemaphores == nullptr || m_vkGetSemaphoreCounterValue == nullptr )
+			throw std::runtime_error( "Failed to load timeline semaphore functions" );
+
+		// Setup the semaphore type
+		VkSemaphoreTypeCreateInfoKHR typeCreateInfo {};
+		typeCreateInfo.sType		 = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR;
+		typeCreateInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+		typeCreateInfo.initialValue	 = p_initialValue;
+
+		// Setup the semaphore create information
+		VkSemaphoreCreateInfo createInfo {};
+		createInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+		createInfo.pNext = &typeCreateInfo;
+
+		// Create the semaphore
+		if ( vkCreateSemaphore( m_logicalDevice, &createInfo, nullptr, &m_semaphore ) != VK_SUCCESS )
+			throw std::runtime_error( "Failed to create timeline semaphore" );
+	}
+
+	void Wait( const uint64_t& p_value ) const
+	{
+		// Setup the wait information
+		VkSemaphoreWaitInfoKHR waitInfo {};
+		waitInfo.sType			= VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR;
+		waitInfo.semaphoreCount = 1;
+		waitInfo.pSemaphores	= &m_semaphore;
+		waitInfo.pValues		= &p_value;
+
+		// Block until the counter reaches the value
+		if ( m_vkWaitSemaphores( m_logicalDevice, &waitInfo, (uint64_t)-1 ) != VK_SUCCESS )
+			throw std::runtime_error( "Failed to wait on timeline semaphore" );
+	}
+
+	uint64_t GetCompletedValue() const
+	{
+		// Get the value the GPU has reached
+		uint64_t value;
+		if ( m_vkGetSemaphoreCounterValue( m_logicalDevice, m_semaphore, &value ) != VK_SUCCESS )
+			throw std::runtime_error( "Failed to get timeline semaphore value" );
+
+		return value;
+	}
+
+	inline const VkSemaphore& GetSemaphore() const { return m_semaphore; }
+
+	void Cleanup()
+	{
+		vkDestroySemaphore( m_logicalDevice, m_semaphore, nullptr );
+		m_semaphore = VK_NULL_HANDLE;
+	}
+};
\ No newline at end of file